@@ -0,0 +1,598 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kenbak_check.h"
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+#include "kenbak_instr.h"
+#include "kenbak_input.h"
+#include "kenbak_state.h"
+
+// Returns the given description from the calling function, if the given
+// condition does not hold:
+//
+#define KENBAK_CHECK_THAT(cond, msg) \
+    do \
+    { \
+        if(!(cond)) \
+        { \
+            return (msg); \
+        } \
+    } while(false)
+
+// Maximum count of steps an instruction takes from SA to SA (or QC):
+//
+#define KENBAK_CHECK_MAX_STEPS_PER_INSTR 16
+
+/** Returns true, if the given value may be added to P during SB.
+ */
+static bool is_valid_inc(uint8_t const inc)
+{
+    return inc == 0 || inc == 1 || inc == 2 || inc == 4;
+}
+
+static bool is_reg_a_b_or_x(uint8_t const addr)
+{
+    return addr == KENBAK_DATA_ADDR_A
+        || addr == KENBAK_DATA_ADDR_B
+        || addr == KENBAK_DATA_ADDR_X;
+}
+
+/** Returns true, if the given instruction's operand (or jump destination) is
+ *  found via SF and SG (see SE).
+ */
+static bool is_indirect(struct kenbak_instr_decoded const * const dec)
+{
+    return dec->addr_mode == kenbak_addr_mode_indirect
+        || dec->addr_mode == kenbak_addr_mode_indirect_indexed
+        || (dec->addr_mode == kenbak_addr_mode_memory
+                && dec->type == kenbak_instr_type_jump);
+}
+
+static bool is_indexed(struct kenbak_instr_decoded const * const dec)
+{
+    return dec->addr_mode == kenbak_addr_mode_indexed
+        || dec->addr_mode == kenbak_addr_mode_indirect_indexed;
+}
+
+/** Returns true, if the given instruction changes A, B or X during SN.
+ */
+static bool is_reg_changing(struct kenbak_instr_decoded const * const dec)
+{
+    return dec->type == kenbak_instr_type_add
+        || dec->type == kenbak_instr_type_sub
+        || dec->type == kenbak_instr_type_load
+        || dec->type == kenbak_instr_type_and
+        || dec->type == kenbak_instr_type_or
+        || dec->type == kenbak_instr_type_lneg;
+}
+
+/** Invariants of the states that read the instruction's first byte and search
+ *  for its operand (SC to SM), see SB.
+ */
+static char const * get_two_byte_violation(
+    struct kenbak_data const * const d,
+    struct kenbak_instr_decoded const * const dec)
+{
+    KENBAK_CHECK_THAT(
+        d->sig_inc == 255, "Increment must be unset (see SB).");
+    KENBAK_CHECK_THAT(
+        dec->len == 2, "Instruction must be a two byte one (see SD).");
+    return NULL;
+}
+
+/** Invariants of the one byte instructions' states (SU to SY), see SD.
+ */
+static char const * get_one_byte_violation(
+    struct kenbak_data const * const d,
+    struct kenbak_instr_decoded const * const dec)
+{
+    KENBAK_CHECK_THAT(
+        d->sig_inc == 1, "Increment must be one (see SD).");
+    KENBAK_CHECK_THAT(
+        dec->len == 1, "Instruction must be a one byte one (see SD).");
+    return NULL;
+}
+
+/** Invariants of the states that access A or B for a one byte instruction
+ *  (SV, SW and SY), see SU and SX.
+ */
+static char const * get_a_or_b_violation(
+    struct kenbak_data const * const d,
+    struct kenbak_instr_decoded const * const dec)
+{
+    KENBAK_CHECK_THAT(
+        d->sig_r == dec->reg, "R must address the instruction's register.");
+    KENBAK_CHECK_THAT(
+        d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B,
+        "R must address A or B.");
+    return NULL;
+}
+
+char const * kenbak_check_get_violation(struct kenbak_data const * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+    uint8_t const p = d->mem[KENBAK_DATA_ADDR_P];
+    char const * violation = NULL;
+
+    switch(d->state)
+    {
+        case kenbak_state_sa:
+        {
+            KENBAK_CHECK_THAT(
+                is_valid_inc(d->sig_inc), "SA: Increment must be valid.");
+            return NULL;
+        }
+        case kenbak_state_sb:
+        {
+            KENBAK_CHECK_THAT(
+                d->sig_r == KENBAK_DATA_ADDR_P, "SB: R must address P.");
+            KENBAK_CHECK_THAT(
+                is_valid_inc(d->sig_inc), "SB: Increment must be valid.");
+            return NULL;
+        }
+        case kenbak_state_sc:
+        {
+            KENBAK_CHECK_THAT(
+                d->sig_inc == 255, "SC: Increment must be unset (see SB).");
+            KENBAK_CHECK_THAT(d->reg_w == p, "SC: W must equal P (see SB).");
+            return NULL;
+        }
+        case kenbak_state_sd:
+        {
+            KENBAK_CHECK_THAT(
+                d->sig_inc == 255, "SD: Increment must be unset (see SB).");
+            KENBAK_CHECK_THAT(d->reg_w == p, "SD: W must equal P (see SB).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == d->reg_w, "SD: R must equal W (see SC).");
+            return NULL;
+        }
+        case kenbak_state_se:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(d->reg_w == p, "SE: W must equal P (see SB).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == d->reg_w, "SE: R must equal W (see SC).");
+            KENBAK_CHECK_THAT(
+                d->reg_i == d->mem[d->sig_r],
+                "SE: I must hold the instruction's first byte (see SD).");
+            return NULL;
+        }
+        case kenbak_state_sf:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                d->sig_r == p, "SF: R must equal P (see SB and SC).");
+            KENBAK_CHECK_THAT(
+                d->reg_i == d->mem[d->sig_r],
+                "SF: I must hold the instruction's first byte (see SD).");
+            KENBAK_CHECK_THAT(
+                is_indirect(dec), "SF: Instruction must be indirect (see SE).");
+            return NULL;
+        }
+        case kenbak_state_sg:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                d->sig_r == d->reg_w, "SG: R must equal W (see SF).");
+            KENBAK_CHECK_THAT(
+                is_indirect(dec), "SG: Instruction must be indirect (see SE).");
+            return NULL;
+        }
+        case kenbak_state_sh:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                is_indexed(dec),
+                "SH: Instruction must be indexed (see SE and SG).");
+            return NULL;
+        }
+        case kenbak_state_sj:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                d->sig_r == KENBAK_DATA_ADDR_X,
+                "SJ: R must address X (see SH).");
+            KENBAK_CHECK_THAT(
+                is_indexed(dec),
+                "SJ: Instruction must be indexed (see SE and SG).");
+            return NULL;
+        }
+        case kenbak_state_sk: // (falls through)
+        case kenbak_state_sl:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                d->state == kenbak_state_sk || d->sig_r == d->reg_w,
+                "SL: R must equal W (see SK).");
+            KENBAK_CHECK_THAT(
+                dec->type != kenbak_instr_type_store
+                    && dec->type != kenbak_instr_type_jump,
+                "SK/SL: Instruction must read an operand.");
+            return NULL;
+        }
+        case kenbak_state_sm:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                dec->type != kenbak_instr_type_bit,
+                "SM: Instruction must not be a bit one (see SL).");
+            return NULL;
+        }
+        case kenbak_state_sn:
+        {
+            if(d->sig_r == KENBAK_DATA_ADDR_P)
+            {
+                KENBAK_CHECK_THAT(
+                    dec->type == kenbak_instr_type_jump && !dec->jmp_is_mark,
+                    "SN: Instruction must be a jump without mark (see ST).");
+                KENBAK_CHECK_THAT(
+                    d->sig_inc == 0, "SN: Increment must be zero (see SZ).");
+                return NULL;
+            }
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                is_reg_changing(dec),
+                "SN: Instruction must change A, B or X (see SM).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == dec->reg && is_reg_a_b_or_x(d->sig_r),
+                "SN: R must address the instruction's register (see SM).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == KENBAK_DATA_ADDR_A
+                    || (dec->type != kenbak_instr_type_and
+                        && dec->type != kenbak_instr_type_or
+                        && dec->type != kenbak_instr_type_lneg),
+                "SN: R must address A for AND, OR and LNEG.");
+            return NULL;
+        }
+        case kenbak_state_sp:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_store,
+                "SP: Instruction must be a store (see SM).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == dec->reg && is_reg_a_b_or_x(d->sig_r),
+                "SP: R must address the instruction's register (see SM).");
+            return NULL;
+        }
+        case kenbak_state_sq:
+        {
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_jump && dec->jmp_is_mark,
+                "SQ: Instruction must be a jump and mark (see ST).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == KENBAK_DATA_ADDR_P,
+                "SQ: R must address P (see ST).");
+            KENBAK_CHECK_THAT(
+                d->sig_inc == 0, "SQ: Increment must be zero (see SZ).");
+            return NULL;
+        }
+        case kenbak_state_sr: // (falls through)
+        case kenbak_state_ss:
+        {
+            // I holds the byte to be written, here (see SP and SQ).
+
+            KENBAK_CHECK_THAT(
+                d->state == kenbak_state_sr || d->sig_r == d->reg_w,
+                "SS: R must equal W (see SR).");
+            KENBAK_CHECK_THAT(
+                d->sig_inc == 1 || d->sig_inc == 2,
+                "SR/SS: Increment must be one or two (see SP and SQ).");
+            return NULL;
+        }
+        case kenbak_state_st:
+        {
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_jump,
+                "ST: Instruction must be a jump (see SZ).");
+            KENBAK_CHECK_THAT(
+                d->sig_inc == 0, "ST: Increment must be zero (see SZ).");
+            return NULL;
+        }
+        case kenbak_state_su:
+        {
+            return get_one_byte_violation(d, dec);
+        }
+        case kenbak_state_sv:
+        {
+            violation = get_one_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            return get_a_or_b_violation(d, dec);
+        }
+        case kenbak_state_sw:
+        {
+            violation = get_one_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            violation = get_a_or_b_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_shift_rot,
+                "SW: Instruction must be a shift or rotate (see SV).");
+            KENBAK_CHECK_THAT(
+                d->reg_w == d->mem[d->sig_r],
+                "SW: W must hold the register's content (see SV).");
+            return NULL;
+        }
+        case kenbak_state_sx: // (falls through)
+        case kenbak_state_sy:
+        {
+            violation = get_one_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_shift_rot,
+                "SX/SY: Instruction must be a shift or rotate (see SV).");
+            KENBAK_CHECK_THAT(
+                d->state == kenbak_state_sx
+                    || get_a_or_b_violation(d, dec) == NULL,
+                "SY: R must address the instruction's register (see SX).");
+            return NULL;
+        }
+        case kenbak_state_sz:
+        {
+            violation = get_two_byte_violation(d, dec);
+            KENBAK_CHECK_THAT(violation == NULL, violation);
+            KENBAK_CHECK_THAT(
+                dec->type == kenbak_instr_type_jump,
+                "SZ: Instruction must be a jump (see SM).");
+            KENBAK_CHECK_THAT(
+                d->sig_r == dec->reg && is_reg_a_b_or_x(d->sig_r),
+                "SZ: R must address the register to check (see SM).");
+            return NULL;
+        }
+
+        case kenbak_state_qd:
+        {
+            KENBAK_CHECK_THAT(
+                (d->sigs & KENBAK_SIG_MASK_MANUAL) != 0,
+                "QD: A manual operation must be selected (see QC).");
+            return NULL;
+        }
+        case kenbak_state_qe:
+        {
+            KENBAK_CHECK_THAT(
+                d->sig_r == d->reg_w, "QE: R must equal W (see QD).");
+            KENBAK_CHECK_THAT(
+                (int)KENBAK_DATA_IS_SIG(d, kenbak_sig_en)
+                    + (int)KENBAK_DATA_IS_SIG(d, kenbak_sig_da)
+                    + (int)KENBAK_DATA_IS_SIG(d, kenbak_sig_dd) == 1,
+                "QE: Exactly one manual operation must be selected (see QC).");
+            return NULL;
+        }
+
+        case kenbak_state_qb: // (falls through)
+        case kenbak_state_qc: // (falls through)
+        case kenbak_state_qf: // (falls through)
+        case kenbak_state_power_off: // (falls through)
+        case kenbak_state_unknown:
+        {
+            return NULL; // Nothing left by previous states to rely on.
+        }
+
+        default:
+        {
+            return "Unknown state.";
+        }
+    }
+}
+
+// *****************************************************************************
+// *** EXHAUSTIVE CHECK                                                      ***
+// *****************************************************************************
+
+// Counts and the first violation found by kenbak_check_exhaustive():
+//
+struct kenbak_check_run
+{
+    long steps;
+
+    // Which states were validated for which instruction (first byte):
+    //
+    bool seen[kenbak_state_index_count][256];
+
+    char const * violation;
+    enum kenbak_state violation_state;
+};
+
+/** Validates the invariants before each step and takes that step, until the
+ *  given Kenbak-1 reaches one of the given states (after one step, at least)
+ *  or the given maximum count of steps is reached.
+ *
+ * - Returns false on violation (see run->violation).
+ */
+static bool validate_steps(
+    struct kenbak_data * const d,
+    struct kenbak_check_run * const run,
+    uint8_t const instr,
+    enum kenbak_state const until_a,
+    enum kenbak_state const until_b,
+    int const max_steps)
+{
+    for(int i = 0; i < max_steps; ++i)
+    {
+        run->violation = kenbak_check_get_violation(d);
+        if(run->violation != NULL)
+        {
+            run->violation_state = d->state;
+            return false;
+        }
+        run->seen[KENBAK_STATE_GET_INDEX(d->state)][instr] = true;
+        ++run->steps;
+
+        kenbak_emu_step(d);
+
+        if(d->state == until_a || d->state == until_b)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+/** Powers-on the given Kenbak-1, loads the given instruction with an operand
+ *  address at 040 and lets P point to it after the given increment, fills A,
+ *  B, X and the operand with the given value and starts it.
+ *
+ * - The state is SA with the given increment pending, on return.
+ */
+static void start_instr(
+    struct kenbak_data * const d,
+    uint8_t const instr,
+    uint8_t const inc,
+    uint8_t const val)
+{
+    kenbak_emu_press(d, kenbak_input_bit_power_on);
+    kenbak_emu_step(d);
+
+    *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_P) = (uint8_t)(040 - inc);
+    *kenbak_emu_get_mem_ptr(d, 040) = instr;
+    *kenbak_emu_get_mem_ptr(d, 041) = 060;
+    *kenbak_emu_get_mem_ptr(d, 060) = val;
+    *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_A) = val;
+    *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_B) = val;
+    *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_X) = val;
+
+    kenbak_emu_press(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d); // QC => QB
+    kenbak_emu_release(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d); // QB => SA
+
+    assert(d->state == kenbak_state_sa);
+    d->sig_inc = inc; // As left by the previous instruction.
+}
+
+bool kenbak_check_exhaustive(void)
+{
+    static uint8_t const incs[] = { 0, 1, 2, 4 };
+    static uint8_t const vals[] = { 0, 1, 0177, 0200, 0377 };
+    static enum kenbak_input_bit const buttons[] = {
+        kenbak_input_bit_memory_store,
+        kenbak_input_bit_address_display,
+        kenbak_input_bit_memory_read,
+        kenbak_input_bit_address_set
+    };
+
+    static struct kenbak_check_run run; // (large)
+    int combination_count = 0;
+    bool ok = true;
+
+    memset(&run, 0, sizeof run);
+
+    // Each instruction in run mode:
+
+    for(int instr = 0; ok && instr < 256; ++instr)
+    {
+        for(int i = 0; ok && i < (int)(sizeof incs / sizeof *incs); ++i)
+        {
+            for(int v = 0; ok && v < (int)(sizeof vals / sizeof *vals); ++v)
+            {
+                struct kenbak_data * const d = kenbak_emu_create(false);
+
+                start_instr(d, (uint8_t)instr, incs[i], vals[v]);
+                ok = validate_steps(
+                    d,
+                    &run,
+                    (uint8_t)instr,
+                    kenbak_state_sa,
+                    kenbak_state_qc,
+                    KENBAK_CHECK_MAX_STEPS_PER_INSTR);
+                if(ok && d->state != kenbak_state_sa
+                    && d->state != kenbak_state_qc)
+                {
+                    run.violation = "Instruction did not end.";
+                    run.violation_state = d->state;
+                    ok = false;
+                }
+                if(!ok)
+                {
+                    printf(
+                        "Violation for instruction %03o (increment %d, value"
+                            " %03o) in %s: %s\n",
+                        instr,
+                        (int)incs[i],
+                        (int)vals[v],
+                        kenbak_state_get_str(run.violation_state),
+                        run.violation);
+                }
+                kenbak_emu_delete(d);
+            }
+        }
+    }
+
+    // Each manual operation (the instruction is the input byte, here):
+
+    for(int b = 0; ok && b < (int)(sizeof buttons / sizeof *buttons); ++b)
+    {
+        for(int v = 0; ok && v < (int)(sizeof vals / sizeof *vals); ++v)
+        {
+            struct kenbak_data * const d = kenbak_emu_create(false);
+
+            kenbak_emu_press(d, kenbak_input_bit_power_on);
+            kenbak_emu_step(d);
+            *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_INPUT) = vals[v];
+
+            kenbak_emu_press(d, buttons[b]);
+            ok = validate_steps(
+                d,
+                &run,
+                vals[v],
+                kenbak_state_qf,
+                kenbak_state_qf,
+                KENBAK_CHECK_MAX_STEPS_PER_INSTR);
+            kenbak_emu_release(d, buttons[b]);
+            ok = ok && validate_steps(
+                d,
+                &run,
+                vals[v],
+                kenbak_state_qc,
+                kenbak_state_qc,
+                KENBAK_CHECK_MAX_STEPS_PER_INSTR);
+            if(!ok)
+            {
+                printf(
+                    "Violation for manual operation %d (value %03o) in %s:"
+                        " %s\n",
+                    b,
+                    (int)vals[v],
+                    kenbak_state_get_str(run.violation_state),
+                    run.violation);
+            }
+            kenbak_emu_delete(d);
+        }
+    }
+
+    if(!ok)
+    {
+        return false;
+    }
+
+    for(int s = 0; s < (int)kenbak_state_index_count; ++s)
+    {
+        for(int instr = 0; instr < 256; ++instr)
+        {
+            combination_count += run.seen[s][instr] ? 1 : 0;
+        }
+    }
+    printf(
+        "No invariant violated in %ld steps (%d state and instruction"
+            " combinations).\n",
+        run.steps,
+        combination_count);
+    return true;
+}
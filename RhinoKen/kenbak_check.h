@@ -0,0 +1,43 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Validator of the state machine's invariants: What the previous states must
+// have done, before a step is taken in the current state (e.g. W must equal P
+// in SC, see SB).
+//
+// - The states' functions in kenbak_emu.c rely on these invariants without
+//   checking them (to keep the hot path free of asserts that read the memory
+//   or decode the instruction again).
+// - Exhaustively checked via kenbak_check_exhaustive(), at run time every N
+//   steps via kenbak_emu_set_check_interval() and before each step, if
+//   KENBAK_EMU_CHECKED is defined (see kenbak_emu.c).
+
+#ifndef KENBAK_CHECK
+#define KENBAK_CHECK
+
+#include <stdbool.h>
+
+#include "kenbak_data.h"
+
+/**
+ * - Returns NULL, if the given Kenbak-1's registers and signals are what the
+ *   state machine's previous states left for the current state. Otherwise,
+ *   returns the description of the (first) violated invariant.
+ * - Does not change anything (e.g. the memory is not read via the emulator,
+ *   so neither the memoization nor the hashing get involved).
+ */
+char const * kenbak_check_get_violation(struct kenbak_data const * const d);
+
+/**
+ * - Executes each possible instruction (first byte) state by state from SA,
+ *   with each pending increment of P and with some operand and register
+ *   values (to meet and not to meet each jump and skip condition), as well as
+ *   each manual operation from QC, validating the invariants before each step
+ *   (see kenbak_check_get_violation()).
+ * - Prints the count of steps and of state and instruction combinations
+ *   validated or the first violation found.
+ * - Returns true, if no invariant got violated.
+ */
+bool kenbak_check_exhaustive(void);
+
+#endif //KENBAK_CHECK
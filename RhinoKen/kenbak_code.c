@@ -0,0 +1,200 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kenbak_code.h"
+#include "kenbak_instr.h"
+#include "kenbak_data.h"
+#include "kenbak_jmp_cond.h"
+#include "kenbak_jit.h"
+
+/** Returns true, if the decoded instruction may continue somewhere else than
+ *  at the instruction that follows it in memory.
+ */
+static bool is_block_end(struct kenbak_instr_decoded const * const dec)
+{
+    switch((enum kenbak_instr_type)dec->type)
+    {
+        case kenbak_instr_type_jump:
+        {
+            return true;
+        }
+        case kenbak_instr_type_bit:
+        {
+            return dec->bit_is_skip;
+        }
+        case kenbak_instr_type_misc:
+        {
+            return dec->is_halt;
+        }
+
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+/** Returns true, if the given address is one of the given count of bytes
+ *  starting at the given first address (wrapping around).
+ */
+static bool is_in_range(uint8_t const addr, uint8_t const first, int const len)
+{
+    return (uint8_t)(addr - first) < len;
+}
+
+static void fill_block(
+    struct kenbak_code_cache * const cache,
+    struct kenbak_code_block * const block,
+    uint8_t const * const mem,
+    uint8_t const addr)
+{
+    uint8_t cur = addr;
+
+    block->len = 0;
+    while(block->len < KENBAK_CODE_MAX_BLOCK_LEN)
+    {
+        struct kenbak_code_instr * const instr = block->instrs + block->len;
+
+        instr->addr = cur;
+        instr->first_byte = mem[cur];
+        instr->second_byte = mem[(uint8_t)(cur + 1)];
+        instr->dec = KENBAK_INSTR_DECODE(instr->first_byte);
+        instr->handler = cache->translator == NULL
+            ? NULL : cache->translator(instr->dec);
+        ++block->len;
+
+        cache->is_code[cur] = true;
+        if(instr->dec->len == 2)
+        {
+            cache->is_code[(uint8_t)(cur + 1)] = true;
+        }
+
+        if(is_block_end(instr->dec))
+        {
+            break;
+        }
+        cur += instr->dec->len;
+    }
+    block->countdown_reg = kenbak_code_get_countdown_reg(mem, addr);
+    block->is_compiled = false;
+    block->native = NULL;
+    block->gen = cache->gen;
+}
+
+int kenbak_code_get_countdown_reg(uint8_t const * const mem, uint8_t const addr)
+{
+    struct kenbak_instr_decoded const * const sub =
+        KENBAK_INSTR_DECODE(mem[addr]);
+
+    if(sub->type != kenbak_instr_type_sub
+        || sub->addr_mode != kenbak_addr_mode_constant
+        || mem[(uint8_t)(addr + 1)] != 1)
+    {
+        return -1;
+    }
+
+    struct kenbak_instr_decoded const * const jmp =
+        KENBAK_INSTR_DECODE(mem[(uint8_t)(addr + 2)]);
+
+    if(jmp->type != kenbak_instr_type_jump
+        || jmp->addr_mode != kenbak_addr_mode_constant // (direct jump)
+        || jmp->jmp_is_mark
+        || jmp->jmp_is_unc
+        || jmp->jmp_cond != kenbak_jmp_cond_non_zero
+        || jmp->reg != sub->reg
+        || mem[(uint8_t)(addr + 3)] != addr)
+    {
+        return -1;
+    }
+
+    if(is_in_range(KENBAK_DATA_ADDR_P, addr, 4)
+        || is_in_range(sub->reg, addr, 4)
+        || is_in_range(KENBAK_DATA_ADDR_OC_FOR(sub->reg), addr, 4))
+    {
+        return -1; // Would modify itself.
+    }
+    return sub->reg;
+}
+
+void kenbak_code_invalidate(struct kenbak_code_cache * const cache)
+{
+    memset(cache->is_code, 0, sizeof cache->is_code);
+
+    ++cache->gen;
+    if(cache->gen == 0)
+    {
+        // Wrapped around, make sure that no block is seen as valid by chance:
+
+        for(int i = 0; i < KENBAK_CODE_ADDR_COUNT; ++i)
+        {
+            cache->blocks[i].gen = 0;
+        }
+        cache->gen = 1;
+    }
+}
+
+void kenbak_code_set_translator(
+    struct kenbak_code_cache * const cache,
+    kenbak_code_translator const translator)
+{
+    cache->translator = translator;
+    kenbak_code_invalidate(cache);
+}
+
+void kenbak_code_set_jit(
+    struct kenbak_code_cache * const cache, struct kenbak_jit * const jit)
+{
+    if(cache->jit != jit)
+    {
+        kenbak_jit_delete(cache->jit);
+        cache->jit = jit;
+    }
+    kenbak_code_invalidate(cache);
+}
+
+struct kenbak_code_block const * kenbak_code_get_block(
+    struct kenbak_code_cache * const cache,
+    uint8_t const * const mem,
+    uint8_t const addr)
+{
+    struct kenbak_code_block * const block = cache->blocks + addr;
+
+    if(block->gen != cache->gen)
+    {
+        fill_block(cache, block, mem, addr);
+    }
+    return block;
+}
+
+struct kenbak_code_cache * kenbak_code_create(void)
+{
+    struct kenbak_code_cache * const cache = calloc(1, sizeof *cache);
+
+    if(cache == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    cache->gen = 1; // All blocks are invalid (their generation is zero).
+    cache->translator = NULL;
+    cache->jit = NULL;
+
+    return cache;
+}
+
+void kenbak_code_delete(struct kenbak_code_cache * const cache)
+{
+    if(cache == NULL)
+    {
+        return;
+    }
+    kenbak_jit_delete(cache->jit);
+    free(cache);
+}
@@ -0,0 +1,170 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Cache of pre-decoded basic blocks, keyed by their start addresses.
+//
+// - A basic block is a straight sequence of instructions, ending with a jump,
+//   a skip or a HALT instruction (or after KENBAK_CODE_MAX_BLOCK_LEN
+//   instructions).
+// - Each write to a byte of a cached block must be reported via
+//   KENBAK_CODE_ON_WRITE() to keep the cache valid (self-modifying code).
+
+#ifndef KENBAK_CODE
+#define KENBAK_CODE
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kenbak_instr.h"
+
+#define KENBAK_CODE_ADDR_COUNT 256
+
+#define KENBAK_CODE_MAX_BLOCK_LEN 16 // Instructions.
+
+struct kenbak_data;
+struct kenbak_code_instr;
+struct kenbak_jit;
+struct kenbak_jit_run;
+
+// Handler of threaded code, executes a specific kind of instruction from state
+// SC on (see kenbak_emu_set_threaded_code()):
+//
+// - Returns the summed-up byte time count of all states passed, or -1 on
+//   error, adds the count of states passed to the given step count.
+//
+typedef int (*kenbak_code_handler)(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps);
+
+// Returns the handler for the given decoded instruction, or NULL, if there is
+// none:
+//
+typedef kenbak_code_handler (*kenbak_code_translator)(
+    struct kenbak_instr_decoded const * const dec);
+
+// Native code of a whole block, compiled by the JIT (see kenbak_jit.h):
+//
+typedef void (*kenbak_code_native)(
+    struct kenbak_data * const d, struct kenbak_jit_run * const run);
+
+struct kenbak_code_instr
+{
+    struct kenbak_instr_decoded const * dec; // Decoded first byte.
+    kenbak_code_handler handler; // NULL, if there is no threaded code.
+
+    uint8_t addr; // Address of the first byte.
+    uint8_t first_byte;
+    uint8_t second_byte; // (undefined for one-byte instructions)
+};
+
+struct kenbak_code_block
+{
+    // The block is valid, if this equals the generation of the cache:
+    //
+    uint32_t gen;
+
+    int len; // Count of instructions.
+
+    // Counter address, if the block is a countdown loop (see
+    // kenbak_code_get_countdown_reg()), otherwise -1:
+    //
+    int countdown_reg;
+
+    // Did the JIT try to compile the block, yet? The native code is NULL, if
+    // it did not (or could not):
+    //
+    bool is_compiled;
+    kenbak_code_native native;
+
+    struct kenbak_code_instr instrs[KENBAK_CODE_MAX_BLOCK_LEN];
+};
+
+struct kenbak_code_cache
+{
+    // Incremented to invalidate all blocks at once (never zero):
+    //
+    uint32_t gen;
+
+    // Translates decoded instructions into threaded code, NULL for none:
+    //
+    kenbak_code_translator translator;
+
+    // Compiles the blocks into native code, NULL for none (owned by the
+    // cache):
+    //
+    struct kenbak_jit * jit;
+
+    // Is the byte at the address (index) part of a valid block?
+    //
+    bool is_code[KENBAK_CODE_ADDR_COUNT];
+
+    // Indexed by start address:
+    //
+    struct kenbak_code_block blocks[KENBAK_CODE_ADDR_COUNT];
+};
+
+// To be used for each write to the memory, invalidates the cache, if a byte of
+// a cached block gets written to:
+//
+#define KENBAK_CODE_ON_WRITE(cache, addr) \
+    do \
+    { \
+        if((cache)->is_code[(uint8_t)(addr)]) \
+        { \
+            kenbak_code_invalidate(cache); \
+        } \
+    } while(false)
+
+/**
+ * - Invalidates all blocks.
+ */
+void kenbak_code_invalidate(struct kenbak_code_cache * const cache);
+
+/**
+ * - Sets the translator to be used for the threaded code of the blocks (may be
+ *   NULL), invalidates all blocks.
+ */
+void kenbak_code_set_translator(
+    struct kenbak_code_cache * const cache,
+    kenbak_code_translator const translator);
+
+/**
+ * - Sets the JIT to compile the blocks into native code (may be NULL), deletes
+ *   the one set before and invalidates all blocks.
+ * - The cache takes ownership of the given JIT.
+ */
+void kenbak_code_set_jit(
+    struct kenbak_code_cache * const cache, struct kenbak_jit * const jit);
+
+/**
+ * - Returns the block starting at the given address, decoding it from the
+ *   given memory first, if it is not cached.
+ * - The returned block is valid until the cache gets invalidated.
+ */
+struct kenbak_code_block const * kenbak_code_get_block(
+    struct kenbak_code_cache * const cache,
+    uint8_t const * const mem,
+    uint8_t const addr);
+
+/**
+ * - Returns the address of the counter (A, B or X) of the countdown loop at
+ *   the given address in the given memory, or -1, if there is none:
+ *
+ *   addr:     SUB-<reg> constant 1
+ *   addr + 2: JPD-<reg> != 0 addr
+ *
+ * - The loop touches nothing but P, its counter and the counter's OC
+ *   register, a loop overlapping these is not seen as a countdown loop.
+ */
+int kenbak_code_get_countdown_reg(uint8_t const * const mem, uint8_t const addr);
+
+/**
+ * - Caller takes ownership of returned object.
+ * - Returns NULL on error.
+ */
+struct kenbak_code_cache * kenbak_code_create(void);
+
+void kenbak_code_delete(struct kenbak_code_cache * const cache);
+
+#endif //KENBAK_CODE
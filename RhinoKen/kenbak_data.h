@@ -4,14 +4,33 @@
 #ifndef KENBAK_DATA
 #define KENBAK_DATA
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "kenbak_code.h"
+#include "kenbak_memo.h"
 #include "kenbak_input.h"
-#include "kenbak_output.h"
+#include "kenbak_sig.h"
 #include "kenbak_state.h"
 #include "kenbak_x.h"
 
 #define KENBAK_DATA_DELAY_LINE_SIZE 128 // bytes
+#define KENBAK_DATA_MEM_SIZE (2 * KENBAK_DATA_DELAY_LINE_SIZE) // bytes
+
+#define KENBAK_DATA_CACHE_LINE_SIZE 64 // bytes
+
+#ifdef _MSC_VER
+    #define KENBAK_DATA_ALIGNED(byte_count) __declspec(align(byte_count))
+#else //_MSC_VER
+    #define KENBAK_DATA_ALIGNED(byte_count) _Alignas(byte_count)
+#endif //_MSC_VER
+
+// Delay line 0 holds the bytes at addresses 0 to 127, delay line 1 the bytes
+// at addresses 128 to 255 (returns a pointer into the memory):
+//
+#define KENBAK_DATA_DELAY_LINE(d, index) \
+    ((d)->mem + (index) * KENBAK_DATA_DELAY_LINE_SIZE)
 
 #define KENBAK_DATA_ADDR_A 0 // A "register".
 #define KENBAK_DATA_ADDR_B 1 // B "register".
@@ -42,52 +61,72 @@
 
 #define KENBAK_DATA_ADDR_INPUT 255 // Input "register".
 
-struct kenbak_data
-{
-    struct kenbak_input input;
-
-    struct kenbak_output output;
+struct kenbak_data;
 
-    enum kenbak_state state;
-    
-    // The boolean signals are all to-be-interpreted as true meaning that the
-    // signal is active, even if the hardware puts the "signal" to ground (0V)
-    // to signalize that it is active:
+// A function to be called before each step by the traced engine variant (see
+// kenbak_emu_set_trace()):
+//
+typedef void (* kenbak_data_trace_fn)(
+    void * const ctx, struct kenbak_data const * const d);
 
-    // BU = The eight data input switches are scanned by T0 through T7 and ORed
-    //      together to produce the serial signal BU.
-    bool sig_bu;
+// The signals are packed into a byte (see enum kenbak_sig):
+//
+#define KENBAK_DATA_IS_SIG(d, sig) (((d)->sigs & KENBAK_SIG_MASK(sig)) != 0)
+#define KENBAK_DATA_SET_SIG(d, sig) ((d)->sigs |= KENBAK_SIG_MASK(sig))
+#define KENBAK_DATA_CLEAR_SIG(d, sig) \
+    ((d)->sigs &= (uint8_t)~KENBAK_SIG_MASK(sig))
 
-    // CL = True when the clear push button is depressed. (04)
-    bool sig_cl;
+// The cold part of a Kenbak-1's state representation, which is not accessed
+// by the steps of the (default) engine (see cold in struct kenbak_data):
+//
+struct kenbak_data_cold
+{
+    // Validate the state machine's invariants each check_interval steps (zero
+    // for never, see kenbak_emu_set_check_interval()) and the first violation
+    // found (or NULL, the countdown is part of the hot data):
+    //
+    uint32_t check_interval;
+    char const * check_violation;
 
-    // ^DA = Display address (from push button of that name). Goes to ground
-    //       when button is pushed. (04)
-    bool sig_da;
+    // The trace function and its context (see kenbak_emu_set_trace()):
+    //
+    kenbak_data_trace_fn trace;
+    void * trace_ctx;
 
-    // ^DD = Display data (from read memory push button) after being cleaned up.
-    //       Goes to ground when button is pushed. (04)
-    bool sig_dd;
+    // Count of steps taken in each state by the instrumented engine variant,
+    // indexed by enum kenbak_state_index (see kenbak_variant.h):
+    //
+    uint64_t state_steps[kenbak_state_index_count];
 
-    // ^EA = Enter Address (from set address push button) after being cleaned
-    //       up. Goes to ground when button is pushed. (04)
-    bool sig_ea;
+    // This indicates, if the memory shall initially be filled with random
+    // values or with zeros.
+    bool randomize_memory;
 
-    // ED = Automatic processing should end after the current instruction is
-    //      finished. (22)
-    bool sig_ed;
+    // The seed and the state of the Kenbak-1's own pseudo-random number
+    // generator used for that (see kenbak_rand.h and kenbak_emu_options):
+    //
+    uint64_t seed;
+    uint64_t rand_state;
+};
 
-    // ^EN = Enter data (from store memory push button) after being cleaned up.
-    //       Goes to ground when button is pushed. (04)
-    bool sig_en;
+// The layout is cache-line-aware: The first cache line holds everything a
+// step needs (state, registers, signals, input and the pointers to the
+// attached caches), the memory fills the next four cache lines and anything
+// else is kept in the cold part. So each Kenbak-1 takes exactly five cache
+// lines (see KENBAK_DATA_SIZE), which matters when many of them get
+// scheduled together.
+//
+struct kenbak_data
+{
+    enum kenbak_state state;
 
-    // ^GO = Signal from start push button after being cleaned up. Goes to
-    //       ground when button is pushed. (04)
-    bool sig_go;
+    // The packed input, see enum kenbak_input_bit:
+    //
+    uint32_t input;
 
-    // X1, X2, X3, X4 or none of these signals:
+    // The packed boolean signals, see enum kenbak_sig and KENBAK_DATA_IS_SIG():
     //
-    enum kenbak_x sig_x;
+    uint8_t sigs;
 
     // R = Serial signal, "holds" the address for read or write.
     //     When R0 to R6 equal L0 to L6, the data for the desired address will
@@ -111,6 +150,11 @@ struct kenbak_data
     //
     uint8_t sig_inc;
 
+    // X1, X2, X3, X4 or none of these signals (an enum kenbak_x, stored in a
+    // byte to keep the hot data within one cache line):
+    //
+    uint8_t sig_x;
+
     // I0/I7 = Generally the I register is the instruction register. I7 is the
     //         most significant bit. As an instruction register, I holds the
     //         first byte of an instruction. (14)
@@ -120,6 +164,9 @@ struct kenbak_data
     // K0/K7 = The K register controls the data lamps. K7 is the most
     //         significant bit. (07)
     //
+    // - Follows the output or input byte while X3 or X4 is active, without
+    //   being updated here, use kenbak_emu_get_reg_k() to read it.
+    //
     uint8_t reg_k;
 
     // W0/W7 = W register. W0 is least significant bit. A general utility
@@ -127,12 +174,66 @@ struct kenbak_data
     //
     uint8_t reg_w;
 
-    // This indicates, if the memory shall initially be filled with random
-    // values or with zeros.
-    bool randomize_memory;
+    // Did any push button change since the input was sampled the last time?
+    //
+    bool input_changed;
 
-    uint8_t delay_line_0[KENBAK_DATA_DELAY_LINE_SIZE];
-    uint8_t delay_line_1[KENBAK_DATA_DELAY_LINE_SIZE];
+    // Is the analytic timing model of the delay line memory enabled (see
+    // kenbak_emu_set_timing())? If not, each step lasts one byte time.
+    //
+    bool timing;
+
+    // Is the memory's hash updated on each write (see kenbak_emu_set_hashing()
+    // and kenbak_hash.h)? Only valid, if mem_hash_valid is true, too:
+    //
+    bool hashing;
+    bool mem_hash_valid;
+
+    // Count of byte times passed since power-on (wraps around). The lower
+    // seven bits are the delay line position of the byte that is at the
+    // memory's output during the current byte time (L is one byte ahead).
+    //
+    uint32_t byte_times;
+
+    // Count of writes to the output register by the Kenbak-1 (wraps around,
+    // see kenbak_emu_run()).
+    //
+    uint32_t output_write_count;
+
+    // Count of steps to the next validation of the state machine's invariants
+    // or zero, if disabled (see check_interval in struct kenbak_data_cold):
+    //
+    uint32_t check_countdown;
+
+    uint64_t mem_hash;
+
+    // The cache of pre-decoded basic blocks used by kenbak_emu_run(), or NULL,
+    // if disabled (see kenbak_emu_set_code_cache()):
+    //
+    struct kenbak_code_cache * code_cache;
+
+    // The memoization of subroutine calls used by kenbak_emu_run(), or NULL,
+    // if disabled (see kenbak_emu_set_memo()):
+    //
+    struct kenbak_memo * memo;
+
+    struct kenbak_data_cold * cold;
+
+    // The memory, indexed by address (see KENBAK_DATA_DELAY_LINE() for the two
+    // delay lines):
+    //
+    KENBAK_DATA_ALIGNED(KENBAK_DATA_CACHE_LINE_SIZE)
+        uint8_t mem[KENBAK_DATA_MEM_SIZE];
 };
 
+#define KENBAK_DATA_SIZE \
+    (KENBAK_DATA_CACHE_LINE_SIZE + KENBAK_DATA_MEM_SIZE) // bytes
+
+_Static_assert(
+    offsetof(struct kenbak_data, mem) == KENBAK_DATA_CACHE_LINE_SIZE,
+    "Hot data of struct kenbak_data must fit into the first cache line.");
+_Static_assert(
+    sizeof (struct kenbak_data) == KENBAK_DATA_SIZE,
+    "Struct kenbak_data must take five cache lines.");
+
 #endif //KENBAK_DATA
@@ -0,0 +1,22 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#ifndef KENBAK_DISPATCH
+#define KENBAK_DISPATCH
+
+// How a single step gets dispatched to the handler of the current state:
+//
+enum kenbak_dispatch
+{
+    kenbak_dispatch_switch = 0, // Via a switch statement on the state.
+    kenbak_dispatch_table = 1, // Via a table of state handler functions.
+
+    // Via a table of labels ("computed goto", a GCC and Clang extension, falls
+    // back to the handler table, where not available), where each state's
+    // body jumps directly to the next one's, if more than one step is taken
+    // (see kenbak_emu_steps()):
+    //
+    kenbak_dispatch_goto = 2
+};
+
+#endif //KENBAK_DISPATCH
@@ -2,42 +2,53 @@
 // Marcel Timm, RhinoDevel, 2024may13
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <time.h>
 
+#ifdef _MSC_VER
+    #include <windows.h>
+#else //_MSC_VER
+    #include <stdatomic.h>
+#endif //_MSC_VER
+
 #include "kenbak_emu.h"
 #include "kenbak_data.h"
 #include "kenbak_instr.h"
+#include "kenbak_code.h"
+#include "kenbak_jit.h"
+#include "kenbak_hash.h"
+#include "kenbak_rand.h"
+#include "kenbak_memo.h"
+#include "kenbak_check.h"
 #include "kenbak_x.h"
 #include "kenbak_jmp_cond.h"
-
-// *****************************************************************************
-// *** HELPER FUNCTIONS                                                      ***
-// *****************************************************************************
-
-static uint8_t get_rotated_left(uint8_t const val, int const places)
-{
-    assert(1 <= places && places <= 4); // This is what the Kenbak-1 supports.
-
-    // (76543210 << 1) | (76543210 >> (8 - 1)) = 6543210x | xxxxxxx7 = 65432107
-    // (76543210 << 2) | (76543210 >> (8 - 2)) = 543210xx | xxxxxx76 = 54321076
-    // (76543210 << 3) | (76543210 >> (8 - 3)) = 43210xxx | xxxxx765 = 43210765
-    // (76543210 << 4) | (76543210 >> (8 - 4)) = 3210xxxx | xxxx7654 = 32107654
-
-    return (val << places) | (val >> (8 - places));
-}
-
-static uint8_t get_rotated_right(uint8_t const val, int const places)
-{
-    assert(1 <= places && places <= 4); // This is what the Kenbak-1 supports.
-
-    // (76543210 >> 1) | (76543210 << (8 - 1)) = x7654321 | 0xxxxxxx = 07654321
-    // (76543210 >> 2) | (76543210 << (8 - 2)) = xx765432 | 10xxxxxx = 10765432
-    // (76543210 >> 3) | (76543210 << (8 - 3)) = xxx76543 | 210xxxxx = 21076543
-    // (76543210 >> 4) | (76543210 << (8 - 4)) = xxxx7654 | 3210xxxx = 32107654
-
-    return (val >> places) | (val << (8 - places));
-}
+#include "kenbak_dispatch.h"
+
+// Define KENBAK_EMU_CHECKED (e.g. via the compiler's command line) for a
+// checked build, that validates the state machine's invariants before each
+// step and asserts that they hold (see kenbak_check.h). Otherwise, they are
+// validated at run time only, if enabled via kenbak_emu_set_check_interval().
+//
+//#define KENBAK_EMU_CHECKED
+
+// The features of the state machine's core used by kenbak_emu_step(),
+// kenbak_emu_run(), etc. (see kenbak_emu_core.h):
+//
+#define KENBAK_EMU_FEATURE_TIMING KENBAK_EMU_FEATURE_RUNTIME
+#define KENBAK_EMU_FEATURE_CODE_CACHE KENBAK_EMU_FEATURE_RUNTIME
+#define KENBAK_EMU_FEATURE_HASH KENBAK_EMU_FEATURE_RUNTIME
+#define KENBAK_EMU_FEATURE_MEMO KENBAK_EMU_FEATURE_RUNTIME
+#ifdef KENBAK_EMU_CHECKED
+    #define KENBAK_EMU_FEATURE_CHECK KENBAK_EMU_FEATURE_ON
+#else //KENBAK_EMU_CHECKED
+    #define KENBAK_EMU_FEATURE_CHECK KENBAK_EMU_FEATURE_RUNTIME
+#endif //KENBAK_EMU_CHECKED
+
+#define KENBAK_EMU_CORE_INSTRS // exec_instr(), etc.
+
+#include "kenbak_emu_core.h"
 
 // *****************************************************************************
 // *** READ-TO AND WRITE-FROM MEMORY                                         ***
@@ -49,73 +60,32 @@ static uint8_t get_rotated_right(uint8_t const val, int const places)
 uint8_t* kenbak_emu_get_mem_ptr(
     struct kenbak_data * const d, uint8_t const addr)
 {
-    if(addr < KENBAK_DATA_DELAY_LINE_SIZE)
+    if(d->code_cache != NULL)
+    {
+        kenbak_code_invalidate(d->code_cache); // Caller may write.
+    }
+    d->mem_hash_valid = false; // (same reason)
+    if(d->memo != NULL)
     {
-        return d->delay_line_0 + (int)addr;
+        kenbak_memo_abort(d->memo); // (same reason)
     }
-    return d->delay_line_1 + (int)(addr - KENBAK_DATA_DELAY_LINE_SIZE);
+    return d->mem + addr;
 }
 
-static void mem_write(
+void kenbak_emu_write_mem(
     struct kenbak_data * const d, uint8_t const addr, uint8_t const val)
 {
-    *kenbak_emu_get_mem_ptr(d, addr) = val;
-}
-
-static uint8_t mem_read(struct kenbak_data * const d, uint8_t const addr)
-{
-    return *kenbak_emu_get_mem_ptr(d, addr);
+    mem_write(d, addr, val);
 }
 
 // *****************************************************************************
 // *** INITIALIZE KENBAK-1 DATA STRUCTURE                                    ***
 // *****************************************************************************
 
-void kenbak_emu_init_input(
-    struct kenbak_data * const d, bool const keep_switch_power_on)
-{
-    for(int i = 0; i < KENBAK_INPUT_BITS; ++i)
-    {
-        d->input.buttons_data[i] = false;
-    }
-    
-    d->input.but_input_clear = false;
-
-    d->input.but_address_display = false;
-    d->input.but_address_set = false;
-
-    d->input.switch_memory_lock = false;
-
-    d->input.but_memory_read = false;
-    d->input.but_memory_store = false;
-
-    d->input.but_run_start = false;
-    d->input.but_run_stop = false;
-
-    if (!keep_switch_power_on)
-    {
-        d->input.switch_power_on = false;
-    }
-}
-
-static void init_output(struct kenbak_data * const d)
+static void init_input(struct kenbak_data * const d)
 {
-    d->output.led_bit_7 = false;
-    d->output.led_bit_6 = false;
-    d->output.led_bit_5 = false;
-    d->output.led_bit_4 = false;
-    d->output.led_bit_3 = false;
-    d->output.led_bit_2 = false;
-    d->output.led_bit_1 = false;
-    d->output.led_bit_0 = false;
-
-    d->output.led_input_clear = false;
-    
-    d->output.led_address_set = false;
-    
-    d->output.led_memory_store = false;
-    
-    d->output.led_run_stop = false;
+    d->input = 0;
+    d->input_changed = false;
 }
 
 static void init_state(struct kenbak_data * const d)
@@ -132,41 +102,36 @@ static void init_registers(struct kenbak_data * const d)
 
 static void init_signals(struct kenbak_data * const d)
 {
-    d->sig_bu = false;
-    d->sig_cl = false;
-    d->sig_da = false;
-    d->sig_dd = false;
-    d->sig_ea = false;
-    d->sig_ed = false;
-    d->sig_en = false;
-    d->sig_go = false;
+    d->sigs = 0;
 
     d->sig_x = kenbak_x_none;
 
     d->sig_r = 0;
 
     d->sig_inc = 0;
+
+    d->byte_times = 0;
 }
 
 static void init_mem(struct kenbak_data * const d)
 {
-    if(d->randomize_memory)
-    {
-        srand((unsigned int)time(NULL));
-    }
+    // The whole memory gets written at once (not via mem_write()):
+    //
+    uint8_t * const mem = kenbak_emu_get_mem_ptr(d, 0);
 
-    for(int i = 0; i < 2 * KENBAK_DATA_DELAY_LINE_SIZE; ++i)
-    {
-        uint8_t const val = d->randomize_memory ? (rand() % 256) : 0;
+    d->output_write_count = 0;
 
-        mem_write(d, i, val);
+    if(d->cold->randomize_memory)
+    {
+        kenbak_rand_fill(&d->cold->rand_state, mem, KENBAK_DATA_MEM_SIZE);
+        return;
     }
+    memset(mem, 0, KENBAK_DATA_MEM_SIZE);
 }
 
 static void init(struct kenbak_data * const d)
 {
-    kenbak_emu_init_input(d, false);
-    init_output(d);
+    init_input(d);
     init_state(d);
     init_registers(d);
     init_signals(d);
@@ -174,1528 +139,1558 @@ static void init(struct kenbak_data * const d)
 }
 
 // *****************************************************************************
-// *** THE STATES OF THE KENBAK-1 STATE MACHINE                              ***
+// *** INPUT                                                                 ***
 // *****************************************************************************
 
-/** Start of the next instruction. Locates the P register in memory.
- *
- *  - Byte time count depends on delay line position. 
- *  - See page 28.
- */
-static int step_in_sa(struct kenbak_data * const d)
+static uint32_t get_input_mask_if(
+    bool const is_on, enum kenbak_input_bit const input_bit)
 {
-    assert(d->state == kenbak_state_sa);
+    return is_on ? KENBAK_INPUT_MASK(input_bit) : 0;
+}
 
-    d->sig_r = KENBAK_DATA_ADDR_P;
+void kenbak_emu_set_input_bits(
+    struct kenbak_data * const d, uint32_t const bits)
+{
+    if(((d->input ^ bits) & KENBAK_INPUT_MASK_BUTTONS) != 0)
+    {
+        d->input_changed = true; // Signals need to be updated on next sample.
+    }
+    d->input = bits;
+}
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sb;
-    return 1;
+uint32_t kenbak_emu_get_input_bits(struct kenbak_data const * const d)
+{
+    return d->input;
 }
 
-/** Increments the program counter (P register). Fills W register with resulting
- *  address of next instruction. Decides, if QC or SC is next.
- * 
- *  - Lasts one byte time.
- *  - See page 28.
- */
-static int step_in_sb(struct kenbak_data * const d)
+void kenbak_emu_press(
+    struct kenbak_data * const d, enum kenbak_input_bit const input_bit)
 {
-    assert(d->state == kenbak_state_sb);
-    assert(d->sig_r == KENBAK_DATA_ADDR_P); // See SA.
-    assert(0 <= d->sig_inc && d->sig_inc != 3 && d->sig_inc <= 4);
+    kenbak_emu_set_input_bits(d, d->input | KENBAK_INPUT_MASK(input_bit));
+}
 
-    // Address of the last executed instruction plus the length of that
-    // instruction, to get the address of the next instruction to be executed:
-    //
-    uint8_t const val = mem_read(d, d->sig_r) + d->sig_inc;
+void kenbak_emu_release(
+    struct kenbak_data * const d, enum kenbak_input_bit const input_bit)
+{
+    kenbak_emu_set_input_bits(d, d->input & ~KENBAK_INPUT_MASK(input_bit));
+}
 
-    d->sig_inc = 255; // Sets to invalid to indicate that it needs to be set.
+uint32_t kenbak_emu_pack_input(struct kenbak_input const * const input)
+{
+    uint32_t bits = 0;
 
-    mem_write(d, d->sig_r, val);
+    for(int i = 0; i < KENBAK_INPUT_BITS; ++i)
+    {
+        bits |= get_input_mask_if(
+            input->buttons_data[i], kenbak_input_bit_data_0 + i);
+    }
 
-    d->reg_w = val;
+    bits |= get_input_mask_if(
+        input->but_input_clear, kenbak_input_bit_input_clear);
 
-    if(d->sig_ed)
-    {
-        // Last instruction was a halt or stop button was pressed.
+    bits |= get_input_mask_if(
+        input->but_address_display, kenbak_input_bit_address_display);
+    bits |= get_input_mask_if(
+        input->but_address_set, kenbak_input_bit_address_set);
 
-        d->state = kenbak_state_qc;
+    bits |= get_input_mask_if(
+        input->switch_memory_lock, kenbak_input_bit_memory_lock);
 
-        // Disabling ED here to prevent overwrite that would happen, if ED was
-        // triggered by a HALT instruction (and not the run stop button), also
-        // see update_input_signals():
-        //
-        d->sig_ed = false;
+    bits |= get_input_mask_if(
+        input->but_memory_read, kenbak_input_bit_memory_read);
+    bits |= get_input_mask_if(
+        input->but_memory_store, kenbak_input_bit_memory_store);
 
-        return 1;
-    }
+    bits |= get_input_mask_if(
+        input->but_run_start, kenbak_input_bit_run_start);
+    bits |= get_input_mask_if(
+        input->but_run_stop, kenbak_input_bit_run_stop);
 
-    // Continue automatic operation.
+    bits |= get_input_mask_if(
+        input->switch_power_on, kenbak_input_bit_power_on);
 
-    d->state = kenbak_state_sc;
-    return 1;
+    return bits;
 }
 
-/** Finds the next instruction in memory.
- *
- *  - Byte time count depends on delay line position.
- *  - See page 29.
- */
-static int step_in_sc(struct kenbak_data * const d)
+void kenbak_emu_set_input(
+    struct kenbak_data * const d, struct kenbak_input const * const input)
+{
+    kenbak_emu_set_input_bits(d, kenbak_emu_pack_input(input));
+}
+
+void kenbak_emu_get_input(
+    struct kenbak_data const * const d, struct kenbak_input * const input)
 {
-    assert(d->state == kenbak_state_sc);
-    assert(d->reg_w == mem_read(d, KENBAK_DATA_ADDR_P)); // See SB.
+    for(int i = 0; i < KENBAK_INPUT_BITS; ++i)
+    {
+        input->buttons_data[i] = is_input_on(d, kenbak_input_bit_data_0 + i);
+    }
 
-    d->sig_r = d->reg_w;
+    input->but_input_clear = is_input_on(d, kenbak_input_bit_input_clear);
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sd;
-    return 1;
+    input->but_address_display =
+        is_input_on(d, kenbak_input_bit_address_display);
+    input->but_address_set = is_input_on(d, kenbak_input_bit_address_set);
+
+    input->switch_memory_lock = is_input_on(d, kenbak_input_bit_memory_lock);
+
+    input->but_memory_read = is_input_on(d, kenbak_input_bit_memory_read);
+    input->but_memory_store = is_input_on(d, kenbak_input_bit_memory_store);
+
+    input->but_run_start = is_input_on(d, kenbak_input_bit_run_start);
+    input->but_run_stop = is_input_on(d, kenbak_input_bit_run_stop);
+
+    input->switch_power_on = is_input_on(d, kenbak_input_bit_power_on);
 }
 
-/** Transfers next instruction's first byte to register I. Selects next state
- *  based on the next instruction's length. 
- * 
- *  - Lasts one byte time.
- *  - See page 29.
- */
-static int step_in_sd(struct kenbak_data * const d)
+void kenbak_emu_sample_input(struct kenbak_data * const d)
 {
-    assert(d->state == kenbak_state_sd);
-    assert(d->reg_w == mem_read(d, KENBAK_DATA_ADDR_P)); // See SB.
-    assert(d->sig_r == d->reg_w); // See SC.
+    update_input_signals_byte_and_x(d);
+}
 
-    // Transfer first byte of to-be-executed instruction to I register:
-    //
-    d->reg_i = mem_read(d, d->sig_r);
+void kenbak_emu_init_input(
+    struct kenbak_data * const d, bool const keep_switch_power_on)
+{
+    kenbak_emu_set_input_bits(
+        d,
+        keep_switch_power_on
+            ? d->input & KENBAK_INPUT_MASK(kenbak_input_bit_power_on) : 0);
+}
 
-    if(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i))
-    {
-        d->state = kenbak_state_se; // Will read second byte of transfer.
-        return 1;
-    }
+// *****************************************************************************
+// *** OUTPUT                                                                ***
+// *****************************************************************************
 
-    // It is a single byte instruction.
+static uint32_t get_output_mask_if(
+    bool const is_on, enum kenbak_output_bit const output_bit)
+{
+    return is_on ? KENBAK_OUTPUT_MASK(output_bit) : 0;
+}
 
-    assert(d->sig_inc == 255); // Must still be unset/invalid, here.
-    d->sig_inc = 1; // All one byte instructions cause a P = P + 1.
+static bool is_output_on(
+    uint32_t const bits, enum kenbak_output_bit const output_bit)
+{
+    return (bits & KENBAK_OUTPUT_MASK(output_bit)) != 0;
+}
 
-    d->state = kenbak_state_su; // Will seek A or B register.
-    return 1;
+uint8_t kenbak_emu_get_reg_k(struct kenbak_data * const d)
+{
+    return get_reg_k(d);
 }
 
-/** First byte of instruction is already in register I. This function transfers
- *  the address of the to-be-used value to the W register; decides, which state
- *  is next by the address mode of the instruction.
- * 
- *  - Lasts one byte time.
- *  - See page 29.
+/**
+ * - If clear or console data push buttons are depressed during run mode, the
+ *   real Kenbak-1 will display the contents of location 128 as a faint
+ *   background light (see page 20 of the programming reference manual)!
  */
-static int step_in_se(struct kenbak_data * const d)
+uint32_t kenbak_emu_get_output_bits(struct kenbak_data * const d)
 {
-    assert(d->state == kenbak_state_se);
-    assert(d->reg_w == mem_read(d, KENBAK_DATA_ADDR_P)); // See SB.
-    assert(d->reg_w == d->sig_r); // See SC.
-    assert(d->reg_i == mem_read(d, d->sig_r)); // See SD.
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i)); // See SD.
+    if(d->state == kenbak_state_power_off)
+    {
+        return 0;
+    }
 
-    enum kenbak_addr_mode const addr_mode =
-        kenbak_instr_get_addr_mode(d->reg_i);
+    // See logic schematics, page 06:
+    //
+    return (uint32_t)get_reg_k(d)
+        | get_output_mask_if(
+            d->sig_x == kenbak_x_1, kenbak_output_bit_led_address_set)
+        | get_output_mask_if(
+            d->sig_x == kenbak_x_2, kenbak_output_bit_led_memory_store)
+        | get_output_mask_if(
+            d->sig_x == kenbak_x_4, kenbak_output_bit_led_input_clear)
+        | get_output_mask_if(
+            d->state != kenbak_state_qc, kenbak_output_bit_led_run_stop);
+}
 
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
+void kenbak_emu_get_output(
+    struct kenbak_data * const d, struct kenbak_output * const output)
+{
+    uint32_t const bits = kenbak_emu_get_output_bits(d);
 
-    if(addr_mode == kenbak_addr_mode_constant
-        && instr_type == kenbak_instr_type_store)
-    {
-        // The instruction is store constant/immediate, load ADDRESS of the
-        // second byte of the instruction into W register (this following second
-        // byte will be overwritten in-place by the store immediate operation):
+    output->led_bit_7 = is_output_on(bits, kenbak_output_bit_led_0 + 7);
+    output->led_bit_6 = is_output_on(bits, kenbak_output_bit_led_0 + 6);
+    output->led_bit_5 = is_output_on(bits, kenbak_output_bit_led_0 + 5);
+    output->led_bit_4 = is_output_on(bits, kenbak_output_bit_led_0 + 4);
+    output->led_bit_3 = is_output_on(bits, kenbak_output_bit_led_0 + 3);
+    output->led_bit_2 = is_output_on(bits, kenbak_output_bit_led_0 + 2);
+    output->led_bit_1 = is_output_on(bits, kenbak_output_bit_led_0 + 1);
+    output->led_bit_0 = is_output_on(bits, kenbak_output_bit_led_0 + 0);
 
-        d->reg_w = d->sig_r + 1;
-    }
-    else
-    {
-        // The instruction is NOT store constant/immediate.
-        // Transfer second byte of to-be-executed instruction to W register:
+    output->led_input_clear =
+        is_output_on(bits, kenbak_output_bit_led_input_clear);
 
-        d->reg_w = mem_read(d, d->sig_r + 1);
-    }
+    output->led_address_set =
+        is_output_on(bits, kenbak_output_bit_led_address_set);
 
-    if(addr_mode == kenbak_addr_mode_indirect
-        || addr_mode == kenbak_addr_mode_indirect_indexed
+    output->led_memory_store =
+        is_output_on(bits, kenbak_output_bit_led_memory_store);
 
-        // See kenbak_instr_get_addr_mode():
-        //
-        || (addr_mode == kenbak_addr_mode_memory
-                && instr_type == kenbak_instr_type_jump))
+    output->led_run_stop = is_output_on(bits, kenbak_output_bit_led_run_stop);
+}
+
+/** Handles the power switch.
+ *
+ * - Returns true, if the Kenbak-1 is (still) powered-on and in a defined state,
+ *   afterwards.
+ */
+static bool handle_power(struct kenbak_data * const d)
+{
+    if(d->state == kenbak_state_power_off)
     {
-        d->state = kenbak_state_sf; // SE -JI+IND-> SF
-        return 1;
+        if(!is_input_on(d, kenbak_input_bit_power_on))
+        {
+            return false;
+        }
+
+        d->state = kenbak_state_unknown; // Must be handled below.
     }
 
-    if(addr_mode == kenbak_addr_mode_indexed)
+    // Kenbak-1 is powered-on.
+
+    if(!is_input_on(d, kenbak_input_bit_power_on))
     {
-        d->state = kenbak_state_sh; // SE -^IND*DEX-> SH
-        return 1;
+        // Power-off:
+
+        init(d);
+        assert(d->state == kenbak_state_power_off);
+        return false;
     }
-    
-    if(addr_mode == kenbak_addr_mode_constant
-        || instr_type == kenbak_instr_type_jump // Must be JD, here.
-        || (instr_type == kenbak_instr_type_store // TM
-                && addr_mode == kenbak_addr_mode_memory))
-    {
-        // No operand to be found.
 
-        assert(
-            instr_type != kenbak_instr_type_jump
-                || ((d->reg_i >> 3) & 7) == 4 // JPD
-                || ((d->reg_i >> 3) & 7) == 6); // JMD
+    // Power toggle is (still) in ON position.
 
-        d->state = kenbak_state_sm; // SE -IMMED+JD+TM*MEM-> SM
-        return 1;
+    if(d->state == kenbak_state_unknown)
+    {
+        d->state = kenbak_state_qc;
     }
 
-    assert(instr_type == kenbak_instr_type_bit // BM
-        || (instr_type != kenbak_instr_type_store // ^TM
-                && addr_mode == kenbak_addr_mode_memory // MEM
-                && instr_type != kenbak_instr_type_jump)); // ^J
+    // Kenbak-1 is in a defined state.
 
-    d->state = kenbak_state_sk; // SE -BM+^TM*MEM*^J-> SK
-    return 1;
+    return true;
 }
 
-/** Searches for the indirect address which is already in register W (see SE).
- * 
- *  - Byte time count depends on delay line position.
- *  - See page 31.
- */
-static int step_in_sf(struct kenbak_data * const d)
+int kenbak_emu_step_via(
+    struct kenbak_data * const d, enum kenbak_dispatch const dispatch)
 {
-    assert(d->state == kenbak_state_sf);
-    assert(d->sig_r == mem_read(d, KENBAK_DATA_ADDR_P)); // See SB & SC.
-    assert(d->reg_i == mem_read(d, d->sig_r)); // See SD.
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i)); // See SD.
-
-    d->sig_r = d->reg_w;
-
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sg;
-    return 1;
+    if(!handle_power(d))
+    {
+        return 0;
+    }
+    return step_in_defined_state(d, dispatch);
 }
 
-/** Transfer content of indirect address location to W register; decides, which
- *  state is next based on the addressing mode (is indexing also required or
- *  not? If no indexing, is it a jump instruction?).
- * 
- *  - Probably always takes on byte time..
- *  - See page 31.
- */
-static int step_in_sg(struct kenbak_data * const d)
+int kenbak_emu_step(struct kenbak_data * const d)
 {
-    assert(d->state == kenbak_state_sg);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i)); // See SD.
-    assert(d->sig_r == d->reg_w); // See SF.
+    if(!handle_power(d))
+    {
+        return 0;
+    }
+    return step_in_defined_state(d, KENBAK_EMU_DISPATCH);
+}
 
-    d->reg_w = mem_read(d, d->sig_r);
+uint64_t kenbak_emu_steps_via(
+    struct kenbak_data * const d,
+    uint64_t const count,
+    enum kenbak_dispatch const dispatch)
+{
+    if(count == 0 || !handle_power(d))
+    {
+        return 0;
+    }
+    return steps_in_defined_state(d, count, dispatch);
+}
 
-    enum kenbak_addr_mode const addr_mode =
-        kenbak_instr_get_addr_mode(d->reg_i);
+uint64_t kenbak_emu_steps(struct kenbak_data * const d, uint64_t const count)
+{
+    return kenbak_emu_steps_via(d, count, KENBAK_EMU_DISPATCH_STEPS);
+}
 
-    switch(addr_mode)
+int kenbak_emu_step_instr(struct kenbak_data * const d)
+{
+    if(!handle_power(d))
     {
-        case kenbak_addr_mode_indirect_indexed: // SG -DEX-> SH
-        {
-            d->state = kenbak_state_sh;
-            return 1;
-        }
-        case kenbak_addr_mode_indirect: 
-        {
-            enum kenbak_instr_type const instr_type = kenbak_instr_get_type(
-                d->reg_i);
+        return 0;
+    }
 
-            assert(instr_type != kenbak_instr_type_jump);
+    if(d->state != kenbak_state_sa)
+    {
+        // Not at an instruction boundary in run mode.
 
-            // Store without indexing. SG -JI+TM*^DEX-> SM
-            //
-            if(instr_type == kenbak_instr_type_store)
-            {
-                d->state = kenbak_state_sm;
-                return 1;
-            }
+        return step_in_defined_state(d, KENBAK_EMU_DISPATCH);
+    }
 
-            // SG -^DEX*^J*^TM-> SK
-            //
-            d->state = kenbak_state_sk;
-            return 1;
-        }
+    int steps = 0;
+    int const c = exec_instr(d, &steps);
 
-        case kenbak_addr_mode_memory: // See kenbak_instr_get_addr_mode().
-        {
-            assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_jump);
+    assert(0 <= c);
+    return c;
+}
 
-            // Indirect jump. SG -JI+TM*^DEX-> SM
-            //
-            d->state = kenbak_state_sm;
-            return 1;
-        }
+void kenbak_emu_set_timing(struct kenbak_data * const d, bool const timing)
+{
+    d->timing = timing;
+}
 
-        case kenbak_addr_mode_none: // Falls through..
-        case kenbak_addr_mode_constant: // Falls through..
-        case kenbak_addr_mode_indexed: // Falls through..
-        default:
-        {
-            assert(false); // Must not get here.
-            return 0;
-        }
+bool kenbak_emu_set_code_cache(struct kenbak_data * const d, bool const enable)
+{
+    if(!enable)
+    {
+        kenbak_code_delete(d->code_cache);
+        d->code_cache = NULL;
+        return true;
+    }
+    if(d->code_cache == NULL)
+    {
+        d->code_cache = kenbak_code_create();
     }
+    return d->code_cache != NULL;
 }
 
-/** Searches for X register. Previous states are SE (for NON-indirect indexing)
- *  or SG (for indirect indexing).
- * 
- *  - Byte time count depends on delay line position.
- *  - See page 31.
- */
-static int step_in_sh(struct kenbak_data * const d)
+bool kenbak_emu_set_memo(struct kenbak_data * const d, bool const enable)
 {
-    assert(d->state == kenbak_state_sh);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i)); // See SD.
+    if(!enable)
+    {
+        kenbak_memo_delete(d->memo);
+        d->memo = NULL;
+        return true;
+    }
+    if(d->memo == NULL)
+    {
+        d->memo = kenbak_memo_create();
+    }
+    return d->memo != NULL;
+}
 
-    d->sig_r = KENBAK_DATA_ADDR_X;
+void kenbak_emu_set_check_interval(
+    struct kenbak_data * const d, uint32_t const interval)
+{
+    d->cold->check_interval = interval;
+    d->check_countdown = interval;
+}
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sj;
-    return 1;
+char const * kenbak_emu_get_check_violation(
+    struct kenbak_data const * const d)
+{
+    return d->cold->check_violation;
 }
 
-/** Adds contents of X register (X was found via signal R in SH) to W.
- * 
- *  - Takes one byte time.
- *  - See page 31.
- */
-static int step_in_sj(struct kenbak_data * const d)
+void kenbak_emu_set_trace(
+    struct kenbak_data * const d,
+    kenbak_data_trace_fn const trace,
+    void * const ctx)
 {
-    assert(d->state == kenbak_state_sj);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i)); // See SD.
-    assert(d->sig_r == KENBAK_DATA_ADDR_X); // see SH.
+    d->cold->trace = trace;
+    d->cold->trace_ctx = ctx;
+}
 
-    d->reg_w += mem_read(d, d->sig_r); // Adds content of X register to W reg.
+// *****************************************************************************
+// *** THREADED CODE                                                         ***
+// *****************************************************************************
 
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
+// The handlers of the threaded code, one per kind of instruction (see
+// select_code_handler()), composed of the same parts as exec_instr_se(), but
+// without deciding about them at run time:
 
-    if(instr_type == kenbak_instr_type_store)
-    {
-        d->state = kenbak_state_sm; // SJ -TM-> SM
-        return 1;
-    }
-    d->state = kenbak_state_sk; // SJ -^TM-> SK
-    return 1;
+static int thr_halt(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
+
+    c += exec_su_sv(d, instr->dec->reg, steps);
+    KENBAK_DATA_SET_SIG(d, kenbak_sig_ed);
+    return c;
 }
 
-/** W holds the operand's address on entry. Searches for that address to be able
- *  to read the operand from memory later.
- * 
- *  - Byte time count depends on delay line position.
- *  - See page 32.
- */
-static int step_in_sk(struct kenbak_data * const d)
+static int thr_noop(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
 {
-    assert(d->state == kenbak_state_sk);
+    int const c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    // d->reg_w contains the address of the operand.
+    return c + exec_su_sv(d, instr->dec->reg, steps);
+}
 
-    d->sig_r = d->reg_w;
+static int thr_shift_rot(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sl;
-    return 1;
+    c += exec_su_sv(d, instr->dec->reg, steps);
+    return c + exec_sw_sy(d, steps);
 }
 
-/**
- * - Takes one byte time for non-bit manipulation instructions.
- *   Assuming one byte time for SKIP, too.
- *   For SET, this should take the maximum byte time (128 bytes), if I am
- *   correct..
- * - See page 32.
+/** SM & SN of the handlers of ADD, SUB, LOAD, AND, OR and LNEG, given the byte
+ *  time count of the states passed before.
  */
-static int step_in_sl(struct kenbak_data * const d)
+static int thr_change_reg_end(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int c,
+    int * const steps)
 {
-    assert(d->state == kenbak_state_sl);
-    assert(d->sig_r == d->reg_w);
+    c += exec_sm(d, instr->dec->reg, steps);
 
-    uint8_t mask = 0;
+    int const sn = exec_sn_change_reg(d, steps);
 
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
-
-    d->reg_w = mem_read(d, d->sig_r); // Loads operand.
+    return sn < 0 ? -1 : c + sn;
+}
 
-    if(instr_type != kenbak_instr_type_bit)
-    {
-        d->state = kenbak_state_sm; // SL -^BM-> SM
-        return 1;
-    }
+static int thr_change_reg_constant(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    // "For the Set 0 or Set 1 instructions, the designated bit is set during
-    // SL. For the Skip on 0 and Skip on 1 instructions, the P register
-    // increment control is set as necessary."
+    c += exec_se(d, instr->second_byte, steps);
+    return thr_change_reg_end(d, instr, c, steps);
+}
 
-    d->state = kenbak_state_sa; // SL -BM-> SA
+static int thr_change_reg_memory(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    int const bit_pos = (d->reg_i >> 3) & 7;
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sk(d, steps);
+    c += pass_state(d, 1, steps); // SL.
+    return thr_change_reg_end(d, instr, c, steps);
+}
 
-    mask = 1 << bit_pos;
-    if((d->reg_i & 0x80) != 0)
-    {
-        // SKIP
+static int thr_change_reg_indirect(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-        bool const bit_is_set = (d->reg_w & mask) != 0;
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sf_sg(d, steps);
+    c += exec_sk(d, steps);
+    c += pass_state(d, 1, steps); // SL.
+    return thr_change_reg_end(d, instr, c, steps);
+}
 
-        assert(d->sig_inc == 255);
-        d->sig_inc = 2;
-        if((d->reg_i & 0x40) != 0)
-        {
-            // Skip on 1.
+static int thr_change_reg_indexed(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-            if(bit_is_set)
-            {
-                d->sig_inc += 2; // Always skips two bytes.
-            }
-        }
-        else
-        {
-            // Skip on 0.
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sh_sj(d, steps);
+    c += exec_sk(d, steps);
+    c += pass_state(d, 1, steps); // SL.
+    return thr_change_reg_end(d, instr, c, steps);
+}
 
-            if(!bit_is_set)
-            {
-                d->sig_inc += 2; // Always skips two bytes.
-            }
-        }
-        return 1; // Assuming one byte time, here.
-    }
+static int thr_change_reg_indirect_indexed(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
+
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sf_sg(d, steps);
+    c += exec_sh_sj(d, steps);
+    c += exec_sk(d, steps);
+    c += pass_state(d, 1, steps); // SL.
+    return thr_change_reg_end(d, instr, c, steps);
+}
 
-    // SET
+static int thr_store_constant(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    assert(d->sig_inc == 255);
-    d->sig_inc = 2;
+    c += exec_se_store_immediate(d, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sp_ss_store(d, steps);
+}
 
-    if((d->reg_i & 0x40) != 0)
-    {
-        d->reg_w = d->reg_w | mask; // Sets to 1.
-    }
-    else
-    {
-        d->reg_w = d->reg_w & (uint8_t)~mask; // Sets to 0.
-    }
+static int thr_store_memory(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    mem_write(d, d->sig_r, d->reg_w);
-    return 1; // Not correct, see comment above.
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sp_ss_store(d, steps);
 }
 
-/**
- * - See page 32.
- * - Byte time count depends on delay line position.
- * - W already contains the operand for instructions that will modify A, B or X.
- */
-static int step_in_sm(struct kenbak_data * const d)
+static int thr_store_indirect(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
 {
-    assert(d->state == kenbak_state_sm);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i));
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    d->sig_r = KENBAK_INSTR_TWO_BYTE_SEARCH_A_B_OR_X(d->reg_i);
-
-    assert(
-        d->sig_r == KENBAK_DATA_ADDR_A
-            || d->sig_r == KENBAK_DATA_ADDR_B
-            || d->sig_r == KENBAK_DATA_ADDR_X);
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sf_sg(d, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sp_ss_store(d, steps);
+}
 
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
+static int thr_store_indexed(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    if(instr_type == kenbak_instr_type_jump)
-    {
-        // JPD, JPI, JMD and JMI.
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sh_sj(d, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sp_ss_store(d, steps);
+}
 
-        // W already contains the target address (which may be the jump or the
-        // "mark" address, see PRM, page 33).
+static int thr_store_indirect_indexed(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-        // In reality, waiting for CM, here.
-        //
-        d->state = kenbak_state_sz;
-        return 1;
-    }
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sf_sg(d, steps);
+    c += exec_sh_sj(d, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sp_ss_store(d, steps);
+}
 
-    if(instr_type == kenbak_instr_type_store)
-    {
-        // STORE
+static int thr_jump_direct(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-        // W already contains the address where the data is to be stored
-        // (see PRM, page 33).
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sz_jump(d, instr->dec, steps);
+}
 
-        // In reality, waiting for CM, here.
-        //
-        d->state = kenbak_state_sp;
-        return 1;
-    }
+static int thr_jump_indirect(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    // ADD, SUB, LOAD, AND, OR and LNEG.
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sf_sg(d, steps);
+    c += exec_sm(d, instr->dec->reg, steps);
+    return c + exec_sz_jump(d, instr->dec, steps);
+}
 
-    assert(
-        instr_type == kenbak_instr_type_add
-        || instr_type == kenbak_instr_type_sub
-        || instr_type == kenbak_instr_type_load
-        || instr_type == kenbak_instr_type_and
-        || instr_type == kenbak_instr_type_or
-        || instr_type == kenbak_instr_type_lneg);
+static int thr_bit(
+    struct kenbak_data * const d,
+    struct kenbak_code_instr const * const instr,
+    int * const steps)
+{
+    int c = exec_instr_sc_sd(d, instr->first_byte, steps);
 
-    // W already contains the operand (see PRM, page 32).
+    c += exec_se(d, instr->second_byte, steps);
+    c += exec_sk(d, steps);
+    return c + exec_sl_bit(d, instr->dec, steps);
+}
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sn;
-    return 1;
-}
-
-/** Instructions changing A, B or X do so during SN. W contains the operand.
- * 
- * - Takes one byte time.
- * - See page 33.
+/** Returns the handler of the threaded code for the given decoded instruction,
+ *  see kenbak_code_translator.
  */
-static int step_in_sn(struct kenbak_data * const d)
+static kenbak_code_handler select_code_handler(
+    struct kenbak_instr_decoded const * const dec)
 {
-    assert(d->state == kenbak_state_sn);
-    assert(
-        d->sig_r == KENBAK_DATA_ADDR_A
-        || d->sig_r == KENBAK_DATA_ADDR_B
-        || d->sig_r == KENBAK_DATA_ADDR_X
-    
-        || d->sig_r == KENBAK_DATA_ADDR_P); // P in case of a jump.
-
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
-
-    // A, B or X is read from memory (see SM):
-    //
-    uint8_t const reg_content = mem_read(d, d->sig_r);
-    uint8_t result = 0;
-    bool do_sub = false;
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
 
-    switch(instr_type)
+    switch((enum kenbak_instr_type)dec->type)
     {
-        case kenbak_instr_type_sub: // See PRM, page 5.
+        case kenbak_instr_type_misc:
+        {
+            return dec->is_halt ? thr_halt : thr_noop;
+        }
+        case kenbak_instr_type_shift_rot:
+        {
+            return thr_shift_rot;
+        }
+        case kenbak_instr_type_bit:
+        {
+            return thr_bit;
+        }
+        case kenbak_instr_type_jump:
         {
-            do_sub = true; // Falls through.
+            return addr_mode == kenbak_addr_mode_constant
+                ? thr_jump_direct : thr_jump_indirect;
         }
-        case kenbak_instr_type_add: // See PRM, page 5.
+        case kenbak_instr_type_store:
         {
-            uint16_t const buf =
-                (uint16_t)(do_sub
-                    ? (uint8_t)(-d->reg_w) // Use two's complement.
-                    : d->reg_w)
-                + (uint16_t)reg_content;
-            uint8_t overflow_and_carry = 0;
-
-            if(255 < buf)
+            switch(addr_mode)
             {
-                overflow_and_carry = overflow_and_carry & 1; // Hard-coded 1.
+                case kenbak_addr_mode_constant:
+                {
+                    return thr_store_constant;
+                }
+                case kenbak_addr_mode_memory:
+                {
+                    return thr_store_memory;
+                }
+                case kenbak_addr_mode_indirect:
+                {
+                    return thr_store_indirect;
+                }
+                case kenbak_addr_mode_indexed:
+                {
+                    return thr_store_indexed;
+                }
+                case kenbak_addr_mode_indirect_indexed:
+                {
+                    return thr_store_indirect_indexed;
+                }
+
+                default:
+                {
+                    return NULL;
+                }
             }
-
-            result = (uint8_t)buf;
-
-            // TODO: Verify that this is correctly implemented:
-            //
-            if(d->reg_w <= 127 && 127 < result)
+        }
+        case kenbak_instr_type_add: // (falls through)
+        case kenbak_instr_type_sub: // (falls through)
+        case kenbak_instr_type_load: // (falls through)
+        case kenbak_instr_type_and: // (falls through)
+        case kenbak_instr_type_or: // (falls through)
+        case kenbak_instr_type_lneg:
+        {
+            switch(addr_mode)
             {
-                overflow_and_carry = overflow_and_carry & 2; // Hard-coded 2.
+                case kenbak_addr_mode_constant:
+                {
+                    return thr_change_reg_constant;
+                }
+                case kenbak_addr_mode_memory:
+                {
+                    return thr_change_reg_memory;
+                }
+                case kenbak_addr_mode_indirect:
+                {
+                    return thr_change_reg_indirect;
+                }
+                case kenbak_addr_mode_indexed:
+                {
+                    return thr_change_reg_indexed;
+                }
+                case kenbak_addr_mode_indirect_indexed:
+                {
+                    return thr_change_reg_indirect_indexed;
+                }
+
+                default:
+                {
+                    return NULL;
+                }
             }
+        }
 
-            mem_write(d, KENBAK_DATA_ADDR_OC_FOR(d->sig_r), overflow_and_carry);
-
-            assert(d->sig_inc == 255);
-            d->sig_inc = 2;
-            break;
+        default:
+        {
+            return NULL; // Executed without threaded code.
         }
-        case kenbak_instr_type_load: // See PRM, page 6.
+    }
+}
+
+bool kenbak_emu_set_threaded_code(
+    struct kenbak_data * const d, bool const enable)
+{
+    if(!enable)
+    {
+        if(d->code_cache != NULL)
         {
-            result = d->reg_w;
+            kenbak_code_set_translator(d->code_cache, NULL);
+        }
+        return true;
+    }
+    if(!kenbak_emu_set_code_cache(d, true))
+    {
+        return false;
+    }
+    kenbak_code_set_translator(d->code_cache, select_code_handler);
+    return true;
+}
 
-            assert(d->sig_inc == 255);
-            d->sig_inc = 2;
-            break;
+bool kenbak_emu_set_jit(struct kenbak_data * const d, bool const enable)
+{
+    if(!enable)
+    {
+        if(d->code_cache != NULL)
+        {
+            kenbak_code_set_jit(d->code_cache, NULL);
         }
-        case kenbak_instr_type_and: // See PRM, page 7.
+        return true;
+    }
+    if(!kenbak_emu_set_threaded_code(d, true))
+    {
+        return false;
+    }
+    if(d->code_cache->jit == NULL)
+    {
+        struct kenbak_jit * const jit = kenbak_jit_create();
+
+        if(jit == NULL)
         {
-            assert(d->sig_r == KENBAK_DATA_ADDR_A);
+            return false; // Not available.
+        }
+        kenbak_code_set_jit(d->code_cache, jit);
+    }
+    return true;
+}
 
-            result = d->reg_w & reg_content;
+// *****************************************************************************
+// *** QUIESCENCE                                                            ***
+// *****************************************************************************
 
-            assert(d->sig_inc == 255);
-            d->sig_inc = 2;
-            break;
-        }
-        case kenbak_instr_type_or: // See PRM, page 7.
-        {
-            assert(d->sig_r == KENBAK_DATA_ADDR_A);
+/** Returns true, if sampling the (unchanged) input would not change the input
+ *  byte at 0377, see update_input_byte().
+ */
+static bool is_input_byte_steady(struct kenbak_data * const d)
+{
+    uint8_t const val = mem_read(d, KENBAK_DATA_ADDR_INPUT);
 
-            result = d->reg_w | reg_content;
+    if(KENBAK_DATA_IS_SIG(d, kenbak_sig_cl))
+    {
+        return val == 0;
+    }
+    return (val | (uint8_t)(d->input & KENBAK_INPUT_MASK_DATA)) == val;
+}
 
-            assert(d->sig_inc == 255);
-            d->sig_inc = 2;
-            break;
+bool kenbak_emu_is_quiescent(struct kenbak_data * const d)
+{
+    if(d->state == kenbak_state_power_off)
+    {
+        return !is_input_on(d, kenbak_input_bit_power_on);
+    }
+    if(!is_input_on(d, kenbak_input_bit_power_on))
+    {
+        return false; // Will power-off.
+    }
+    if(d->input_changed)
+    {
+        return false; // Signals will change with the next sample.
+    }
+
+    switch(d->state)
+    {
+        case kenbak_state_qb: // Waiting for the start button to be released.
+        {
+            return KENBAK_DATA_IS_SIG(d, kenbak_sig_go)
+                && is_input_byte_steady(d);
         }
-        case kenbak_instr_type_lneg: // See PRM, page 8.
+        case kenbak_state_qc: // Idle (see step_in_qc()).
         {
-            assert(d->sig_r == KENBAK_DATA_ADDR_A);
-
-            result = -d->reg_w; // "Arithmetic complement".
-
-            assert(d->sig_inc == 255);
-            d->sig_inc = 2;
-            break;
+            return (d->sigs & KENBAK_SIG_MASK_MANUAL) == 0
+                && !KENBAK_DATA_IS_SIG(d, kenbak_sig_go)
+                && d->sig_inc == 0
+                && d->reg_i == mem_read(d, KENBAK_DATA_ADDR_INPUT)
+                && (!KENBAK_DATA_IS_SIG(d, kenbak_sig_ea)
+                    || d->reg_w == d->reg_i)
+                && is_input_byte_steady(d);
         }
-        case kenbak_instr_type_jump:
+        case kenbak_state_qf: // Waiting for the control buttons' release.
         {
-            assert(d->sig_r == KENBAK_DATA_ADDR_P);
-
-            result = d->reg_w; // W holds the jump destination address.
-
-            assert(d->sig_inc == 0); // See SZ.
-            break;
+            return (d->sigs & KENBAK_SIG_MASK_MANUAL) != 0
+                && is_input_byte_steady(d);
         }
 
         default:
         {
-            assert(false);
-            return 0; // Error!
+            return false;
         }
     }
+}
 
-    mem_write(d, d->sig_r, result);
+// *****************************************************************************
+// *** STATE HASHING                                                         ***
+// *****************************************************************************
 
-    d->state = kenbak_state_sa;
-    assert(d->sig_inc != 255);
-    return 1;
-}
+// The count of bytes filled by fill_state_regs():
+//
+#define KENBAK_EMU_STATE_REGS_SIZE 15
 
-/**
- * - See page 33.
+/** Fills the given buffer with everything but the memory, that determines
+ *  what the Kenbak-1 is going to do (the counters of byte times and output
+ *  writes are not included, just the delay line position, if the timing model
+ *  is enabled).
  */
-static int step_in_sp(struct kenbak_data * const d)
+static void fill_state_regs(
+    struct kenbak_data const * const d, uint8_t * const regs)
 {
-    assert(d->state == kenbak_state_sp);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i));
-    assert(
-        d->sig_r == KENBAK_DATA_ADDR_A
-        || d->sig_r == KENBAK_DATA_ADDR_B
-        || d->sig_r == KENBAK_DATA_ADDR_X);
-    assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_store);
-
-    // W already contains the address where the data is to be stored (see PRM,
-    // page 33).
-
-    // Load the byte to be stored in memory to the I register:
-    //
-    d->reg_i = mem_read(d, d->sig_r);
-
-    assert(d->sig_inc == 255);
-    d->sig_inc = 2;
-
-    d->state = kenbak_state_sr;
-    return 1; // Unsure, if this really takes a single byte time.
+    regs[0] = (uint8_t)d->state;
+    regs[1] = d->sig_inc;
+    regs[2] = d->reg_i;
+    regs[3] = d->reg_k;
+    regs[4] = d->reg_w;
+    regs[5] = d->sig_r;
+    regs[6] = d->sig_x;
+    regs[7] = d->sigs;
+    regs[8] = (uint8_t)d->input;
+    regs[9] = (uint8_t)(d->input >> 8);
+    regs[10] = (uint8_t)(d->input >> 16);
+    regs[11] = (uint8_t)(d->input >> 24);
+    regs[12] = (uint8_t)d->input_changed;
+    regs[13] = (uint8_t)d->timing;
+    regs[14] = d->timing
+        ? (uint8_t)(d->byte_times % KENBAK_DATA_DELAY_LINE_SIZE) : 0;
 }
 
-/**
- * - See page 34.
- */
-static int step_in_sq(struct kenbak_data * const d)
+void kenbak_emu_set_hashing(struct kenbak_data * const d, bool const enable)
 {
-    assert(d->state == kenbak_state_sq);
-    assert(KENBAK_INSTR_IS_TWO_BYTE(d->reg_i));
-
-    // Also see ST, see PRM, page 9 (bit 4 decides about marking):
-    //
-    assert((0x10 & d->reg_i) != 0);
-
-    // Also see ST:
-    //
-    assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_jump);
-
-    assert(d->sig_inc == 0); // See SZ.
-
-    // Load the return address into the I register:
-    //
-    d->reg_i = mem_read(d, KENBAK_DATA_ADDR_P) + 2;
-    
-    // W holds the target address, set P to that target address:
-    //
-    mem_write(d, KENBAK_DATA_ADDR_P, d->reg_w);
-
-    // TODO: The P register increment control must be set to add one, is this already done somewhere?
-
-    d->state = kenbak_state_sr;
-    return 1; // Unsure, if this really takes a single byte time.
+    d->hashing = enable;
+    d->mem_hash_valid = false; // Calculated on next use.
 }
 
-/**
- *  - Byte time count depends on delay line position.
- *  - See page 34.
- */
-static int step_in_sr(struct kenbak_data * const d)
+uint64_t kenbak_emu_get_hash(struct kenbak_data * const d)
 {
-    assert(d->state == kenbak_state_sr);
+    uint8_t regs[KENBAK_EMU_STATE_REGS_SIZE];
 
-    d->sig_r = d->reg_w;
+    if(!d->hashing || !d->mem_hash_valid)
+    {
+        d->mem_hash = kenbak_hash_get(d->mem, KENBAK_DATA_MEM_SIZE, 0);
+        d->mem_hash_valid = d->hashing;
+    }
 
-    // In reality, waiting for CM, here.
+    // The registers and signals are just a few bytes, hashing them here is
+    // cheaper than on each of their changes:
     //
-    d->state = kenbak_state_ss;
-    return 1;
+    fill_state_regs(d, regs);
+    return d->mem_hash
+        ^ kenbak_hash_get(
+            regs, KENBAK_EMU_STATE_REGS_SIZE, KENBAK_DATA_MEM_SIZE);
 }
 
-/** Write content of register I to memory.
- * 
- *  - Takes one byte time.
- *  - See page 34.
+// *****************************************************************************
+// *** BATCH PROCESSING                                                      ***
+// *****************************************************************************
+
+/** Returns the reason to stop before taking the next step, or
+ *  kenbak_run_stop_none, if no reason exists.
  */
-static int step_in_ss(struct kenbak_data * const d)
+static enum kenbak_run_stop get_stop_before_step(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result const * const result,
+    uint32_t const output_write_count)
 {
-    assert(d->state == kenbak_state_ss);
-    assert(d->sig_r == d->reg_w); // See SR.
-
-    mem_write(d, d->sig_r, d->reg_i);
+    if(!is_in_budget(limits->max_steps, result->steps, 1))
+    {
+        return kenbak_run_stop_steps;
+    }
+    if(!is_in_budget(limits->max_byte_times, result->byte_times, 1))
+    {
+        return kenbak_run_stop_byte_times;
+    }
 
-    assert(d->sig_inc != 255);
+    if(d->state != kenbak_state_sa && d->state != kenbak_state_qc)
+    {
+        return kenbak_run_stop_none; // Not at an instruction boundary.
+    }
 
-    d->state = kenbak_state_sa;
-    return 1;
+    if(limits->stop_at_output
+        && d->output_write_count != output_write_count)
+    {
+        return kenbak_run_stop_output;
+    }
+    if(!is_in_budget(limits->max_instrs, result->instrs, 1))
+    {
+        return kenbak_run_stop_instrs;
+    }
+    if(limits->stop_at_p
+        && d->state == kenbak_state_sa
+        && 0 < result->steps
+        && (uint8_t)(mem_read(d, KENBAK_DATA_ADDR_P)
+                + d->sig_inc) == limits->p)
+    {
+        return kenbak_run_stop_p; // Next instr. will be at given address.
+    }
+    return kenbak_run_stop_none;
 }
 
-/**
- * - Byte time count depends on delay line position.
- * - See page 34.
+/** Returns the counter address of the countdown loop that starts with the next
+ *  instruction in run mode, or -1, if there is none (see
+ *  kenbak_code_get_countdown_reg()).
  */
-static int step_in_st(struct kenbak_data * const d)
+static int get_next_countdown_reg(struct kenbak_data * const d)
 {
-    assert(d->state == kenbak_state_st);
-    assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_jump);
-    assert(d->sig_inc != 255); // See SZ.
-
-    d->sig_r = KENBAK_DATA_ADDR_P;
-
-    // Without "marking" => SN
-
-    // With "marking" => SQ
+    uint8_t const next = mem_read(d, KENBAK_DATA_ADDR_P) + d->sig_inc;
 
-    // In reality, waiting for CM, here.
-
-    if((0x10 & d->reg_i) == 0) // See PRM, page 9 (bit 4 decides about marking).
+    if(d->code_cache != NULL
+        && d->code_cache->blocks[next].gen == d->code_cache->gen)
     {
-        d->state = kenbak_state_sn; // Jump (without Mark).
-        return 1;
+        return d->code_cache->blocks[next].countdown_reg; // Already known.
     }
-    d->state = kenbak_state_sq; // Jump and Mark.
-    return 1;
+    return kenbak_code_get_countdown_reg(d->mem, next);
 }
 
-/**
- * - Byte time count depends on delay line position.
- * - See page 35.
+/** Returns true, if the next instruction in run mode is a jump and mark with
+ *  its condition being met (a call, see kenbak_memo.h).
  */
-static int step_in_su(struct kenbak_data * const d)
+static bool is_next_instr_call(struct kenbak_data const * const d)
 {
-    assert(d->state == kenbak_state_su);
-    assert(!KENBAK_INSTR_IS_TWO_BYTE(d->reg_i));
-
-    d->sig_r = KENBAK_INSTR_ONE_BYTE_SEARCH_A_OR_B(d->reg_i);
-
-    assert(d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B);
-
-    // In reality, waiting for CM, here.
+    // (not read via mem_read(), the Kenbak-1 itself does not read here)
     //
-    d->state = kenbak_state_sv;
-    return 1;
+    uint8_t const next = d->mem[KENBAK_DATA_ADDR_P] + d->sig_inc;
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->mem[next]);
+
+    return dec->type == kenbak_instr_type_jump
+        && dec->jmp_is_mark
+        && (dec->jmp_is_unc
+            || is_jmp_cond_met(dec->jmp_cond, d->mem[dec->reg]));
 }
 
-/**
- * - See page 35.
+/** Skips the countdown loop that starts with the next instruction, if there is
+ *  one (see skip_countdown_loop()).
  */
-static int step_in_sv(struct kenbak_data * const d)
+static void skip_next_countdown_loop(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    assert(d->state == kenbak_state_sv);
-
-    // See SU:
-    //
-    assert(d->sig_r == KENBAK_INSTR_ONE_BYTE_SEARCH_A_OR_B(d->reg_i));
-    assert(d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B);
+    int const countdown_reg = get_next_countdown_reg(d);
 
-    // Transfer content of A or B to W:
-    //
-    d->reg_w = mem_read(d, d->sig_r);
-
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(d->reg_i);
-
-    if(instr_type == kenbak_instr_type_misc)
+    if(countdown_reg != -1)
     {
-        // ^IO
-
-        if(KENBAK_INSTR_IS_HALT(d->reg_i))
-        {
-            d->sig_ed = true;
-        }
-
-        d->state = kenbak_state_sa; // Done for HALT and NOOP.
-        return 1;
+        skip_countdown_loop(d, countdown_reg, limits, result);
     }
-
-    // IO
-
-    assert(instr_type == kenbak_instr_type_shift_rot);
-    d->state = kenbak_state_sw; // Will execute shifts or rotates.
-    return 1;
 }
 
-/** Shifts and rotates are executed here.
- * 
- * - Takes one byte time.
- * - See page 35.
- * - Also see PRM, page 12.
+/** Returns what is left of the given budget after the used part and the part
+ *  needed, without a limit for a budget of zero (see is_in_budget()).
  */
-static int step_in_sw(struct kenbak_data * const d)
+static uint64_t get_budget_rest(
+    uint64_t const budget, uint64_t const used, uint64_t const needed)
 {
-    // See SU:
-    //
-    assert(d->sig_r == KENBAK_INSTR_ONE_BYTE_SEARCH_A_OR_B(d->reg_i));
-    assert(d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B);
-
-    // See SV:
-    //
-    assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_shift_rot);
-    assert(d->reg_w == mem_read(d, d->sig_r));
-
-    // W already holds the content loaded from A or B.
-
-    // 76 543 210
-    //
-    uint8_t const kind = d->reg_i >> 6;
-    uint8_t places = (d->reg_i >> 3) & 3; // 0 means 4!
-    
-    if(places == 0)
+    if(budget == 0)
     {
-        places = 4;
+        return UINT64_MAX;
     }
-    assert(1 <= places && places <= 4);
-
-    switch(kind)
+    if(budget < used || budget - used < needed)
     {
-        case 0: // Right shift.
-        {
-            d->reg_w = d->reg_w >> places;
-            break;
-        }
-        case 1: // Right rotate.
-        {
-            d->reg_w = get_rotated_right(d->reg_w, places);
-            break;
-        }
-        case 2: // Left shift.
-        {
-            d->reg_w = d->reg_w << places;
-            break;
-        }
-        case 3: // Left rotate.
-        {
-            d->reg_w = get_rotated_left(d->reg_w, places);
-            break;
-        }
-
-        default: // Must not get here.
-        {
-            assert(false);
-            return 0; // Error!
-        }
+        return 0;
     }
-
-    d->state = kenbak_state_sx;
-    return 1;
+    return budget - used - needed;
 }
 
-/**
- * - Byte time count depends on delay line position.
- * - See page 35.
+/** Executes the native code of the block that starts with the next
+ *  instruction, if the JIT is enabled, the native code may be used now and
+ *  there is native code for the block (see kenbak_jit.h).
+ *
+ * - Must be called in state SA with the code cache enabled and the next
+ *   instruction in budget, only.
+ * - Adds the steps, instructions and byte times to the given result.
+ * - Returns false, if nothing got executed.
  */
-static int step_in_sx(struct kenbak_data * const d)
+static bool exec_native_block(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    assert(d->state == kenbak_state_sx);
-
-    d->sig_r = KENBAK_INSTR_ONE_BYTE_SEARCH_A_OR_B(d->reg_i);
-
-    assert(d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B);
+    struct kenbak_code_cache * const cache = d->code_cache;
+
+    if(cache->jit == NULL
+        || d->timing
+        || d->hashing
+        || d->memo != NULL
+        || d->sig_x != kenbak_x_3 // (K gets latched from the output)
+        || !is_input_settled(d))
+    {
+        return false;
+    }
 
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_sy;
-    return 1;
-}
+    kenbak_code_native const native = kenbak_jit_get_native(
+        cache->jit,
+        cache,
+        d->mem,
+        (uint8_t)(d->mem[KENBAK_DATA_ADDR_P] + d->sig_inc));
 
-/**
- * - See page 35.
- */
-static int step_in_sy(struct kenbak_data * const d)
-{
-    assert(d->state == kenbak_state_sy);
-    assert(d->sig_r == KENBAK_DATA_ADDR_A || d->sig_r == KENBAK_DATA_ADDR_B);
+    if(native == NULL)
+    {
+        return false;
+    }
 
-    // W holds the shifted or rotated value that also originated in A or B.
+    // As each state lasts one byte time, the step and byte time budgets are
+    // checked against the same count (see is_next_instr_in_budget()):
     //
-    mem_write(d, d->sig_r, d->reg_w);
-
-    d->state = kenbak_state_sa; // Done for rotate/shift instructions.
-    return 1;
+    struct kenbak_jit_run run = {
+        .max_steps = min_u64(
+            get_budget_rest(
+                limits->max_steps,
+                result->steps,
+                KENBAK_EMU_MAX_STEPS_PER_INSTR),
+            get_budget_rest(limits->max_byte_times, result->byte_times, 1)),
+        .max_instrs = get_budget_rest(limits->max_instrs, result->instrs, 1)
+    };
+
+    native(d, &run);
+
+    d->byte_times += (uint32_t)run.steps;
+    result->steps += run.steps;
+    result->byte_times += run.steps;
+    result->instrs += run.instrs;
+    return true;
 }
 
-/**
- * - Takes one byte time.
- * - See page 34.
+/** Executes instructions in one pass each (see exec_instr()), but takes them
+ *  from the pre-decoded blocks of the code cache instead of fetching and
+ *  decoding them, as long as kenbak_emu_run() would execute the next
+ *  instruction in one pass, too (see the budget checks there).
+ *
+ * - Must be called in state SA with the code cache enabled, only.
+ * - The checks of get_stop_before_step() for the output register and P must
+ *   not be enabled.
+ * - Returns before a call, if the memoization is enabled (see
+ *   memoize_call()).
+ * - Executes the native code of the blocks instead, where possible (see
+ *   exec_native_block()).
+ * - Adds the steps, instructions and byte times to the given result.
+ * - Returns false on error.
  */
-static int step_in_sz(struct kenbak_data * const d)
+static bool exec_cached_instrs(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    assert(d->state == kenbak_state_sz);
-    assert(kenbak_instr_get_type(d->reg_i) == kenbak_instr_type_jump);
-    assert(
-        d->sig_r == KENBAK_DATA_ADDR_A
-        || d->sig_r == KENBAK_DATA_ADDR_B
-        || d->sig_r == KENBAK_DATA_ADDR_X);
-
-    bool cond_is_true = false;
-    uint8_t const reg_sel = (0xC0 & d->reg_i) >> 6;
-
-    if(reg_sel == 3) // Unconditional jump, if bit 7 and 6 are both set.
-    {
-        d->state = kenbak_state_st; // Jump!
-        assert(d->sig_inc == 255);
-        d->sig_inc = 0;
-        return 1;
-    }
-
-    // A, B or X need to be checked.
-
-    assert(reg_sel == d->sig_r);
-
-    uint8_t const reg_val = mem_read(d, d->sig_r);
+    assert(d->code_cache != NULL);
+    assert(!limits->stop_at_output && !limits->stop_at_p);
 
-    uint8_t const cond = (7 & d->reg_i);
+    struct kenbak_code_block const * block = NULL;
+    int i = 0; // Index of the next instruction in the block.
 
-    assert(3 <= cond); // See possible jump conditions (from 3 to 7).
-
-    assert(!cond_is_true);
-    switch((enum kenbak_jmp_cond)cond)
+    do
     {
-        case kenbak_jmp_cond_non_zero:
+        if(exec_native_block(d, limits, result))
         {
-            if(reg_val != 0)
-            {
-                cond_is_true = true;
-            }
-            break;
+            block = NULL; // (continued by the native code, if possible)
+            skip_next_countdown_loop(d, limits, result);
+            continue;
         }
-        case kenbak_jmp_cond_zero:
+
+        int steps = 0;
+        int c = exec_instr_sa_sb(d, &steps);
+
+        if(d->state == kenbak_state_qc)
         {
-            if(reg_val == 0)
-            {
-                cond_is_true = true;
-            }
-            break;
+            result->steps += (uint64_t)steps;
+            result->byte_times += (uint64_t)c;
+            return true;
         }
-        case kenbak_jmp_cond_neg:
+
+        // Continue with the block, if P points to its next instruction and no
+        // write invalidated it (maybe by the last instruction, or P's update):
+        //
+        if(block == NULL
+            || block->gen != d->code_cache->gen
+            || i == block->len
+            || block->instrs[i].addr != d->reg_w)
         {
-            if((0x80 & reg_val) != 0) // Is 7th bit set?
-            {
-                cond_is_true = true;
-            }
-            break;
+            block = kenbak_code_get_block(d->code_cache, d->mem, d->reg_w);
+            i = 0;
         }
-        case kenbak_jmp_cond_pos:
+
+        struct kenbak_code_instr const * const instr = block->instrs + i;
+        int rest = 0;
+
+        ++i;
+
+        if(instr->handler != NULL)
         {
-            if((0x80 & reg_val) == 0) // Is 7th bit unset?
-            {
-                cond_is_true = true;
-            }
-            break;
+            rest = instr->handler(d, instr, &steps); // Threaded code.
         }
-        case kenbak_jmp_cond_pos_non_zero:
+        else
         {
-            if((0x80 & reg_val) == 0 && (0x7F & reg_val) != 0)
-            {
-                cond_is_true = true;
-            }
-            break;
+            c += exec_instr_sc_sd(d, instr->first_byte, &steps);
+            rest = exec_instr_se(d, instr->dec, instr->second_byte, &steps);
         }
-
-        default:
+        result->steps += (uint64_t)steps;
+        if(rest < 0)
         {
-            assert(false); // Must not get here.
-            return 0;
+            return false;
         }
-    }
+        result->byte_times += (uint64_t)(c + rest);
+        ++result->instrs;
 
-    if(cond_is_true)
-    {
-        d->state = kenbak_state_st; // Jump!
-        assert(d->sig_inc == 255);
-        d->sig_inc = 0;
-        return 1;
-    }
+        skip_next_countdown_loop(d, limits, result);
+    } while(is_next_instr_in_budget(limits, result)
+        && (d->memo == NULL || !is_next_instr_call(d))); // (to be memoized)
 
-    d->state = kenbak_state_sa; // NO jump.
-    assert(d->sig_inc == 255);
-    d->sig_inc = 2;
-    return 1;
+    return true;
 }
 
-/** Just waits for start button to be released.
- * 
- * - See page 37.
- */
-static int step_in_qb(struct kenbak_data * const d)
+// Brent's cycle detection, applied to the states at the instruction
+// boundaries in run mode (state SA) passed by kenbak_emu_run():
+//
+struct cycle_detector
 {
-    assert(d->state == kenbak_state_qb);
+    uint64_t power; // Samples between checkpoints (zero before the first).
+    uint64_t len; // Samples since the checkpoint.
 
-    if(d->sig_go)
-    {
-        return 1;
-    }
+    // The state at the checkpoint and the results at that time:
 
-    // Not that close to the real Kenbak-1, maybe implement d->sig_ht?
-    d->sig_ed = false;
+    uint64_t hash;
+    uint8_t mem[KENBAK_DATA_MEM_SIZE];
+    uint8_t regs[KENBAK_EMU_STATE_REGS_SIZE];
 
-    d->state = kenbak_state_sa;
-    return 1;
-}
+    uint64_t steps;
+    uint64_t instrs;
+    uint64_t byte_times;
+    uint32_t output_write_count;
+};
 
-/** The idle state (also entered, if the computer is halted).
- * 
- * - See page 36.
+/** Samples the current state, returns true, if it is the same as the one at
+ *  the checkpoint of the given detector (so the Kenbak-1 entered a cycle).
+ *
+ * - Equal hashes get confirmed by comparing the whole states.
  */
-static int step_in_qc(struct kenbak_data * const d)
+static bool is_cycle_found(
+    struct cycle_detector * const c,
+    struct kenbak_data * const d,
+    struct kenbak_run_result const * const result)
 {
-    assert(d->state == kenbak_state_qc);
-
-    d->sig_inc = 0; // Add zero bytes to P for first instruction on next run.
-
-    d->reg_i = mem_read(d, KENBAK_DATA_ADDR_INPUT);
-
-    // - The order is random here, not checked, in which "order" this works on
-    //   the hardware..
-
-    // X5 = EN or DA or DD (see page 25):
-    //
-    if(d->sig_en) // <= Store memory push button.
-    {
-        d->state = kenbak_state_qd;
-        return 1;
-    }
-    if(d->sig_da) // <= Display address push button.
-    {
-        d->state = kenbak_state_qd;
-        return 1;
-    }
-    if(d->sig_dd) // <= Read memory push button.
-    {
-        d->state = kenbak_state_qd;
-        return 1;
-    }
+    uint64_t const hash = kenbak_emu_get_hash(d);
+    uint8_t regs[KENBAK_EMU_STATE_REGS_SIZE];
 
-    if(d->sig_go) // <= Start push button.
-    {
-        d->state = kenbak_state_qb;
-        return 1;
-    }
+    fill_state_regs(d, regs);
 
-    if(d->sig_ea) // <= Set address push button.
+    if(c->power != 0
+        && hash == c->hash
+        && memcmp(c->mem, d->mem, sizeof c->mem) == 0
+        && memcmp(c->regs, regs, sizeof c->regs) == 0)
     {
-        d->reg_w = d->reg_i;
+        return true;
     }
-    assert(d->state == kenbak_state_qc);
-    return 1;
-}
-
-/**
- * - See page 36.
- */
-static int step_in_qd(struct kenbak_data * const d)
-{
-    assert(d->state == kenbak_state_qd);
-
-    d->sig_r = d->reg_w;
-
-    // In reality, waiting for CM, here.
-    //
-    d->state = kenbak_state_qe;
-    return 1;
-}
 
-/**
- * - See page 36.
- */
-static int step_in_qe(struct kenbak_data * const d)
-{
-    assert(d->state == kenbak_state_qe);
-    assert(d->sig_r == d->reg_w);
-
-    d->state = kenbak_state_qf; // State QF follows after one byte time.
-
-    if(d->sig_en) // Enter data:
+    if(c->len == c->power)
     {
-        assert(!d->sig_da && !d->sig_dd); // See QC.
+        // New checkpoint, twice as far away as the last one:
 
-        mem_write(d, d->sig_r, d->reg_i); // Transfers I to memory.
-        ++d->reg_w; // Adds 1 to W.
-        return 1;
-    }
+        c->power = c->power == 0 ? 1 : 2 * c->power;
+        c->len = 0;
 
-    if(d->sig_da) // Display address:
-    {
-        assert(!d->sig_en && !d->sig_dd); // See QC.
+        c->hash = hash;
+        memcpy(c->mem, d->mem, sizeof c->mem);
+        memcpy(c->regs, regs, sizeof c->regs);
 
-        d->reg_k = d->sig_r; // Transfers W to K (content of R equals W, here).
-        return 1;
+        c->steps = result->steps;
+        c->instrs = result->instrs;
+        c->byte_times = result->byte_times;
+        c->output_write_count = d->output_write_count;
     }
-
-    // Display data:
-
-    assert(d->sig_dd); // Because there is only the path QC -X5-> QD -CM-> QE.
-    assert(!d->sig_en && !d->sig_da); // See QC.
-
-    d->reg_k = mem_read(d, d->sig_r); // Transfers memory to K.
-    ++d->reg_w; // Adds 1 to W.
-    return 1;
+    ++c->len;
+    return false;
 }
 
-/**
- * - See page 37.
+/** Lets as many passes of the cycle found by the given detector pass
+ *  arithmetically, as the budgets allow (at least one budget's rest is then
+ *  less than a pass needs).
+ *
+ * - Returns false, if no budget is given (the cycle would repeat forever).
  */
-static int step_in_qf(struct kenbak_data * const d)
+static bool skip_cycles(
+    struct kenbak_data * const d,
+    struct cycle_detector const * const c,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    assert(d->state == kenbak_state_qf);
+    uint32_t const output_writes =
+        d->output_write_count - c->output_write_count;
+    uint64_t count = UINT64_MAX;
 
-    // The state register control waits at QF until the control buttons are
-    // released (waiting for ^X5).
-    //
-    if(!d->sig_en && !d->sig_da && !d->sig_dd)
+    if(limits->max_steps != 0)
     {
-        d->state = kenbak_state_qc;
+        count = min_u64(
+            count,
+            (limits->max_steps - result->steps) / result->cycle_steps);
     }
-    return 1;
-}
-
-// *****************************************************************************
-// *** PROCESSING OF A SINGLE "STEP"                                         ***
-// *****************************************************************************
-
-/**
- * - See page 06 of the logic schematics.
- */
-static void update_x_signal(struct kenbak_data* const d)
-{
-    if (d->sig_da) // Address display button is pressed.
+    if(limits->max_instrs != 0 && result->cycle_instrs != 0)
     {
-        assert(!d->sig_dd);
-        //assert(d->state != kenbak_state_sa);
-        assert(!d->sig_bu);
-        assert(!d->sig_cl);
-
-        d->sig_x = kenbak_x_1;
-        return;
+        count = min_u64(
+            count,
+            (limits->max_instrs - result->instrs) / result->cycle_instrs);
     }
-    if (d->sig_dd) // Memory read button is pressed.
+    if(limits->max_byte_times != 0)
     {
-        assert(!d->sig_da);
-        //assert(d->state != kenbak_state_sa);
-        assert(!d->sig_bu);
-        assert(!d->sig_cl);
-
-        d->sig_x = kenbak_x_2;
-        return;
+        count = min_u64(
+            count,
+            (limits->max_byte_times - result->byte_times)
+                / result->cycle_byte_times);
     }
-    if (d->state == kenbak_state_sa)
+    if(count == UINT64_MAX)
     {
-        assert(!d->sig_da);
-        assert(!d->sig_dd);
-        //assert(!d->sig_bu);
-        //assert(!d->sig_cl);
-
-        d->sig_x = kenbak_x_3;
-        return;
+        return false;
     }
-    if (d->sig_bu || d->sig_cl)
-    {
-        assert(!d->sig_da);
-        assert(!d->sig_dd);
-        assert(d->state != kenbak_state_sa);
 
-        d->sig_x = kenbak_x_4;
-        return;
-    }
-
-    // Keep current X state, when getting here.
+    result->steps += count * result->cycle_steps;
+    result->instrs += count * result->cycle_instrs;
+    result->byte_times += count * result->cycle_byte_times;
+    d->byte_times += (uint32_t)(count * result->cycle_byte_times); // (wraps)
+    d->output_write_count += (uint32_t)(count * output_writes); // (wraps)
+    return true;
 }
 
-/** Update the content at address (octal) 377 by the current data buttons'
- *  states and the current state of the clear signal (as it is not possible to
- *  toggle the bits from 1 to 0 via data buttons, you need to clear ALL ones via
- *  the clear signal for that).
+/** Handles the memoization of calls at an instruction boundary in run mode
+ *  (state SA, see kenbak_emu_set_memo()): Finishes recording the current call,
+ *  if it returns now, then replays the recorded call that starts now, if there
+ *  is one and the budgets allow it, or starts recording it.
+ *
+ * - Returns true, if a call got replayed (adding its costs to the given
+ *   result).
  */
-static void update_input_byte(struct kenbak_data * const d)
+static bool memoize_call(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    // Get state of the 8 data buttons into (octal) address 377 (this is the
-    // serial signal BU) [page 22]:
+    assert(d->state == kenbak_state_sa);
 
-    uint8_t val = 0, or_mask = 0;
+    struct kenbak_memo * const memo = d->memo;
 
-    // (chose precedence of clear signal over data buttons, maybe wrong..)
+    // (not read via mem_read(), the Kenbak-1 itself does not read here)
     //
-    if(d->sig_cl)
-    {
-        mem_write(d, KENBAK_DATA_ADDR_INPUT, 0);
-        return;
-    }
- 
-    if(d->sig_bu) // The if clause is technically not necessary, here.
+    uint8_t const next = d->mem[KENBAK_DATA_ADDR_P] + d->sig_inc;
+
+    if(memo->recording)
     {
-        for(int i = 0; i < KENBAK_INPUT_BITS; ++i)
+        if(next != memo->ret_addr)
         {
-            if(d->input.buttons_data[i])
+            if(KENBAK_MEMO_MAX_INSTRS < result->instrs - memo->call.instrs)
             {
-                // Current bit's input button is currently pushed down.
-
-                or_mask |= 1 << i; // Triggers enabling of bit value.
+                kenbak_memo_abort(memo);
             }
+            return false; // Call is still running (or too long).
         }
-        val = mem_read(d, KENBAK_DATA_ADDR_INPUT);
-        val |= or_mask;
-        mem_write(d, KENBAK_DATA_ADDR_INPUT, val);
+
+        // The call returns:
+
+        memo->call.end_sig_inc = d->sig_inc;
+        memo->call.end_reg_i = d->reg_i;
+        memo->call.end_reg_k = d->reg_k;
+        memo->call.end_reg_w = d->reg_w;
+        memo->call.end_sig_r = d->sig_r;
+
+        memo->call.steps = result->steps - memo->call.steps;
+        memo->call.instrs = result->instrs - memo->call.instrs;
+        memo->call.byte_times = result->byte_times - memo->call.byte_times;
+        memo->call.output_writes =
+            d->output_write_count - memo->call.output_writes;
+
+        kenbak_memo_finish(memo, d->mem);
     }
-}
 
-static void update_input_signals(struct kenbak_data * const d)
-{
-    // Update signals generated by pushed control buttons:
+    // X3 is active during run mode (register K follows the output register,
+    // see get_reg_k()), but maybe not before the first instruction:
     //
-    d->sig_bu = false;
-    for (int i = 0; i < KENBAK_INPUT_BITS; ++i)
+    if(!is_input_settled(d) || d->sig_x != kenbak_x_3)
     {
-        if (d->input.buttons_data[i])
-        {
-            d->sig_bu = true;
-            break;
-        }
+        return false;
     }
-    d->sig_cl = d->input.but_input_clear;
-    d->sig_da = d->input.but_address_display;
-    d->sig_dd = d->input.but_memory_read;
-    d->sig_ea = d->input.but_address_set;
 
-    // Never disabling ED here to prevent overwrite, if cause is HALT
-    // instruction and not the run stop button, also see step_in_sb():
-    //
-    d->sig_ed = d->sig_ed || d->input.but_run_stop;
+    if(!is_next_instr_call(d))
+    {
+        return false;
+    }
 
-    d->sig_en = d->input.but_memory_store;
-    d->sig_go = d->input.but_run_start;
-}
+    int const pos = d->timing
+        ? (int)(d->byte_times % KENBAK_DATA_DELAY_LINE_SIZE) : -1;
+    struct kenbak_memo_call const * const call =
+        kenbak_memo_find(memo, d->mem, next, d->sig_inc, pos);
 
-/**
- * - See logic schematics, page 07.
- */
-static void update_reg_k(struct kenbak_data * const d)
-{
-    switch(d->sig_x)
+    if(call == NULL)
     {
-        case kenbak_x_none:
-        {
-            return; // Nothing to do.
-        }
-        case kenbak_x_1:
-        {
-            return; // Nothing to do, as already done via QE state handler.
-        }
-        case kenbak_x_2:
-        {
-            return; // Nothing to do, as already done via QE state handler.
-        }
-        case kenbak_x_3:
-        {
-            d->reg_k = mem_read(d, KENBAK_DATA_ADDR_OUTPUT);
-            return;
-        }
-        case kenbak_x_4:
-        {
-            d->reg_k = mem_read(d, KENBAK_DATA_ADDR_INPUT);
-            return;
-        }
+        kenbak_memo_start(memo, next, d->sig_inc, pos);
+        memo->call.steps = result->steps;
+        memo->call.instrs = result->instrs;
+        memo->call.byte_times = result->byte_times;
+        memo->call.output_writes = d->output_write_count;
+        return false;
+    }
 
-        default:
-        {
-            assert(false);
-            return;
-        }
+    if(!is_in_budget(limits->max_steps, result->steps, call->steps)
+        || !is_in_budget(limits->max_instrs, result->instrs, call->instrs)
+        || !is_in_budget(
+            limits->max_byte_times, result->byte_times, call->byte_times))
+    {
+        return false; // Would stop during the call.
     }
-}
 
-/**
- * - If clear or console data push buttons are depressed during run mode, the
- *   real Kenbak-1 will display the contents of location 128 as a faint
- *   background light (see page 20 of the programming reference manual)!
- */
-static void update_output(struct kenbak_data * const d)
-{
-    // See logic schematics, page 06:
+    // Replay:
+
+    uint32_t const output_write_count = d->output_write_count;
+    bool output_written = false;
+
+    for(int i = 0; i < call->write_count; ++i)
+    {
+        mem_write(d, call->writes[i].addr, call->writes[i].val);
+        output_written = output_written
+            || call->writes[i].addr == KENBAK_DATA_ADDR_OUTPUT;
+    }
+    d->output_write_count = output_write_count + call->output_writes;
+
+    d->sig_inc = call->end_sig_inc;
+    d->reg_i = call->end_reg_i;
+    d->reg_w = call->end_reg_w;
+    d->sig_r = call->end_sig_r;
+
+    // Register K got latched from the output register at each instruction
+    // boundary, so it holds its value, if the call did not write to it:
     //
-    d->output.led_address_set = d->sig_x == kenbak_x_1;
-    d->output.led_memory_store = d->sig_x == kenbak_x_2;
-    d->output.led_input_clear = d->sig_x == kenbak_x_4;
-    d->output.led_run_stop = d->state != kenbak_state_qc;
+    d->reg_k = output_written
+        ? call->end_reg_k : d->mem[KENBAK_DATA_ADDR_OUTPUT];
 
-    d->output.led_bit_0 = ((d->reg_k >> 0) & 1) == 1;
-    d->output.led_bit_1 = ((d->reg_k >> 1) & 1) == 1;
-    d->output.led_bit_2 = ((d->reg_k >> 2) & 1) == 1;
-    d->output.led_bit_3 = ((d->reg_k >> 3) & 1) == 1;
-    d->output.led_bit_4 = ((d->reg_k >> 4) & 1) == 1;
-    d->output.led_bit_5 = ((d->reg_k >> 5) & 1) == 1;
-    d->output.led_bit_6 = ((d->reg_k >> 6) & 1) == 1;
-    d->output.led_bit_7 = ((d->reg_k >> 7) & 1) == 1;
-}
+    result->steps += call->steps;
+    result->instrs += call->instrs;
+    result->byte_times += call->byte_times;
+    d->byte_times += (uint32_t)call->byte_times; // (wraps around, see there)
 
-static void update_input_signals_byte_and_x(struct kenbak_data * const d)
-{
-    update_input_signals(d);
-    update_input_byte(d);
-    update_x_signal(d);
+    ++memo->hit_count;
+    return true;
 }
 
-/**
- * - To be called, if Kenbak-1 is in a defined state and a step shall be taken.
- */
-static int step_in_defined_state(struct kenbak_data * const d)
+enum kenbak_run_stop kenbak_emu_run(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
 {
-    assert(d->state != kenbak_state_power_off);
-    assert(d->state != kenbak_state_unknown);
-
-    int c = 0;
+    assert(limits != NULL);
+    assert(result != NULL);
+
+    uint32_t const output_write_count = d->output_write_count;
+    struct cycle_detector cycle;
+    bool detect_cycles = limits->detect_cycles || limits->skip_cycles;
+
+    result->stop = kenbak_run_stop_none;
+    result->steps = 0;
+    result->instrs = 0;
+    result->byte_times = 0;
+    result->cycle_at_steps = 0;
+    result->cycle_steps = 0;
+    result->cycle_instrs = 0;
+    result->cycle_byte_times = 0;
+
+    cycle.power = 0;
+    cycle.len = 0;
+
+    if(!handle_power(d))
+    {
+        result->stop = kenbak_run_stop_power_off;
+        return result->stop;
+    }
 
-    switch(d->state)
+    while(true)
     {
-        case kenbak_state_sa: // SL, SN, SS, SV, SY or SZ -> SA
-        {
-            update_input_signals_byte_and_x(d);
+        enum kenbak_state const last_state = d->state;
+        int c = 0;
 
-            c = step_in_sa(d);
-            break;
-        }
-        case kenbak_state_sb: // SA -CM-> SB
-        {
-            c = step_in_sb(d);
-            break;
-        }
-        case kenbak_state_sc: // SB -^ED-> SC
-        {
-            c = step_in_sc(d);
-            break;
-        }
-        case kenbak_state_sd: // SC -CM-> SD
-        {
-            c = step_in_sd(d); // I <- Next instr. first byte.
-            break;
-        }
-        case kenbak_state_se: // SD -I3+I2-> SE (I2+I1 in emulator..)
-        {
-            c = step_in_se(d); // Gets here for TWO byte instructions.
-            break;
-        }
-        case kenbak_state_sf: // SE -JI+IND-> SF
-        {
-            c = step_in_sf(d);
-            break;
-        }
-        case kenbak_state_sg: // SF -CM-> SG
+        result->stop = get_stop_before_step(
+            d, limits, result, output_write_count);
+        if(result->stop != kenbak_run_stop_none)
         {
-            c = step_in_sg(d);
             break;
         }
-        case kenbak_state_sh: // ... -> SH
-        {
-            c = step_in_sh(d);
-            break;
-        }
-        case kenbak_state_sj: // SH -CM-> SJ
-        {
-            c = step_in_sj(d);
-            break;
-        }
-        case kenbak_state_sk: // ... -> SK
-        {
-            c = step_in_sk(d);
-            break;
-        }
-        case kenbak_state_sl: // SK -CM-> SL
-        {
-            c = step_in_sl(d);
-            break;
-        }
-        case kenbak_state_sm: // ... -> ...
-        {
-            c = step_in_sm(d);
-            break;
-        }
-        case kenbak_state_sn: // SM -^TM*^J*CM-> SN or ST-JP CM-> SN
-        {
-            c = step_in_sn(d);
-            break;
-        }
-        case kenbak_state_sp: // SM -TM*CM-> SP
-        {
-            c = step_in_sp(d);
-            break;
-        }
-        case kenbak_state_sq: // ST -JM*CM-> SR
-        {
-            c = step_in_sq(d);
-            break;
-        }
-        case kenbak_state_sr: // SP, SQ -> SR
-        {
-            c = step_in_sr(d);
-            break;
-        }
-        case kenbak_state_ss: // SR -CM-> SS
-        {
-            c = step_in_ss(d);
-            break;
-        }
-        case kenbak_state_st: // SZ -JC-> ST
-        {
-            c = step_in_st(d);
-            break;
-        }
-        case kenbak_state_su: // SD -^I3*^I2-> SU (^I2*^I1 in emulator..)
-        {
-            c = step_in_su(d); // Gets here for ONE byte instructions.
-            break;
-        }
-        case kenbak_state_sv: // SU -CM-> SV
-        {
-            c = step_in_sv(d);
-            break;
-        }
-        case kenbak_state_sw: // SV -IO-> SW
-        {
-            c = step_in_sw(d);
-            break;
-        }
-        case kenbak_state_sx: // SW -1-> SX
+
+        if(kenbak_emu_is_quiescent(d))
         {
-            c = step_in_sx(d);
+            // Each of the following steps would just last one byte time
+            // without changing anything, so let them pass arithmetically, as
+            // far as the budgets allow:
+
+            uint64_t count = 0;
+
+            if(limits->max_steps != 0)
+            {
+                count = limits->max_steps - result->steps;
+            }
+            if(limits->max_byte_times != 0
+                && (count == 0
+                    || limits->max_byte_times - result->byte_times < count))
+            {
+                count = limits->max_byte_times - result->byte_times;
+            }
+
+            result->steps += count;
+            result->byte_times += count;
+            d->byte_times += (uint32_t)count; // (wraps around, see there)
+
+            result->stop = kenbak_run_stop_quiescent;
             break;
         }
-        case kenbak_state_sy: // SX -CM-> SY
+
+        if(detect_cycles
+            && last_state == kenbak_state_sa
+            && is_cycle_found(&cycle, d, result))
         {
-            c = step_in_sy(d);
-            break;
+            result->cycle_at_steps = result->steps;
+            result->cycle_steps = result->steps - cycle.steps;
+            result->cycle_instrs = result->instrs - cycle.instrs;
+            result->cycle_byte_times = result->byte_times - cycle.byte_times;
+
+            if(!limits->skip_cycles || !skip_cycles(d, &cycle, limits, result))
+            {
+                result->stop = kenbak_run_stop_cycle;
+                break;
+            }
+            detect_cycles = false; // The rest is shorter than a cycle.
+            continue; // Check for a reason to stop, again.
         }
-        case kenbak_state_sz: // SM -> SZ
+
+        if(d->memo != NULL
+            && last_state == kenbak_state_sa
+            && !limits->stop_at_output
+            && !limits->stop_at_p
+            && memoize_call(d, limits, result))
         {
-            c = step_in_sz(d);
-            break;
+            continue; // Check for a reason to stop, again.
         }
 
-        case kenbak_state_qb: // QC -GO-> QB
+        if(last_state == kenbak_state_sa
+            && is_in_budget(
+                limits->max_steps,
+                result->steps,
+                KENBAK_EMU_MAX_STEPS_PER_INSTR))
         {
-            update_input_signals_byte_and_x(d);
+            // The whole instruction in one pass (the byte time budget is not
+            // used up, see get_stop_before_step(), but may get exceeded by
+            // this instruction):
 
-            c = step_in_qb(d);
-            break;
-        }
-        case kenbak_state_qc: // SB -ED-> QC or QF -^X5-> QC
-        {
-            update_input_signals_byte_and_x(d);
+            int const countdown_reg = get_next_countdown_reg(d);
 
-            c = step_in_qc(d);
-            break;
-        }
-        case kenbak_state_qd: // QC -X5-> QD
-        {
-            c = step_in_qd(d);
-            break;
+            if(countdown_reg != -1)
+            {
+                uint64_t const instrs = result->instrs;
+
+                skip_countdown_loop(d, countdown_reg, limits, result);
+                if(result->instrs != instrs)
+                {
+                    continue; // Check for a reason to stop, again.
+                }
+            }
+
+            if(d->code_cache != NULL
+                && !limits->stop_at_output
+                && !limits->stop_at_p
+                && !detect_cycles
+                && (d->memo == NULL || !d->memo->recording))
+            {
+                // As many instructions as possible from the code cache:
+
+                if(!exec_cached_instrs(d, limits, result))
+                {
+                    c = -1;
+                }
+            }
+            else
+            {
+                int steps = 0;
+
+                c = exec_instr(d, &steps);
+                result->steps += (uint64_t)steps;
+                if(d->state == kenbak_state_sa)
+                {
+                    ++result->instrs; // (otherwise, ED led from SB to QC)
+                }
+            }
         }
-        case kenbak_state_qe: // QD -CM-> QE
+        else
         {
-            c = step_in_qe(d);
-            break;
+            c = step_in_defined_state(d, KENBAK_EMU_DISPATCH);
+            ++result->steps;
+            if(last_state == kenbak_state_sd)
+            {
+                ++result->instrs;
+            }
         }
-        case kenbak_state_qf: // QE -1-> QF
+        if(c < 0)
         {
-            update_input_signals_byte_and_x(d);
-
-            c = step_in_qf(d);
+            result->stop = kenbak_run_stop_error;
             break;
         }
+        result->byte_times += (uint64_t)c;
 
-        case kenbak_state_power_off: // (falls through)
-        case kenbak_state_unknown: // (falls through)
-        default:
+        if(limits->stop_at_qc
+            && last_state != kenbak_state_qc
+            && d->state == kenbak_state_qc)
         {
-            assert(false);
-            return -1; // Error!
+            result->stop = kenbak_run_stop_qc;
+            break;
         }
     }
 
-    update_reg_k(d);
-    update_output(d);
-    assert(0 <= c);
-    return c;
-}
-
-int kenbak_emu_step(struct kenbak_data * const d)
-{
-    if(d->state == kenbak_state_power_off)
+    if(d->memo != NULL)
     {
-        if(!d->input.switch_power_on)
-        {
-            return 0;
-        }
-
-        d->state = kenbak_state_unknown; // Must be handled below.
+        kenbak_memo_abort(d->memo); // The input may change until next call.
     }
+    return result->stop;
+}
 
-    // Kenbak-1 is powered-on.
+// *****************************************************************************
+// *** CREATION AND DELETION OF A KENBAK-1'S STATE REPRESENTATION            ***
+// *****************************************************************************
 
-    if(!d->input.switch_power_on)
+void kenbak_emu_reset(struct kenbak_data * const d)
+{
+    d->timing = false;
+    d->hashing = false;
+    d->mem_hash_valid = false;
+    d->mem_hash = 0;
+    d->check_countdown = 0;
+    d->cold->check_interval = 0;
+    d->cold->check_violation = NULL;
+    d->cold->trace = NULL;
+    d->cold->trace_ctx = NULL;
+    memset(d->cold->state_steps, 0, sizeof d->cold->state_steps);
+    d->cold->rand_state = d->cold->seed; // Same memory again, if randomized.
+
+    if(d->memo != NULL)
     {
-        // Power-off:
-
-        init(d);
-        assert(d->state == kenbak_state_power_off);
-        return 0;
+        kenbak_memo_abort(d->memo); // A call may have been recorded.
     }
 
-    // Power toggle is (still) in ON position.
+    init(d); // (reports the writes to the memory to the code cache)
+}
 
-    if(d->state == kenbak_state_unknown)
-    {
-        d->state = kenbak_state_qc;
-    }
+void kenbak_emu_init_in_place(
+    struct kenbak_data * const d,
+    struct kenbak_data_cold * const cold,
+    struct kenbak_emu_options const * const options)
+{
+    assert((uintptr_t)d % KENBAK_DATA_CACHE_LINE_SIZE == 0);
 
-    // Kenbak-1 is in a defined state.
+    d->cold = cold;
+    d->cold->randomize_memory = options->randomize_memory;
+    d->cold->seed = options->seed;
+    d->code_cache = NULL;
+    d->memo = NULL;
 
-    return step_in_defined_state(d);
+    kenbak_emu_reset(d);
 }
 
-// *****************************************************************************
-// *** CREATION AND DELETION OF A KENBAK-1'S STATE REPRESENTATION            ***
-// *****************************************************************************
+void kenbak_emu_deinit(struct kenbak_data * const d)
+{
+    kenbak_code_delete(d->code_cache);
+    d->code_cache = NULL;
+    kenbak_memo_delete(d->memo);
+    d->memo = NULL;
+}
 
 void kenbak_emu_delete(struct kenbak_data * const d)
 {
@@ -1703,12 +1698,32 @@ void kenbak_emu_delete(struct kenbak_data * const d)
     {
         return; // Just do nothing.
     }
+    kenbak_emu_deinit(d);
+#ifdef _MSC_VER
+    _aligned_free(d);
+#else //_MSC_VER
     free(d);
+#endif //_MSC_VER
 }
 
-struct kenbak_data * kenbak_emu_create(bool const randomize_memory)
+struct kenbak_data * kenbak_emu_create_with(
+    struct kenbak_emu_options const * const options)
 {
-    struct kenbak_data * const d = malloc(sizeof *d);
+    // The memory is cache-line-aligned, so the whole object is, too (and its
+    // size is a multiple of the cache line size, as aligned_alloc() wants).
+    // The cold part follows in the same allocation:
+    //
+    size_t const size = sizeof (struct kenbak_data)
+        + (sizeof (struct kenbak_data_cold) + KENBAK_DATA_CACHE_LINE_SIZE - 1)
+            / KENBAK_DATA_CACHE_LINE_SIZE * KENBAK_DATA_CACHE_LINE_SIZE;
+
+#ifdef _MSC_VER
+    struct kenbak_data * const d = _aligned_malloc(
+        size, KENBAK_DATA_CACHE_LINE_SIZE);
+#else //_MSC_VER
+    struct kenbak_data * const d = aligned_alloc(
+        KENBAK_DATA_CACHE_LINE_SIZE, size);
+#endif //_MSC_VER
 
     if(d == NULL)
     {
@@ -1716,9 +1731,35 @@ struct kenbak_data * kenbak_emu_create(bool const randomize_memory)
         return NULL;
     }
 
-    d->randomize_memory = randomize_memory;
+    kenbak_emu_init_in_place(d, (struct kenbak_data_cold *)(d + 1), options);
+    return d;
+}
+
+/** Returns the count of calls before this one (thread-safe).
+ */
+static uint64_t get_create_count(void)
+{
+#ifdef _MSC_VER
+    static LONG64 volatile s_count = 0;
 
-    init(d);
+    return (uint64_t)InterlockedIncrement64(&s_count) - 1;
+#else //_MSC_VER
+    static _Atomic uint64_t s_count = 0;
 
-    return d;
+    return atomic_fetch_add(&s_count, 1);
+#endif //_MSC_VER
+}
+
+struct kenbak_data * kenbak_emu_create(bool const randomize_memory)
+{
+    struct kenbak_emu_options const options = {
+        .randomize_memory = randomize_memory,
+
+        // A different seed for each Kenbak-1 created, even in the same
+        // second:
+        //
+        .seed = ((uint64_t)time(NULL) << 20) ^ (get_create_count() + 1)
+    };
+
+    return kenbak_emu_create_with(&options);
 }
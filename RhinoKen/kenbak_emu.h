@@ -57,16 +57,19 @@
 // - A step of this Kenbak-1 emulator equals processing ONE of the states
 //   from the state diagrams (see pages 25, 26 and 27).
 // 
-//   This emulator does NOT simulate the delays caused by the serial memory
-//   so let's assume 10 emulator steps per instruction (the emulator also does
-//   not differentiate between run mode on and run mode off state steps..).
+//   With the timing model enabled (see kenbak_emu_set_timing()), each step
+//   returns the count of byte times the state really lasts: The position of
+//   the delay lines (L) is tracked and a state waiting for CM lasts until the
+//   wanted address is reached, which is computed instead of being simulated.
 //
-//   This would lead to 10 * 480 (emulator) steps per second (see above).
-//   => 4800 steps / second.
+//   This way, 62500 byte times (1 s / 16 us) equal one second of a real
+//   Kenbak-1's operation.
+//
+//   Without the timing model, each step returns one byte time.
 //
 // - If we want to update the output 25 times per second (to get 25 FPS),
-//   for each update(/frame) we would take 4800 steps / 25 = 192 steps per
-//   update.
+//   for each update(/frame) we would let 62500 / 25 = 2500 byte times pass
+//   (e.g. via kenbak_emu_run()).
 
 // ^CP = Basic system clock (square wave), output of the clock pulse generator,
 //       that has the RC multivibrator as input.
@@ -177,17 +180,331 @@
 #define KENBAK_EMU
 
 #include "kenbak_data.h"
+#include "kenbak_dispatch.h"
+#include "kenbak_output.h"
+#include "kenbak_run.h"
 
+/**
+ * - The memory may be changed via the returned pointer, so the code cache
+ *   gets invalidated (see kenbak_emu_set_code_cache()). Write to d->mem
+ *   directly only with the code cache disabled.
+ */
 uint8_t* kenbak_emu_get_mem_ptr(
     struct kenbak_data * const d, uint8_t const addr);
 
+/**
+ * - Writes the given value to the given address like the Kenbak-1 does,
+ *   keeping the output write count, the code cache, the hash and the
+ *   memoization up-to-date (for other engines, see kenbak_serial.h).
+ */
+void kenbak_emu_write_mem(
+    struct kenbak_data * const d, uint8_t const addr, uint8_t const val);
+
+/**
+ * - Samples the input like the state machine does before a step in states
+ *   SA, QB, QC and QF: Updates the signals of the push buttons, the input
+ *   byte, X and register K (for other engines, see kenbak_serial.h).
+ */
+void kenbak_emu_sample_input(struct kenbak_data * const d);
+
+/**
+ * - Releases all push buttons and switches (but the power switch, if wanted).
+ */
 void kenbak_emu_init_input(
     struct kenbak_data* const d, bool const keep_switch_power_on);
 
+/**
+ * - Sets the whole packed input (see enum kenbak_input_bit).
+ * - The emulator samples the input in states SA, QB, QC and QF, but only
+ *   needs to update its signals and the input byte there, if a push button is
+ *   pressed or a push button's state changed since the last sample.
+ */
+void kenbak_emu_set_input_bits(
+    struct kenbak_data * const d, uint32_t const bits);
+
+uint32_t kenbak_emu_get_input_bits(struct kenbak_data const * const d);
+
+/**
+ * - Presses the given push button or switches on the given switch.
+ */
+void kenbak_emu_press(
+    struct kenbak_data * const d, enum kenbak_input_bit const input_bit);
+
+/**
+ * - Releases the given push button or switches off the given switch.
+ */
+void kenbak_emu_release(
+    struct kenbak_data * const d, enum kenbak_input_bit const input_bit);
+
+/**
+ * - Returns the packed input (see enum kenbak_input_bit) of the given
+ *   unpacked input.
+ */
+uint32_t kenbak_emu_pack_input(struct kenbak_input const * const input);
+
+/**
+ * - Compatibility: Sets the whole input from the given unpacked input.
+ */
+void kenbak_emu_set_input(
+    struct kenbak_data * const d, struct kenbak_input const * const input);
+
+/**
+ * - Compatibility: Gets the whole input into the given unpacked input.
+ */
+void kenbak_emu_get_input(
+    struct kenbak_data const * const d, struct kenbak_input * const input);
+
 void kenbak_emu_delete(struct kenbak_data * const d);
 
+/**
+ * - Returns the current content of register K (that controls the data lamps).
+ */
+uint8_t kenbak_emu_get_reg_k(struct kenbak_data * const d);
+
+/**
+ * - Derives the current packed front panel output (see enum
+ *   kenbak_output_bit) from the Kenbak-1's state and returns it (the steps do
+ *   not update the output on their own).
+ */
+uint32_t kenbak_emu_get_output_bits(struct kenbak_data * const d);
+
+/**
+ * - Compatibility: Gets the whole output into the given unpacked output (see
+ *   kenbak_emu_get_output_bits()).
+ */
+void kenbak_emu_get_output(
+    struct kenbak_data * const d, struct kenbak_output * const output);
+
 int kenbak_emu_step(struct kenbak_data * const d);
 
+/**
+ * - Like kenbak_emu_step(), but with the given kind of dispatch to the current
+ *   state's handler (mainly for benchmarking, see test/kenbak_bench.h).
+ */
+int kenbak_emu_step_via(
+    struct kenbak_data * const d, enum kenbak_dispatch const dispatch);
+
+/**
+ * - Takes the given count of steps, as that many calls of kenbak_emu_step()
+ *   would (stopping on error), but without returning after each step (with
+ *   the computed goto dispatch, each state's handler jumps directly to the
+ *   next one's, see enum kenbak_dispatch).
+ * - The power switch is handled before the first step only.
+ * - Returns the summed-up byte time count.
+ */
+uint64_t kenbak_emu_steps(struct kenbak_data * const d, uint64_t const count);
+
+/**
+ * - Like kenbak_emu_steps(), but with the given kind of dispatch (mainly for
+ *   benchmarking, see test/kenbak_bench.h).
+ */
+uint64_t kenbak_emu_steps_via(
+    struct kenbak_data * const d,
+    uint64_t const count,
+    enum kenbak_dispatch const dispatch);
+
+/**
+ * - Executes the whole next instruction in one pass, if the Kenbak-1 is in run
+ *   mode at an instruction boundary (state SA). Otherwise, a single step is
+ *   taken, as kenbak_emu_step() does.
+ * - The results at the instruction boundaries (states SA and QC) are the same
+ *   as when calling kenbak_emu_step() for each state of the instruction.
+ * - Returns the summed-up byte time count of all states passed.
+ */
+int kenbak_emu_step_instr(struct kenbak_data * const d);
+
+/**
+ * - Enables or disables the analytic timing model of the delay line memory
+ *   (disabled by default), see "SPEED" OF EMULATION, above.
+ */
+void kenbak_emu_set_timing(struct kenbak_data * const d, bool const timing);
+
+/**
+ * - Enables or disables the cache of pre-decoded basic blocks (disabled by
+ *   default), used by kenbak_emu_run() to execute instructions in run mode
+ *   without fetching and decoding them again (see kenbak_code.h).
+ * - Writes to cached instructions by the Kenbak-1 itself invalidate the cache
+ *   (e.g. store immediate, SET or a manual store).
+ * - Returns false, if the cache could not be created.
+ */
+bool kenbak_emu_set_code_cache(struct kenbak_data * const d, bool const enable);
+
+/**
+ * - Enables or disables the threaded code (disabled by default): The blocks of
+ *   the code cache get translated into calls of handlers that are specialized
+ *   per kind of instruction (addressing mode included), so kenbak_emu_run()
+ *   does not need to decide about the states to pass at run time.
+ * - Enables the code cache, if necessary (see kenbak_emu_set_code_cache()),
+ *   disabling it disables the threaded code, too.
+ * - Manual mode is always processed by the interpreter.
+ * - Returns false, if the code cache could not be created.
+ */
+bool kenbak_emu_set_threaded_code(
+    struct kenbak_data * const d, bool const enable);
+
+/**
+ * - Enables or disables the JIT (disabled by default): The blocks of the code
+ *   cache get compiled into native x86-64 code, which kenbak_emu_run() uses
+ *   in run mode with the input settled, without the timing model, the hashing
+ *   and the memoization (see kenbak_jit.h). The threaded code and the
+ *   interpreter do everything else.
+ * - Enables the threaded code, if necessary (see
+ *   kenbak_emu_set_threaded_code()), disabling the code cache disables the
+ *   JIT, too.
+ * - Returns false, if the code cache could not be created or if the JIT is
+ *   not available (see KENBAK_JIT_AVAILABLE).
+ */
+bool kenbak_emu_set_jit(struct kenbak_data * const d, bool const enable);
+
+/**
+ * - Enables or disables the memoization of subroutine calls (disabled by
+ *   default), used by kenbak_emu_run() in run mode: Calls via jump and mark
+ *   (JMD or JMI) get recorded and a later call from the same address that
+ *   would read the same values gets replayed at once (see kenbak_memo.h).
+ * - Calls are not memoized while stopping at the output or at P (see struct
+ *   kenbak_run_limits), or while a push button is pressed.
+ * - Instructions are not taken from the code cache while recording a call.
+ * - Returns false, if the memoization could not be created.
+ */
+bool kenbak_emu_set_memo(struct kenbak_data * const d, bool const enable);
+
+/**
+ * - Validates the state machine's invariants (see kenbak_check.h) before each
+ *   given count of steps taken state by state (zero disables this, which is
+ *   the default). Whole instructions executed in one pass (see
+ *   kenbak_emu_step_instr() and kenbak_emu_run()) are not validated.
+ * - A checked build validates before each step taken state by state, anyway
+ *   (see KENBAK_EMU_CHECKED in kenbak_emu.c).
+ */
+void kenbak_emu_set_check_interval(
+    struct kenbak_data * const d, uint32_t const interval);
+
+/**
+ * - Returns the description of the first violation of the state machine's
+ *   invariants found (see kenbak_emu_set_check_interval()) or NULL, if none
+ *   was found.
+ */
+char const * kenbak_emu_get_check_violation(
+    struct kenbak_data const * const d);
+
+/**
+ * - Sets the function to be called with the given context before each step
+ *   taken by the traced engine variant (see kenbak_variant.h), NULL for none.
+ * - The other engines do not trace (at no cost).
+ */
+void kenbak_emu_set_trace(
+    struct kenbak_data * const d,
+    kenbak_data_trace_fn const trace,
+    void * const ctx);
+
+/**
+ * - Enables or disables the incremental hashing of the memory (disabled by
+ *   default): Each write by the Kenbak-1 updates the memory's hash (see
+ *   kenbak_hash.h), so kenbak_emu_get_hash() does not need to hash the whole
+ *   memory again (e.g. for the cycle detection of kenbak_emu_run()).
+ */
+void kenbak_emu_set_hashing(struct kenbak_data * const d, bool const enable);
+
+/**
+ * - Returns a 64-bit hash of the whole state that determines what the
+ *   Kenbak-1 is going to do: Memory, state, registers, signals, input and the
+ *   delay line position, if the timing model is enabled (not the counters of
+ *   byte times and output writes).
+ * - Equal states have equal hashes, equal hashes most probably mean equal
+ *   states.
+ * - Hashes the whole memory, if hashing is disabled (see
+ *   kenbak_emu_set_hashing()) or the memory got accessed via
+ *   kenbak_emu_get_mem_ptr() since the last call.
+ */
+uint64_t kenbak_emu_get_hash(struct kenbak_data * const d);
+
+/**
+ * - Returns true, if taking steps would not change anything (but the byte
+ *   times passed), until the input changes: If the Kenbak-1 is powered-off,
+ *   idles in QC or waits in QB or QF for push buttons to be released.
+ * - A host can then block on the next input event instead of taking steps.
+ */
+bool kenbak_emu_is_quiescent(struct kenbak_data * const d);
+
+/**
+ * - Takes steps (see kenbak_emu_step()) until one of the given limits is
+ *   reached, keeping the loop inside the emulator (e.g. for turbo, headless
+ *   and batch modes). Uses kenbak_emu_step_instr()'s fast path, where the
+ *   budgets allow it.
+ * - Countdown loops (e.g. SUB-X constant 1 followed by JPD-X != 0 back to the
+ *   SUB) are fast-forwarded, the results are the same as if each iteration
+ *   was executed.
+ * - Optionally finds cycles of the whole machine state and stops at them or
+ *   skips whole passes (see detect_cycles and skip_cycles of struct
+ *   kenbak_run_limits).
+ * - The power switch is checked once at the start. Changes to the input made
+ *   by the caller take effect with the next call.
+ * - Fills the given result with the reason to stop and the used budgets and
+ *   also returns the reason.
+ * - Returns kenbak_run_stop_quiescent without taking the remaining steps,
+ *   if the Kenbak-1 is quiescent (see kenbak_emu_is_quiescent()), so the
+ *   stop conditions can not be reached before the input changes.
+ * - Does not return before a limit is reached (or being quiescent), so at
+ *   least one should be given.
+ */
+enum kenbak_run_stop kenbak_emu_run(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result);
+
+// The options of a Kenbak-1 to be created (see kenbak_emu_create_with() and
+// kenbak_emu_init_in_place()):
+//
+struct kenbak_emu_options
+{
+    // Fill the memory with pseudo-random values instead of zeros on creation
+    // and on each power-off?
+    //
+    bool randomize_memory;
+
+    // Seed of the Kenbak-1's own pseudo-random number generator for that (see
+    // kenbak_rand.h), the same seed leads to the same values:
+    //
+    uint64_t seed;
+};
+
+struct kenbak_data * kenbak_emu_create_with(
+    struct kenbak_emu_options const * const options);
+
+/**
+ * - Like kenbak_emu_create_with(), with a new seed for each Kenbak-1 (derived
+ *   from the time and a counter).
+ */
 struct kenbak_data * kenbak_emu_create(bool const randomize_memory);
 
+/**
+ * - Initializes the given caller-owned Kenbak-1 like kenbak_emu_create() does,
+ *   but without allocating anything: The given storage is used for the cold
+ *   part (see struct kenbak_data_cold) and both must stay valid until the
+ *   Kenbak-1 is no longer used.
+ * - The Kenbak-1 must be cache-line-aligned, which its type takes care of for
+ *   static and automatic objects (but not necessarily for allocated ones).
+ * - To be undone via kenbak_emu_deinit(), NOT via kenbak_emu_delete().
+ */
+void kenbak_emu_init_in_place(
+    struct kenbak_data * const d,
+    struct kenbak_data_cold * const cold,
+    struct kenbak_emu_options const * const options);
+
+/**
+ * - Deletes the code cache and the memoization of the given Kenbak-1 (if
+ *   enabled), but not the Kenbak-1 itself (see kenbak_emu_init_in_place()).
+ */
+void kenbak_emu_deinit(struct kenbak_data * const d);
+
+/**
+ * - Resets the given Kenbak-1 to how it was right after its creation or
+ *   initialization (memory, input, state, registers, signals, counters and
+ *   options, randomized memory gets the same values again), BUT keeps the
+ *   code cache (with the threaded code) and the memoization enabled, if they
+ *   are (their content stays valid, see kenbak_emu_set_code_cache() and
+ *   kenbak_emu_set_memo()).
+ */
+void kenbak_emu_reset(struct kenbak_data * const d);
+
 #endif //KENBAK_EMU
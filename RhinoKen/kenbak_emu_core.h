@@ -0,0 +1,2531 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// The core of the emulator: The Kenbak-1's state machine and everything a
+// single step needs.
+//
+// - To be included by a translation unit once, after configuring the features
+//   below, so that a single source is compiled into each engine variant (see
+//   kenbak_variant.h) and into the engine of kenbak_emu.c. All functions are
+//   static, so the variants can be linked side by side.
+// - Each feature is KENBAK_EMU_FEATURE_OFF, if not defined, which compiles it
+//   out (instead of checking at run time, whether it is enabled):
+//
+//   KENBAK_EMU_FEATURE_TIMING: The analytic timing model of the delay line
+//   memory (KENBAK_EMU_FEATURE_RUNTIME: if enabled via
+//   kenbak_emu_set_timing()).
+//
+//   KENBAK_EMU_FEATURE_CHECK: Validation of the state machine's invariants
+//   before each step, asserting that they hold (see kenbak_check.h,
+//   KENBAK_EMU_FEATURE_RUNTIME: as set via kenbak_emu_set_check_interval()).
+//
+//   KENBAK_EMU_FEATURE_TRACE: Calls the trace function set via
+//   kenbak_emu_set_trace() before each step.
+//
+//   KENBAK_EMU_FEATURE_COUNT: Counts the steps taken in each state (see
+//   state_steps in struct kenbak_data_cold).
+//
+//   KENBAK_EMU_FEATURE_CODE_CACHE, KENBAK_EMU_FEATURE_HASH and
+//   KENBAK_EMU_FEATURE_MEMO: Tell the code cache, the memory hash and the
+//   memoization of calls about memory accesses (KENBAK_EMU_FEATURE_RUNTIME
+//   only: if enabled via kenbak_emu_set_code_cache(), kenbak_emu_set_hashing()
+//   or kenbak_emu_set_memo(), an engine variant without them refuses to
+//   step).
+//
+// - If KENBAK_EMU_CORE_PREFIX is defined, the functions <prefix>_step() and
+//   <prefix>_steps() get defined (see kenbak_variant.h).
+// - If KENBAK_EMU_CORE_INSTRS is defined, exec_instr() (a whole instruction in
+//   one pass) and skip_countdown_loop() get defined, too (see kenbak_emu_run()
+//   and kenbak_multi.c).
+
+#ifndef KENBAK_EMU_CORE
+#define KENBAK_EMU_CORE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "kenbak_data.h"
+#include "kenbak_instr.h"
+#include "kenbak_code.h"
+#include "kenbak_hash.h"
+#include "kenbak_memo.h"
+#include "kenbak_check.h"
+#include "kenbak_input.h"
+#include "kenbak_state.h"
+#include "kenbak_x.h"
+#include "kenbak_jmp_cond.h"
+#include "kenbak_dispatch.h"
+#include "kenbak_variant.h"
+#include "kenbak_run.h"
+
+#define KENBAK_EMU_FEATURE_OFF 0
+#define KENBAK_EMU_FEATURE_ON 1
+#define KENBAK_EMU_FEATURE_RUNTIME 2 // (not supported by each feature)
+
+#ifndef KENBAK_EMU_FEATURE_TIMING
+    #define KENBAK_EMU_FEATURE_TIMING KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_TIMING
+#ifndef KENBAK_EMU_FEATURE_CHECK
+    #define KENBAK_EMU_FEATURE_CHECK KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_CHECK
+#ifndef KENBAK_EMU_FEATURE_TRACE
+    #define KENBAK_EMU_FEATURE_TRACE KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_TRACE
+#ifndef KENBAK_EMU_FEATURE_COUNT
+    #define KENBAK_EMU_FEATURE_COUNT KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_COUNT
+#ifndef KENBAK_EMU_FEATURE_CODE_CACHE
+    #define KENBAK_EMU_FEATURE_CODE_CACHE KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_CODE_CACHE
+#ifndef KENBAK_EMU_FEATURE_HASH
+    #define KENBAK_EMU_FEATURE_HASH KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_HASH
+#ifndef KENBAK_EMU_FEATURE_MEMO
+    #define KENBAK_EMU_FEATURE_MEMO KENBAK_EMU_FEATURE_OFF
+#endif //KENBAK_EMU_FEATURE_MEMO
+
+// How the functions below access the Kenbak-1 given to them as d: The type d
+// points to, a register, signal, counter, etc. by its name in struct
+// kenbak_data (an lvalue) and the memory (kenbak_multi.c accesses its
+// struct-of-arrays this way, only the timing model is supported by it):
+//
+#ifndef KENBAK_EMU_CORE_DATA
+    #define KENBAK_EMU_CORE_DATA struct kenbak_data
+    #define KENBAK_EMU_AT(d, field) ((d)->field)
+    #define KENBAK_EMU_MEM(d) ((d)->mem)
+#endif //KENBAK_EMU_CORE_DATA
+
+// See KENBAK_DATA_IS_SIG(), etc.:
+//
+#define KENBAK_EMU_IS_SIG(d, sig) \
+    ((KENBAK_EMU_AT(d, sigs) & KENBAK_SIG_MASK(sig)) != 0)
+#define KENBAK_EMU_SET_SIG(d, sig) \
+    (KENBAK_EMU_AT(d, sigs) |= KENBAK_SIG_MASK(sig))
+#define KENBAK_EMU_CLEAR_SIG(d, sig) \
+    (KENBAK_EMU_AT(d, sigs) &= (uint8_t)~KENBAK_SIG_MASK(sig))
+
+// Is the timing model enabled for the given Kenbak-1 (a constant, unless
+// selected at run time)?
+//
+#if KENBAK_EMU_FEATURE_TIMING == KENBAK_EMU_FEATURE_RUNTIME
+    #define KENBAK_EMU_IS_TIMING(d) (KENBAK_EMU_AT(d, timing))
+#else //KENBAK_EMU_FEATURE_TIMING == KENBAK_EMU_FEATURE_RUNTIME
+    #define KENBAK_EMU_IS_TIMING(d) \
+        (KENBAK_EMU_FEATURE_TIMING == KENBAK_EMU_FEATURE_ON)
+#endif //KENBAK_EMU_FEATURE_TIMING == KENBAK_EMU_FEATURE_RUNTIME
+
+// The dispatch used for a single step by kenbak_emu_step(), etc., see enum
+// kenbak_dispatch (the computed goto is the fastest only when it does not
+// return after each step):
+//
+#ifndef KENBAK_EMU_DISPATCH
+    #define KENBAK_EMU_DISPATCH kenbak_dispatch_table
+#endif //KENBAK_EMU_DISPATCH
+
+// The dispatch used for a count of steps by kenbak_emu_steps(), etc.:
+//
+#ifndef KENBAK_EMU_DISPATCH_STEPS
+    #if defined(__GNUC__) || defined(__clang__)
+        #define KENBAK_EMU_DISPATCH_STEPS kenbak_dispatch_goto
+    #else
+        #define KENBAK_EMU_DISPATCH_STEPS kenbak_dispatch_table
+    #endif
+#endif //KENBAK_EMU_DISPATCH_STEPS
+
+// *****************************************************************************
+// *** HELPER FUNCTIONS                                                      ***
+// *****************************************************************************
+
+static uint8_t get_rotated_left(uint8_t const val, int const places)
+{
+    assert(1 <= places && places <= 4); // This is what the Kenbak-1 supports.
+
+    // (76543210 << 1) | (76543210 >> (8 - 1)) = 6543210x | xxxxxxx7 = 65432107
+    // (76543210 << 2) | (76543210 >> (8 - 2)) = 543210xx | xxxxxx76 = 54321076
+    // (76543210 << 3) | (76543210 >> (8 - 3)) = 43210xxx | xxxxx765 = 43210765
+    // (76543210 << 4) | (76543210 >> (8 - 4)) = 3210xxxx | xxxx7654 = 32107654
+
+    return (val << places) | (val >> (8 - places));
+}
+
+static uint8_t get_rotated_right(uint8_t const val, int const places)
+{
+    assert(1 <= places && places <= 4); // This is what the Kenbak-1 supports.
+
+    // (76543210 >> 1) | (76543210 << (8 - 1)) = x7654321 | 0xxxxxxx = 07654321
+    // (76543210 >> 2) | (76543210 << (8 - 2)) = xx765432 | 10xxxxxx = 10765432
+    // (76543210 >> 3) | (76543210 << (8 - 3)) = xxx76543 | 210xxxxx = 21076543
+    // (76543210 >> 4) | (76543210 << (8 - 4)) = xxxx7654 | 3210xxxx = 32107654
+
+    return (val >> places) | (val << (8 - places));
+}
+
+// *****************************************************************************
+// *** READ-TO AND WRITE-FROM MEMORY                                         ***
+// *****************************************************************************
+
+static void mem_write(
+    KENBAK_EMU_CORE_DATA * const d, uint8_t const addr, uint8_t const val)
+{
+    if(addr == KENBAK_DATA_ADDR_OUTPUT)
+    {
+        ++KENBAK_EMU_AT(d, output_write_count);
+    }
+#if KENBAK_EMU_FEATURE_CODE_CACHE != KENBAK_EMU_FEATURE_OFF
+    if(KENBAK_EMU_AT(d, code_cache) != NULL)
+    {
+        // Self-modifying code:
+        //
+        KENBAK_CODE_ON_WRITE(KENBAK_EMU_AT(d, code_cache), addr);
+    }
+#endif //KENBAK_EMU_FEATURE_CODE_CACHE != KENBAK_EMU_FEATURE_OFF
+#if KENBAK_EMU_FEATURE_HASH != KENBAK_EMU_FEATURE_OFF
+    if(KENBAK_EMU_AT(d, hashing))
+    {
+        KENBAK_HASH_ON_WRITE(
+            KENBAK_EMU_AT(d, mem_hash), addr, KENBAK_EMU_MEM(d)[addr], val);
+    }
+#endif //KENBAK_EMU_FEATURE_HASH != KENBAK_EMU_FEATURE_OFF
+#if KENBAK_EMU_FEATURE_MEMO != KENBAK_EMU_FEATURE_OFF
+    if(KENBAK_EMU_AT(d, memo) != NULL)
+    {
+        KENBAK_MEMO_ON_WRITE(KENBAK_EMU_AT(d, memo), addr);
+    }
+#endif //KENBAK_EMU_FEATURE_MEMO != KENBAK_EMU_FEATURE_OFF
+    KENBAK_EMU_MEM(d)[addr] = val;
+}
+
+static uint8_t mem_read(KENBAK_EMU_CORE_DATA * const d, uint8_t const addr)
+{
+#if KENBAK_EMU_FEATURE_MEMO != KENBAK_EMU_FEATURE_OFF
+    if(KENBAK_EMU_AT(d, memo) != NULL)
+    {
+        KENBAK_MEMO_ON_READ(
+            KENBAK_EMU_AT(d, memo), addr, KENBAK_EMU_MEM(d)[addr]);
+    }
+#else //KENBAK_EMU_FEATURE_MEMO != KENBAK_EMU_FEATURE_OFF
+    (void)d;
+#endif //KENBAK_EMU_FEATURE_MEMO != KENBAK_EMU_FEATURE_OFF
+    return KENBAK_EMU_MEM(d)[addr];
+}
+
+// *****************************************************************************
+// *** INPUT                                                                 ***
+// *****************************************************************************
+
+static bool is_input_on(
+    KENBAK_EMU_CORE_DATA const * const d, enum kenbak_input_bit const input_bit)
+{
+    return (KENBAK_EMU_AT(d, input) & KENBAK_INPUT_MASK(input_bit)) != 0;
+}
+
+// *****************************************************************************
+// *** INSTRUCTION EXECUTION (SHARED BY STATE MACHINE AND FAST PATH)         ***
+// *****************************************************************************
+
+/** Executes the bit manipulation or test instruction in register I, W must
+ *  hold the operand and R the operand's address (see SL).
+ */
+static void exec_bit(KENBAK_EMU_CORE_DATA * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+    uint8_t const mask = 1 << dec->bit_pos;
+
+    KENBAK_EMU_AT(d, sig_inc) = 2;
+
+    if(dec->bit_is_skip)
+    {
+        // SKIP on 0 or on 1.
+
+        bool const bit_is_set = (KENBAK_EMU_AT(d, reg_w) & mask) != 0;
+
+        if(bit_is_set == dec->bit_val)
+        {
+            KENBAK_EMU_AT(d, sig_inc) += 2; // Always skips two bytes.
+        }
+        return;
+    }
+
+    // SET
+
+    if(dec->bit_val)
+    {
+        KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, reg_w) | mask; // Sets to 1.
+    }
+    else
+    {
+        // Sets to 0:
+        //
+        KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, reg_w) & (uint8_t)~mask;
+    }
+
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_w));
+}
+
+/** Changes A, B or X (addressed by R) by the instruction in register I, W
+ *  must hold the operand (see SN).
+ *
+ *  - Also used for jumps, where R addresses P and W holds the jump destination.
+ *  - Returns false on error.
+ */
+static bool exec_change_reg(KENBAK_EMU_CORE_DATA * const d)
+{
+    enum kenbak_instr_type const instr_type = (enum kenbak_instr_type)
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->type;
+
+    // A, B or X is read from memory (see SM):
+    //
+    uint8_t const reg_content = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    uint8_t result = 0;
+    bool do_sub = false;
+
+    switch(instr_type)
+    {
+        case kenbak_instr_type_sub: // See PRM, page 5.
+        {
+            do_sub = true; // Falls through.
+        }
+        case kenbak_instr_type_add: // See PRM, page 5.
+        {
+            uint16_t const buf =
+                (uint16_t)(do_sub
+                    ? (uint8_t)(-KENBAK_EMU_AT(d, reg_w)) // Two's complement.
+                    : KENBAK_EMU_AT(d, reg_w))
+                + (uint16_t)reg_content;
+            uint8_t overflow_and_carry = 0;
+
+            if(255 < buf)
+            {
+                overflow_and_carry = overflow_and_carry & 1; // Hard-coded 1.
+            }
+
+            result = (uint8_t)buf;
+
+            // TODO: Verify that this is correctly implemented:
+            //
+            if(KENBAK_EMU_AT(d, reg_w) <= 127 && 127 < result)
+            {
+                overflow_and_carry = overflow_and_carry & 2; // Hard-coded 2.
+            }
+
+            mem_write(
+                d,
+                KENBAK_DATA_ADDR_OC_FOR(KENBAK_EMU_AT(d, sig_r)),
+                overflow_and_carry);
+
+            KENBAK_EMU_AT(d, sig_inc) = 2;
+            break;
+        }
+        case kenbak_instr_type_load: // See PRM, page 6.
+        {
+            result = KENBAK_EMU_AT(d, reg_w);
+
+            KENBAK_EMU_AT(d, sig_inc) = 2;
+            break;
+        }
+        case kenbak_instr_type_and: // See PRM, page 7.
+        {
+            result = KENBAK_EMU_AT(d, reg_w) & reg_content;
+
+            KENBAK_EMU_AT(d, sig_inc) = 2;
+            break;
+        }
+        case kenbak_instr_type_or: // See PRM, page 7.
+        {
+            result = KENBAK_EMU_AT(d, reg_w) | reg_content;
+
+            KENBAK_EMU_AT(d, sig_inc) = 2;
+            break;
+        }
+        case kenbak_instr_type_lneg: // See PRM, page 8.
+        {
+            result = -KENBAK_EMU_AT(d, reg_w); // "Arithmetic complement".
+
+            KENBAK_EMU_AT(d, sig_inc) = 2;
+            break;
+        }
+        case kenbak_instr_type_jump:
+        {
+            result = KENBAK_EMU_AT(d, reg_w); // W holds the jump destination.
+            break;
+        }
+
+        default:
+        {
+            assert(false);
+            return false; // Error!
+        }
+    }
+
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), result);
+    return true;
+}
+
+/** Does the shift or rotate instruction in register I with the content of W
+ *  (see SW).
+ *
+ *  - Also see PRM, page 12.
+ */
+static void exec_shift_rot(KENBAK_EMU_CORE_DATA * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+    int const places = dec->shift_places;
+
+    switch((enum kenbak_instr_shift)dec->shift_kind)
+    {
+        case kenbak_instr_shift_right_shift:
+        {
+            KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, reg_w) >> places;
+            break;
+        }
+        case kenbak_instr_shift_right_rot:
+        {
+            KENBAK_EMU_AT(d, reg_w) =
+                get_rotated_right(KENBAK_EMU_AT(d, reg_w), places);
+            break;
+        }
+        case kenbak_instr_shift_left_shift:
+        {
+            KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, reg_w) << places;
+            break;
+        }
+        case kenbak_instr_shift_left_rot:
+        {
+            KENBAK_EMU_AT(d, reg_w) =
+                get_rotated_left(KENBAK_EMU_AT(d, reg_w), places);
+            break;
+        }
+
+        default: // Must not get here.
+        {
+            assert(false);
+            break;
+        }
+    }
+}
+
+/** Returns true, if the given register value meets the given (not
+ *  unconditional) jump condition.
+ */
+static bool is_jmp_cond_met(uint8_t const jmp_cond, uint8_t const reg_val)
+{
+    assert(3 <= jmp_cond); // See possible jump conditions (from 3 to 7).
+
+    switch((enum kenbak_jmp_cond)jmp_cond)
+    {
+        case kenbak_jmp_cond_non_zero:
+        {
+            return reg_val != 0;
+        }
+        case kenbak_jmp_cond_zero:
+        {
+            return reg_val == 0;
+        }
+        case kenbak_jmp_cond_neg:
+        {
+            return (0x80 & reg_val) != 0; // Is 7th bit set?
+        }
+        case kenbak_jmp_cond_pos:
+        {
+            return (0x80 & reg_val) == 0; // Is 7th bit unset?
+        }
+        case kenbak_jmp_cond_pos_non_zero:
+        {
+            return (0x80 & reg_val) == 0 && (0x7F & reg_val) != 0;
+        }
+
+        default:
+        {
+            assert(false); // Must not get here.
+            return false;
+        }
+    }
+}
+
+/** Evaluates the jump condition of the jump instruction in register I, R must
+ *  address the register to check (see SZ).
+ */
+static bool is_jmp_cond_true(KENBAK_EMU_CORE_DATA * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+
+    if(dec->jmp_is_unc) // Unconditional jump, if bit 7 and 6 are both set.
+    {
+        return true;
+    }
+
+    // A, B or X need to be checked.
+
+    return is_jmp_cond_met(dec->jmp_cond, mem_read(d, KENBAK_EMU_AT(d, sig_r)));
+}
+
+// *****************************************************************************
+// *** TIMING OF THE DELAY LINE MEMORY                                       ***
+// *****************************************************************************
+
+/** Returns the count of byte times a state waiting for CM lasts, until the
+ *  byte at the address in R is at the memory's output (during the following
+ *  state's byte time).
+ *
+ * - L is one byte ahead of the memory and CM (R equals L) is checked at T7,
+ *   so this is one byte time at least and a full revolution at most.
+ * - Returns one, if the timing model is disabled.
+ */
+static int wait_for_cm(KENBAK_EMU_CORE_DATA const * const d)
+{
+    if(!KENBAK_EMU_IS_TIMING(d))
+    {
+        return 1;
+    }
+    return (int)(((uint32_t)KENBAK_EMU_AT(d, sig_r)
+                - KENBAK_EMU_AT(d, byte_times) - 1)
+            % KENBAK_DATA_DELAY_LINE_SIZE) + 1;
+}
+
+/** Returns the count of byte times a state lasts that needs the byte it just
+ *  read at the memory's output again (a full revolution of the delay lines).
+ *
+ * - Returns one, if the timing model is disabled.
+ */
+static int wait_for_revolution(KENBAK_EMU_CORE_DATA const * const d)
+{
+    (void)d; // (unused, unless the timing model is selected at run time)
+
+    return KENBAK_EMU_IS_TIMING(d) ? KENBAK_DATA_DELAY_LINE_SIZE : 1;
+}
+
+/** Lets the given count of byte times pass and returns that count.
+ */
+static int pass_byte_times(KENBAK_EMU_CORE_DATA * const d, int const count)
+{
+    KENBAK_EMU_AT(d, byte_times) += (uint32_t)count;
+    return count;
+}
+
+// *****************************************************************************
+// *** THE STATES OF THE KENBAK-1 STATE MACHINE                              ***
+// *****************************************************************************
+//
+// The states' functions rely on what the previous states did without checking
+// it, see kenbak_check_get_violation() for these invariants.
+
+/** Start of the next instruction. Locates the P register in memory.
+ *
+ *  - Byte time count depends on delay line position. 
+ *  - See page 28.
+ */
+static int step_in_sa(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_P;
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sb;
+    return wait_for_cm(d);
+}
+
+/** Increments the program counter (P register). Fills W register with resulting
+ *  address of next instruction. Decides, if QC or SC is next.
+ * 
+ *  - Lasts one byte time.
+ *  - See page 28.
+ */
+static int step_in_sb(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Address of the last executed instruction plus the length of that
+    // instruction, to get the address of the next instruction to be executed:
+    //
+    uint8_t const val =
+        mem_read(d, KENBAK_EMU_AT(d, sig_r)) + KENBAK_EMU_AT(d, sig_inc);
+
+    // Sets to invalid to indicate that it needs to be set:
+    //
+    KENBAK_EMU_AT(d, sig_inc) = 255;
+
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), val);
+
+    KENBAK_EMU_AT(d, reg_w) = val;
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_ed))
+    {
+        // Last instruction was a halt or stop button was pressed.
+
+        KENBAK_EMU_AT(d, state) = kenbak_state_qc;
+
+        // Disabling ED here to prevent overwrite that would happen, if ED was
+        // triggered by a HALT instruction (and not the run stop button), also
+        // see update_input_signals():
+        //
+        KENBAK_EMU_CLEAR_SIG(d, kenbak_sig_ed);
+
+        return 1;
+    }
+
+    // Continue automatic operation.
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sc;
+    return 1;
+}
+
+/** Finds the next instruction in memory.
+ *
+ *  - Byte time count depends on delay line position.
+ *  - See page 29.
+ */
+static int step_in_sc(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sd;
+    return wait_for_cm(d);
+}
+
+/** Transfers next instruction's first byte to register I. Selects next state
+ *  based on the next instruction's length. 
+ * 
+ *  - Lasts one byte time.
+ *  - See page 29.
+ */
+static int step_in_sd(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Transfer first byte of to-be-executed instruction to I register:
+    //
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    if(KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->len == 2)
+    {
+        // Will read second byte of transfer:
+        //
+        KENBAK_EMU_AT(d, state) = kenbak_state_se;
+        return 1;
+    }
+
+    // It is a single byte instruction.
+
+    // All one byte instructions cause a P = P + 1:
+    //
+    KENBAK_EMU_AT(d, sig_inc) = 1;
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_su; // Will seek A or B register.
+    return 1;
+}
+
+/** First byte of instruction is already in register I. This function transfers
+ *  the address of the to-be-used value to the W register; decides, which state
+ *  is next by the address mode of the instruction.
+ * 
+ *  - Lasts one byte time.
+ *  - See page 29.
+ */
+static int step_in_se(KENBAK_EMU_CORE_DATA * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+
+    if(addr_mode == kenbak_addr_mode_constant
+        && instr_type == kenbak_instr_type_store)
+    {
+        // The instruction is store constant/immediate, load ADDRESS of the
+        // second byte of the instruction into W register (this following second
+        // byte will be overwritten in-place by the store immediate operation):
+
+        KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, sig_r) + 1;
+    }
+    else
+    {
+        // The instruction is NOT store constant/immediate.
+        // Transfer second byte of to-be-executed instruction to W register:
+
+        KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r) + 1);
+    }
+
+    if(addr_mode == kenbak_addr_mode_indirect
+        || addr_mode == kenbak_addr_mode_indirect_indexed
+
+        // See kenbak_instr_decoded_table:
+        //
+        || (addr_mode == kenbak_addr_mode_memory
+                && instr_type == kenbak_instr_type_jump))
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_sf; // SE -JI+IND-> SF
+        return 1;
+    }
+
+    if(addr_mode == kenbak_addr_mode_indexed)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_sh; // SE -^IND*DEX-> SH
+        return 1;
+    }
+    
+    if(addr_mode == kenbak_addr_mode_constant
+        || instr_type == kenbak_instr_type_jump // Must be JD, here.
+        || (instr_type == kenbak_instr_type_store // TM
+                && addr_mode == kenbak_addr_mode_memory))
+    {
+        // No operand to be found.
+
+        KENBAK_EMU_AT(d, state) = kenbak_state_sm; // SE -IMMED+JD+TM*MEM-> SM
+        return 1;
+    }
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sk; // SE -BM+^TM*MEM*^J-> SK
+    return 1;
+}
+
+/** Searches for the indirect address which is already in register W (see SE).
+ * 
+ *  - Byte time count depends on delay line position.
+ *  - See page 31.
+ */
+static int step_in_sf(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sg;
+    return wait_for_cm(d);
+}
+
+/** Transfer content of indirect address location to W register; decides, which
+ *  state is next based on the addressing mode (is indexing also required or
+ *  not? If no indexing, is it a jump instruction?).
+ * 
+ *  - Probably always takes on byte time..
+ *  - See page 31.
+ */
+static int step_in_sg(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+
+    switch((enum kenbak_addr_mode)dec->addr_mode)
+    {
+        case kenbak_addr_mode_indirect_indexed: // SG -DEX-> SH
+        {
+            KENBAK_EMU_AT(d, state) = kenbak_state_sh;
+            return 1;
+        }
+        case kenbak_addr_mode_indirect: 
+        {
+            enum kenbak_instr_type const instr_type =
+                (enum kenbak_instr_type)dec->type;
+
+            // Store without indexing. SG -JI+TM*^DEX-> SM
+            //
+            if(instr_type == kenbak_instr_type_store)
+            {
+                KENBAK_EMU_AT(d, state) = kenbak_state_sm;
+                return 1;
+            }
+
+            // SG -^DEX*^J*^TM-> SK
+            //
+            KENBAK_EMU_AT(d, state) = kenbak_state_sk;
+            return 1;
+        }
+
+        case kenbak_addr_mode_memory: // See kenbak_instr_decoded_table.
+        {
+            // Indirect jump. SG -JI+TM*^DEX-> SM
+            //
+            KENBAK_EMU_AT(d, state) = kenbak_state_sm;
+            return 1;
+        }
+
+        case kenbak_addr_mode_none: // Falls through..
+        case kenbak_addr_mode_constant: // Falls through..
+        case kenbak_addr_mode_indexed: // Falls through..
+        default:
+        {
+            assert(false); // Must not get here.
+            return 0;
+        }
+    }
+}
+
+/** Searches for X register. Previous states are SE (for NON-indirect indexing)
+ *  or SG (for indirect indexing).
+ * 
+ *  - Byte time count depends on delay line position.
+ *  - See page 31.
+ */
+static int step_in_sh(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_X;
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sj;
+    return wait_for_cm(d);
+}
+
+/** Adds contents of X register (X was found via signal R in SH) to W.
+ * 
+ *  - Takes one byte time.
+ *  - See page 31.
+ */
+static int step_in_sj(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Adds content of X register to W register:
+    //
+    KENBAK_EMU_AT(d, reg_w) += mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    if(KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->type
+        == kenbak_instr_type_store)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_sm; // SJ -TM-> SM
+        return 1;
+    }
+    KENBAK_EMU_AT(d, state) = kenbak_state_sk; // SJ -^TM-> SK
+    return 1;
+}
+
+/** W holds the operand's address on entry. Searches for that address to be able
+ *  to read the operand from memory later.
+ * 
+ *  - Byte time count depends on delay line position.
+ *  - See page 32.
+ */
+static int step_in_sk(KENBAK_EMU_CORE_DATA * const d)
+{
+    // W contains the address of the operand.
+
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sl;
+    return wait_for_cm(d);
+}
+
+/**
+ * - Takes one byte time for non-bit manipulation instructions.
+ *   Assuming one byte time for SKIP, too.
+ *   For SET, this takes a full revolution of the delay lines (128 byte
+ *   times), see wait_for_revolution().
+ * - See page 32.
+ */
+static int step_in_sl(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Loads operand:
+    //
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    if(KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->type
+        != kenbak_instr_type_bit)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_sm; // SL -^BM-> SM
+        return 1;
+    }
+
+    // "For the Set 0 or Set 1 instructions, the designated bit is set during
+    // SL. For the Skip on 0 and Skip on 1 instructions, the P register
+    // increment control is set as necessary."
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa; // SL -BM-> SA
+
+    exec_bit(d);
+
+    // The modified byte can be written back at the next revolution, only:
+    //
+    return KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->bit_is_skip
+        ? 1 : wait_for_revolution(d);
+}
+
+/**
+ * - See page 32.
+ * - Byte time count depends on delay line position.
+ * - W already contains the operand for instructions that will modify A, B or X.
+ */
+static int step_in_sm(KENBAK_EMU_CORE_DATA * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+
+    KENBAK_EMU_AT(d, sig_r) = dec->reg;
+
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+
+    if(instr_type == kenbak_instr_type_jump)
+    {
+        // JPD, JPI, JMD and JMI.
+
+        // W already contains the target address (which may be the jump or the
+        // "mark" address, see PRM, page 33).
+
+        // Waiting for CM, here (see wait_for_cm()).
+        //
+        KENBAK_EMU_AT(d, state) = kenbak_state_sz;
+        return wait_for_cm(d);
+    }
+
+    if(instr_type == kenbak_instr_type_store)
+    {
+        // STORE
+
+        // W already contains the address where the data is to be stored
+        // (see PRM, page 33).
+
+        // Waiting for CM, here (see wait_for_cm()).
+        //
+        KENBAK_EMU_AT(d, state) = kenbak_state_sp;
+        return wait_for_cm(d);
+    }
+
+    // ADD, SUB, LOAD, AND, OR and LNEG.
+
+    // W already contains the operand (see PRM, page 32).
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sn;
+    return wait_for_cm(d);
+}
+
+/** Instructions changing A, B or X do so during SN. W contains the operand.
+ * 
+ * - Takes one byte time.
+ * - See page 33.
+ */
+static int step_in_sn(KENBAK_EMU_CORE_DATA * const d)
+{
+    if(!exec_change_reg(d))
+    {
+        return 0; // Error!
+    }
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa;
+    return 1;
+}
+
+/**
+ * - See page 33.
+ */
+static int step_in_sp(KENBAK_EMU_CORE_DATA * const d)
+{
+    // W already contains the address where the data is to be stored (see PRM,
+    // page 33).
+
+    // Load the byte to be stored in memory to the I register:
+    //
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    KENBAK_EMU_AT(d, sig_inc) = 2;
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sr;
+    return 1; // Unsure, if this really takes a single byte time.
+}
+
+/**
+ * - See page 34.
+ */
+static int step_in_sq(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Load the return address into the I register:
+    //
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_DATA_ADDR_P) + 2;
+    
+    // W holds the target address, set P to that target address:
+    //
+    mem_write(d, KENBAK_DATA_ADDR_P, KENBAK_EMU_AT(d, reg_w));
+
+    // The mark (return address) gets stored at the target address, execution
+    // continues at the address following it (P is incremented by one in SB):
+    //
+    KENBAK_EMU_AT(d, sig_inc) = 1;
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sr;
+    return 1; // Unsure, if this really takes a single byte time.
+}
+
+/**
+ *  - Byte time count depends on delay line position.
+ *  - See page 34.
+ */
+static int step_in_sr(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_ss;
+    return wait_for_cm(d);
+}
+
+/** Write content of register I to memory.
+ * 
+ *  - Takes one byte time.
+ *  - See page 34.
+ */
+static int step_in_ss(KENBAK_EMU_CORE_DATA * const d)
+{
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_i));
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa;
+    return 1;
+}
+
+/**
+ * - Byte time count depends on delay line position.
+ * - See page 34.
+ */
+static int step_in_st(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_P;
+
+    // Without "marking" => SN
+
+    // With "marking" => SQ
+
+    // Waiting for CM, here (see wait_for_cm()).
+
+    // See PRM, page 9:
+    //
+    if(!KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->jmp_is_mark)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_sn; // Jump (without Mark).
+        return wait_for_cm(d);
+    }
+    KENBAK_EMU_AT(d, state) = kenbak_state_sq; // Jump and Mark.
+    return wait_for_cm(d);
+}
+
+/**
+ * - Byte time count depends on delay line position.
+ * - See page 35.
+ */
+static int step_in_su(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->reg;
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sv;
+    return wait_for_cm(d);
+}
+
+/**
+ * - See page 35.
+ */
+static int step_in_sv(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Transfer content of A or B to W:
+    //
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i));
+
+    if(dec->type == kenbak_instr_type_misc)
+    {
+        // ^IO
+
+        if(dec->is_halt)
+        {
+            KENBAK_EMU_SET_SIG(d, kenbak_sig_ed);
+        }
+
+        KENBAK_EMU_AT(d, state) = kenbak_state_sa; // Done for HALT and NOOP.
+        return 1;
+    }
+
+    // IO
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sw; // Will shift or rotate.
+    return 1;
+}
+
+/** Shifts and rotates are executed here.
+ * 
+ * - Takes one byte time.
+ * - See page 35.
+ * - Also see PRM, page 12.
+ */
+static int step_in_sw(KENBAK_EMU_CORE_DATA * const d)
+{
+    // W already holds the content loaded from A or B.
+
+    exec_shift_rot(d);
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sx;
+    return 1;
+}
+
+/**
+ * - Byte time count depends on delay line position.
+ * - See page 35.
+ */
+static int step_in_sx(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i))->reg;
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_sy;
+    return wait_for_cm(d);
+}
+
+/**
+ * - See page 35.
+ */
+static int step_in_sy(KENBAK_EMU_CORE_DATA * const d)
+{
+    // W holds the shifted or rotated value that also originated in A or B.
+    //
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_w));
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa; // Done for rotate/shift.
+    return 1;
+}
+
+/**
+ * - Takes one byte time.
+ * - See page 34.
+ */
+static int step_in_sz(KENBAK_EMU_CORE_DATA * const d)
+{
+    bool const cond_is_true = is_jmp_cond_true(d);
+
+    if(cond_is_true)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_st; // Jump!
+        KENBAK_EMU_AT(d, sig_inc) = 0;
+        return 1;
+    }
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa; // NO jump.
+    KENBAK_EMU_AT(d, sig_inc) = 2;
+    return 1;
+}
+
+/** Just waits for start button to be released.
+ * 
+ * - See page 37.
+ */
+static int step_in_qb(KENBAK_EMU_CORE_DATA * const d)
+{
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_go))
+    {
+        return 1;
+    }
+
+    // Not that close to the real Kenbak-1, maybe implement d->sig_ht?
+    KENBAK_EMU_CLEAR_SIG(d, kenbak_sig_ed);
+
+    KENBAK_EMU_AT(d, state) = kenbak_state_sa;
+    return 1;
+}
+
+/** The idle state (also entered, if the computer is halted).
+ * 
+ * - See page 36.
+ */
+static int step_in_qc(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Add zero bytes to P for first instruction on next run:
+    //
+    KENBAK_EMU_AT(d, sig_inc) = 0;
+
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_DATA_ADDR_INPUT);
+
+    // - The order is random here, not checked, in which "order" this works on
+    //   the hardware..
+
+    // X5 = EN or DA or DD (see page 25):
+    //
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_en)) // <= Store memory push button.
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_qd;
+        return 1;
+    }
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_da)) // <= Display address push button.
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_qd;
+        return 1;
+    }
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_dd)) // <= Read memory push button.
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_qd;
+        return 1;
+    }
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_go)) // <= Start push button.
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_qb;
+        return 1;
+    }
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_ea)) // <= Set address push button.
+    {
+        KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, reg_i);
+    }
+    return 1;
+}
+
+/**
+ * - See page 36.
+ */
+static int step_in_qd(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+
+    // Waiting for CM, here (see wait_for_cm()).
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_qe;
+    return wait_for_cm(d);
+}
+
+/**
+ * - See page 36.
+ */
+static int step_in_qe(KENBAK_EMU_CORE_DATA * const d)
+{
+    // State QF follows after one byte time:
+    //
+    KENBAK_EMU_AT(d, state) = kenbak_state_qf;
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_en)) // Enter data:
+    {
+        // Transfers I to memory:
+        //
+        mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_i));
+        ++KENBAK_EMU_AT(d, reg_w); // Adds 1 to W.
+        return 1;
+    }
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_da)) // Display address:
+    {
+        // Transfers W to K (content of R equals W, here):
+        //
+        KENBAK_EMU_AT(d, reg_k) = KENBAK_EMU_AT(d, sig_r);
+        return 1;
+    }
+
+    // Display data:
+
+    // Transfers memory to K:
+    //
+    KENBAK_EMU_AT(d, reg_k) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    ++KENBAK_EMU_AT(d, reg_w); // Adds 1 to W.
+    return 1;
+}
+
+/**
+ * - See page 37.
+ */
+static int step_in_qf(KENBAK_EMU_CORE_DATA * const d)
+{
+    // The state register control waits at QF until the control buttons are
+    // released (waiting for ^X5).
+    //
+    if((KENBAK_EMU_AT(d, sigs) & KENBAK_SIG_MASK_MANUAL) == 0)
+    {
+        KENBAK_EMU_AT(d, state) = kenbak_state_qc;
+    }
+    return 1;
+}
+
+// *****************************************************************************
+// *** PROCESSING OF A SINGLE "STEP"                                         ***
+// *****************************************************************************
+
+/**
+ * - See page 06 of the logic schematics.
+ */
+static void update_x_signal(KENBAK_EMU_CORE_DATA * const d)
+{
+    if (KENBAK_EMU_IS_SIG(d, kenbak_sig_da)) // Address display button.
+    {
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_dd));
+        //assert(d->state != kenbak_state_sa);
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_bu));
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_cl));
+
+        KENBAK_EMU_AT(d, sig_x) = kenbak_x_1;
+        return;
+    }
+    if (KENBAK_EMU_IS_SIG(d, kenbak_sig_dd)) // Memory read button is pressed.
+    {
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_da));
+        //assert(d->state != kenbak_state_sa);
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_bu));
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_cl));
+
+        KENBAK_EMU_AT(d, sig_x) = kenbak_x_2;
+        return;
+    }
+    if (KENBAK_EMU_AT(d, state) == kenbak_state_sa)
+    {
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_da));
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_dd));
+        //assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_bu));
+        //assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_cl));
+
+        KENBAK_EMU_AT(d, sig_x) = kenbak_x_3;
+        return;
+    }
+    if (KENBAK_EMU_IS_SIG(d, kenbak_sig_bu)
+        || KENBAK_EMU_IS_SIG(d, kenbak_sig_cl))
+    {
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_da));
+        assert(!KENBAK_EMU_IS_SIG(d, kenbak_sig_dd));
+        assert(KENBAK_EMU_AT(d, state) != kenbak_state_sa);
+
+        KENBAK_EMU_AT(d, sig_x) = kenbak_x_4;
+        return;
+    }
+
+    // Keep current X state, when getting here.
+}
+
+/** Update the content at address (octal) 377 by the current data buttons'
+ *  states and the current state of the clear signal (as it is not possible to
+ *  toggle the bits from 1 to 0 via data buttons, you need to clear ALL ones via
+ *  the clear signal for that).
+ */
+static void update_input_byte(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Get state of the 8 data buttons into (octal) address 377 (this is the
+    // serial signal BU) [page 22]:
+
+    uint8_t val = 0;
+
+    // (chose precedence of clear signal over data buttons, maybe wrong..)
+    //
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_cl))
+    {
+        mem_write(d, KENBAK_DATA_ADDR_INPUT, 0);
+        return;
+    }
+ 
+    // The if clause is technically not necessary, here:
+    //
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_bu))
+    {
+        // The bits of the currently pushed down data buttons trigger enabling
+        // of the bit values:
+        //
+        val = mem_read(d, KENBAK_DATA_ADDR_INPUT);
+        val |= (uint8_t)(KENBAK_EMU_AT(d, input) & KENBAK_INPUT_MASK_DATA);
+        mem_write(d, KENBAK_DATA_ADDR_INPUT, val);
+    }
+}
+
+static uint8_t get_sig_mask_if(bool const is_on, enum kenbak_sig const sig)
+{
+    return is_on ? KENBAK_SIG_MASK(sig) : 0;
+}
+
+static void update_input_signals(KENBAK_EMU_CORE_DATA * const d)
+{
+    // Never disabling ED here to prevent overwrite, if cause is HALT
+    // instruction and not the run stop button, also see step_in_sb():
+    //
+    uint8_t sigs = KENBAK_EMU_AT(d, sigs) & KENBAK_SIG_MASK(kenbak_sig_ed);
+
+    // Update signals generated by pushed control buttons:
+    //
+    sigs |= get_sig_mask_if(
+        (KENBAK_EMU_AT(d, input) & KENBAK_INPUT_MASK_DATA) != 0, kenbak_sig_bu);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_input_clear), kenbak_sig_cl);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_address_display), kenbak_sig_da);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_memory_read), kenbak_sig_dd);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_address_set), kenbak_sig_ea);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_run_stop), kenbak_sig_ed);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_memory_store), kenbak_sig_en);
+    sigs |= get_sig_mask_if(
+        is_input_on(d, kenbak_input_bit_run_start), kenbak_sig_go);
+
+    KENBAK_EMU_AT(d, sigs) = sigs;
+}
+
+/** Returns the current content of register K.
+ *
+ * - Register K follows the output or input byte, while X3 or X4 is active.
+ *   Otherwise, it holds what the QE state handler (or the last X3/X4 phase,
+ *   see latch_reg_k()) put into register K.
+ * - See logic schematics, page 07.
+ */
+static uint8_t get_reg_k(KENBAK_EMU_CORE_DATA * const d)
+{
+    switch(KENBAK_EMU_AT(d, sig_x))
+    {
+        case kenbak_x_none: // (falls through)
+        case kenbak_x_1: // (falls through)
+        case kenbak_x_2:
+        {
+            return KENBAK_EMU_AT(d, reg_k); // Set via QE handler, if at all.
+        }
+        // Not read via mem_read(), as the lamps do not influence what the
+        // Kenbak-1 does (see the memoization of calls):
+
+        case kenbak_x_3:
+        {
+            return KENBAK_EMU_MEM(d)[KENBAK_DATA_ADDR_OUTPUT];
+        }
+        case kenbak_x_4:
+        {
+            return KENBAK_EMU_MEM(d)[KENBAK_DATA_ADDR_INPUT];
+        }
+
+        default:
+        {
+            assert(false);
+            return KENBAK_EMU_AT(d, reg_k);
+        }
+    }
+}
+
+/** To be called before the X signal (or the input byte) may change, to keep
+ *  the value register K shows until then.
+ */
+static void latch_reg_k(KENBAK_EMU_CORE_DATA * const d)
+{
+    KENBAK_EMU_AT(d, reg_k) = get_reg_k(d);
+}
+
+static void update_input_signals_byte_and_x(KENBAK_EMU_CORE_DATA * const d)
+{
+    latch_reg_k(d);
+
+    if(KENBAK_EMU_AT(d, input_changed)
+        || (KENBAK_EMU_AT(d, input) & KENBAK_INPUT_MASK_BUTTONS) != 0)
+    {
+        // A push button is pressed or got released since the last sample.
+
+        update_input_signals(d);
+        update_input_byte(d);
+        KENBAK_EMU_AT(d, input_changed) = false;
+    }
+    //
+    // Otherwise, all signals of the push buttons are still off (ED may be on,
+    // but is not touched by the buttons, then) and the input byte is not
+    // affected.
+
+    update_x_signal(d);
+}
+
+/** Dispatches via a switch statement on the (sparse) state value.
+ */
+static int dispatch_switch(KENBAK_EMU_CORE_DATA * const d)
+{
+    int c = 0;
+
+    switch(KENBAK_EMU_AT(d, state))
+    {
+        case kenbak_state_sa: // SL, SN, SS, SV, SY or SZ -> SA
+        {
+            update_input_signals_byte_and_x(d);
+
+            c = step_in_sa(d);
+            break;
+        }
+        case kenbak_state_sb: // SA -CM-> SB
+        {
+            c = step_in_sb(d);
+            break;
+        }
+        case kenbak_state_sc: // SB -^ED-> SC
+        {
+            c = step_in_sc(d);
+            break;
+        }
+        case kenbak_state_sd: // SC -CM-> SD
+        {
+            c = step_in_sd(d); // I <- Next instr. first byte.
+            break;
+        }
+        case kenbak_state_se: // SD -I3+I2-> SE (I2+I1 in emulator..)
+        {
+            c = step_in_se(d); // Gets here for TWO byte instructions.
+            break;
+        }
+        case kenbak_state_sf: // SE -JI+IND-> SF
+        {
+            c = step_in_sf(d);
+            break;
+        }
+        case kenbak_state_sg: // SF -CM-> SG
+        {
+            c = step_in_sg(d);
+            break;
+        }
+        case kenbak_state_sh: // ... -> SH
+        {
+            c = step_in_sh(d);
+            break;
+        }
+        case kenbak_state_sj: // SH -CM-> SJ
+        {
+            c = step_in_sj(d);
+            break;
+        }
+        case kenbak_state_sk: // ... -> SK
+        {
+            c = step_in_sk(d);
+            break;
+        }
+        case kenbak_state_sl: // SK -CM-> SL
+        {
+            c = step_in_sl(d);
+            break;
+        }
+        case kenbak_state_sm: // ... -> ...
+        {
+            c = step_in_sm(d);
+            break;
+        }
+        case kenbak_state_sn: // SM -^TM*^J*CM-> SN or ST-JP CM-> SN
+        {
+            c = step_in_sn(d);
+            break;
+        }
+        case kenbak_state_sp: // SM -TM*CM-> SP
+        {
+            c = step_in_sp(d);
+            break;
+        }
+        case kenbak_state_sq: // ST -JM*CM-> SR
+        {
+            c = step_in_sq(d);
+            break;
+        }
+        case kenbak_state_sr: // SP, SQ -> SR
+        {
+            c = step_in_sr(d);
+            break;
+        }
+        case kenbak_state_ss: // SR -CM-> SS
+        {
+            c = step_in_ss(d);
+            break;
+        }
+        case kenbak_state_st: // SZ -JC-> ST
+        {
+            c = step_in_st(d);
+            break;
+        }
+        case kenbak_state_su: // SD -^I3*^I2-> SU (^I2*^I1 in emulator..)
+        {
+            c = step_in_su(d); // Gets here for ONE byte instructions.
+            break;
+        }
+        case kenbak_state_sv: // SU -CM-> SV
+        {
+            c = step_in_sv(d);
+            break;
+        }
+        case kenbak_state_sw: // SV -IO-> SW
+        {
+            c = step_in_sw(d);
+            break;
+        }
+        case kenbak_state_sx: // SW -1-> SX
+        {
+            c = step_in_sx(d);
+            break;
+        }
+        case kenbak_state_sy: // SX -CM-> SY
+        {
+            c = step_in_sy(d);
+            break;
+        }
+        case kenbak_state_sz: // SM -> SZ
+        {
+            c = step_in_sz(d);
+            break;
+        }
+
+        case kenbak_state_qb: // QC -GO-> QB
+        {
+            update_input_signals_byte_and_x(d);
+
+            c = step_in_qb(d);
+            break;
+        }
+        case kenbak_state_qc: // SB -ED-> QC or QF -^X5-> QC
+        {
+            update_input_signals_byte_and_x(d);
+
+            c = step_in_qc(d);
+            break;
+        }
+        case kenbak_state_qd: // QC -X5-> QD
+        {
+            c = step_in_qd(d);
+            break;
+        }
+        case kenbak_state_qe: // QD -CM-> QE
+        {
+            c = step_in_qe(d);
+            break;
+        }
+        case kenbak_state_qf: // QE -1-> QF
+        {
+            update_input_signals_byte_and_x(d);
+
+            c = step_in_qf(d);
+            break;
+        }
+
+        case kenbak_state_power_off: // (falls through)
+        case kenbak_state_unknown: // (falls through)
+        default:
+        {
+            assert(false);
+            return -1; // Error!
+        }
+    }
+
+    return c;
+}
+
+static int step_in_undefined(KENBAK_EMU_CORE_DATA * const d)
+{
+    (void)d;
+    assert(false); // Must not get here.
+    return -1; // Error!
+}
+
+// The state handlers, indexed by enum kenbak_state_index:
+//
+static int (* const s_step_in[kenbak_state_index_count])(
+    KENBAK_EMU_CORE_DATA * const d) = {
+        step_in_undefined, // Power-off.
+        step_in_undefined, // Unknown.
+
+        step_in_qb, step_in_qc, step_in_qd, step_in_qe, step_in_qf,
+
+        step_in_sa, step_in_sb, step_in_sc, step_in_sd, step_in_se,
+        step_in_sf, step_in_sg, step_in_sh, step_in_sj, step_in_sk,
+        step_in_sl, step_in_sm, step_in_sn, step_in_sp, step_in_sq,
+        step_in_sr, step_in_ss, step_in_st, step_in_su, step_in_sv,
+        step_in_sw, step_in_sx, step_in_sy, step_in_sz
+    };
+
+// Are the input signals to be updated before the state handler gets called?
+// Indexed by enum kenbak_state_index.
+//
+static bool const s_updates_input[kenbak_state_index_count] = {
+    false, false, // Power-off and unknown.
+
+    true, true, false, false, true, // QB, QC, QD, QE and QF.
+
+    true, // SA
+    false, false, false, false, false, false, false, false, false, false,
+    false, false, false, false, false, false, false, false, false, false,
+    false, false, false // SB to SZ.
+};
+
+/** Dispatches via the table of state handlers.
+ */
+static int dispatch_table(KENBAK_EMU_CORE_DATA * const d)
+{
+    enum kenbak_state_index const i =
+        KENBAK_STATE_GET_INDEX(KENBAK_EMU_AT(d, state));
+
+    assert(i != kenbak_state_index_count);
+
+    if(s_updates_input[i])
+    {
+        update_input_signals_byte_and_x(d);
+    }
+    return s_step_in[i](d);
+}
+
+#if KENBAK_EMU_FEATURE_CHECK != KENBAK_EMU_FEATURE_OFF
+
+/** Validates the state machine's invariants before a step, if the feature is
+ *  enabled (see KENBAK_EMU_FEATURE_CHECK), keeping the first violation found.
+ */
+static void check_before_step(KENBAK_EMU_CORE_DATA * const d)
+{
+#if KENBAK_EMU_FEATURE_CHECK == KENBAK_EMU_FEATURE_RUNTIME
+    if(KENBAK_EMU_AT(d, check_countdown) == 0
+        || --KENBAK_EMU_AT(d, check_countdown) != 0)
+    {
+        return; // Not to be validated before this step.
+    }
+    KENBAK_EMU_AT(d, check_countdown) = KENBAK_EMU_AT(d, cold)->check_interval;
+#endif //KENBAK_EMU_FEATURE_CHECK == KENBAK_EMU_FEATURE_RUNTIME
+
+    if(KENBAK_EMU_AT(d, cold)->check_violation == NULL)
+    {
+        KENBAK_EMU_AT(d, cold)->check_violation = kenbak_check_get_violation(d);
+#if KENBAK_EMU_FEATURE_CHECK == KENBAK_EMU_FEATURE_ON
+        assert(KENBAK_EMU_AT(d, cold)->check_violation == NULL);
+#endif //KENBAK_EMU_FEATURE_CHECK == KENBAK_EMU_FEATURE_ON
+    }
+}
+
+#endif //KENBAK_EMU_FEATURE_CHECK != KENBAK_EMU_FEATURE_OFF
+
+/** Does what is to be done before each step (tracing, counting and validating,
+ *  as far as the features are enabled).
+ */
+static void before_step(KENBAK_EMU_CORE_DATA * const d)
+{
+#if KENBAK_EMU_FEATURE_TRACE != KENBAK_EMU_FEATURE_OFF
+    if(KENBAK_EMU_AT(d, cold)->trace != NULL)
+    {
+        KENBAK_EMU_AT(d, cold)->trace(KENBAK_EMU_AT(d, cold)->trace_ctx, d);
+    }
+#endif //KENBAK_EMU_FEATURE_TRACE != KENBAK_EMU_FEATURE_OFF
+#if KENBAK_EMU_FEATURE_COUNT != KENBAK_EMU_FEATURE_OFF
+    ++KENBAK_EMU_AT(d, cold)->state_steps[
+        KENBAK_STATE_GET_INDEX(KENBAK_EMU_AT(d, state))];
+#endif //KENBAK_EMU_FEATURE_COUNT != KENBAK_EMU_FEATURE_OFF
+#if KENBAK_EMU_FEATURE_CHECK != KENBAK_EMU_FEATURE_OFF
+    check_before_step(d);
+#endif //KENBAK_EMU_FEATURE_CHECK != KENBAK_EMU_FEATURE_OFF
+    (void)d;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define KENBAK_EMU_HAS_GOTO_DISPATCH
+
+/** Takes up to the given count of steps (at least one) via a table of labels
+ *  ("computed goto"), jumping from the end of each state's body directly to
+ *  the body of the next state (threaded), instead of returning to a loop.
+ *
+ * - Adds the byte time count of the steps taken to the given sum.
+ * - Returns false on error (stopping at the step that failed).
+ */
+static bool dispatch_goto(
+    KENBAK_EMU_CORE_DATA * const d,
+    uint64_t const count,
+    uint64_t * const byte_times)
+{
+    // Indexed by enum kenbak_state_index:
+    //
+    static void * const labels[kenbak_state_index_count] = {
+        &&undefined, &&undefined,
+
+        &&qb, &&qc, &&qd, &&qe, &&qf,
+
+        &&sa, &&sb, &&sc, &&sd, &&se, &&sf, &&sg, &&sh, &&sj, &&sk, &&sl,
+        &&sm, &&sn, &&sp, &&sq, &&sr, &&ss, &&st, &&su, &&sv, &&sw, &&sx,
+        &&sy, &&sz
+    };
+
+    uint64_t left = count;
+    int c = 0;
+
+    assert(0 < count);
+
+// Ends the body of a state: Passes the byte times of the step taken and jumps
+// to the body of the next state, if there are steps left:
+//
+#define KENBAK_EMU_GOTO_NEXT \
+    if(c < 0) \
+    { \
+        return false; \
+    } \
+    if(0 < c) \
+    { \
+        pass_byte_times(d, c); \
+    } \
+    *byte_times += (uint64_t)c; \
+    if(--left == 0) \
+    { \
+        return true; \
+    } \
+    before_step(d); \
+    goto *labels[KENBAK_STATE_GET_INDEX(KENBAK_EMU_AT(d, state))]
+
+    assert(KENBAK_STATE_GET_INDEX(KENBAK_EMU_AT(d, state))
+        != kenbak_state_index_count);
+
+    before_step(d);
+    goto *labels[KENBAK_STATE_GET_INDEX(KENBAK_EMU_AT(d, state))];
+
+    sa: update_input_signals_byte_and_x(d); c = step_in_sa(d);
+        KENBAK_EMU_GOTO_NEXT;
+    sb: c = step_in_sb(d); KENBAK_EMU_GOTO_NEXT;
+    sc: c = step_in_sc(d); KENBAK_EMU_GOTO_NEXT;
+    sd: c = step_in_sd(d); KENBAK_EMU_GOTO_NEXT;
+    se: c = step_in_se(d); KENBAK_EMU_GOTO_NEXT;
+    sf: c = step_in_sf(d); KENBAK_EMU_GOTO_NEXT;
+    sg: c = step_in_sg(d); KENBAK_EMU_GOTO_NEXT;
+    sh: c = step_in_sh(d); KENBAK_EMU_GOTO_NEXT;
+    sj: c = step_in_sj(d); KENBAK_EMU_GOTO_NEXT;
+    sk: c = step_in_sk(d); KENBAK_EMU_GOTO_NEXT;
+    sl: c = step_in_sl(d); KENBAK_EMU_GOTO_NEXT;
+    sm: c = step_in_sm(d); KENBAK_EMU_GOTO_NEXT;
+    sn: c = step_in_sn(d); KENBAK_EMU_GOTO_NEXT;
+    sp: c = step_in_sp(d); KENBAK_EMU_GOTO_NEXT;
+    sq: c = step_in_sq(d); KENBAK_EMU_GOTO_NEXT;
+    sr: c = step_in_sr(d); KENBAK_EMU_GOTO_NEXT;
+    ss: c = step_in_ss(d); KENBAK_EMU_GOTO_NEXT;
+    st: c = step_in_st(d); KENBAK_EMU_GOTO_NEXT;
+    su: c = step_in_su(d); KENBAK_EMU_GOTO_NEXT;
+    sv: c = step_in_sv(d); KENBAK_EMU_GOTO_NEXT;
+    sw: c = step_in_sw(d); KENBAK_EMU_GOTO_NEXT;
+    sx: c = step_in_sx(d); KENBAK_EMU_GOTO_NEXT;
+    sy: c = step_in_sy(d); KENBAK_EMU_GOTO_NEXT;
+    sz: c = step_in_sz(d); KENBAK_EMU_GOTO_NEXT;
+
+    qb: update_input_signals_byte_and_x(d); c = step_in_qb(d);
+        KENBAK_EMU_GOTO_NEXT;
+    qc: update_input_signals_byte_and_x(d); c = step_in_qc(d);
+        KENBAK_EMU_GOTO_NEXT;
+    qd: c = step_in_qd(d); KENBAK_EMU_GOTO_NEXT;
+    qe: c = step_in_qe(d); KENBAK_EMU_GOTO_NEXT;
+    qf: update_input_signals_byte_and_x(d); c = step_in_qf(d);
+        KENBAK_EMU_GOTO_NEXT;
+
+    undefined: c = step_in_undefined(d); KENBAK_EMU_GOTO_NEXT;
+
+#undef KENBAK_EMU_GOTO_NEXT
+}
+
+#endif //defined(__GNUC__) || defined(__clang__)
+
+/**
+ * - To be called, if Kenbak-1 is in a defined state and a step shall be taken.
+ */
+static int step_in_defined_state(
+    KENBAK_EMU_CORE_DATA * const d, enum kenbak_dispatch const dispatch)
+{
+    assert(KENBAK_EMU_AT(d, state) != kenbak_state_power_off);
+    assert(KENBAK_EMU_AT(d, state) != kenbak_state_unknown);
+
+    int c = 0;
+
+#ifdef KENBAK_EMU_HAS_GOTO_DISPATCH
+    if(dispatch == kenbak_dispatch_goto)
+    {
+        uint64_t byte_times = 0;
+
+        return dispatch_goto(d, 1, &byte_times) ? (int)byte_times : -1;
+    }
+#endif //KENBAK_EMU_HAS_GOTO_DISPATCH
+
+    before_step(d);
+
+    switch(dispatch)
+    {
+        case kenbak_dispatch_switch:
+        {
+            c = dispatch_switch(d);
+            break;
+        }
+
+        case kenbak_dispatch_goto: // (falls through, if not available)
+        case kenbak_dispatch_table: // (falls through)
+        default:
+        {
+            c = dispatch_table(d);
+            break;
+        }
+    }
+    if(0 < c)
+    {
+        pass_byte_times(d, c);
+    }
+    return c;
+}
+
+/**
+ * - To be called, if Kenbak-1 is in a defined state and the given count of
+ *   steps shall be taken (stopping on error).
+ * - Returns the summed-up byte time count.
+ */
+static uint64_t steps_in_defined_state(
+    KENBAK_EMU_CORE_DATA * const d,
+    uint64_t const count,
+    enum kenbak_dispatch const dispatch)
+{
+    uint64_t byte_times = 0;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+#ifdef KENBAK_EMU_HAS_GOTO_DISPATCH
+    if(dispatch == kenbak_dispatch_goto)
+    {
+        dispatch_goto(d, count, &byte_times); // (stops on error)
+        return byte_times;
+    }
+#endif //KENBAK_EMU_HAS_GOTO_DISPATCH
+
+    for(uint64_t i = 0; i < count; ++i)
+    {
+        int const c = step_in_defined_state(d, dispatch);
+
+        if(c < 0)
+        {
+            break; // Error!
+        }
+        byte_times += (uint64_t)c;
+    }
+    return byte_times;
+}
+
+#ifdef KENBAK_EMU_CORE_INSTRS
+
+// *****************************************************************************
+// *** PROCESSING OF A WHOLE INSTRUCTION                                     ***
+// *****************************************************************************
+
+/** Lets the byte times of a state passed by exec_instr() pass, counts that
+ *  state and returns the given byte time count.
+ */
+static int pass_state(
+    KENBAK_EMU_CORE_DATA * const d, int const byte_times, int * const steps)
+{
+    ++*steps;
+    return pass_byte_times(d, byte_times);
+}
+
+/** SA & SB of exec_instr(): Samples the input and lets P point to the next
+ *  instruction, whose address is in W afterwards.
+ *
+ * - Must be called in state SA, only.
+ * - The state is still SA on return, or QC, if ED was set.
+ */
+static int exec_instr_sa_sb(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    assert(KENBAK_EMU_AT(d, state) == kenbak_state_sa);
+
+    int c = 0;
+
+    update_input_signals_byte_and_x(d);
+
+    // SA & SB:
+    //
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_P;
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_w) =
+        mem_read(d, KENBAK_DATA_ADDR_P) + KENBAK_EMU_AT(d, sig_inc);
+    KENBAK_EMU_AT(d, sig_inc) = 255;
+    mem_write(d, KENBAK_DATA_ADDR_P, KENBAK_EMU_AT(d, reg_w));
+    c += pass_state(d, 1, steps);
+
+    if(KENBAK_EMU_IS_SIG(d, kenbak_sig_ed))
+    {
+        KENBAK_EMU_CLEAR_SIG(d, kenbak_sig_ed); // See step_in_sb().
+        KENBAK_EMU_AT(d, state) = kenbak_state_qc;
+    }
+    return c;
+}
+
+/** SC & SD of exec_instr(): Gets the given first byte of the instruction at
+ *  the address in W into I.
+ */
+static int exec_instr_sc_sd(
+    KENBAK_EMU_CORE_DATA * const d, uint8_t const first_byte, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_i) = first_byte;
+    return c + pass_state(d, 1, steps);
+}
+
+// The parts of exec_instr() following SC & SD (named after the states they
+// go through), also composed to the specialized instruction handlers of the
+// threaded code (see select_code_handler()):
+
+/** SU & SV: Gets the content of the register to search for into W (one-byte
+ *  instructions).
+ */
+static int exec_su_sv(
+    KENBAK_EMU_CORE_DATA * const d, uint8_t const reg, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, sig_inc) = 1;
+    KENBAK_EMU_AT(d, sig_r) = reg;
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SW, SX & SY: Shifts or rotates W and writes it back to the register.
+ */
+static int exec_sw_sy(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = 0;
+
+    exec_shift_rot(d);
+    c += pass_state(d, 1, steps);
+    c += pass_state(d, wait_for_cm(d), steps);
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_w));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SE: Gets the given second byte into W.
+ */
+static int exec_se(
+    KENBAK_EMU_CORE_DATA * const d,
+    uint8_t const second_byte,
+    int * const steps)
+{
+    KENBAK_EMU_AT(d, reg_w) = second_byte;
+    return pass_state(d, 1, steps);
+}
+
+/** SE for store immediate: Gets the address of the second byte into W (see
+ *  step_in_se()).
+ */
+static int exec_se_store_immediate(
+    KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    KENBAK_EMU_AT(d, reg_w) = KENBAK_EMU_AT(d, sig_r) + 1;
+    return pass_state(d, 1, steps);
+}
+
+/** SF & SG: Gets the byte at the address in W into W (indirection).
+ */
+static int exec_sf_sg(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SH & SJ: Adds X to W (indexing).
+ */
+static int exec_sh_sj(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_X;
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_w) += mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SK: Gets the operand at the address in W into W (SL must follow).
+ */
+static int exec_sk(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+    c += pass_state(d, wait_for_cm(d), steps);
+    KENBAK_EMU_AT(d, reg_w) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    return c;
+}
+
+/** SL for bit instructions: Executes the bit test or manipulation.
+ */
+static int exec_sl_bit(
+    KENBAK_EMU_CORE_DATA * const d,
+    struct kenbak_instr_decoded const * const dec,
+    int * const steps)
+{
+    exec_bit(d);
+    return pass_state(
+        d, dec->bit_is_skip ? 1 : wait_for_revolution(d), steps);
+}
+
+/** SM: Searches for the register given.
+ */
+static int exec_sm(
+    KENBAK_EMU_CORE_DATA * const d, uint8_t const reg, int * const steps)
+{
+    KENBAK_EMU_AT(d, sig_r) = reg;
+    return pass_state(d, wait_for_cm(d), steps);
+}
+
+/** SZ to the end of a jump: Jumps to the address in W, if the condition is
+ *  true (and marks, if it is a jump and mark).
+ */
+static int exec_sz_jump(
+    KENBAK_EMU_CORE_DATA * const d,
+    struct kenbak_instr_decoded const * const dec,
+    int * const steps)
+{
+    int c = 0;
+
+    // SZ:
+    //
+    c += pass_state(d, 1, steps);
+    if(!is_jmp_cond_true(d))
+    {
+        KENBAK_EMU_AT(d, sig_inc) = 2;
+        return c;
+    }
+    KENBAK_EMU_AT(d, sig_inc) = 0;
+
+    // ST:
+    //
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_DATA_ADDR_P;
+    c += pass_state(d, wait_for_cm(d), steps);
+
+    if(!dec->jmp_is_mark)
+    {
+        // SN, jump (without mark):
+        //
+        mem_write(d, KENBAK_DATA_ADDR_P, KENBAK_EMU_AT(d, reg_w));
+        return c + pass_state(d, 1, steps);
+    }
+
+    // SQ, SR & SS, jump and mark:
+    //
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_DATA_ADDR_P) + 2;
+    mem_write(d, KENBAK_DATA_ADDR_P, KENBAK_EMU_AT(d, reg_w));
+    KENBAK_EMU_AT(d, sig_inc) = 1; // Continue after the mark.
+    c += pass_state(d, 1, steps);
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+    c += pass_state(d, wait_for_cm(d), steps);
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_i));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SP, SR & SS: Stores the register found by SM at the address in W.
+ */
+static int exec_sp_ss_store(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = 0;
+
+    KENBAK_EMU_AT(d, reg_i) = mem_read(d, KENBAK_EMU_AT(d, sig_r));
+    KENBAK_EMU_AT(d, sig_inc) = 2;
+    c += pass_state(d, 1, steps);
+    KENBAK_EMU_AT(d, sig_r) = KENBAK_EMU_AT(d, reg_w);
+    c += pass_state(d, wait_for_cm(d), steps);
+    mem_write(d, KENBAK_EMU_AT(d, sig_r), KENBAK_EMU_AT(d, reg_i));
+    return c + pass_state(d, 1, steps);
+}
+
+/** SN: Changes the register found by SM (ADD, SUB, LOAD, AND, OR and LNEG).
+ *
+ * - Returns -1 on error.
+ */
+static int exec_sn_change_reg(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    if(!exec_change_reg(d))
+    {
+        return -1;
+    }
+    return pass_state(d, 1, steps);
+}
+
+/** SE (or SU) to the end of exec_instr(): Executes the instruction in I, whose
+ *  first byte got decoded to the given decoded instruction and whose second
+ *  byte (if any) is the one given.
+ *
+ * - Returns -1 on error.
+ */
+static int exec_instr_se(
+    KENBAK_EMU_CORE_DATA * const d,
+    struct kenbak_instr_decoded const * const dec,
+    uint8_t const second_byte,
+    int * const steps)
+{
+    int c = 0;
+
+    if(dec->len == 1)
+    {
+        c += exec_su_sv(d, dec->reg, steps);
+
+        if(dec->type == kenbak_instr_type_misc)
+        {
+            if(dec->is_halt)
+            {
+                KENBAK_EMU_SET_SIG(d, kenbak_sig_ed);
+            }
+            return c; // Done for HALT and NOOP.
+        }
+        return c + exec_sw_sy(d, steps);
+    }
+
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+    bool seek_operand = false;
+
+    if(addr_mode == kenbak_addr_mode_constant
+        && instr_type == kenbak_instr_type_store)
+    {
+        c += exec_se_store_immediate(d, steps);
+    }
+    else
+    {
+        c += exec_se(d, second_byte, steps);
+    }
+
+    switch(addr_mode)
+    {
+        case kenbak_addr_mode_indirect: // (falls through)
+        case kenbak_addr_mode_indirect_indexed:
+        {
+            c += exec_sf_sg(d, steps);
+
+            if(addr_mode == kenbak_addr_mode_indirect)
+            {
+                seek_operand = instr_type != kenbak_instr_type_store;
+                break;
+            }
+
+            c += exec_sh_sj(d, steps);
+            seek_operand = instr_type != kenbak_instr_type_store;
+            break;
+        }
+        case kenbak_addr_mode_indexed:
+        {
+            c += exec_sh_sj(d, steps);
+            seek_operand = instr_type != kenbak_instr_type_store;
+            break;
+        }
+        case kenbak_addr_mode_memory:
+        {
+            if(instr_type == kenbak_instr_type_jump)
+            {
+                // Indirect jump (see kenbak_instr_decoded_table):
+                //
+                c += exec_sf_sg(d, steps);
+                break;
+            }
+            seek_operand = instr_type != kenbak_instr_type_store;
+            break;
+        }
+        case kenbak_addr_mode_constant:
+        {
+            break; // No operand to be found (also for direct jumps).
+        }
+
+        case kenbak_addr_mode_none: // (falls through)
+        default:
+        {
+            assert(false); // Must not get here.
+            return -1;
+        }
+    }
+
+    if(seek_operand)
+    {
+        c += exec_sk(d, steps);
+
+        if(instr_type == kenbak_instr_type_bit)
+        {
+            return c + exec_sl_bit(d, dec, steps);
+        }
+        c += pass_state(d, 1, steps); // SL.
+    }
+
+    c += exec_sm(d, dec->reg, steps);
+
+    switch(instr_type)
+    {
+        case kenbak_instr_type_jump:
+        {
+            return c + exec_sz_jump(d, dec, steps);
+        }
+        case kenbak_instr_type_store:
+        {
+            return c + exec_sp_ss_store(d, steps);
+        }
+
+        default: // ADD, SUB, LOAD, AND, OR and LNEG.
+        {
+            int const sn = exec_sn_change_reg(d, steps);
+
+            return sn < 0 ? -1 : c + sn;
+        }
+    }
+}
+
+/** Executes the whole instruction that follows in one pass, going through the
+ *  same work as the states SA to SZ do (see the step_in_*() functions), but
+ *  without setting the intermediate states.
+ *
+ * - Must be called in state SA, only.
+ * - The state is SA again on return, or QC, if ED was set.
+ * - Adds the count of states passed to the given step count.
+ * - Returns the summed-up byte time count of all states passed, or -1 on error.
+ */
+static int exec_instr(KENBAK_EMU_CORE_DATA * const d, int * const steps)
+{
+    int c = exec_instr_sa_sb(d, steps);
+
+    if(KENBAK_EMU_AT(d, state) == kenbak_state_qc)
+    {
+        return c;
+    }
+
+    c += exec_instr_sc_sd(d, mem_read(d, KENBAK_EMU_AT(d, reg_w)), steps);
+
+    // (the second byte is read in SE, nothing gets written before)
+    //
+    int const rest = exec_instr_se(
+        d,
+        KENBAK_INSTR_DECODE(KENBAK_EMU_AT(d, reg_i)),
+        mem_read(d, KENBAK_EMU_AT(d, sig_r) + 1),
+        steps);
+
+    return rest < 0 ? -1 : c + rest;
+}
+
+// *****************************************************************************
+// *** COUNTDOWN LOOPS                                                       ***
+// *****************************************************************************
+
+// The maximum count of steps exec_instr() can take:
+//
+#define KENBAK_EMU_MAX_STEPS_PER_INSTR 13
+
+static uint64_t min_u64(uint64_t const a, uint64_t const b)
+{
+    return a < b ? a : b;
+}
+
+/** Returns true, if the given budget is zero (meaning "no limit") or at least
+ *  the given used amount plus the given needed amount.
+ */
+static bool is_in_budget(
+    uint64_t const budget, uint64_t const used, uint64_t const needed)
+{
+    return budget == 0 || (used <= budget && needed <= budget - used);
+}
+
+/** Returns true, if kenbak_emu_run() would execute the next instruction in one
+ *  pass with the given limits and results so far (given that there is no
+ *  other reason to stop, see get_stop_before_step() of kenbak_emu.c).
+ */
+static bool is_next_instr_in_budget(
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result const * const result)
+{
+    return is_in_budget(
+            limits->max_steps, result->steps, KENBAK_EMU_MAX_STEPS_PER_INSTR)
+        && is_in_budget(limits->max_byte_times, result->byte_times, 1)
+        && is_in_budget(limits->max_instrs, result->instrs, 1);
+}
+
+/** Returns true, if sampling the (unchanged) input in run mode would not change
+ *  anything: No push button is pressed or got released and ED is not set.
+ */
+static bool is_input_settled(KENBAK_EMU_CORE_DATA const * const d)
+{
+    return !KENBAK_EMU_AT(d, input_changed)
+        && (KENBAK_EMU_AT(d, input) & KENBAK_INPUT_MASK_BUTTONS) == 0
+        && !KENBAK_EMU_IS_SIG(d, kenbak_sig_ed);
+}
+
+/** Fast-forwards the countdown loop that starts with the next instruction,
+ *  with the given counter address (see kenbak_code_get_countdown_reg()).
+ *
+ * - Must be called in state SA, only.
+ * - Executes iterations one by one, until the timing of an iteration repeats
+ *   (at once without the timing model, otherwise after at most one iteration
+ *   per delay line position), then lets as many of such repeating sequences
+ *   of iterations pass arithmetically as the budgets and the counter allow,
+ *   keeping the last iteration (leaving the loop) for normal execution.
+ * - The results are the same as if each instruction got executed by
+ *   kenbak_emu_run() in one pass (adds to the given result, too).
+ */
+static void skip_countdown_loop(
+    KENBAK_EMU_CORE_DATA * const d,
+    int const reg,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
+{
+    assert(KENBAK_EMU_AT(d, state) == kenbak_state_sa);
+
+    uint8_t const addr =
+        mem_read(d, KENBAK_DATA_ADDR_P) + KENBAK_EMU_AT(d, sig_inc);
+
+    if(!is_input_settled(d))
+    {
+        return; // Sampling the input would change something (maybe ED).
+    }
+    if(limits->stop_at_p
+        && (limits->p == addr || limits->p == (uint8_t)(addr + 2)))
+    {
+        return;
+    }
+
+    // Results at the first iteration starting at a delay line position (the
+    // iteration count is stored plus one, zero means "not seen"):
+    //
+    struct
+    {
+        int iter;
+        uint64_t steps;
+        uint64_t byte_times;
+    } seen[KENBAK_DATA_DELAY_LINE_SIZE] = { { 0 } };
+
+    for(int iter = 1;; ++iter)
+    {
+        uint8_t const counter = mem_read(d, (uint8_t)reg);
+        int const skippable = (counter == 0 ? 256 : counter) - 1; // W/o last.
+        int const pos = KENBAK_EMU_IS_TIMING(d)
+            ? (int)(KENBAK_EMU_AT(d, byte_times)
+                % KENBAK_DATA_DELAY_LINE_SIZE)
+            : 0;
+
+        if(skippable == 0)
+        {
+            return;
+        }
+
+        if(!is_next_instr_in_budget(limits, result))
+        {
+            return;
+        }
+
+        if(seen[pos].iter != 0)
+        {
+            // The iterations since then will repeat:
+
+            int const len = iter - seen[pos].iter;
+            uint64_t const steps = result->steps - seen[pos].steps;
+            uint64_t const byte_times =
+                result->byte_times - seen[pos].byte_times;
+            uint64_t count = (uint64_t)(skippable / len);
+
+            // Keep enough budget for the last instruction of the last skipped
+            // iteration to be executed in one pass:
+
+            if(limits->max_steps != 0)
+            {
+                count = min_u64(
+                    count,
+                    (limits->max_steps
+                            - result->steps
+                            - KENBAK_EMU_MAX_STEPS_PER_INSTR)
+                        / steps);
+            }
+            if(limits->max_byte_times != 0)
+            {
+                count = min_u64(
+                    count,
+                    (limits->max_byte_times - result->byte_times) / byte_times);
+            }
+            if(limits->max_instrs != 0)
+            {
+                count = min_u64(
+                    count,
+                    (limits->max_instrs - result->instrs)
+                        / (2 * (uint64_t)len));
+            }
+
+            mem_write(d, (uint8_t)reg, (uint8_t)(counter - count * len));
+            result->steps += count * steps;
+            result->byte_times += count * byte_times;
+            result->instrs += count * 2 * (uint64_t)len;
+            // (wraps around)
+            //
+            KENBAK_EMU_AT(d, byte_times) += (uint32_t)(count * byte_times);
+            return;
+        }
+        if(1 < iter) // (the first one may be the first after the input changed)
+        {
+            seen[pos].iter = iter;
+            seen[pos].steps = result->steps;
+            seen[pos].byte_times = result->byte_times;
+        }
+
+        // One iteration, SUB and JPD:
+
+        for(int i = 0; i < 2; ++i)
+        {
+            int steps = 0;
+
+            if(i == 1 && !is_next_instr_in_budget(limits, result))
+            {
+                return;
+            }
+            int const c = exec_instr(d, &steps);
+
+            assert(0 <= c && KENBAK_EMU_AT(d, state) == kenbak_state_sa);
+            result->steps += (uint64_t)steps;
+            result->byte_times += (uint64_t)c;
+            ++result->instrs;
+        }
+    }
+}
+
+#endif //KENBAK_EMU_CORE_INSTRS
+
+// *****************************************************************************
+// *** ENTRY POINTS OF AN ENGINE VARIANT                                     ***
+// *****************************************************************************
+
+#ifdef KENBAK_EMU_CORE_PREFIX
+
+#define KENBAK_EMU_CORE_CONCAT(prefix, name) prefix ## name
+#define KENBAK_EMU_CORE_NAME(prefix, name) KENBAK_EMU_CORE_CONCAT(prefix, name)
+
+// The given name with the variant's prefix:
+//
+#define KENBAK_EMU_CORE_FN(name) \
+    KENBAK_EMU_CORE_NAME(KENBAK_EMU_CORE_PREFIX, name)
+
+/** Returns true, if the given Kenbak-1 has a feature enabled that the variant
+ *  does not have and that must see each memory access (checked once per
+ *  call, not per access).
+ */
+static bool lacks_mem_feature(struct kenbak_data const * const d)
+{
+    return (KENBAK_EMU_FEATURE_CODE_CACHE == KENBAK_EMU_FEATURE_OFF
+            && d->code_cache != NULL)
+        || (KENBAK_EMU_FEATURE_HASH == KENBAK_EMU_FEATURE_OFF && d->hashing)
+        || (KENBAK_EMU_FEATURE_MEMO == KENBAK_EMU_FEATURE_OFF
+            && d->memo != NULL);
+}
+
+int KENBAK_EMU_CORE_FN(_step)(struct kenbak_data * const d)
+{
+    if(d->state == kenbak_state_power_off || d->state == kenbak_state_unknown)
+    {
+        return 0; // Power switch is handled by kenbak_emu_step(), only.
+    }
+    if(lacks_mem_feature(d))
+    {
+        assert(false); // Must not get here.
+        return -1;
+    }
+    return step_in_defined_state(d, KENBAK_EMU_DISPATCH);
+}
+
+uint64_t KENBAK_EMU_CORE_FN(_steps)(
+    struct kenbak_data * const d, uint64_t const count)
+{
+    if(d->state == kenbak_state_power_off || d->state == kenbak_state_unknown)
+    {
+        return 0; // (see above)
+    }
+    if(lacks_mem_feature(d))
+    {
+        assert(false); // Must not get here.
+        return 0;
+    }
+    return steps_in_defined_state(d, count, KENBAK_EMU_DISPATCH_STEPS);
+}
+
+#endif //KENBAK_EMU_CORE_PREFIX
+
+#endif //KENBAK_EMU_CORE
@@ -0,0 +1,860 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "kenbak_gate.h"
+
+#define KENBAK_GATE_MAX_LINE_LEN 255 // (not counting terminator)
+
+#define KENBAK_GATE_MAX_MSG_LEN 127 // (not counting terminator)
+
+enum kenbak_gate_op
+{
+    kenbak_gate_op_const0 = 0,
+    kenbak_gate_op_const1,
+    kenbak_gate_op_buf,
+    kenbak_gate_op_not,
+    kenbak_gate_op_and,
+    kenbak_gate_op_or,
+    kenbak_gate_op_nand,
+    kenbak_gate_op_nor,
+    kenbak_gate_op_xor,
+    kenbak_gate_op_xnor,
+    kenbak_gate_op_dff,
+
+    kenbak_gate_op_count
+};
+
+// Names of the operations as used in netlists, their minimum and maximum
+// counts of inputs (indexed by enum kenbak_gate_op):
+//
+static struct
+{
+    char const * name;
+    int min_inputs;
+    int max_inputs;
+} const s_ops[kenbak_gate_op_count] = {
+    { "const0", 0, 0 },
+    { "const1", 0, 0 },
+    { "buf", 1, 1 },
+    { "not", 1, 1 },
+    { "and", 2, KENBAK_GATE_MAX_INPUTS },
+    { "or", 2, KENBAK_GATE_MAX_INPUTS },
+    { "nand", 2, KENBAK_GATE_MAX_INPUTS },
+    { "nor", 2, KENBAK_GATE_MAX_INPUTS },
+    { "xor", 2, KENBAK_GATE_MAX_INPUTS },
+    { "xnor", 2, KENBAK_GATE_MAX_INPUTS },
+    { "dff", 1, 1 } // (plus the optional initial value)
+};
+
+#define KENBAK_GATE_DRIVER_NONE (-1)
+#define KENBAK_GATE_DRIVER_INPUT (-2)
+
+struct kenbak_gate_gate
+{
+    int op; // enum kenbak_gate_op
+    int out; // Net driven.
+    int in_count;
+    int in[KENBAK_GATE_MAX_INPUTS]; // Nets read.
+    uint64_t init; // Initial value of a flip-flop.
+    int level; // Of a combinational gate, see levelize().
+};
+
+struct kenbak_gate
+{
+    int net_count;
+    char (*names)[KENBAK_GATE_MAX_NAME_LEN + 1];
+    uint64_t * vals; // The lanes' bits of each net.
+    int * drivers; // Gate driving each net or a KENBAK_GATE_DRIVER_*.
+
+    // The combinational gates ordered by level, followed by the flip-flops:
+    //
+    int gate_count;
+    struct kenbak_gate_gate * gates;
+    int comb_count; // Count of combinational gates.
+
+    // Indices of the combinational gates reading each net (the ones of net n
+    // are at fanout_first[n] to fanout_first[n + 1] - 1):
+    //
+    int * fanout_first;
+    int * fanouts;
+
+    // The combinational gates to be evaluated, per level (the ones of level l
+    // are at level_first[l] to level_first[l] + queued_counts[l] - 1, which
+    // is where the gates of level l are in gates, too):
+    //
+    int level_count;
+    int * level_first;
+    int * queued_counts;
+    int * queue;
+    bool * is_queued; // Per combinational gate.
+    bool any_queued;
+
+    uint64_t * dff_nexts; // Per flip-flop, see kenbak_gate_clock().
+
+    uint64_t evals;
+};
+
+static int get_net_index(
+    struct kenbak_gate const * const g, char const * const name)
+{
+    for(int i = 0; i < g->net_count; ++i)
+    {
+        if(strcmp(g->names[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** Returns the index of the net with the given name, adds it, if not found.
+ *
+ *  - Returns -1 on error.
+ */
+static int get_or_add_net(
+    struct kenbak_gate * const g, char const * const name, int * const cap)
+{
+    int const found = get_net_index(g, name);
+
+    if(found != -1)
+    {
+        return found;
+    }
+
+    if(g->net_count == *cap)
+    {
+        int const new_cap = *cap == 0 ? 64 : 2 * *cap;
+        void * const names =
+            realloc(g->names, (size_t)new_cap * sizeof *g->names);
+        void * const drivers = names == NULL
+            ? NULL
+            : realloc(g->drivers, (size_t)new_cap * sizeof *g->drivers);
+
+        if(names != NULL)
+        {
+            g->names = names;
+        }
+        if(drivers == NULL)
+        {
+            assert(false); // Must not get here.
+            return -1;
+        }
+        g->drivers = drivers;
+        *cap = new_cap;
+    }
+
+    // (length checked by caller):
+    //
+    memcpy(g->names[g->net_count], name, strlen(name) + 1);
+    g->drivers[g->net_count] = KENBAK_GATE_DRIVER_NONE;
+    return g->net_count++;
+}
+
+/** Returns a new error message for the given line of a netlist (or for the
+ *  whole netlist, if line is zero) or NULL on error.
+ *
+ *  - Caller takes ownership of returned message.
+ */
+static char * create_err_msg(
+    int const line, char const * const msg, char const * const name)
+{
+    char * const ret_val = malloc(KENBAK_GATE_MAX_MSG_LEN + 1);
+
+    if(ret_val == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    if(line == 0)
+    {
+        snprintf(
+            ret_val,
+            KENBAK_GATE_MAX_MSG_LEN + 1,
+            "Netlist: %s%s%s.",
+            msg,
+            name == NULL ? "" : " ",
+            name == NULL ? "" : name);
+        return ret_val;
+    }
+    snprintf(
+        ret_val,
+        KENBAK_GATE_MAX_MSG_LEN + 1,
+        "Netlist line %d: %s%s%s.",
+        line,
+        msg,
+        name == NULL ? "" : " ",
+        name == NULL ? "" : name);
+    return ret_val;
+}
+
+/** Splits the given line into its tokens (in place), stopping at a comment.
+ *
+ *  - Returns the count of tokens or -1, if there are too many or a token is
+ *    longer than a net's name may be.
+ */
+static int split_line(char * const line, char * * const tokens, int const max)
+{
+    int ret_val = 0;
+    char * c = line;
+
+    while(true)
+    {
+        while(isspace((unsigned char)*c))
+        {
+            ++c;
+        }
+        if(*c == '\0' || *c == '#')
+        {
+            return ret_val;
+        }
+        if(ret_val == max)
+        {
+            return -1;
+        }
+        tokens[ret_val] = c;
+        while(*c != '\0' && *c != '#' && !isspace((unsigned char)*c))
+        {
+            ++c;
+        }
+        if(KENBAK_GATE_MAX_NAME_LEN < c - tokens[ret_val])
+        {
+            return -1;
+        }
+        ++ret_val;
+        if(*c == '#')
+        {
+            *c = '\0';
+            return ret_val;
+        }
+        if(*c != '\0')
+        {
+            *c++ = '\0';
+        }
+    }
+}
+
+/** Adds the definition in the given tokens of a netlist's line.
+ *
+ *  - Returns NULL or an error message (caller takes ownership).
+ */
+static char * add_def(
+    struct kenbak_gate * const g,
+    int const line,
+    char * * const tokens,
+    int const token_count,
+    int * const net_cap,
+    int * const gate_cap)
+{
+    if(strcmp(tokens[0], "input") == 0)
+    {
+        if(token_count != 2)
+        {
+            return create_err_msg(line, "Expected one name after", "input");
+        }
+
+        int const net = get_or_add_net(g, tokens[1], net_cap);
+
+        if(net == -1)
+        {
+            return create_err_msg(line, "Out of memory", NULL);
+        }
+        if(g->drivers[net] != KENBAK_GATE_DRIVER_NONE)
+        {
+            return create_err_msg(line, "Net defined twice:", tokens[1]);
+        }
+        g->drivers[net] = KENBAK_GATE_DRIVER_INPUT;
+        return NULL;
+    }
+
+    if(token_count < 3 || strcmp(tokens[1], "=") != 0)
+    {
+        return create_err_msg(line, "Expected NAME = OP ..", NULL);
+    }
+
+    int op = 0;
+
+    while(op < kenbak_gate_op_count && strcmp(s_ops[op].name, tokens[2]) != 0)
+    {
+        ++op;
+    }
+    if(op == kenbak_gate_op_count)
+    {
+        return create_err_msg(line, "Unknown operation", tokens[2]);
+    }
+
+    struct kenbak_gate_gate gate = { .op = op };
+    int in_count = token_count - 3;
+
+    if(op == kenbak_gate_op_dff && in_count == 2)
+    {
+        if(strcmp(tokens[4], "0") != 0 && strcmp(tokens[4], "1") != 0)
+        {
+            return create_err_msg(
+                line, "Initial value not 0 or 1:", tokens[4]);
+        }
+        gate.init = tokens[4][0] == '1' ? ~(uint64_t)0 : 0;
+        in_count = 1;
+    }
+    if(in_count < s_ops[op].min_inputs || s_ops[op].max_inputs < in_count)
+    {
+        return create_err_msg(line, "Wrong count of inputs for", tokens[2]);
+    }
+
+    gate.in_count = in_count;
+    gate.out = get_or_add_net(g, tokens[0], net_cap);
+    if(gate.out == -1)
+    {
+        return create_err_msg(line, "Out of memory", NULL);
+    }
+    if(g->drivers[gate.out] != KENBAK_GATE_DRIVER_NONE)
+    {
+        return create_err_msg(line, "Net defined twice:", tokens[0]);
+    }
+    for(int i = 0; i < in_count; ++i)
+    {
+        gate.in[i] = get_or_add_net(g, tokens[3 + i], net_cap);
+        if(gate.in[i] == -1)
+        {
+            return create_err_msg(line, "Out of memory", NULL);
+        }
+    }
+
+    if(g->gate_count == *gate_cap)
+    {
+        int const new_cap = *gate_cap == 0 ? 64 : 2 * *gate_cap;
+        void * const gates =
+            realloc(g->gates, (size_t)new_cap * sizeof *g->gates);
+
+        if(gates == NULL)
+        {
+            return create_err_msg(line, "Out of memory", NULL);
+        }
+        g->gates = gates;
+        *gate_cap = new_cap;
+    }
+    g->drivers[gate.out] = g->gate_count;
+    g->gates[g->gate_count++] = gate;
+    return NULL;
+}
+
+/** Reads the definitions of the given netlist into the given simulator.
+ *
+ *  - Returns NULL or an error message (caller takes ownership).
+ */
+static char * read_defs(struct kenbak_gate * const g, char const * const txt)
+{
+    int net_cap = 0;
+    int gate_cap = 0;
+    int line = 1;
+    char const * c = txt;
+
+    while(*c != '\0')
+    {
+        char buf[KENBAK_GATE_MAX_LINE_LEN + 1];
+        char * tokens[3 + KENBAK_GATE_MAX_INPUTS];
+        int len = 0;
+
+        while(c[len] != '\0' && c[len] != '\n')
+        {
+            ++len;
+        }
+        if(KENBAK_GATE_MAX_LINE_LEN < len)
+        {
+            return create_err_msg(line, "Line too long", NULL);
+        }
+        memcpy(buf, c, (size_t)len);
+        buf[len] = '\0';
+        c += c[len] == '\n' ? len + 1 : len;
+
+        int const token_count = split_line(
+            buf, tokens, (int)(sizeof tokens / sizeof *tokens));
+
+        if(token_count == -1)
+        {
+            return create_err_msg(line, "Too many or too long names", NULL);
+        }
+        if(0 < token_count)
+        {
+            char * const msg =
+                add_def(g, line, tokens, token_count, &net_cap, &gate_cap);
+
+            if(msg != NULL)
+            {
+                return msg;
+            }
+        }
+        ++line;
+    }
+
+    for(int i = 0; i < g->net_count; ++i)
+    {
+        if(g->drivers[i] == KENBAK_GATE_DRIVER_NONE)
+        {
+            return create_err_msg(0, "Net not defined:", g->names[i]);
+        }
+    }
+    return NULL;
+}
+
+/** Returns true, if the net is driven by a combinational gate.
+ */
+static bool is_comb_driven(struct kenbak_gate const * const g, int const net)
+{
+    int const driver = g->drivers[net];
+
+    return 0 <= driver && g->gates[driver].op != kenbak_gate_op_dff;
+}
+
+/** Sets the level of each combinational gate (a topological order, inputs and
+ *  flip-flops are at the bottom) and the count of levels.
+ *
+ *  - Returns NULL or an error message (caller takes ownership), if there is
+ *    a combinational loop.
+ */
+static char * levelize(struct kenbak_gate * const g)
+{
+    // Count of inputs of each gate driven by a combinational gate, whose
+    // level is not known, yet:
+    //
+    int * const pending =
+        malloc(((size_t)g->gate_count + 1) * sizeof *pending);
+    int * const ready = malloc(((size_t)g->gate_count + 1) * sizeof *ready);
+    int ready_count = 0;
+    int done_count = 0;
+    int comb_count = 0;
+    char * ret_val = NULL;
+
+    if(pending == NULL || ready == NULL)
+    {
+        free(pending);
+        free(ready);
+        return create_err_msg(0, "Out of memory", NULL);
+    }
+
+    g->level_count = 0;
+    for(int i = 0; i < g->gate_count; ++i)
+    {
+        struct kenbak_gate_gate * const gate = g->gates + i;
+
+        gate->level = 0;
+        pending[i] = 0;
+        if(gate->op == kenbak_gate_op_dff)
+        {
+            continue;
+        }
+        ++comb_count;
+        for(int j = 0; j < gate->in_count; ++j)
+        {
+            if(is_comb_driven(g, gate->in[j]))
+            {
+                ++pending[i];
+            }
+        }
+        if(pending[i] == 0)
+        {
+            ready[ready_count++] = i;
+        }
+    }
+
+    while(done_count < ready_count)
+    {
+        struct kenbak_gate_gate const * const done =
+            g->gates + ready[done_count++];
+
+        if(g->level_count <= done->level)
+        {
+            g->level_count = done->level + 1;
+        }
+
+        // (quadratic, but for netlist creation only)
+        //
+        for(int i = 0; i < g->gate_count; ++i)
+        {
+            struct kenbak_gate_gate * const gate = g->gates + i;
+
+            if(gate->op == kenbak_gate_op_dff)
+            {
+                continue;
+            }
+            for(int j = 0; j < gate->in_count; ++j)
+            {
+                if(gate->in[j] != done->out)
+                {
+                    continue;
+                }
+                if(gate->level <= done->level)
+                {
+                    gate->level = done->level + 1;
+                }
+                if(--pending[i] == 0)
+                {
+                    ready[ready_count++] = i;
+                }
+            }
+        }
+    }
+
+    if(done_count < comb_count)
+    {
+        for(int i = 0; i < g->gate_count; ++i)
+        {
+            if(0 < pending[i])
+            {
+                ret_val = create_err_msg(
+                    0, "Combinational loop at net", g->names[g->gates[i].out]);
+                break;
+            }
+        }
+    }
+    free(pending);
+    free(ready);
+    return ret_val;
+}
+
+/** Orders the gates by level (the flip-flops last) and creates the fanouts
+ *  and the queues.
+ *
+ *  - Returns false on error.
+ */
+static bool order_gates(struct kenbak_gate * const g)
+{
+    struct kenbak_gate_gate * const gates =
+        malloc(((size_t)g->gate_count + 1) * sizeof *gates);
+    int i = 0;
+
+    if(gates == NULL)
+    {
+        return false;
+    }
+
+    size_t const levels = (size_t)g->level_count + 1;
+    size_t const gate_count = (size_t)g->gate_count + 1;
+    size_t const net_count = (size_t)g->net_count + 1;
+
+    g->level_first = calloc(levels, sizeof *g->level_first);
+    g->queued_counts = calloc(levels, sizeof *g->queued_counts);
+    g->queue = malloc(gate_count * sizeof *g->queue);
+    g->is_queued = calloc(gate_count, sizeof *g->is_queued);
+    g->dff_nexts = calloc(gate_count, sizeof *g->dff_nexts);
+    g->vals = calloc(net_count, sizeof *g->vals);
+    g->fanout_first = calloc(net_count, sizeof *g->fanout_first);
+    if(g->level_first == NULL || g->queued_counts == NULL
+        || g->queue == NULL || g->is_queued == NULL || g->dff_nexts == NULL
+        || g->vals == NULL || g->fanout_first == NULL)
+    {
+        free(gates);
+        return false;
+    }
+
+    g->comb_count = 0;
+    for(int level = 0; level < g->level_count; ++level)
+    {
+        g->level_first[level] = i;
+        for(int j = 0; j < g->gate_count; ++j)
+        {
+            if(g->gates[j].op != kenbak_gate_op_dff
+                && g->gates[j].level == level)
+            {
+                gates[i++] = g->gates[j];
+            }
+        }
+    }
+    g->level_first[g->level_count] = i;
+    g->comb_count = i;
+    for(int j = 0; j < g->gate_count; ++j)
+    {
+        if(g->gates[j].op == kenbak_gate_op_dff)
+        {
+            gates[i++] = g->gates[j];
+        }
+    }
+    assert(i == g->gate_count);
+    free(g->gates);
+    g->gates = gates;
+
+    // Drivers and fanouts by the new indices:
+
+    int fanout_count = 0;
+
+    for(int j = 0; j < g->gate_count; ++j)
+    {
+        g->drivers[g->gates[j].out] = j;
+        g->vals[g->gates[j].out] = g->gates[j].init;
+        if(j < g->comb_count)
+        {
+            fanout_count += g->gates[j].in_count;
+        }
+    }
+
+    g->fanouts = malloc(((size_t)fanout_count + 1) * sizeof *g->fanouts);
+    if(g->fanouts == NULL)
+    {
+        return false;
+    }
+
+    int pos = 0;
+
+    for(int net = 0; net < g->net_count; ++net)
+    {
+        g->fanout_first[net] = pos;
+        for(int j = 0; j < g->comb_count; ++j)
+        {
+            for(int k = 0; k < g->gates[j].in_count; ++k)
+            {
+                if(g->gates[j].in[k] == net)
+                {
+                    g->fanouts[pos++] = j; // (once per gate)
+                    break;
+                }
+            }
+        }
+    }
+    g->fanout_first[g->net_count] = pos;
+
+    // All combinational gates get evaluated first:
+
+    for(int j = 0; j < g->comb_count; ++j)
+    {
+        g->queue[j] = j;
+        g->is_queued[j] = true;
+    }
+    for(int level = 0; level < g->level_count; ++level)
+    {
+        g->queued_counts[level] =
+            g->level_first[level + 1] - g->level_first[level];
+    }
+    g->any_queued = 0 < g->comb_count;
+    return true;
+}
+
+/** Queues the gates reading the given net for evaluation.
+ */
+static void queue_fanouts(struct kenbak_gate * const g, int const net)
+{
+    for(int i = g->fanout_first[net]; i < g->fanout_first[net + 1]; ++i)
+    {
+        int const gate = g->fanouts[i];
+
+        if(!g->is_queued[gate])
+        {
+            int const level = g->gates[gate].level;
+
+            g->queue[g->level_first[level] + g->queued_counts[level]++] = gate;
+            g->is_queued[gate] = true;
+        }
+    }
+    g->any_queued =
+        g->any_queued || g->fanout_first[net] < g->fanout_first[net + 1];
+}
+
+static uint64_t eval(
+    struct kenbak_gate const * const g,
+    struct kenbak_gate_gate const * const gate)
+{
+    uint64_t const * const vals = g->vals;
+    uint64_t ret_val = gate->in_count == 0 ? 0 : vals[gate->in[0]];
+
+    switch(gate->op)
+    {
+        case kenbak_gate_op_const0:
+            return 0;
+        case kenbak_gate_op_const1:
+            return ~(uint64_t)0;
+        case kenbak_gate_op_buf:
+            return ret_val;
+        case kenbak_gate_op_not:
+            return ~ret_val;
+
+        case kenbak_gate_op_and:
+        case kenbak_gate_op_nand:
+            for(int i = 1; i < gate->in_count; ++i)
+            {
+                ret_val &= vals[gate->in[i]];
+            }
+            return gate->op == kenbak_gate_op_and ? ret_val : ~ret_val;
+
+        case kenbak_gate_op_or:
+        case kenbak_gate_op_nor:
+            for(int i = 1; i < gate->in_count; ++i)
+            {
+                ret_val |= vals[gate->in[i]];
+            }
+            return gate->op == kenbak_gate_op_or ? ret_val : ~ret_val;
+
+        case kenbak_gate_op_xor:
+        case kenbak_gate_op_xnor:
+            for(int i = 1; i < gate->in_count; ++i)
+            {
+                ret_val ^= vals[gate->in[i]];
+            }
+            return gate->op == kenbak_gate_op_xor ? ret_val : ~ret_val;
+
+        default:
+            assert(false); // Must not get here.
+            return 0;
+    }
+}
+
+/** Evaluates the queued gates level by level, queuing the gates reading a net
+ *  that changed (all at higher levels).
+ */
+static void settle(struct kenbak_gate * const g)
+{
+    if(!g->any_queued)
+    {
+        return;
+    }
+
+    for(int level = 0; level < g->level_count; ++level)
+    {
+        int const first = g->level_first[level];
+
+        for(int i = 0; i < g->queued_counts[level]; ++i)
+        {
+            int const gate = g->queue[first + i];
+            struct kenbak_gate_gate const * const p = g->gates + gate;
+            uint64_t const val = eval(g, p);
+
+            g->is_queued[gate] = false;
+            if(val != g->vals[p->out])
+            {
+                g->vals[p->out] = val;
+                queue_fanouts(g, p->out);
+            }
+        }
+        g->evals += (uint64_t)g->queued_counts[level];
+        g->queued_counts[level] = 0;
+    }
+    g->any_queued = false;
+}
+
+int kenbak_gate_get_net(
+    struct kenbak_gate const * const g, char const * const name)
+{
+    assert(g != NULL);
+    assert(name != NULL);
+
+    return get_net_index(g, name);
+}
+
+void kenbak_gate_set(
+    struct kenbak_gate * const g, int const net, uint64_t const lanes)
+{
+    assert(g != NULL);
+    assert(0 <= net && net < g->net_count);
+    assert(!is_comb_driven(g, net)); // Input or flip-flop.
+
+    if(g->vals[net] != lanes)
+    {
+        g->vals[net] = lanes;
+        queue_fanouts(g, net);
+    }
+}
+
+uint64_t kenbak_gate_get(struct kenbak_gate * const g, int const net)
+{
+    assert(g != NULL);
+    assert(0 <= net && net < g->net_count);
+
+    settle(g);
+    return g->vals[net];
+}
+
+void kenbak_gate_clock(struct kenbak_gate * const g)
+{
+    assert(g != NULL);
+
+    settle(g);
+
+    // All flip-flops latch at once:
+
+    for(int i = g->comb_count; i < g->gate_count; ++i)
+    {
+        g->dff_nexts[i] = g->vals[g->gates[i].in[0]];
+    }
+    for(int i = g->comb_count; i < g->gate_count; ++i)
+    {
+        int const out = g->gates[i].out;
+
+        if(g->vals[out] != g->dff_nexts[i])
+        {
+            g->vals[out] = g->dff_nexts[i];
+            queue_fanouts(g, out);
+        }
+    }
+}
+
+uint64_t kenbak_gate_get_evals(struct kenbak_gate const * const g)
+{
+    assert(g != NULL);
+
+    return g->evals;
+}
+
+int kenbak_gate_get_gate_count(struct kenbak_gate const * const g)
+{
+    assert(g != NULL);
+
+    return g->gate_count;
+}
+
+void kenbak_gate_delete(struct kenbak_gate * const g)
+{
+    if(g == NULL)
+    {
+        return;
+    }
+    free(g->names);
+    free(g->vals);
+    free(g->drivers);
+    free(g->gates);
+    free(g->fanout_first);
+    free(g->fanouts);
+    free(g->level_first);
+    free(g->queued_counts);
+    free(g->queue);
+    free(g->is_queued);
+    free(g->dff_nexts);
+    free(g);
+}
+
+struct kenbak_gate * kenbak_gate_create(
+    char const * const txt, char * * const out_msg)
+{
+    assert(txt != NULL);
+    assert(out_msg != NULL);
+
+    struct kenbak_gate * const ret_val = calloc(1, sizeof *ret_val);
+
+    *out_msg = NULL;
+    if(ret_val == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    *out_msg = read_defs(ret_val, txt);
+    if(*out_msg == NULL)
+    {
+        *out_msg = levelize(ret_val);
+    }
+    if(*out_msg == NULL && !order_gates(ret_val))
+    {
+        *out_msg = create_err_msg(0, "Out of memory", NULL);
+    }
+    if(*out_msg != NULL)
+    {
+        kenbak_gate_delete(ret_val);
+        return NULL;
+    }
+    return ret_val;
+}
@@ -0,0 +1,87 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Gate-level simulator for netlists of logic gates and D flip-flops, e.g. to
+// check parts of the Kenbak-1's logic against the emulator (see
+// kenbak_gate_net.h for the netlist bundled).
+//
+// - A netlist is a text of one definition per line, a '#' starts a comment
+//   that ends with the line:
+//
+//   input NAME           An input, set via kenbak_gate_set().
+//   NAME = OP IN1 IN2 .. A gate with OP one of and, or, nand, nor, xor, xnor
+//                        (two to KENBAK_GATE_MAX_INPUTS inputs), not, buf
+//                        (one input), const0 or const1 (no inputs).
+//   NAME = dff D [INIT]  A D flip-flop that latches net D at each clock (see
+//                        kenbak_gate_clock()), starting with INIT (0 or 1,
+//                        zero, if not given).
+//
+//   Nets may be used before they are defined.
+// - Each net holds KENBAK_GATE_LANES bits, one per instance of the netlist,
+//   so all instances get simulated at once (bit-parallel).
+// - The gates (but the flip-flops) get levelized when a netlist is created:
+//   Each gate's level is one above the highest level of the gates driving its
+//   inputs, a combinational loop is an error.
+// - Evaluation is activity-driven: Only gates with an input net that changed
+//   get evaluated again, level by level.
+
+#ifndef KENBAK_GATE
+#define KENBAK_GATE
+
+#include <stdint.h>
+
+#define KENBAK_GATE_LANES 64 // Instances of a netlist (bits per net).
+
+#define KENBAK_GATE_MAX_INPUTS 8 // Per gate.
+
+#define KENBAK_GATE_MAX_NAME_LEN 31 // Per net (not counting terminator).
+
+struct kenbak_gate; // (see kenbak_gate.c)
+
+/**
+ * - Returns the index of the net with the given name or -1, if not found.
+ */
+int kenbak_gate_get_net(
+    struct kenbak_gate const * const g, char const * const name);
+
+/**
+ * - Sets the given input or flip-flop net to the given lanes' bits.
+ */
+void kenbak_gate_set(
+    struct kenbak_gate * const g, int const net, uint64_t const lanes);
+
+/**
+ * - Returns the lanes' bits of the given net, with all gates evaluated that
+ *   were affected by changes since the last evaluation.
+ */
+uint64_t kenbak_gate_get(struct kenbak_gate * const g, int const net);
+
+/**
+ * - Evaluates all gates affected by changes (if any) and lets all flip-flops
+ *   latch their D nets at once (one rising edge of the clock).
+ */
+void kenbak_gate_clock(struct kenbak_gate * const g);
+
+/**
+ * - Returns the count of gate evaluations done so far.
+ */
+uint64_t kenbak_gate_get_evals(struct kenbak_gate const * const g);
+
+/**
+ * - Returns the count of gates (including flip-flops) of the given netlist.
+ */
+int kenbak_gate_get_gate_count(struct kenbak_gate const * const g);
+
+void kenbak_gate_delete(struct kenbak_gate * const g);
+
+/**
+ * - Creates a simulator for the given netlist with all inputs zero and all
+ *   flip-flops at their initial values.
+ * - Returns NULL on error and the error message via given pointer (caller
+ *   takes ownership of the message).
+ * - Caller takes ownership of returned object.
+ */
+struct kenbak_gate * kenbak_gate_create(
+    char const * const txt, char * * const out_msg);
+
+#endif //KENBAK_GATE
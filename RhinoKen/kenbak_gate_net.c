@@ -0,0 +1,72 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include "kenbak_gate_net.h"
+
+char const * const kenbak_gate_net_timing =
+    "# Bit time register, a single one shifting through T0 to T7:\n"
+    "#\n"
+    "t0 = dff t7 1\n"
+    "t1 = dff t0\n"
+    "t2 = dff t1\n"
+    "t3 = dff t2\n"
+    "t4 = dff t3\n"
+    "t5 = dff t4\n"
+    "t6 = dff t5\n"
+    "t7 = dff t6\n"
+    "\n"
+    "# Memory address counter L, counting after T7 (L_n toggles, if T7 and L0\n"
+    "# to L_n-1 are set):\n"
+    "#\n"
+    "c0 = buf t7\n"
+    "l0n = xor l0 c0\n"
+    "l0 = dff l0n\n"
+    "c1 = and c0 l0\n"
+    "l1n = xor l1 c1\n"
+    "l1 = dff l1n\n"
+    "c2 = and c1 l1\n"
+    "l2n = xor l2 c2\n"
+    "l2 = dff l2n\n"
+    "c3 = and c2 l2\n"
+    "l3n = xor l3 c3\n"
+    "l3 = dff l3n\n"
+    "c4 = and c3 l3\n"
+    "l4n = xor l4 c4\n"
+    "l4 = dff l4n\n"
+    "c5 = and c4 l4\n"
+    "l5n = xor l5 c5\n"
+    "l5 = dff l5n\n"
+    "c6 = and c5 l5\n"
+    "l6n = xor l6 c6\n"
+    "l6 = dff l6n\n"
+    "\n"
+    "# Comparator CM, R equals L during T7:\n"
+    "#\n"
+    "input r0\n"
+    "input r1\n"
+    "input r2\n"
+    "input r3\n"
+    "input r4\n"
+    "input r5\n"
+    "input r6\n"
+    "e0 = xnor r0 l0\n"
+    "e1 = xnor r1 l1\n"
+    "e2 = xnor r2 l2\n"
+    "e3 = xnor r3 l3\n"
+    "e4 = xnor r4 l4\n"
+    "e5 = xnor r5 l5\n"
+    "e6 = xnor r6 l6\n"
+    "cm = and t7 e0 e1 e2 e3 e4 e5 e6\n"
+    "\n"
+    "# Serial adder with carry flip-flop, the carry is cleared for T0:\n"
+    "#\n"
+    "input a\n"
+    "input b\n"
+    "nt0 = not t0\n"
+    "cin = and cy nt0\n"
+    "ab = xor a b\n"
+    "sum = xor ab cin\n"
+    "gen = and a b\n"
+    "prop = and ab cin\n"
+    "cout = or gen prop\n"
+    "cy = dff cout\n";
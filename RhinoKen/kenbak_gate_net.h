@@ -0,0 +1,33 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Netlists bundled for the gate-level simulator (see kenbak_gate.h).
+//
+// - Partial groundwork, only: These are models of the logic whose behavior
+//   the emulator relies on, built from the same kind of parts the Kenbak-1's
+//   TTL logic is made of, not transcriptions of its logic schematics (which
+//   are not part of this repository).
+// - There is no netlist of the data path and the control logic, yet, so no
+//   netlist executes instructions or runs a program. Transcriptions of the
+//   schematics' pages may be added the same way.
+
+#ifndef KENBAK_GATE_NET
+#define KENBAK_GATE_NET
+
+/**
+ * - Timing and address logic, one clock per bit time:
+ *
+ *   - The bit time register (flip-flops t0 to t7, of which one at a time is
+ *     set, starting with t0).
+ *   - The memory address counter L (flip-flops l0 to l6), which counts at the
+ *     end of each byte time (after T7) and is one byte ahead of the memory's
+ *     output (see wait_for_cm() of kenbak_emu_core.h).
+ *   - The comparator CM (net cm, R equals L during T7), with R as inputs r0 to
+ *     r6.
+ *   - The serial adder (operands' bits at inputs a and b, least significant
+ *     bit first during T0 to T7, sum's bits at net sum, carry flip-flop cy,
+ *     cleared for T0).
+ */
+extern char const * const kenbak_gate_net_timing;
+
+#endif //KENBAK_GATE_NET
@@ -0,0 +1,30 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdint.h>
+
+#include "kenbak_hash.h"
+
+uint64_t kenbak_hash_get_key(int const index, uint8_t const val)
+{
+    // The finalizer of SplitMix64, applied to the index and value:
+
+    uint64_t z = (((uint64_t)(uint32_t)index << 8 | val) + 1)
+        * 0x9E3779B97F4A7C15ull;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t kenbak_hash_get(
+    uint8_t const * const bytes, int const count, int const first_index)
+{
+    uint64_t hash = 0;
+
+    for(int i = 0; i < count; ++i)
+    {
+        hash ^= kenbak_hash_get_key(first_index + i, bytes[i]);
+    }
+    return hash;
+}
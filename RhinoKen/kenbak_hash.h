@@ -0,0 +1,45 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Incremental (Zobrist-style) hashing of byte sequences, like a Kenbak-1's
+// memory.
+//
+// - Each value at each position (index) has its own pseudo-random 64-bit key,
+//   the hash of a byte sequence is the XOR of the keys of all of its bytes.
+// - Changing a byte just needs the keys of its old and new value to be XORed
+//   into the hash, see KENBAK_HASH_ON_WRITE().
+// - The keys are calculated (not stored in a table), so the hashes are the
+//   same on each platform and for each run.
+
+#ifndef KENBAK_HASH
+#define KENBAK_HASH
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// To be used for each write of the given new value over the given old one at
+// the given index, to keep the given hash up-to-date:
+//
+#define KENBAK_HASH_ON_WRITE(hash, index, old_val, new_val) \
+    do \
+    { \
+        if((old_val) != (new_val)) \
+        { \
+            (hash) ^= kenbak_hash_get_key((index), (old_val)) \
+                ^ kenbak_hash_get_key((index), (new_val)); \
+        } \
+    } while(false)
+
+/**
+ * - Returns the key of the given value at the given index.
+ */
+uint64_t kenbak_hash_get_key(int const index, uint8_t const val);
+
+/**
+ * - Returns the hash of the given count of bytes, the first one being at the
+ *   given index.
+ */
+uint64_t kenbak_hash_get(
+    uint8_t const * const bytes, int const count, int const first_index);
+
+#endif //KENBAK_HASH
@@ -5,9 +5,44 @@
 #define KENBAK_INPUT
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define KENBAK_INPUT_BITS 8
 
+// The bits of the packed input (see kenbak_emu_press(), kenbak_emu_release()
+// and kenbak_emu_set_input_bits()), true/1 means pressed or switched on:
+//
+enum kenbak_input_bit
+{
+    kenbak_input_bit_data_0 = 0, // Data buttons 0 to 7 are bits 0 to 7.
+    kenbak_input_bit_data_7 = 7,
+
+    kenbak_input_bit_input_clear = 8,
+
+    kenbak_input_bit_address_display = 9,
+    kenbak_input_bit_address_set = 10,
+
+    kenbak_input_bit_memory_lock = 11,
+
+    kenbak_input_bit_memory_read = 12,
+    kenbak_input_bit_memory_store = 13,
+
+    kenbak_input_bit_run_start = 14,
+    kenbak_input_bit_run_stop = 15,
+
+    kenbak_input_bit_power_on = 16
+};
+
+#define KENBAK_INPUT_MASK(input_bit) ((uint32_t)1 << (input_bit))
+
+#define KENBAK_INPUT_MASK_DATA 0x000000FFu
+
+// All push buttons (but not the two switches):
+//
+#define KENBAK_INPUT_MASK_BUTTONS 0x0000F7FFu
+
+// This is the original, unpacked input (also see kenbak_emu_set_input()):
+//
 struct kenbak_input
 {
     bool buttons_data[KENBAK_INPUT_BITS];
@@ -11,145 +11,309 @@
 #include "kenbak_instr.h"
 #include "kenbak_addr_mode.h"
 
-/**
- * - Can be performance-improved by using a LUT. 
- */
+// Helpers to fill the decode table entries per instruction group (see PRM,
+// page 24). The register values are hard-coded, see KENBAK_DATA_ADDR_A,
+// KENBAK_DATA_ADDR_B and KENBAK_DATA_ADDR_X.
+//
+// - Jumps with direct addressing get the constant addressing mode and jumps
+//   with indirect addressing get the memory addressing mode (the jump address
+//   is the second byte of the instruction, or found at the address given by
+//   that second byte).
+//
+#define D_MISC(halt, reg) { \
+    kenbak_instr_type_misc, kenbak_addr_mode_none, 1, (reg), \
+    0, false, false, 0, 0, 0, false, false, (halt) }
+#define D_SHIFT(kind, places, reg) { \
+    kenbak_instr_type_shift_rot, kenbak_addr_mode_none, 1, (reg), \
+    0, false, false, kenbak_instr_shift_##kind, (places), 0, false, false, \
+    false }
+#define D_BIT(skip, val, pos) { \
+    kenbak_instr_type_bit, kenbak_addr_mode_memory, 2, 0, \
+    0, false, false, 0, 0, (pos), (val) == 1, (skip), false }
+#define D_REG(type, mode, reg) { \
+    kenbak_instr_type_##type, kenbak_addr_mode_##mode, 2, (reg), \
+    0, false, false, 0, 0, 0, false, false, false }
+#define D_JMP(mode, mark, unc, reg, cond) { \
+    kenbak_instr_type_jump, kenbak_addr_mode_##mode, 2, (reg), \
+    (cond), (unc), (mark), 0, 0, 0, false, false, false }
+
+struct kenbak_instr_decoded const kenbak_instr_decoded_table[256] = {
+    D_MISC(true, 0),                             // 0000 HALT
+    D_SHIFT(right_shift, 4, 0),                  // 0001 SFTR 4 A
+    D_BIT(false, 0, 0),                          // 0002 SET 0 0
+    D_REG(add, constant, 0),                     // 0003 ADD-A constant
+    D_REG(add, memory, 0),                       // 0004 ADD-A memory
+    D_REG(add, indirect, 0),                     // 0005 ADD-A indirect
+    D_REG(add, indexed, 0),                      // 0006 ADD-A indexed
+    D_REG(add, indirect_indexed, 0),             // 0007 ADD-A indirect indexed
+    D_MISC(true, 0),                             // 0010 HALT
+    D_SHIFT(right_shift, 1, 0),                  // 0011 SFTR 1 A
+    D_BIT(false, 0, 1),                          // 0012 SET 0 1
+    D_REG(sub, constant, 0),                     // 0013 SUB-A constant
+    D_REG(sub, memory, 0),                       // 0014 SUB-A memory
+    D_REG(sub, indirect, 0),                     // 0015 SUB-A indirect
+    D_REG(sub, indexed, 0),                      // 0016 SUB-A indexed
+    D_REG(sub, indirect_indexed, 0),             // 0017 SUB-A indirect indexed
+    D_MISC(true, 0),                             // 0020 HALT
+    D_SHIFT(right_shift, 2, 0),                  // 0021 SFTR 2 A
+    D_BIT(false, 0, 2),                          // 0022 SET 0 2
+    D_REG(load, constant, 0),                    // 0023 LOAD-A constant
+    D_REG(load, memory, 0),                      // 0024 LOAD-A memory
+    D_REG(load, indirect, 0),                    // 0025 LOAD-A indirect
+    D_REG(load, indexed, 0),                     // 0026 LOAD-A indexed
+    D_REG(load, indirect_indexed, 0),            // 0027 LOAD-A indirect indexed
+    D_MISC(true, 0),                             // 0030 HALT
+    D_SHIFT(right_shift, 3, 0),                  // 0031 SFTR 3 A
+    D_BIT(false, 0, 3),                          // 0032 SET 0 3
+    D_REG(store, constant, 0),                   // 0033 STORE-A constant
+    D_REG(store, memory, 0),                     // 0034 STORE-A memory
+    D_REG(store, indirect, 0),                   // 0035 STORE-A indirect
+    D_REG(store, indexed, 0),                    // 0036 STORE-A indexed
+    D_REG(store, indirect_indexed, 0),           // 0037 STORE-A indirect indexed
+    D_MISC(true, 1),                             // 0040 HALT
+    D_SHIFT(right_shift, 4, 1),                  // 0041 SFTR 4 B
+    D_BIT(false, 0, 4),                          // 0042 SET 0 4
+    D_JMP(constant, false, false, 0, 3),         // 0043 JPD A != 0
+    D_JMP(constant, false, false, 0, 4),         // 0044 JPD A == 0
+    D_JMP(constant, false, false, 0, 5),         // 0045 JPD A < 0
+    D_JMP(constant, false, false, 0, 6),         // 0046 JPD A >= 0
+    D_JMP(constant, false, false, 0, 7),         // 0047 JPD A > 0
+    D_MISC(true, 1),                             // 0050 HALT
+    D_SHIFT(right_shift, 1, 1),                  // 0051 SFTR 1 B
+    D_BIT(false, 0, 5),                          // 0052 SET 0 5
+    D_JMP(memory, false, false, 0, 3),           // 0053 JPI A != 0
+    D_JMP(memory, false, false, 0, 4),           // 0054 JPI A == 0
+    D_JMP(memory, false, false, 0, 5),           // 0055 JPI A < 0
+    D_JMP(memory, false, false, 0, 6),           // 0056 JPI A >= 0
+    D_JMP(memory, false, false, 0, 7),           // 0057 JPI A > 0
+    D_MISC(true, 1),                             // 0060 HALT
+    D_SHIFT(right_shift, 2, 1),                  // 0061 SFTR 2 B
+    D_BIT(false, 0, 6),                          // 0062 SET 0 6
+    D_JMP(constant, true, false, 0, 3),          // 0063 JMD A != 0
+    D_JMP(constant, true, false, 0, 4),          // 0064 JMD A == 0
+    D_JMP(constant, true, false, 0, 5),          // 0065 JMD A < 0
+    D_JMP(constant, true, false, 0, 6),          // 0066 JMD A >= 0
+    D_JMP(constant, true, false, 0, 7),          // 0067 JMD A > 0
+    D_MISC(true, 1),                             // 0070 HALT
+    D_SHIFT(right_shift, 3, 1),                  // 0071 SFTR 3 B
+    D_BIT(false, 0, 7),                          // 0072 SET 0 7
+    D_JMP(memory, true, false, 0, 3),            // 0073 JMI A != 0
+    D_JMP(memory, true, false, 0, 4),            // 0074 JMI A == 0
+    D_JMP(memory, true, false, 0, 5),            // 0075 JMI A < 0
+    D_JMP(memory, true, false, 0, 6),            // 0076 JMI A >= 0
+    D_JMP(memory, true, false, 0, 7),            // 0077 JMI A > 0
+    D_MISC(false, 0),                            // 0100 NOOP
+    D_SHIFT(right_rot, 4, 0),                    // 0101 ROTR 4 A
+    D_BIT(false, 1, 0),                          // 0102 SET 1 0
+    D_REG(add, constant, 1),                     // 0103 ADD-B constant
+    D_REG(add, memory, 1),                       // 0104 ADD-B memory
+    D_REG(add, indirect, 1),                     // 0105 ADD-B indirect
+    D_REG(add, indexed, 1),                      // 0106 ADD-B indexed
+    D_REG(add, indirect_indexed, 1),             // 0107 ADD-B indirect indexed
+    D_MISC(false, 0),                            // 0110 NOOP
+    D_SHIFT(right_rot, 1, 0),                    // 0111 ROTR 1 A
+    D_BIT(false, 1, 1),                          // 0112 SET 1 1
+    D_REG(sub, constant, 1),                     // 0113 SUB-B constant
+    D_REG(sub, memory, 1),                       // 0114 SUB-B memory
+    D_REG(sub, indirect, 1),                     // 0115 SUB-B indirect
+    D_REG(sub, indexed, 1),                      // 0116 SUB-B indexed
+    D_REG(sub, indirect_indexed, 1),             // 0117 SUB-B indirect indexed
+    D_MISC(false, 0),                            // 0120 NOOP
+    D_SHIFT(right_rot, 2, 0),                    // 0121 ROTR 2 A
+    D_BIT(false, 1, 2),                          // 0122 SET 1 2
+    D_REG(load, constant, 1),                    // 0123 LOAD-B constant
+    D_REG(load, memory, 1),                      // 0124 LOAD-B memory
+    D_REG(load, indirect, 1),                    // 0125 LOAD-B indirect
+    D_REG(load, indexed, 1),                     // 0126 LOAD-B indexed
+    D_REG(load, indirect_indexed, 1),            // 0127 LOAD-B indirect indexed
+    D_MISC(false, 0),                            // 0130 NOOP
+    D_SHIFT(right_rot, 3, 0),                    // 0131 ROTR 3 A
+    D_BIT(false, 1, 3),                          // 0132 SET 1 3
+    D_REG(store, constant, 1),                   // 0133 STORE-B constant
+    D_REG(store, memory, 1),                     // 0134 STORE-B memory
+    D_REG(store, indirect, 1),                   // 0135 STORE-B indirect
+    D_REG(store, indexed, 1),                    // 0136 STORE-B indexed
+    D_REG(store, indirect_indexed, 1),           // 0137 STORE-B indirect indexed
+    D_MISC(false, 1),                            // 0140 NOOP
+    D_SHIFT(right_rot, 4, 1),                    // 0141 ROTR 4 B
+    D_BIT(false, 1, 4),                          // 0142 SET 1 4
+    D_JMP(constant, false, false, 1, 3),         // 0143 JPD B != 0
+    D_JMP(constant, false, false, 1, 4),         // 0144 JPD B == 0
+    D_JMP(constant, false, false, 1, 5),         // 0145 JPD B < 0
+    D_JMP(constant, false, false, 1, 6),         // 0146 JPD B >= 0
+    D_JMP(constant, false, false, 1, 7),         // 0147 JPD B > 0
+    D_MISC(false, 1),                            // 0150 NOOP
+    D_SHIFT(right_rot, 1, 1),                    // 0151 ROTR 1 B
+    D_BIT(false, 1, 5),                          // 0152 SET 1 5
+    D_JMP(memory, false, false, 1, 3),           // 0153 JPI B != 0
+    D_JMP(memory, false, false, 1, 4),           // 0154 JPI B == 0
+    D_JMP(memory, false, false, 1, 5),           // 0155 JPI B < 0
+    D_JMP(memory, false, false, 1, 6),           // 0156 JPI B >= 0
+    D_JMP(memory, false, false, 1, 7),           // 0157 JPI B > 0
+    D_MISC(false, 1),                            // 0160 NOOP
+    D_SHIFT(right_rot, 2, 1),                    // 0161 ROTR 2 B
+    D_BIT(false, 1, 6),                          // 0162 SET 1 6
+    D_JMP(constant, true, false, 1, 3),          // 0163 JMD B != 0
+    D_JMP(constant, true, false, 1, 4),          // 0164 JMD B == 0
+    D_JMP(constant, true, false, 1, 5),          // 0165 JMD B < 0
+    D_JMP(constant, true, false, 1, 6),          // 0166 JMD B >= 0
+    D_JMP(constant, true, false, 1, 7),          // 0167 JMD B > 0
+    D_MISC(false, 1),                            // 0170 NOOP
+    D_SHIFT(right_rot, 3, 1),                    // 0171 ROTR 3 B
+    D_BIT(false, 1, 7),                          // 0172 SET 1 7
+    D_JMP(memory, true, false, 1, 3),            // 0173 JMI B != 0
+    D_JMP(memory, true, false, 1, 4),            // 0174 JMI B == 0
+    D_JMP(memory, true, false, 1, 5),            // 0175 JMI B < 0
+    D_JMP(memory, true, false, 1, 6),            // 0176 JMI B >= 0
+    D_JMP(memory, true, false, 1, 7),            // 0177 JMI B > 0
+    D_MISC(false, 0),                            // 0200 NOOP
+    D_SHIFT(left_shift, 4, 0),                   // 0201 SFTL 4 A
+    D_BIT(true, 0, 0),                           // 0202 SKP 0 0
+    D_REG(add, constant, 2),                     // 0203 ADD-X constant
+    D_REG(add, memory, 2),                       // 0204 ADD-X memory
+    D_REG(add, indirect, 2),                     // 0205 ADD-X indirect
+    D_REG(add, indexed, 2),                      // 0206 ADD-X indexed
+    D_REG(add, indirect_indexed, 2),             // 0207 ADD-X indirect indexed
+    D_MISC(false, 0),                            // 0210 NOOP
+    D_SHIFT(left_shift, 1, 0),                   // 0211 SFTL 1 A
+    D_BIT(true, 0, 1),                           // 0212 SKP 0 1
+    D_REG(sub, constant, 2),                     // 0213 SUB-X constant
+    D_REG(sub, memory, 2),                       // 0214 SUB-X memory
+    D_REG(sub, indirect, 2),                     // 0215 SUB-X indirect
+    D_REG(sub, indexed, 2),                      // 0216 SUB-X indexed
+    D_REG(sub, indirect_indexed, 2),             // 0217 SUB-X indirect indexed
+    D_MISC(false, 0),                            // 0220 NOOP
+    D_SHIFT(left_shift, 2, 0),                   // 0221 SFTL 2 A
+    D_BIT(true, 0, 2),                           // 0222 SKP 0 2
+    D_REG(load, constant, 2),                    // 0223 LOAD-X constant
+    D_REG(load, memory, 2),                      // 0224 LOAD-X memory
+    D_REG(load, indirect, 2),                    // 0225 LOAD-X indirect
+    D_REG(load, indexed, 2),                     // 0226 LOAD-X indexed
+    D_REG(load, indirect_indexed, 2),            // 0227 LOAD-X indirect indexed
+    D_MISC(false, 0),                            // 0230 NOOP
+    D_SHIFT(left_shift, 3, 0),                   // 0231 SFTL 3 A
+    D_BIT(true, 0, 3),                           // 0232 SKP 0 3
+    D_REG(store, constant, 2),                   // 0233 STORE-X constant
+    D_REG(store, memory, 2),                     // 0234 STORE-X memory
+    D_REG(store, indirect, 2),                   // 0235 STORE-X indirect
+    D_REG(store, indexed, 2),                    // 0236 STORE-X indexed
+    D_REG(store, indirect_indexed, 2),           // 0237 STORE-X indirect indexed
+    D_MISC(false, 1),                            // 0240 NOOP
+    D_SHIFT(left_shift, 4, 1),                   // 0241 SFTL 4 B
+    D_BIT(true, 0, 4),                           // 0242 SKP 0 4
+    D_JMP(constant, false, false, 2, 3),         // 0243 JPD X != 0
+    D_JMP(constant, false, false, 2, 4),         // 0244 JPD X == 0
+    D_JMP(constant, false, false, 2, 5),         // 0245 JPD X < 0
+    D_JMP(constant, false, false, 2, 6),         // 0246 JPD X >= 0
+    D_JMP(constant, false, false, 2, 7),         // 0247 JPD X > 0
+    D_MISC(false, 1),                            // 0250 NOOP
+    D_SHIFT(left_shift, 1, 1),                   // 0251 SFTL 1 B
+    D_BIT(true, 0, 5),                           // 0252 SKP 0 5
+    D_JMP(memory, false, false, 2, 3),           // 0253 JPI X != 0
+    D_JMP(memory, false, false, 2, 4),           // 0254 JPI X == 0
+    D_JMP(memory, false, false, 2, 5),           // 0255 JPI X < 0
+    D_JMP(memory, false, false, 2, 6),           // 0256 JPI X >= 0
+    D_JMP(memory, false, false, 2, 7),           // 0257 JPI X > 0
+    D_MISC(false, 1),                            // 0260 NOOP
+    D_SHIFT(left_shift, 2, 1),                   // 0261 SFTL 2 B
+    D_BIT(true, 0, 6),                           // 0262 SKP 0 6
+    D_JMP(constant, true, false, 2, 3),          // 0263 JMD X != 0
+    D_JMP(constant, true, false, 2, 4),          // 0264 JMD X == 0
+    D_JMP(constant, true, false, 2, 5),          // 0265 JMD X < 0
+    D_JMP(constant, true, false, 2, 6),          // 0266 JMD X >= 0
+    D_JMP(constant, true, false, 2, 7),          // 0267 JMD X > 0
+    D_MISC(false, 1),                            // 0270 NOOP
+    D_SHIFT(left_shift, 3, 1),                   // 0271 SFTL 3 B
+    D_BIT(true, 0, 7),                           // 0272 SKP 0 7
+    D_JMP(memory, true, false, 2, 3),            // 0273 JMI X != 0
+    D_JMP(memory, true, false, 2, 4),            // 0274 JMI X == 0
+    D_JMP(memory, true, false, 2, 5),            // 0275 JMI X < 0
+    D_JMP(memory, true, false, 2, 6),            // 0276 JMI X >= 0
+    D_JMP(memory, true, false, 2, 7),            // 0277 JMI X > 0
+    D_MISC(false, 0),                            // 0300 NOOP
+    D_SHIFT(left_rot, 4, 0),                     // 0301 ROTL 4 A
+    D_BIT(true, 1, 0),                           // 0302 SKP 1 0
+    D_REG(or, constant, 0),                      // 0303 OR constant
+    D_REG(or, memory, 0),                        // 0304 OR memory
+    D_REG(or, indirect, 0),                      // 0305 OR indirect
+    D_REG(or, indexed, 0),                       // 0306 OR indexed
+    D_REG(or, indirect_indexed, 0),              // 0307 OR indirect indexed
+    D_MISC(false, 0),                            // 0310 NOOP
+    D_SHIFT(left_rot, 1, 0),                     // 0311 ROTL 1 A
+    D_BIT(true, 1, 1),                           // 0312 SKP 1 1
+    D_MISC(false, 0),                            // 0313 NOOP
+    D_MISC(false, 0),                            // 0314 NOOP
+    D_MISC(false, 0),                            // 0315 NOOP
+    D_MISC(false, 0),                            // 0316 NOOP
+    D_MISC(false, 0),                            // 0317 NOOP
+    D_MISC(false, 0),                            // 0320 NOOP
+    D_SHIFT(left_rot, 2, 0),                     // 0321 ROTL 2 A
+    D_BIT(true, 1, 2),                           // 0322 SKP 1 2
+    D_REG(and, constant, 0),                     // 0323 AND constant
+    D_REG(and, memory, 0),                       // 0324 AND memory
+    D_REG(and, indirect, 0),                     // 0325 AND indirect
+    D_REG(and, indexed, 0),                      // 0326 AND indexed
+    D_REG(and, indirect_indexed, 0),             // 0327 AND indirect indexed
+    D_MISC(false, 0),                            // 0330 NOOP
+    D_SHIFT(left_rot, 3, 0),                     // 0331 ROTL 3 A
+    D_BIT(true, 1, 3),                           // 0332 SKP 1 3
+    D_REG(lneg, constant, 0),                    // 0333 LNEG constant
+    D_REG(lneg, memory, 0),                      // 0334 LNEG memory
+    D_REG(lneg, indirect, 0),                    // 0335 LNEG indirect
+    D_REG(lneg, indexed, 0),                     // 0336 LNEG indexed
+    D_REG(lneg, indirect_indexed, 0),            // 0337 LNEG indirect indexed
+    D_MISC(false, 1),                            // 0340 NOOP
+    D_SHIFT(left_rot, 4, 1),                     // 0341 ROTL 4 B
+    D_BIT(true, 1, 4),                           // 0342 SKP 1 4
+    D_JMP(constant, false, true, 0, 3),          // 0343 JPD Unc.
+    D_JMP(constant, false, true, 0, 4),          // 0344 JPD Unc.
+    D_JMP(constant, false, true, 0, 5),          // 0345 JPD Unc.
+    D_JMP(constant, false, true, 0, 6),          // 0346 JPD Unc.
+    D_JMP(constant, false, true, 0, 7),          // 0347 JPD Unc.
+    D_MISC(false, 1),                            // 0350 NOOP
+    D_SHIFT(left_rot, 1, 1),                     // 0351 ROTL 1 B
+    D_BIT(true, 1, 5),                           // 0352 SKP 1 5
+    D_JMP(memory, false, true, 0, 3),            // 0353 JPI Unc.
+    D_JMP(memory, false, true, 0, 4),            // 0354 JPI Unc.
+    D_JMP(memory, false, true, 0, 5),            // 0355 JPI Unc.
+    D_JMP(memory, false, true, 0, 6),            // 0356 JPI Unc.
+    D_JMP(memory, false, true, 0, 7),            // 0357 JPI Unc.
+    D_MISC(false, 1),                            // 0360 NOOP
+    D_SHIFT(left_rot, 2, 1),                     // 0361 ROTL 2 B
+    D_BIT(true, 1, 6),                           // 0362 SKP 1 6
+    D_JMP(constant, true, true, 0, 3),           // 0363 JMD Unc.
+    D_JMP(constant, true, true, 0, 4),           // 0364 JMD Unc.
+    D_JMP(constant, true, true, 0, 5),           // 0365 JMD Unc.
+    D_JMP(constant, true, true, 0, 6),           // 0366 JMD Unc.
+    D_JMP(constant, true, true, 0, 7),           // 0367 JMD Unc.
+    D_MISC(false, 1),                            // 0370 NOOP
+    D_SHIFT(left_rot, 3, 1),                     // 0371 ROTL 3 B
+    D_BIT(true, 1, 7),                           // 0372 SKP 1 7
+    D_JMP(memory, true, true, 0, 3),             // 0373 JMI Unc.
+    D_JMP(memory, true, true, 0, 4),             // 0374 JMI Unc.
+    D_JMP(memory, true, true, 0, 5),             // 0375 JMI Unc.
+    D_JMP(memory, true, true, 0, 6),             // 0376 JMI Unc.
+    D_JMP(memory, true, true, 0, 7),             // 0377 JMI Unc.
+};
+
+#undef D_MISC
+#undef D_SHIFT
+#undef D_BIT
+#undef D_REG
+#undef D_JMP
+
 enum kenbak_addr_mode kenbak_instr_get_addr_mode(uint8_t const first_byte)
 {
-    if(!KENBAK_INSTR_IS_TWO_BYTE(first_byte))
-    {
-        // Shift/rotate or miscellaneous (halt, noop).
-
-        return kenbak_addr_mode_none;
-    }
-
-    // Two-byte instruction.
-
-    if(KENBAK_INSTR_IS_BIT(first_byte))
-    {
-        return kenbak_addr_mode_memory; // Bit test or manipulation instruction.
-    }
-
-    uint8_t const mid_sign_oct = 7 & (first_byte >> 3);
-
-    if(3 < mid_sign_oct)
-    {
-        // Jump instruction.
-
-        if(mid_sign_oct % 2 == 0)
-        {
-            // Direct addressing.
-
-            return kenbak_addr_mode_constant/*kenbak_addr_mode_memory*/;
-        }
-
-        // Indirect addressing.
-
-        return kenbak_addr_mode_memory/*kenbak_addr_mode_indirect*/;
-    }
-
-    // Add/sub/load/store or or/and/lneg instruction.
-
-    return KENBAK_INSTR_ASLS_OAL_ADDR_MODE(first_byte);
+    return (enum kenbak_addr_mode)KENBAK_INSTR_DECODE(first_byte)->addr_mode;
 }
 
 /**
- * - Can be performance-improved by using a LUT.
- * - Detail may be expanded in the future, if necessary.
+ * - Detail may be expanded in the future, if necessary (see
+ *   kenbak_instr_decoded_table).
  */
 enum kenbak_instr_type kenbak_instr_get_type(uint8_t const first_byte)
 {
-    if(KENBAK_INSTR_IS_031X_NOOP(first_byte))
-    {
-        return kenbak_instr_type_misc;
-    }
-
-    uint8_t const least_sign_oct = 7 & first_byte;
-
-    switch(least_sign_oct)
-    {
-        case 0:
-        {
-            return kenbak_instr_type_misc;
-        }
-        case 1:
-        {
-            return kenbak_instr_type_shift_rot;
-        }
-        case 2:
-        {
-            return kenbak_instr_type_bit;
-        }
-
-        default:
-        {
-            assert(3 <= least_sign_oct && least_sign_oct <= 7); // Stupid..
-
-            uint8_t const mid_sign_oct = 7 & (first_byte >> 3);
-
-            if(3 < mid_sign_oct)
-            {
-                return kenbak_instr_type_jump;
-            }
-
-            uint8_t const most_sign_oct = 7 & (first_byte >> 6);
-
-            if(most_sign_oct == 3)
-            {
-                switch(mid_sign_oct)
-                {
-                    case 0:
-                    {
-                        return kenbak_instr_type_or;
-                    }
-                    case 1:
-                    {
-                        return kenbak_instr_type_misc; // NOOP!
-                    }
-                    case 2:
-                    {
-                        return kenbak_instr_type_and;
-                    }
-                    case 3:
-                    {
-                        return kenbak_instr_type_lneg;
-                    }
-
-                    default:
-                    {
-                        assert(false); // Cannot get here.
-                        return kenbak_instr_type_invalid;
-                    }
-                }
-            }
-
-            switch(mid_sign_oct)
-            {
-                case 0:
-                {
-                    return kenbak_instr_type_add;
-                }
-                case 1:
-                {
-                    return kenbak_instr_type_sub;
-                }
-                case 2:
-                {
-                    return kenbak_instr_type_load;
-                }
-                case 3:
-                {
-                    return kenbak_instr_type_store;
-                }
-
-                default:
-                {
-                    assert(false); // Cannot get here.
-                    return kenbak_instr_type_invalid;
-                }
-            }
-        }
-    }
+    return (enum kenbak_instr_type)KENBAK_INSTR_DECODE(first_byte)->type;
 }
 
 bool kenbak_instr_fill_str(
@@ -169,7 +333,8 @@ bool kenbak_instr_fill_str(
     //    return false;
     //}
 
-    enum kenbak_instr_type const instr_type = kenbak_instr_get_type(first_byte);
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(first_byte);
     char second_byte_oct[3 + 1];
 
     mt_str_fill_with_octal(
@@ -179,7 +344,7 @@ bool kenbak_instr_fill_str(
 
     // TODO: Improve the following:
     //
-    switch(instr_type)
+    switch((enum kenbak_instr_type)dec->type)
     {
         case kenbak_instr_type_add: snprintf(buf, buf_len,          "ADD             "); break;
         case kenbak_instr_type_sub: snprintf(buf, buf_len,          "SUB             "); break;
@@ -192,45 +357,45 @@ bool kenbak_instr_fill_str(
 
         case kenbak_instr_type_jump:
         {
-            bool is_unc = false,
-                is_ind = false;
+            // Indirect jumps have the memory addressing mode, see
+            // kenbak_instr_decoded_table:
+            //
+            bool const is_ind = dec->addr_mode == kenbak_addr_mode_memory;
 
-            switch(7 & (first_byte >> 3))
+            if(dec->jmp_is_mark)
             {
-                case 4: snprintf(buf, buf_len,                      "JPD             "); break;
-                case 5: snprintf(buf, buf_len,                      "JPI             "); is_ind = true; break;
-                case 6: snprintf(buf, buf_len,                      "JMD             "); break;
-                case 7: snprintf(buf, buf_len,                      "JMI             "); is_ind = true; break;
-
-                default:
-                {
-                    assert(false);
-                    return false;
-                }
+                snprintf(buf, buf_len, is_ind ?                     "JMI             " : "JMD             ");
+            }
+            else
+            {
+                snprintf(buf, buf_len, is_ind ?                     "JPI             " : "JPD             ");
             }
 
-            switch(3 & (first_byte >> 6)) // TODO: buf_len - 4 is theoretically dangerous!
+            if(dec->jmp_is_unc) // TODO: buf_len - 4 is theoretically dangerous!
+            {
+                snprintf(buf + 4, buf_len - 4,                          "Unc.        ");
+            }
+            else
             {
-                case 0: snprintf(buf + 4, buf_len - 4,                  "A           "); break;
-                case 1: snprintf(buf + 4, buf_len - 4,                  "B           "); break;
-                case 2: snprintf(buf + 4, buf_len - 4,                  "X           "); break;
-                case 3: snprintf(buf + 4, buf_len - 4,                  "Unc.        "); is_unc = true; break;
-                default:
+                switch(dec->reg) // TODO: buf_len - 4 is theoretically dangerous!
                 {
-                    assert(false);
-                    return false;
+                    case 0: snprintf(buf + 4, buf_len - 4,              "A           "); break;
+                    case 1: snprintf(buf + 4, buf_len - 4,              "B           "); break;
+                    case 2: snprintf(buf + 4, buf_len - 4,              "X           "); break;
+                    default:
+                    {
+                        assert(false);
+                        return false;
+                    }
                 }
-            }
 
-            if(!is_unc)
-            {
-                switch(7 & first_byte) // TODO: buf_len - 4 - 2 is theoretically dangerous!
+                switch((enum kenbak_jmp_cond)dec->jmp_cond) // TODO: buf_len - 4 - 2 is theoretically dangerous!
                 {
-                    case 3: snprintf(buf + 4 + 2, buf_len - 4 - 2,        "!= 0      "); break;
-                    case 4: snprintf(buf + 4 + 2, buf_len - 4 - 2,        "== 0      "); break;
-                    case 5: snprintf(buf + 4 + 2, buf_len - 4 - 2,        "< 0       "); break;
-                    case 6: snprintf(buf + 4 + 2, buf_len - 4 - 2,        ">= 0      "); break;
-                    case 7: snprintf(buf + 4 + 2, buf_len - 4 - 2,        "> 0       "); break;
+                    case kenbak_jmp_cond_non_zero: snprintf(buf + 4 + 2, buf_len - 4 - 2,        "!= 0      "); break;
+                    case kenbak_jmp_cond_zero: snprintf(buf + 4 + 2, buf_len - 4 - 2,            "== 0      "); break;
+                    case kenbak_jmp_cond_neg: snprintf(buf + 4 + 2, buf_len - 4 - 2,             "< 0       "); break;
+                    case kenbak_jmp_cond_pos: snprintf(buf + 4 + 2, buf_len - 4 - 2,             ">= 0      "); break;
+                    case kenbak_jmp_cond_pos_non_zero: snprintf(buf + 4 + 2, buf_len - 4 - 2,    "> 0       "); break;
 
                     default:
                     {
@@ -8,6 +8,7 @@
 #include <stdbool.h>
 
 #include "kenbak_addr_mode.h"
+#include "kenbak_jmp_cond.h"
 
 // See PRM, page 24:
 //
@@ -80,6 +81,54 @@ enum kenbak_instr_type
     kenbak_instr_type_misc      = 0000  // HALT and NOOP.
 };
 
+// See PRM, page 12, the values equal the two most significant bits of the
+// shift and rotate instructions:
+//
+enum kenbak_instr_shift
+{
+    kenbak_instr_shift_right_shift = 0,
+    kenbak_instr_shift_right_rot = 1,
+    kenbak_instr_shift_left_shift = 2,
+    kenbak_instr_shift_left_rot = 3
+};
+
+// Everything that can be decoded from the first byte of an instruction.
+//
+// - Stored as bytes (instead of the enumerations) to keep the table small.
+//
+struct kenbak_instr_decoded
+{
+    uint8_t type; // enum kenbak_instr_type
+    uint8_t addr_mode; // enum kenbak_addr_mode, see kenbak_instr_get_addr_mode()
+    uint8_t len; // Instruction length in bytes (1 or 2).
+
+    // A, B or X register address to search for (see
+    // KENBAK_INSTR_ONE_BYTE_SEARCH_A_OR_B and
+    // KENBAK_INSTR_TWO_BYTE_SEARCH_A_B_OR_X):
+    //
+    uint8_t reg;
+
+    uint8_t jmp_cond; // enum kenbak_jmp_cond, jumps only.
+    bool jmp_is_unc; // Unconditional jump.
+    bool jmp_is_mark; // Jump and mark (JMD or JMI).
+
+    uint8_t shift_kind; // enum kenbak_instr_shift, shifts and rotates only.
+    uint8_t shift_places; // 1 to 4, shifts and rotates only.
+
+    uint8_t bit_pos; // 0 to 7, bit test and manipulation only.
+    bool bit_val; // The bit value to set or to skip on.
+    bool bit_is_skip; // SKP (otherwise SET).
+
+    bool is_halt;
+};
+
+// The decode table, indexed by the first byte of an instruction:
+//
+extern struct kenbak_instr_decoded const kenbak_instr_decoded_table[256];
+
+#define KENBAK_INSTR_DECODE(first_byte) \
+    (kenbak_instr_decoded_table + (uint8_t)(first_byte))
+
 enum kenbak_addr_mode kenbak_instr_get_addr_mode(uint8_t const first_byte);
 
 enum kenbak_instr_type kenbak_instr_get_type(uint8_t const first_byte);
@@ -0,0 +1,1255 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#if !defined(_MSC_VER) && !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE // For mmap()'s MAP_ANONYMOUS.
+#endif //!defined(_MSC_VER) && !defined(_DEFAULT_SOURCE)
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kenbak_jit.h"
+#include "kenbak_code.h"
+
+#ifdef KENBAK_JIT_AVAILABLE
+
+#ifdef _MSC_VER
+    #include <windows.h>
+#else //_MSC_VER
+    #include <sys/mman.h>
+#endif //_MSC_VER
+
+#include "kenbak_data.h"
+#include "kenbak_instr.h"
+#include "kenbak_sig.h"
+#include "kenbak_jmp_cond.h"
+#include "kenbak_addr_mode.h"
+
+// The memory reserved for the native code, enough for a block at each
+// possible start address, committed page by page when needed:
+//
+#define KENBAK_JIT_CODE_SIZE \
+    ((size_t)KENBAK_CODE_ADDR_COUNT * KENBAK_JIT_MAX_BLOCK_SIZE)
+
+#define KENBAK_JIT_PAGE_SIZE 4096 // (x86-64)
+#define KENBAK_JIT_ALIGN 16 // Start of each block's native code.
+
+struct kenbak_jit
+{
+    // The native code of the blocks, one after the other (read-only and
+    // executable, except while a block's code gets copied in):
+    //
+    uint8_t * code;
+    size_t len; // Bytes used.
+
+    // The generation of the code cache the native code belongs to (see
+    // struct kenbak_code_cache), on a new one, the memory gets reused:
+    //
+    uint32_t gen;
+
+    // A block's native code gets emitted here, first:
+    //
+    uint8_t buf[KENBAK_JIT_MAX_BLOCK_SIZE];
+};
+
+// The registers used by the native code (by their encodings):
+//
+// - RBX: The Kenbak-1 (struct kenbak_data).
+// - RBP: W (zero-extended).
+// - R12: The count of instructions taken.
+// - R13: The code cache.
+// - R14: The struct kenbak_jit_run.
+// - R15: The count of steps taken.
+// - RAX, RCX & RDX: Scratch (RCX holds a computed address, RDX a byte to be
+//   written), preserved while the code cache gets invalidated.
+//
+enum reg
+{
+    reg_ax = 0,
+    reg_cx = 1,
+    reg_dx = 2,
+    reg_bp = 5
+};
+
+// Condition codes of the jumps used:
+//
+enum cond
+{
+    cond_e = 4, // Equal (zero).
+    cond_ne = 5, // Not equal (not zero).
+    cond_a = 7 // Above.
+};
+
+#define KENBAK_JIT_OFF(field) ((uint32_t)offsetof(struct kenbak_data, field))
+#define KENBAK_JIT_OFF_MEM(addr) (KENBAK_JIT_OFF(mem) + (uint32_t)(addr))
+
+// Emits the given bytes:
+//
+#define KENBAK_JIT_EMIT(e, ...) \
+    emit_bytes( \
+        (e), \
+        (uint8_t const[]){ __VA_ARGS__ }, \
+        (int)sizeof ((uint8_t const[]){ __VA_ARGS__ }))
+
+// The native code of a block being emitted (into the JIT's buffer):
+//
+struct emitter
+{
+    uint8_t * buf;
+    int len;
+    bool overflow; // Ran out of space (the code is not usable).
+
+    // The block's first instruction and the position of its code, if the
+    // block may continue with it after a jump or skip (loop), otherwise NULL:
+    //
+    struct kenbak_code_instr const * loop_instr;
+    int loop_entry;
+};
+
+// Where the next instruction is (see emit_instr_end()):
+//
+enum instr_next
+{
+    instr_next_follows = 0, // Next in the block.
+    instr_next_any = 1, // Anywhere (the block ends).
+    instr_next_none = 2 // HALT.
+};
+
+// What the end of an instruction's native code has to store, besides W (see
+// emit_instr_end()):
+//
+struct instr_end
+{
+    uint8_t first_byte; // I, if not stored while executing.
+    bool is_reg_i_stored;
+
+    int sig_r; // Constant R, or -1, if stored while executing.
+    int sig_inc; // Constant increment of P, or -1, if stored while executing.
+
+    int steps; // Count of states passed (each lasts one byte time).
+};
+
+// *****************************************************************************
+// *** ENCODING                                                              ***
+// *****************************************************************************
+
+static void emit_bytes(
+    struct emitter * const e, uint8_t const * const bytes, int const count)
+{
+    if(KENBAK_JIT_MAX_BLOCK_SIZE - e->len < count)
+    {
+        e->overflow = true;
+        return;
+    }
+    for(int i = 0; i < count; ++i)
+    {
+        e->buf[e->len++] = bytes[i];
+    }
+}
+
+static void emit_u32(struct emitter * const e, uint32_t const val)
+{
+    KENBAK_JIT_EMIT(
+        e,
+        (uint8_t)val,
+        (uint8_t)(val >> 8),
+        (uint8_t)(val >> 16),
+        (uint8_t)(val >> 24));
+}
+
+static void emit_u64(struct emitter * const e, uint64_t const val)
+{
+    emit_u32(e, (uint32_t)val);
+    emit_u32(e, (uint32_t)(val >> 32));
+}
+
+/** movzx <reg>, byte [rbx + <disp>]
+ */
+static void emit_load(
+    struct emitter * const e, enum reg const reg, uint32_t const disp)
+{
+    KENBAK_JIT_EMIT(e, 0x0F, 0xB6, 0x83 | reg << 3);
+    emit_u32(e, disp);
+}
+
+/** movzx <reg>, byte [rbx + rcx + <disp>]
+ */
+static void emit_load_at_cx(
+    struct emitter * const e, enum reg const reg, uint32_t const disp)
+{
+    KENBAK_JIT_EMIT(e, 0x0F, 0xB6, 0x84 | reg << 3, 0x0B);
+    emit_u32(e, disp);
+}
+
+/** mov byte [rbx + <disp>], <reg> (AL, CL or DL)
+ */
+static void emit_store(
+    struct emitter * const e, uint32_t const disp, enum reg const reg)
+{
+    KENBAK_JIT_EMIT(e, 0x88, 0x83 | reg << 3);
+    emit_u32(e, disp);
+}
+
+/** mov byte [rbx + rcx + <disp>], <reg> (AL or DL)
+ */
+static void emit_store_at_cx(
+    struct emitter * const e, uint32_t const disp, enum reg const reg)
+{
+    KENBAK_JIT_EMIT(e, 0x88, 0x84 | reg << 3, 0x0B);
+    emit_u32(e, disp);
+}
+
+/** mov byte [rbx + <disp>], <val>
+ */
+static void emit_store_imm(
+    struct emitter * const e, uint32_t const disp, uint8_t const val)
+{
+    KENBAK_JIT_EMIT(e, 0xC6, 0x83);
+    emit_u32(e, disp);
+    KENBAK_JIT_EMIT(e, val);
+}
+
+/** mov <reg>, <val>
+ */
+static void emit_mov_imm(
+    struct emitter * const e, enum reg const reg, uint32_t const val)
+{
+    KENBAK_JIT_EMIT(e, 0xB8 + reg);
+    emit_u32(e, val);
+}
+
+/** mov <dst>, <src> (32 bits)
+ */
+static void emit_mov(
+    struct emitter * const e, enum reg const dst, enum reg const src)
+{
+    KENBAK_JIT_EMIT(e, 0x89, 0xC0 | src << 3 | dst);
+}
+
+/** movzx ebp, al
+ */
+static void emit_w_from_al(struct emitter * const e)
+{
+    KENBAK_JIT_EMIT(e, 0x0F, 0xB6, 0xE8);
+}
+
+/** j<cond> <target> (rel32, target is an offset into the block's code)
+ */
+static void emit_jcc(
+    struct emitter * const e, enum cond const cond, int const target)
+{
+    KENBAK_JIT_EMIT(e, 0x0F, 0x80 | cond);
+    emit_u32(e, (uint32_t)(target - (e->len + 4)));
+}
+
+/** jmp <target> (rel32, target is an offset into the block's code)
+ */
+static void emit_jmp(struct emitter * const e, int const target)
+{
+    KENBAK_JIT_EMIT(e, 0xE9);
+    emit_u32(e, (uint32_t)(target - (e->len + 4)));
+}
+
+/** j<cond> to a label that follows (rel32), returns the position to be given
+ *  to patch_jcc() at the label.
+ */
+static int emit_jcc_forward(struct emitter * const e, enum cond const cond)
+{
+    KENBAK_JIT_EMIT(e, 0x0F, 0x80 | cond);
+    emit_u32(e, 0);
+    return e->len;
+}
+
+static void patch_jcc(struct emitter * const e, int const pos)
+{
+    if(e->overflow)
+    {
+        return;
+    }
+
+    uint32_t const rel = (uint32_t)(e->len - pos);
+
+    e->buf[pos - 4] = (uint8_t)rel;
+    e->buf[pos - 3] = (uint8_t)(rel >> 8);
+    e->buf[pos - 2] = (uint8_t)(rel >> 16);
+    e->buf[pos - 1] = (uint8_t)(rel >> 24);
+}
+
+/** j<cond> to a label that follows closely (rel8), returns the position to be
+ *  given to patch_jcc_short() at the label.
+ */
+static int emit_jcc_short(struct emitter * const e, enum cond const cond)
+{
+    KENBAK_JIT_EMIT(e, 0x70 | cond, 0);
+    return e->len;
+}
+
+static void patch_jcc_short(struct emitter * const e, int const pos)
+{
+    if(e->overflow)
+    {
+        return;
+    }
+    assert(e->len - pos <= 127);
+    e->buf[pos - 1] = (uint8_t)(e->len - pos);
+}
+
+// *****************************************************************************
+// *** MEMORY                                                                ***
+// *****************************************************************************
+
+/** Emits the call of kenbak_code_invalidate() for the code cache in R13,
+ *  preserving RAX, RCX and RDX.
+ */
+static void emit_invalidate(struct emitter * const e)
+{
+    void (* const fn)(struct kenbak_code_cache * const) =
+        kenbak_code_invalidate;
+
+    KENBAK_JIT_EMIT(e, 0x50, 0x51, 0x52); // push rax, rcx & rdx
+    KENBAK_JIT_EMIT(e, 0x48, 0x83, 0xEC, 40); // sub rsp, 40 (+ shadow space)
+#ifdef _WIN32
+    KENBAK_JIT_EMIT(e, 0x4C, 0x89, 0xE9); // mov rcx, r13
+#else //_WIN32
+    KENBAK_JIT_EMIT(e, 0x4C, 0x89, 0xEF); // mov rdi, r13
+#endif //_WIN32
+    KENBAK_JIT_EMIT(e, 0x48, 0xB8); // mov rax, fn
+    emit_u64(e, (uint64_t)(uintptr_t)fn);
+    KENBAK_JIT_EMIT(e, 0xFF, 0xD0); // call rax
+    KENBAK_JIT_EMIT(e, 0x48, 0x83, 0xC4, 40); // add rsp, 40
+    KENBAK_JIT_EMIT(e, 0x5A, 0x59, 0x58); // pop rdx, rcx & rax
+}
+
+/** Writes the given register's byte to the given address, like mem_write()
+ *  does (without hashing and memoization).
+ */
+static void emit_write(
+    struct emitter * const e, uint8_t const addr, enum reg const val)
+{
+    if(addr == KENBAK_DATA_ADDR_OUTPUT)
+    {
+        KENBAK_JIT_EMIT(e, 0xFF, 0x83); // inc dword [rbx + output_write_count]
+        emit_u32(e, KENBAK_JIT_OFF(output_write_count));
+    }
+
+    // Self-modifying code:
+    //
+    KENBAK_JIT_EMIT(e, 0x41, 0x80, 0xBD); // cmp byte [r13 + is_code[addr]], 0
+    emit_u32(
+        e,
+        (uint32_t)offsetof(struct kenbak_code_cache, is_code) + addr);
+    KENBAK_JIT_EMIT(e, 0);
+    int const not_code = emit_jcc_short(e, cond_e);
+    emit_invalidate(e);
+    patch_jcc_short(e, not_code);
+
+    emit_store(e, KENBAK_JIT_OFF_MEM(addr), val);
+}
+
+/** Writes the given register's byte (AL or DL) to the address in CL, like
+ *  mem_write() does (without hashing and memoization).
+ */
+static void emit_write_at_cx(struct emitter * const e, enum reg const val)
+{
+    KENBAK_JIT_EMIT(e, 0x80, 0xF9, KENBAK_DATA_ADDR_OUTPUT); // cmp cl, output
+    int const not_output = emit_jcc_short(e, cond_ne);
+    KENBAK_JIT_EMIT(e, 0xFF, 0x83); // inc dword [rbx + output_write_count]
+    emit_u32(e, KENBAK_JIT_OFF(output_write_count));
+    patch_jcc_short(e, not_output);
+
+    // Self-modifying code:
+    //
+    KENBAK_JIT_EMIT(e, 0x41, 0x80, 0xBC, 0x0D); // cmp byte [r13 + rcx + ...
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_code_cache, is_code));
+    KENBAK_JIT_EMIT(e, 0); // ..., 0
+    int const not_code = emit_jcc_short(e, cond_e);
+    emit_invalidate(e);
+    patch_jcc_short(e, not_code);
+
+    emit_store_at_cx(e, KENBAK_JIT_OFF(mem), val);
+}
+
+/** R = W (stored at once, the address stays in RCX).
+ */
+static void emit_sig_r_from_w(
+    struct emitter * const e, struct instr_end * const end)
+{
+    emit_mov(e, reg_cx, reg_bp);
+    emit_store(e, KENBAK_JIT_OFF(sig_r), reg_cx);
+    end->sig_r = -1;
+}
+
+// *****************************************************************************
+// *** INSTRUCTIONS (SEE THE exec_*() FUNCTIONS IN kenbak_emu.c)             ***
+// *****************************************************************************
+
+/** Returns true, if there is native code for the given decoded instruction
+ *  (the same kinds as there are handlers of the threaded code for).
+ */
+static bool is_covered(struct kenbak_instr_decoded const * const dec)
+{
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
+
+    switch((enum kenbak_instr_type)dec->type)
+    {
+        case kenbak_instr_type_misc: // (falls through)
+        case kenbak_instr_type_shift_rot:
+        {
+            return dec->len == 1;
+        }
+        case kenbak_instr_type_bit:
+        {
+            return dec->len == 2;
+        }
+        case kenbak_instr_type_jump:
+        {
+            return dec->len == 2
+                && (addr_mode == kenbak_addr_mode_constant
+                    || addr_mode == kenbak_addr_mode_memory);
+        }
+        case kenbak_instr_type_store: // (falls through)
+        case kenbak_instr_type_add: // (falls through)
+        case kenbak_instr_type_sub: // (falls through)
+        case kenbak_instr_type_load: // (falls through)
+        case kenbak_instr_type_and: // (falls through)
+        case kenbak_instr_type_or: // (falls through)
+        case kenbak_instr_type_lneg:
+        {
+            return dec->len == 2
+                && (addr_mode == kenbak_addr_mode_constant
+                    || addr_mode == kenbak_addr_mode_memory
+                    || addr_mode == kenbak_addr_mode_indirect
+                    || addr_mode == kenbak_addr_mode_indexed
+                    || addr_mode == kenbak_addr_mode_indirect_indexed);
+        }
+
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+/** Leaves the block, if the budgets do not allow another instruction or P
+ *  does not point to the given (next) instruction.
+ */
+static void emit_instr_check(
+    struct emitter * const e, struct kenbak_code_instr const * const instr)
+{
+    KENBAK_JIT_EMIT(e, 0x4D, 0x3B, 0xBE); // cmp r15, [r14 + max_steps]
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_jit_run, max_steps));
+    emit_jcc(e, cond_a, 0);
+    KENBAK_JIT_EMIT(e, 0x4D, 0x3B, 0xA6); // cmp r12, [r14 + max_instrs]
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_jit_run, max_instrs));
+    emit_jcc(e, cond_a, 0);
+
+    emit_load(e, reg_ax, KENBAK_JIT_OFF_MEM(KENBAK_DATA_ADDR_P));
+    KENBAK_JIT_EMIT(e, 0x02, 0x83); // add al, [rbx + sig_inc]
+    emit_u32(e, KENBAK_JIT_OFF(sig_inc));
+    KENBAK_JIT_EMIT(e, 0x3C, instr->addr); // cmp al, addr
+    emit_jcc(e, cond_ne, 0);
+}
+
+/** Stores what the instruction did not store while executing, adds its counts
+ *  and leaves the block, if it ends (and does not continue with its start) or
+ *  the code cache got invalidated.
+ */
+static void emit_instr_end(
+    struct emitter * const e,
+    struct instr_end const * const end,
+    uint32_t const gen,
+    enum instr_next const next)
+{
+    emit_mov(e, reg_ax, reg_bp);
+    emit_store(e, KENBAK_JIT_OFF(reg_w), reg_ax);
+    if(!end->is_reg_i_stored)
+    {
+        emit_store_imm(e, KENBAK_JIT_OFF(reg_i), end->first_byte);
+    }
+    if(end->sig_r != -1)
+    {
+        emit_store_imm(e, KENBAK_JIT_OFF(sig_r), (uint8_t)end->sig_r);
+    }
+    if(end->sig_inc != -1)
+    {
+        emit_store_imm(e, KENBAK_JIT_OFF(sig_inc), (uint8_t)end->sig_inc);
+    }
+
+    KENBAK_JIT_EMIT(e, 0x49, 0x81, 0xC7); // add r15, steps
+    emit_u32(e, (uint32_t)end->steps);
+    KENBAK_JIT_EMIT(e, 0x49, 0xFF, 0xC4); // inc r12
+
+    if(next == instr_next_none
+        || (next == instr_next_any && e->loop_instr == NULL))
+    {
+        emit_jmp(e, 0);
+        return;
+    }
+
+    KENBAK_JIT_EMIT(e, 0x41, 0x81, 0xBD); // cmp dword [r13 + gen], gen
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_code_cache, gen));
+    emit_u32(e, gen);
+    emit_jcc(e, cond_ne, 0);
+
+    if(next == instr_next_any)
+    {
+        emit_instr_check(e, e->loop_instr);
+        emit_jmp(e, e->loop_entry);
+    }
+}
+
+/** SA to SD, see exec_instr_sa_sb() and exec_instr_sc_sd() (the input is
+ *  settled, so SA just latches the output into K, W gets the instruction's
+ *  address, as P is known to point to it).
+ */
+static void emit_sa_to_sd(
+    struct emitter * const e,
+    struct kenbak_code_instr const * const instr,
+    struct instr_end * const end)
+{
+    emit_load(e, reg_ax, KENBAK_JIT_OFF_MEM(KENBAK_DATA_ADDR_OUTPUT));
+    emit_store(e, KENBAK_JIT_OFF(reg_k), reg_ax);
+
+    emit_mov_imm(e, reg_dx, instr->addr);
+    emit_write(e, KENBAK_DATA_ADDR_P, reg_dx);
+    emit_mov_imm(e, reg_bp, instr->addr);
+
+    end->sig_r = instr->addr;
+    end->steps += 4;
+}
+
+/** SW, SX & SY, see exec_sw_sy().
+ */
+static void emit_sw_sy(
+    struct emitter * const e,
+    struct kenbak_instr_decoded const * const dec,
+    struct instr_end * const end)
+{
+    static uint8_t const ext[] = { // Indexed by enum kenbak_instr_shift.
+        5, // shr
+        1, // ror
+        4, // shl
+        0 // rol
+    };
+
+    emit_mov(e, reg_ax, reg_bp);
+    KENBAK_JIT_EMIT(
+        e, 0xC0, 0xC0 | ext[dec->shift_kind & 3] << 3, dec->shift_places);
+    emit_w_from_al(e);
+
+    emit_mov(e, reg_dx, reg_bp);
+    emit_write(e, dec->reg, reg_dx);
+    end->steps += 3;
+}
+
+/** SF & SG, see exec_sf_sg().
+ */
+static void emit_sf_sg(struct emitter * const e, struct instr_end * const end)
+{
+    emit_sig_r_from_w(e, end);
+    emit_load_at_cx(e, reg_bp, KENBAK_JIT_OFF(mem));
+    end->steps += 2;
+}
+
+/** SH & SJ, see exec_sh_sj().
+ */
+static void emit_sh_sj(struct emitter * const e, struct instr_end * const end)
+{
+    emit_mov(e, reg_ax, reg_bp);
+    KENBAK_JIT_EMIT(e, 0x02, 0x83); // add al, [rbx + mem[X]]
+    emit_u32(e, KENBAK_JIT_OFF_MEM(KENBAK_DATA_ADDR_X));
+    emit_w_from_al(e);
+    end->sig_r = KENBAK_DATA_ADDR_X;
+    end->steps += 2;
+}
+
+/** SK, see exec_sk().
+ */
+static void emit_sk(struct emitter * const e, struct instr_end * const end)
+{
+    emit_sig_r_from_w(e, end);
+    emit_load_at_cx(e, reg_bp, KENBAK_JIT_OFF(mem));
+    end->steps += 1;
+}
+
+/** SL for bit instructions, see exec_sl_bit() and exec_bit() (R is in RCX).
+ */
+static void emit_sl_bit(
+    struct emitter * const e,
+    struct kenbak_instr_decoded const * const dec,
+    struct instr_end * const end)
+{
+    uint8_t const mask = (uint8_t)(1 << dec->bit_pos);
+
+    end->steps += 1;
+
+    if(dec->bit_is_skip)
+    {
+        emit_store_imm(e, KENBAK_JIT_OFF(sig_inc), 2);
+        emit_mov(e, reg_ax, reg_bp);
+        KENBAK_JIT_EMIT(e, 0xA8, mask); // test al, mask
+        int const no_skip =
+            emit_jcc_short(e, dec->bit_val ? cond_e : cond_ne);
+        emit_store_imm(e, KENBAK_JIT_OFF(sig_inc), 4);
+        patch_jcc_short(e, no_skip);
+        end->sig_inc = -1;
+        return;
+    }
+
+    emit_mov(e, reg_ax, reg_bp);
+    if(dec->bit_val)
+    {
+        KENBAK_JIT_EMIT(e, 0x0C, mask); // or al, mask
+    }
+    else
+    {
+        KENBAK_JIT_EMIT(e, 0x24, (uint8_t)~mask); // and al, ~mask
+    }
+    emit_w_from_al(e);
+    emit_mov(e, reg_dx, reg_bp);
+    emit_write_at_cx(e, reg_dx);
+    end->sig_inc = 2;
+}
+
+/** SZ to the end of a jump, see exec_sz_jump(), leaves the block.
+ */
+static void emit_sz_jump(
+    struct emitter * const e,
+    struct kenbak_instr_decoded const * const dec,
+    uint32_t const gen,
+    struct instr_end * const end)
+{
+    int not_met[2] = { -1, -1 };
+
+    end->steps += 1; // SZ
+
+    if(!dec->jmp_is_unc)
+    {
+        emit_load(e, reg_ax, KENBAK_JIT_OFF_MEM(dec->reg));
+        switch((enum kenbak_jmp_cond)dec->jmp_cond)
+        {
+            case kenbak_jmp_cond_non_zero:
+            {
+                KENBAK_JIT_EMIT(e, 0x84, 0xC0); // test al, al
+                not_met[0] = emit_jcc_forward(e, cond_e);
+                break;
+            }
+            case kenbak_jmp_cond_zero:
+            {
+                KENBAK_JIT_EMIT(e, 0x84, 0xC0); // test al, al
+                not_met[0] = emit_jcc_forward(e, cond_ne);
+                break;
+            }
+            case kenbak_jmp_cond_neg:
+            {
+                KENBAK_JIT_EMIT(e, 0xA8, 0x80); // test al, 0x80
+                not_met[0] = emit_jcc_forward(e, cond_e);
+                break;
+            }
+            case kenbak_jmp_cond_pos:
+            {
+                KENBAK_JIT_EMIT(e, 0xA8, 0x80); // test al, 0x80
+                not_met[0] = emit_jcc_forward(e, cond_ne);
+                break;
+            }
+            case kenbak_jmp_cond_pos_non_zero:
+            {
+                KENBAK_JIT_EMIT(e, 0xA8, 0x80); // test al, 0x80
+                not_met[0] = emit_jcc_forward(e, cond_ne);
+                KENBAK_JIT_EMIT(e, 0xA8, 0x7F); // test al, 0x7F
+                not_met[1] = emit_jcc_forward(e, cond_e);
+                break;
+            }
+
+            default:
+            {
+                assert(false); // Must not get here.
+                e->overflow = true; // (not usable)
+                return;
+            }
+        }
+    }
+
+    // The condition is true:
+    {
+        struct instr_end met = *end;
+
+        met.sig_r = KENBAK_DATA_ADDR_P;
+        met.steps += 1; // ST
+
+        if(!dec->jmp_is_mark)
+        {
+            emit_mov(e, reg_dx, reg_bp);
+            emit_write(e, KENBAK_DATA_ADDR_P, reg_dx);
+            met.sig_inc = 0;
+            met.steps += 1; // SN
+        }
+        else
+        {
+            emit_load(e, reg_ax, KENBAK_JIT_OFF_MEM(KENBAK_DATA_ADDR_P));
+            KENBAK_JIT_EMIT(e, 0x04, 2); // add al, 2
+            emit_store(e, KENBAK_JIT_OFF(reg_i), reg_ax);
+            met.is_reg_i_stored = true;
+
+            emit_mov(e, reg_dx, reg_bp);
+            emit_write(e, KENBAK_DATA_ADDR_P, reg_dx);
+            met.sig_inc = 1; // Continue after the mark.
+            met.steps += 1; // SQ
+
+            emit_sig_r_from_w(e, &met);
+            met.steps += 1; // SR
+
+            emit_load(e, reg_dx, KENBAK_JIT_OFF(reg_i));
+            emit_write_at_cx(e, reg_dx);
+            met.steps += 1; // SS
+        }
+        emit_instr_end(e, &met, gen, instr_next_any);
+    }
+
+    // The condition is false:
+
+    for(int i = 0; i < 2; ++i)
+    {
+        if(not_met[i] != -1)
+        {
+            patch_jcc(e, not_met[i]);
+        }
+    }
+    end->sig_inc = 2;
+    emit_instr_end(e, end, gen, instr_next_any);
+}
+
+/** SP, SR & SS, see exec_sp_ss_store().
+ */
+static void emit_sp_ss_store(
+    struct emitter * const e,
+    struct kenbak_instr_decoded const * const dec,
+    struct instr_end * const end)
+{
+    emit_load(e, reg_dx, KENBAK_JIT_OFF_MEM(dec->reg));
+    emit_store(e, KENBAK_JIT_OFF(reg_i), reg_dx);
+    end->is_reg_i_stored = true;
+    end->sig_inc = 2;
+
+    emit_sig_r_from_w(e, end);
+    emit_write_at_cx(e, reg_dx);
+    end->steps += 3;
+}
+
+/** SN, see exec_sn_change_reg() and exec_change_reg().
+ */
+static void emit_sn_change_reg(
+    struct emitter * const e,
+    struct kenbak_instr_decoded const * const dec,
+    struct instr_end * const end)
+{
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+
+    emit_load(e, reg_ax, KENBAK_JIT_OFF_MEM(dec->reg)); // Register content.
+    emit_mov(e, reg_dx, reg_bp);
+
+    switch(instr_type)
+    {
+        case kenbak_instr_type_add:
+        {
+            KENBAK_JIT_EMIT(e, 0x00, 0xC2); // add dl, al
+            break;
+        }
+        case kenbak_instr_type_sub:
+        {
+            KENBAK_JIT_EMIT(e, 0xF6, 0xDA); // neg dl
+            KENBAK_JIT_EMIT(e, 0x00, 0xC2); // add dl, al
+            break;
+        }
+        case kenbak_instr_type_load:
+        {
+            break;
+        }
+        case kenbak_instr_type_and:
+        {
+            KENBAK_JIT_EMIT(e, 0x20, 0xC2); // and dl, al
+            break;
+        }
+        case kenbak_instr_type_or:
+        {
+            KENBAK_JIT_EMIT(e, 0x08, 0xC2); // or dl, al
+            break;
+        }
+        case kenbak_instr_type_lneg:
+        {
+            KENBAK_JIT_EMIT(e, 0xF6, 0xDA); // neg dl
+            break;
+        }
+
+        default:
+        {
+            assert(false); // Must not get here.
+            e->overflow = true; // (not usable)
+            return;
+        }
+    }
+
+    if(instr_type == kenbak_instr_type_add
+        || instr_type == kenbak_instr_type_sub)
+    {
+        // Always zero, see exec_change_reg():
+        //
+        emit_mov_imm(e, reg_ax, 0);
+        emit_write(e, (uint8_t)KENBAK_DATA_ADDR_OC_FOR(dec->reg), reg_ax);
+    }
+    emit_write(e, dec->reg, reg_dx);
+
+    end->sig_inc = 2;
+    end->steps += 1;
+}
+
+/** Emits the native code of the given instruction, see exec_instr() and
+ *  exec_instr_se().
+ *
+ * - Returns false, if the block ends with it (and left).
+ */
+static bool emit_instr(
+    struct emitter * const e,
+    struct kenbak_code_instr const * const instr,
+    bool const is_first,
+    uint32_t const gen)
+{
+    struct kenbak_instr_decoded const * const dec = instr->dec;
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+    struct instr_end end = {
+        .first_byte = instr->first_byte,
+        .is_reg_i_stored = false,
+        .sig_r = -1,
+        .sig_inc = -1,
+        .steps = 0
+    };
+
+    if(!is_first)
+    {
+        emit_instr_check(e, instr);
+    }
+    emit_sa_to_sd(e, instr, &end);
+
+    if(dec->len == 1)
+    {
+        // SU & SV, see exec_su_sv():
+        //
+        emit_load(e, reg_bp, KENBAK_JIT_OFF_MEM(dec->reg));
+        end.sig_r = dec->reg;
+        end.sig_inc = 1;
+        end.steps += 2;
+
+        if(instr_type == kenbak_instr_type_misc)
+        {
+            if(dec->is_halt)
+            {
+                KENBAK_JIT_EMIT(e, 0x80, 0x8B); // or byte [rbx + sigs], ED
+                emit_u32(e, KENBAK_JIT_OFF(sigs));
+                KENBAK_JIT_EMIT(e, KENBAK_SIG_MASK(kenbak_sig_ed));
+            }
+            emit_instr_end(
+                e,
+                &end,
+                gen,
+                dec->is_halt ? instr_next_none : instr_next_follows);
+            return !dec->is_halt;
+        }
+        emit_sw_sy(e, dec, &end);
+        emit_instr_end(e, &end, gen, instr_next_follows);
+        return true;
+    }
+
+    // SE, see exec_se() and exec_se_store_immediate():
+    //
+    emit_mov_imm(
+        e,
+        reg_bp,
+        addr_mode == kenbak_addr_mode_constant
+            && instr_type == kenbak_instr_type_store
+                ? (uint8_t)(instr->addr + 1) : instr->second_byte);
+    end.steps += 1;
+
+    bool const is_change_reg = instr_type != kenbak_instr_type_store
+        && instr_type != kenbak_instr_type_jump
+        && instr_type != kenbak_instr_type_bit;
+
+    if(instr_type == kenbak_instr_type_bit)
+    {
+        emit_sk(e, &end);
+        emit_sl_bit(e, dec, &end);
+        emit_instr_end(
+            e,
+            &end,
+            gen,
+            dec->bit_is_skip ? instr_next_any : instr_next_follows);
+        return !dec->bit_is_skip;
+    }
+
+    if(addr_mode == kenbak_addr_mode_indirect
+        || addr_mode == kenbak_addr_mode_indirect_indexed
+        || (addr_mode == kenbak_addr_mode_memory
+            && instr_type == kenbak_instr_type_jump))
+    {
+        emit_sf_sg(e, &end);
+    }
+    if(addr_mode == kenbak_addr_mode_indexed
+        || addr_mode == kenbak_addr_mode_indirect_indexed)
+    {
+        emit_sh_sj(e, &end);
+    }
+    if(is_change_reg && addr_mode != kenbak_addr_mode_constant)
+    {
+        emit_sk(e, &end);
+        end.steps += 1; // SL
+    }
+
+    // SM, see exec_sm():
+    //
+    end.sig_r = dec->reg;
+    end.steps += 1;
+
+    if(instr_type == kenbak_instr_type_jump)
+    {
+        emit_sz_jump(e, dec, gen, &end);
+        return false;
+    }
+    if(instr_type == kenbak_instr_type_store)
+    {
+        emit_sp_ss_store(e, dec, &end);
+    }
+    else
+    {
+        emit_sn_change_reg(e, dec, &end);
+    }
+    emit_instr_end(e, &end, gen, instr_next_follows);
+    return true;
+}
+
+// *****************************************************************************
+// *** BLOCKS                                                                ***
+// *****************************************************************************
+
+/** Emits the code that returns from the native code (at its start, the target
+ *  of all jumps leaving the block).
+ */
+static void emit_exit(struct emitter * const e)
+{
+    KENBAK_JIT_EMIT(e, 0x4D, 0x89, 0xBE); // mov [r14 + steps], r15
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_jit_run, steps));
+    KENBAK_JIT_EMIT(e, 0x4D, 0x89, 0xA6); // mov [r14 + instrs], r12
+    emit_u32(e, (uint32_t)offsetof(struct kenbak_jit_run, instrs));
+
+    KENBAK_JIT_EMIT(e, 0x48, 0x83, 0xC4, 8); // add rsp, 8
+    KENBAK_JIT_EMIT(e, 0x41, 0x5F); // pop r15
+    KENBAK_JIT_EMIT(e, 0x41, 0x5E); // pop r14
+    KENBAK_JIT_EMIT(e, 0x41, 0x5D); // pop r13
+    KENBAK_JIT_EMIT(e, 0x41, 0x5C); // pop r12
+    KENBAK_JIT_EMIT(e, 0x5D); // pop rbp
+    KENBAK_JIT_EMIT(e, 0x5B); // pop rbx
+    KENBAK_JIT_EMIT(e, 0xC3); // ret
+}
+
+/** Emits the entry of the native code (see kenbak_code_native).
+ */
+static void emit_entry(struct emitter * const e)
+{
+    KENBAK_JIT_EMIT(e, 0x53); // push rbx
+    KENBAK_JIT_EMIT(e, 0x55); // push rbp
+    KENBAK_JIT_EMIT(e, 0x41, 0x54); // push r12
+    KENBAK_JIT_EMIT(e, 0x41, 0x55); // push r13
+    KENBAK_JIT_EMIT(e, 0x41, 0x56); // push r14
+    KENBAK_JIT_EMIT(e, 0x41, 0x57); // push r15
+    KENBAK_JIT_EMIT(e, 0x48, 0x83, 0xEC, 8); // sub rsp, 8 (stack alignment)
+
+#ifdef _WIN32
+    KENBAK_JIT_EMIT(e, 0x48, 0x89, 0xCB); // mov rbx, rcx
+    KENBAK_JIT_EMIT(e, 0x49, 0x89, 0xD6); // mov r14, rdx
+#else //_WIN32
+    KENBAK_JIT_EMIT(e, 0x48, 0x89, 0xFB); // mov rbx, rdi
+    KENBAK_JIT_EMIT(e, 0x49, 0x89, 0xF6); // mov r14, rsi
+#endif //_WIN32
+    KENBAK_JIT_EMIT(e, 0x4C, 0x8B, 0xAB); // mov r13, [rbx + code_cache]
+    emit_u32(e, KENBAK_JIT_OFF(code_cache));
+    KENBAK_JIT_EMIT(e, 0x45, 0x31, 0xFF); // xor r15d, r15d
+    KENBAK_JIT_EMIT(e, 0x45, 0x31, 0xE4); // xor r12d, r12d
+}
+
+/** Returns true, if the given instruction may start a countdown loop (see
+ *  kenbak_code_get_countdown_reg()), which is left to kenbak_emu_run().
+ */
+static bool may_start_countdown_loop(
+    struct kenbak_code_instr const * const instr)
+{
+    return instr->dec->type == kenbak_instr_type_sub
+        && instr->dec->addr_mode == kenbak_addr_mode_constant
+        && instr->second_byte == 1;
+}
+
+/** Returns true, if the given instruction includes P, which SB changes before
+ *  the instruction gets fetched (so it is not the cached one, anymore).
+ */
+static bool is_at_p(struct kenbak_code_instr const * const instr)
+{
+    return instr->addr == KENBAK_DATA_ADDR_P
+        || (instr->dec->len == 2
+            && (uint8_t)(instr->addr + 1) == KENBAK_DATA_ADDR_P);
+}
+
+/** Makes the pages holding the given range of the native code writable (and
+ *  not executable) or executable (and not writable), committing them first,
+ *  if necessary. Returns false on error.
+ */
+static bool protect(
+    struct kenbak_jit * const jit,
+    size_t const begin,
+    size_t const end,
+    bool const writable)
+{
+    size_t const first = begin - begin % KENBAK_JIT_PAGE_SIZE;
+    uint8_t * const addr = jit->code + first;
+    size_t const size = end - first;
+
+#ifdef _MSC_VER
+    DWORD old_protect;
+
+    if(writable
+        && VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) == NULL)
+    {
+        return false;
+    }
+    return VirtualProtect(
+            addr,
+            size,
+            writable ? PAGE_READWRITE : PAGE_EXECUTE_READ,
+            &old_protect)
+        != 0;
+#else //_MSC_VER
+    return mprotect(
+            addr,
+            size,
+            writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC)
+        == 0;
+#endif //_MSC_VER
+}
+
+/** Copies the native code of the given length from the JIT's buffer to the
+ *  memory for the native code of the given cache generation, returns its
+ *  start or NULL, if it does not fit or on error.
+ */
+static uint8_t * install(
+    struct kenbak_jit * const jit, uint32_t const gen, int const len)
+{
+    if(jit->gen != gen)
+    {
+        // All blocks with native code got invalidated (see
+        // kenbak_code_invalidate()), their code is not used anymore:
+
+        jit->len = 0;
+        jit->gen = gen;
+    }
+
+    size_t const begin = jit->len;
+    size_t const end = begin + (size_t)len;
+
+    if(KENBAK_JIT_CODE_SIZE < end)
+    {
+        return NULL; // (only after the generation wrapped around)
+    }
+    if(!protect(jit, begin, end, true))
+    {
+        return NULL;
+    }
+    memcpy(jit->code + begin, jit->buf, (size_t)len);
+    if(!protect(jit, begin, end, false))
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+#ifdef _MSC_VER
+    FlushInstructionCache(GetCurrentProcess(), jit->code + begin, (SIZE_T)len);
+#endif //_MSC_VER
+
+    jit->len = (end + KENBAK_JIT_ALIGN - 1) / KENBAK_JIT_ALIGN
+        * KENBAK_JIT_ALIGN;
+    return jit->code + begin;
+}
+
+/** Compiles the given block of the given cache generation.
+ *
+ * - Returns NULL, if the block's first instruction is not covered.
+ */
+static kenbak_code_native compile(
+    struct kenbak_jit * const jit,
+    uint32_t const gen,
+    struct kenbak_code_block const * const block)
+{
+    struct emitter e = {
+        .buf = jit->buf,
+        .len = 0,
+        .overflow = false,
+        .loop_instr = NULL,
+        .loop_entry = 0
+    };
+
+    if(!is_covered(block->instrs[0].dec) || is_at_p(block->instrs))
+    {
+        return NULL;
+    }
+
+    emit_exit(&e);
+
+    int const entry = e.len;
+
+    emit_entry(&e);
+
+    // (before a countdown loop, kenbak_emu_run() must get back control)
+    //
+    if(!may_start_countdown_loop(block->instrs))
+    {
+        e.loop_instr = block->instrs;
+        e.loop_entry = e.len;
+    }
+
+    for(int i = 0; i < block->len; ++i)
+    {
+        struct kenbak_code_instr const * const instr = block->instrs + i;
+
+        if(0 < i
+            && (!is_covered(instr->dec)
+                || may_start_countdown_loop(instr)
+                || is_at_p(instr)))
+        {
+            break;
+        }
+        if(!emit_instr(&e, instr, i == 0, block->gen))
+        {
+            break;
+        }
+    }
+    emit_jmp(&e, 0); // (if not left, yet)
+
+    if(e.overflow)
+    {
+        return NULL;
+    }
+
+    uint8_t * const code = install(jit, gen, e.len);
+
+    if(code == NULL)
+    {
+        return NULL;
+    }
+    return (kenbak_code_native)(uintptr_t)(code + entry);
+}
+
+kenbak_code_native kenbak_jit_get_native(
+    struct kenbak_jit * const jit,
+    struct kenbak_code_cache * const cache,
+    uint8_t const * const mem,
+    uint8_t const addr)
+{
+    assert(jit != NULL && cache != NULL);
+
+    kenbak_code_get_block(cache, mem, addr); // (decodes, if necessary)
+
+    struct kenbak_code_block * const block = cache->blocks + addr;
+
+    if(!block->is_compiled)
+    {
+        block->native = compile(jit, cache->gen, block);
+        block->is_compiled = true;
+    }
+    return block->native;
+}
+
+struct kenbak_jit * kenbak_jit_create(void)
+{
+    struct kenbak_jit * const jit = malloc(sizeof *jit);
+
+    if(jit == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    // Reserved, only (see protect()):
+    //
+#ifdef _MSC_VER
+    jit->code = VirtualAlloc(
+        NULL, KENBAK_JIT_CODE_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+#else //_MSC_VER
+    jit->code = mmap(
+        NULL,
+        KENBAK_JIT_CODE_SIZE,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1,
+        0);
+    if(jit->code == MAP_FAILED)
+    {
+        jit->code = NULL;
+    }
+#endif //_MSC_VER
+
+    if(jit->code == NULL)
+    {
+        free(jit);
+        return NULL;
+    }
+    jit->len = 0;
+    jit->gen = 0; // (no cache has this generation)
+    return jit;
+}
+
+void kenbak_jit_delete(struct kenbak_jit * const jit)
+{
+    if(jit == NULL)
+    {
+        return;
+    }
+#ifdef _MSC_VER
+    VirtualFree(jit->code, 0, MEM_RELEASE); // (return value ignored)
+#else //_MSC_VER
+    munmap(jit->code, KENBAK_JIT_CODE_SIZE); // (return value ignored)
+#endif //_MSC_VER
+    free(jit);
+}
+
+#else //KENBAK_JIT_AVAILABLE
+
+kenbak_code_native kenbak_jit_get_native(
+    struct kenbak_jit * const jit,
+    struct kenbak_code_cache * const cache,
+    uint8_t const * const mem,
+    uint8_t const addr)
+{
+    (void)jit;
+    (void)cache;
+    (void)mem;
+    (void)addr;
+    assert(false); // Must not get here (there is no JIT to be given).
+    return NULL;
+}
+
+struct kenbak_jit * kenbak_jit_create(void)
+{
+    return NULL; // Not available.
+}
+
+void kenbak_jit_delete(struct kenbak_jit * const jit)
+{
+    assert(jit == NULL);
+    (void)jit;
+}
+
+#endif //KENBAK_JIT_AVAILABLE
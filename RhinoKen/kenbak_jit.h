@@ -0,0 +1,87 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Just-in-time compiler of the code cache's blocks into native x86-64 code
+// (see kenbak_emu_set_jit()).
+//
+// - Only available on x86-64 (see KENBAK_JIT_AVAILABLE), elsewhere, the
+//   threaded code and the interpreter do all the work.
+// - The native code of a block executes its instructions from the block's
+//   start on like kenbak_emu_run() does in one pass, with the same results at
+//   each instruction boundary. It covers the common case only: Run mode with
+//   the input settled, the timing model and the hashing of the memory
+//   disabled and without the memoization of calls. kenbak_emu_run() calls it
+//   in that case, only (everything else is left to the threaded code).
+// - It leaves the block (returns) after a jump or a skip that does not lead
+//   back to the block's start, after HALT, before an instruction it does not
+//   cover, that includes P or that may start a countdown loop (see
+//   kenbak_code_get_countdown_reg()), if P does not point to the next
+//   instruction of the block, if the code cache got invalidated (e.g. by the
+//   block itself) and if a budget would not allow another instruction.
+// - Writes to cached blocks are reported to the code cache like
+//   KENBAK_CODE_ON_WRITE() does, the native code of a block stays valid as
+//   long as the block does.
+// - The memory holding the native code is never writable and executable at
+//   the same time: Each block's code gets emitted into a buffer and copied
+//   to pages that are made writable for that, only. The pages get committed
+//   when needed and reused after the cache got invalidated.
+
+#ifndef KENBAK_JIT
+#define KENBAK_JIT
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kenbak_code.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define KENBAK_JIT_AVAILABLE
+#endif
+
+// The maximum bytes of native code per block (the blocks' code is packed, one
+// after the other, so most blocks need much less):
+//
+#define KENBAK_JIT_MAX_BLOCK_SIZE 8192
+
+// Passed to the native code of a block:
+//
+struct kenbak_jit_run
+{
+    // Set by the caller: The native code continues with the next instruction
+    // only, if the steps and instructions taken so far do not exceed these:
+    //
+    uint64_t max_steps;
+    uint64_t max_instrs;
+
+    // Set by the native code, the counts of steps and instructions taken (as
+    // each state lasts one byte time, the steps equal the byte times):
+    //
+    uint64_t steps;
+    uint64_t instrs;
+};
+
+struct kenbak_jit; // (see kenbak_jit.c)
+
+/**
+ * - Returns the native code of the block starting at the given address,
+ *   decoding the block from the given memory and compiling it first, if
+ *   necessary (see kenbak_code_get_block()).
+ * - Returns NULL, if the block's first instruction is not covered.
+ * - The returned code is valid until the cache gets invalidated.
+ */
+kenbak_code_native kenbak_jit_get_native(
+    struct kenbak_jit * const jit,
+    struct kenbak_code_cache * const cache,
+    uint8_t const * const mem,
+    uint8_t const addr);
+
+/**
+ * - Caller takes ownership of returned object.
+ * - Returns NULL on error and where not available (see
+ *   KENBAK_JIT_AVAILABLE).
+ */
+struct kenbak_jit * kenbak_jit_create(void);
+
+void kenbak_jit_delete(struct kenbak_jit * const jit);
+
+#endif //KENBAK_JIT
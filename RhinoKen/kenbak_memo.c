@@ -0,0 +1,136 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kenbak_memo.h"
+
+void kenbak_memo_add_read(
+    struct kenbak_memo * const memo, uint8_t const addr, uint8_t const val)
+{
+    assert(memo->recording && memo->touched[addr] == 0);
+
+    if(memo->call.read_count == KENBAK_MEMO_MAX_READS)
+    {
+        kenbak_memo_abort(memo); // Too many to be compared fast.
+        return;
+    }
+
+    memo->touched[addr] = KENBAK_MEMO_TOUCHED_READ;
+    memo->call.reads[memo->call.read_count].addr = addr;
+    memo->call.reads[memo->call.read_count].val = val;
+    ++memo->call.read_count;
+}
+
+void kenbak_memo_start(
+    struct kenbak_memo * const memo,
+    uint8_t const call_addr,
+    uint8_t const sig_inc,
+    int const pos)
+{
+    memset(memo->touched, 0, sizeof memo->touched);
+
+    memo->call.call_addr = call_addr;
+    memo->call.sig_inc = sig_inc;
+    memo->call.pos = pos;
+    memo->call.read_count = 0;
+    memo->call.write_count = 0;
+
+    memo->ret_addr = (uint8_t)(call_addr + 2);
+    memo->recording = true;
+}
+
+void kenbak_memo_abort(struct kenbak_memo * const memo)
+{
+    memo->recording = false;
+}
+
+bool kenbak_memo_finish(
+    struct kenbak_memo * const memo, uint8_t const * const mem)
+{
+    assert(memo->recording);
+
+    memo->recording = false;
+
+    for(int i = 0; i < KENBAK_MEMO_ADDR_COUNT; ++i)
+    {
+        if((memo->touched[i] & KENBAK_MEMO_TOUCHED_WRITTEN) == 0)
+        {
+            continue;
+        }
+        if(memo->call.write_count == KENBAK_MEMO_MAX_WRITES)
+        {
+            return false;
+        }
+        memo->call.writes[memo->call.write_count].addr = (uint8_t)i;
+        memo->call.writes[memo->call.write_count].val = mem[i];
+        ++memo->call.write_count;
+    }
+
+    int const set = memo->call.call_addr % KENBAK_MEMO_SET_COUNT;
+
+    memo->call.valid = true;
+    memo->calls[set][memo->next_way[set]] = memo->call;
+    memo->next_way[set] = (memo->next_way[set] + 1) % KENBAK_MEMO_WAY_COUNT;
+    return true;
+}
+
+struct kenbak_memo_call const * kenbak_memo_find(
+    struct kenbak_memo const * const memo,
+    uint8_t const * const mem,
+    uint8_t const call_addr,
+    uint8_t const sig_inc,
+    int const pos)
+{
+    struct kenbak_memo_call const * const calls =
+        memo->calls[call_addr % KENBAK_MEMO_SET_COUNT];
+
+    for(int way = 0; way < KENBAK_MEMO_WAY_COUNT; ++way)
+    {
+        struct kenbak_memo_call const * const call = calls + way;
+        int i = 0;
+
+        if(!call->valid
+            || call->call_addr != call_addr
+            || call->sig_inc != sig_inc
+            || call->pos != pos)
+        {
+            continue;
+        }
+
+        while(i < call->read_count
+            && mem[call->reads[i].addr] == call->reads[i].val)
+        {
+            ++i;
+        }
+        if(i == call->read_count)
+        {
+            return call; // All values read are the same.
+        }
+    }
+    return NULL;
+}
+
+struct kenbak_memo * kenbak_memo_create(void)
+{
+    struct kenbak_memo * const memo = calloc(1, sizeof *memo);
+
+    if(memo == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    memo->recording = false; // (all calls are invalid)
+
+    return memo;
+}
+
+void kenbak_memo_delete(struct kenbak_memo * const memo)
+{
+    free(memo);
+}
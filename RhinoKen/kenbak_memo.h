@@ -0,0 +1,175 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Memoization of subroutine calls via jump and mark (JMD or JMI), see
+// kenbak_emu_set_memo().
+//
+// - A call lasts from the instruction boundary before the jump and mark
+//   instruction at address a until the next instruction boundary where the
+//   next instruction is at a + 2 (where the subroutine returns to, via the
+//   mark).
+// - While a call runs, the values of all bytes read before being written
+//   (read set, including the instructions fetched) and the addresses written
+//   to (write set) get recorded, together with the costs and the registers at
+//   the end of the call.
+// - A later call from the same address with the same values in the read set
+//   would do exactly the same, so the recorded writes, costs and registers can
+//   be applied at once (self-modifying code just leads to another record).
+
+#ifndef KENBAK_MEMO
+#define KENBAK_MEMO
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KENBAK_MEMO_ADDR_COUNT 256
+
+#define KENBAK_MEMO_MAX_READS 96 // Calls reading more are not recorded.
+#define KENBAK_MEMO_MAX_WRITES 32 // Calls writing more are not recorded.
+#define KENBAK_MEMO_MAX_INSTRS 4096 // Longer calls are not recorded.
+
+// The records are found via the call address (modulo the set count), each
+// set holds up to the way count of records (replaced round-robin):
+//
+#define KENBAK_MEMO_SET_COUNT 64
+#define KENBAK_MEMO_WAY_COUNT 4
+
+// Flags of struct kenbak_memo's touched array:
+//
+#define KENBAK_MEMO_TOUCHED_READ 1 // Read before being written.
+#define KENBAK_MEMO_TOUCHED_WRITTEN 2
+
+struct kenbak_memo_byte
+{
+    uint8_t addr;
+    uint8_t val;
+};
+
+struct kenbak_memo_call
+{
+    bool valid;
+
+    // The key, besides the read set (what happens may also depend on the
+    // increment of P pending and on the delay line position, with the timing
+    // model enabled, otherwise -1):
+    //
+    uint8_t call_addr;
+    uint8_t sig_inc;
+    int pos;
+
+    int read_count;
+    struct kenbak_memo_byte reads[KENBAK_MEMO_MAX_READS];
+
+    int write_count;
+    struct kenbak_memo_byte writes[KENBAK_MEMO_MAX_WRITES];
+
+    // Registers and signals at the end of the call:
+    //
+    uint8_t end_sig_inc;
+    uint8_t end_reg_i;
+    uint8_t end_reg_k;
+    uint8_t end_reg_w;
+    uint8_t end_sig_r;
+
+    // The costs of the call (while being recorded, the counts at its start):
+    //
+    uint64_t steps;
+    uint64_t instrs;
+    uint64_t byte_times;
+    uint32_t output_writes;
+};
+
+struct kenbak_memo
+{
+    // Is a call being recorded (into call)?
+    //
+    bool recording;
+    uint8_t ret_addr;
+    uint8_t touched[KENBAK_MEMO_ADDR_COUNT]; // See KENBAK_MEMO_TOUCHED_READ.
+    struct kenbak_memo_call call;
+
+    uint64_t hit_count; // Count of calls replayed.
+
+    int next_way[KENBAK_MEMO_SET_COUNT];
+    struct kenbak_memo_call calls[KENBAK_MEMO_SET_COUNT][KENBAK_MEMO_WAY_COUNT];
+};
+
+// To be used for each read of the memory by the Kenbak-1:
+//
+#define KENBAK_MEMO_ON_READ(memo, addr, val) \
+    do \
+    { \
+        if((memo)->recording && (memo)->touched[(uint8_t)(addr)] == 0) \
+        { \
+            kenbak_memo_add_read((memo), (uint8_t)(addr), (val)); \
+        } \
+    } while(false)
+
+// To be used for each write to the memory by the Kenbak-1:
+//
+#define KENBAK_MEMO_ON_WRITE(memo, addr) \
+    do \
+    { \
+        if((memo)->recording) \
+        { \
+            (memo)->touched[(uint8_t)(addr)] |= KENBAK_MEMO_TOUCHED_WRITTEN; \
+        } \
+    } while(false)
+
+/**
+ * - Adds the given value read from the given address, which must not have been
+ *   touched during the call being recorded, to the read set. Stops recording,
+ *   if the read set is full.
+ */
+void kenbak_memo_add_read(
+    struct kenbak_memo * const memo, uint8_t const addr, uint8_t const val);
+
+/**
+ * - Starts recording a call from the given address (the one of the jump and
+ *   mark instruction) with the given key values (see struct
+ *   kenbak_memo_call).
+ * - The caller needs to fill the costs' fields of memo->call with the counts
+ *   at the start.
+ */
+void kenbak_memo_start(
+    struct kenbak_memo * const memo,
+    uint8_t const call_addr,
+    uint8_t const sig_inc,
+    int const pos);
+
+/**
+ * - Stops recording without storing the call.
+ */
+void kenbak_memo_abort(struct kenbak_memo * const memo);
+
+/**
+ * - Stops recording and stores the call, taking the values of its write set
+ *   from the given memory.
+ * - The caller needs to fill the end registers and costs of memo->call
+ *   before.
+ * - Returns false, if the call was not stored (too many writes).
+ */
+bool kenbak_memo_finish(
+    struct kenbak_memo * const memo, uint8_t const * const mem);
+
+/**
+ * - Returns the recorded call from the given address, with the given key
+ *   values and a read set equal to the given memory, or NULL, if there is
+ *   none.
+ */
+struct kenbak_memo_call const * kenbak_memo_find(
+    struct kenbak_memo const * const memo,
+    uint8_t const * const mem,
+    uint8_t const call_addr,
+    uint8_t const sig_inc,
+    int const pos);
+
+/**
+ * - Caller takes ownership of returned object.
+ * - Returns NULL on error.
+ */
+struct kenbak_memo * kenbak_memo_create(void);
+
+void kenbak_memo_delete(struct kenbak_memo * const memo);
+
+#endif //KENBAK_MEMO
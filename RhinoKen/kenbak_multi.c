@@ -0,0 +1,921 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#ifndef _MSC_VER
+    #define _POSIX_C_SOURCE 200809L // For sysconf().
+#endif //_MSC_VER
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#ifdef _MSC_VER
+    #include <windows.h>
+#else //_MSC_VER
+    #include <pthread.h>
+    #include <unistd.h>
+#endif //_MSC_VER
+
+#include "kenbak_multi.h"
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+#include "kenbak_code.h"
+#include "kenbak_input.h"
+#include "kenbak_run.h"
+#include "kenbak_sig.h"
+#include "kenbak_state.h"
+
+// A Kenbak-1 in a slot, as the state machine's core sees it: The addresses of
+// the slot's registers, signals and counters in the arrays of struct
+// kenbak_multi:
+//
+struct kenbak_multi_ref
+{
+    int16_t * state;
+    uint8_t * reg_i;
+    uint8_t * reg_k;
+    uint8_t * reg_w;
+    uint8_t * sig_r;
+    uint8_t * sig_inc;
+    uint8_t * sigs;
+    uint8_t * sig_x;
+    uint32_t * byte_times;
+    uint32_t * output_write_count;
+    uint8_t * mem;
+    bool timing;
+
+    // No push button is pressed (see kenbak_multi_load()):
+    //
+    uint32_t input;
+    bool input_changed;
+};
+
+// The state machine's core (see kenbak_emu_core.h), accessing a slot via
+// struct kenbak_multi_ref:
+//
+#define KENBAK_EMU_FEATURE_TIMING KENBAK_EMU_FEATURE_RUNTIME
+#define KENBAK_EMU_CORE_INSTRS // exec_instr(), etc.
+#define KENBAK_EMU_CORE_DATA struct kenbak_multi_ref
+#define KENBAK_EMU_AT(d, field) KENBAK_MULTI_AT_ ## field(d)
+#define KENBAK_EMU_MEM(d) ((d)->mem)
+
+#define KENBAK_MULTI_AT_state(d) (*(d)->state)
+#define KENBAK_MULTI_AT_reg_i(d) (*(d)->reg_i)
+#define KENBAK_MULTI_AT_reg_k(d) (*(d)->reg_k)
+#define KENBAK_MULTI_AT_reg_w(d) (*(d)->reg_w)
+#define KENBAK_MULTI_AT_sig_r(d) (*(d)->sig_r)
+#define KENBAK_MULTI_AT_sig_inc(d) (*(d)->sig_inc)
+#define KENBAK_MULTI_AT_sigs(d) (*(d)->sigs)
+#define KENBAK_MULTI_AT_sig_x(d) (*(d)->sig_x)
+#define KENBAK_MULTI_AT_byte_times(d) (*(d)->byte_times)
+#define KENBAK_MULTI_AT_output_write_count(d) (*(d)->output_write_count)
+#define KENBAK_MULTI_AT_timing(d) ((d)->timing)
+#define KENBAK_MULTI_AT_input(d) ((d)->input)
+#define KENBAK_MULTI_AT_input_changed(d) ((d)->input_changed)
+
+#include "kenbak_emu_core.h"
+
+// *****************************************************************************
+// *** SLOTS                                                                 ***
+// *****************************************************************************
+
+static uint8_t * get_mem(struct kenbak_multi * const m, int32_t const slot)
+{
+    return m->mem + (size_t)slot * KENBAK_DATA_MEM_SIZE;
+}
+
+static struct kenbak_multi_ref get_ref(
+    struct kenbak_multi * const m, int32_t const slot)
+{
+    struct kenbak_multi_ref const ref = {
+        .state = m->state + slot,
+        .reg_i = m->reg_i + slot,
+        .reg_k = m->reg_k + slot,
+        .reg_w = m->reg_w + slot,
+        .sig_r = m->sig_r + slot,
+        .sig_inc = m->sig_inc + slot,
+        .sigs = m->sigs + slot,
+        .sig_x = m->sig_x + slot,
+        .byte_times = m->byte_times + slot,
+        .output_write_count = m->output_write_count + slot,
+        .mem = get_mem(m, slot),
+        .timing = m->timing
+    };
+
+    return ref;
+}
+
+// *****************************************************************************
+// *** GROUPS                                                                ***
+// *****************************************************************************
+
+/** Puts the given slot into the group of its state for the next tick, if its
+ *  step budget is not used up.
+ */
+static void regroup(struct kenbak_multi_part * const p, int32_t const slot)
+{
+    struct kenbak_multi * const m = p->m;
+
+    if(m->steps_left[slot] == 0)
+    {
+        return; // Done (for this call of kenbak_multi_steps()).
+    }
+
+    enum kenbak_state_index const i = KENBAK_STATE_GET_INDEX(m->state[slot]);
+
+    p->next_groups[i][p->next_counts[i]++] = slot;
+}
+
+/** Puts each loaded slot of the given part into the group of its current
+ *  state and gives it the given step budget.
+ */
+static void group_by_state(
+    struct kenbak_multi_part * const p, uint64_t const count)
+{
+    struct kenbak_multi * const m = p->m;
+
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        p->counts[i] = 0;
+    }
+    for(int32_t slot = p->first; slot < p->end; ++slot)
+    {
+        if(m->state[slot] == kenbak_state_power_off)
+        {
+            continue; // Empty.
+        }
+
+        enum kenbak_state_index const i =
+            KENBAK_STATE_GET_INDEX(m->state[slot]);
+
+        m->steps_left[slot] = count;
+        p->groups[i][p->counts[i]++] = slot;
+    }
+}
+
+// *****************************************************************************
+// *** STEPS                                                                 ***
+// *****************************************************************************
+
+/** Takes a step of the state machine in the given slot and puts the slot into
+ *  its next group.
+ */
+static void step(struct kenbak_multi_part * const p, int32_t const slot)
+{
+    struct kenbak_multi * const m = p->m;
+    struct kenbak_multi_ref ref = get_ref(m, slot);
+
+    if(m->state[slot] == kenbak_state_sd)
+    {
+        ++p->instrs; // (as kenbak_emu_run() counts)
+    }
+    steps_in_defined_state(&ref, 1, KENBAK_EMU_DISPATCH); // (no errors)
+    --m->steps_left[slot];
+    regroup(p, slot);
+}
+
+/** Executes the next instructions of the given slot in state SA, one after
+ *  the other, each in one pass (see exec_instr()), as long as the slot's step
+ *  budget allows a whole instruction (fast-forwarding countdown loops, see
+ *  skip_countdown_loop()), as kenbak_emu_run() does. Then takes a step in
+ *  SA, if the budget is not used up, yet, and puts the slot into its next
+ *  group.
+ */
+static void exec_instrs(
+    struct kenbak_multi_part * const p, int32_t const slot)
+{
+    struct kenbak_multi * const m = p->m;
+    struct kenbak_multi_ref ref = get_ref(m, slot);
+    struct kenbak_run_limits limits = { 0 };
+    struct kenbak_run_result result = { 0 };
+
+    limits.max_steps = m->steps_left[slot];
+
+    while(m->state[slot] == kenbak_state_sa
+        && is_next_instr_in_budget(&limits, &result))
+    {
+        int const reg = kenbak_code_get_countdown_reg(
+            ref.mem, (uint8_t)(ref.mem[KENBAK_DATA_ADDR_P] + m->sig_inc[slot]));
+
+        if(reg != -1)
+        {
+            skip_countdown_loop(&ref, reg, &limits, &result);
+            if(!is_next_instr_in_budget(&limits, &result))
+            {
+                break;
+            }
+        }
+
+        int steps = 0;
+        int const c = exec_instr(&ref, &steps);
+
+        assert(0 <= c);
+        result.steps += (uint64_t)steps;
+        result.byte_times += (uint64_t)c;
+        if(m->state[slot] == kenbak_state_sa)
+        {
+            ++result.instrs; // (otherwise, ED led from SB to QC)
+        }
+    }
+
+    m->steps_left[slot] -= result.steps;
+    p->instrs += result.instrs;
+    if(m->state[slot] == kenbak_state_sa && m->steps_left[slot] != 0)
+    {
+        step(p, slot); // (the rest of the budget is too small)
+        return;
+    }
+    regroup(p, slot);
+}
+
+/** Takes the remaining steps of the given slot in state QC at once, as
+ *  nothing changes after the first one (no push button is pressed).
+ */
+static void idle(struct kenbak_multi_part * const p, int32_t const slot)
+{
+    struct kenbak_multi * const m = p->m;
+    uint64_t const rest = m->steps_left[slot] - 1;
+
+    m->steps_left[slot] = 1;
+    step(p, slot); // (uses up the budget)
+    m->byte_times[slot] += (uint32_t)rest; // (one byte time per step)
+}
+
+// *****************************************************************************
+// *** PARTS                                                                 ***
+// *****************************************************************************
+
+/** Takes the steps of one tick for each group of the given part, whole
+ *  instructions in state SA (see exec_instrs()) and idling in QC at once
+ *  (see idle()), a single step in each other state.
+ */
+static void step_groups(struct kenbak_multi_part * const p)
+{
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        p->next_counts[i] = 0;
+    }
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        int32_t const * const g = p->groups[i];
+        int const count = p->counts[i];
+
+        if(count == 0)
+        {
+            continue;
+        }
+        if(i == kenbak_state_index_sa)
+        {
+            for(int j = 0; j < count; ++j)
+            {
+                exec_instrs(p, g[j]);
+            }
+            continue;
+        }
+        if(i == kenbak_state_index_qc)
+        {
+            for(int j = 0; j < count; ++j)
+            {
+                idle(p, g[j]);
+            }
+            continue;
+        }
+
+        for(int j = 0; j < count; ++j)
+        {
+            step(p, g[j]);
+        }
+    }
+
+    // The next tick's groups become the current ones:
+    //
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        int32_t * const groups = p->groups[i];
+
+        p->groups[i] = p->next_groups[i];
+        p->next_groups[i] = groups;
+        p->counts[i] = p->next_counts[i];
+    }
+}
+
+/** Takes the given count of steps in each loaded slot of the given part.
+ */
+static void step_part(
+    struct kenbak_multi_part * const p, uint64_t const count)
+{
+    bool is_empty = false;
+
+    group_by_state(p, count);
+    while(!is_empty)
+    {
+        step_groups(p);
+
+        is_empty = true;
+        for(int i = 0; i < kenbak_state_index_count; ++i)
+        {
+            if(p->counts[i] != 0)
+            {
+                is_empty = false;
+                break;
+            }
+        }
+    }
+}
+
+// *****************************************************************************
+// *** WORKER THREADS                                                        ***
+// *****************************************************************************
+
+// A thread stepping a part on each call of kenbak_multi_steps():
+//
+struct kenbak_multi_worker
+{
+    struct kenbak_multi_pool * pool;
+    struct kenbak_multi_part * p;
+#ifdef _MSC_VER
+    HANDLE thread;
+#else //_MSC_VER
+    pthread_t thread;
+#endif //_MSC_VER
+    bool is_started; // (otherwise, the calling thread steps the part)
+};
+
+// The worker threads of all parts but the first one (that is stepped on the
+// calling thread), waiting for the next call of kenbak_multi_steps() between
+// the calls:
+//
+struct kenbak_multi_pool
+{
+#ifdef _MSC_VER
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE work; // Signalled on a new call or to stop.
+    CONDITION_VARIABLE done; // Signalled, when busy gets zero.
+#else //_MSC_VER
+    pthread_mutex_t lock;
+    pthread_cond_t work; // (see above)
+    pthread_cond_t done;
+#endif //_MSC_VER
+
+    struct kenbak_multi_worker * workers;
+    int worker_count;
+
+    // Guarded by lock:
+    //
+    uint64_t gen; // Counts the calls of kenbak_multi_steps().
+    uint64_t count; // Steps of the current call.
+    int busy; // Count of started workers still stepping their parts.
+    bool stop;
+};
+
+static void lock_pool(struct kenbak_multi_pool * const pool)
+{
+#ifdef _MSC_VER
+    EnterCriticalSection(&pool->lock);
+#else //_MSC_VER
+    pthread_mutex_lock(&pool->lock); // (return value ignored)
+#endif //_MSC_VER
+}
+
+static void unlock_pool(struct kenbak_multi_pool * const pool)
+{
+#ifdef _MSC_VER
+    LeaveCriticalSection(&pool->lock);
+#else //_MSC_VER
+    pthread_mutex_unlock(&pool->lock); // (return value ignored)
+#endif //_MSC_VER
+}
+
+/** Waits for the given condition of the given pool to be signalled, the
+ *  pool's lock must be held (and is held again on return).
+ */
+#ifdef _MSC_VER
+static void wait_pool(
+    struct kenbak_multi_pool * const pool, CONDITION_VARIABLE * const cond)
+{
+    SleepConditionVariableCS(cond, &pool->lock, INFINITE); // (ret. val. ign.)
+}
+#else //_MSC_VER
+static void wait_pool(
+    struct kenbak_multi_pool * const pool, pthread_cond_t * const cond)
+{
+    pthread_cond_wait(cond, &pool->lock); // (return value ignored)
+}
+#endif //_MSC_VER
+
+static void signal_work(struct kenbak_multi_pool * const pool)
+{
+#ifdef _MSC_VER
+    WakeAllConditionVariable(&pool->work);
+#else //_MSC_VER
+    pthread_cond_broadcast(&pool->work); // (return value ignored)
+#endif //_MSC_VER
+}
+
+static void signal_done(struct kenbak_multi_pool * const pool)
+{
+#ifdef _MSC_VER
+    WakeConditionVariable(&pool->done);
+#else //_MSC_VER
+    pthread_cond_signal(&pool->done); // (return value ignored)
+#endif //_MSC_VER
+}
+
+/** Steps the given worker's part on each call of kenbak_multi_steps(), until
+ *  the pool gets stopped.
+ */
+static void work(struct kenbak_multi_worker * const w)
+{
+    struct kenbak_multi_pool * const pool = w->pool;
+    uint64_t gen = 0;
+
+    lock_pool(pool);
+    while(true)
+    {
+        while(!pool->stop && pool->gen == gen)
+        {
+            wait_pool(pool, &pool->work);
+        }
+        if(pool->stop)
+        {
+            break;
+        }
+        gen = pool->gen;
+
+        uint64_t const count = pool->count;
+
+        unlock_pool(pool);
+        step_part(w->p, count);
+        lock_pool(pool);
+
+        if(--pool->busy == 0)
+        {
+            signal_done(pool);
+        }
+    }
+    unlock_pool(pool);
+}
+
+#ifdef _MSC_VER
+static DWORD WINAPI work_thread(LPVOID param)
+{
+    work(param);
+    return 0;
+}
+#else //_MSC_VER
+static void * work_thread(void * param)
+{
+    work(param);
+    return NULL;
+}
+#endif //_MSC_VER
+
+/** Stops and joins the workers of the given pool and deletes it.
+ */
+static void delete_pool(struct kenbak_multi_pool * const pool)
+{
+    if(pool == NULL)
+    {
+        return; // Just do nothing.
+    }
+
+    lock_pool(pool);
+    pool->stop = true;
+    signal_work(pool);
+    unlock_pool(pool);
+
+    for(int i = 0; i < pool->worker_count; ++i)
+    {
+        struct kenbak_multi_worker * const w = pool->workers + i;
+
+        if(!w->is_started)
+        {
+            continue;
+        }
+#ifdef _MSC_VER
+        WaitForSingleObject(w->thread, INFINITE); // (return value ignored)
+        CloseHandle(w->thread); // (return value ignored)
+#else //_MSC_VER
+        pthread_join(w->thread, NULL); // (return value ignored)
+#endif //_MSC_VER
+    }
+
+#ifdef _MSC_VER
+    DeleteCriticalSection(&pool->lock);
+#else //_MSC_VER
+    pthread_cond_destroy(&pool->done); // (return value ignored)
+    pthread_cond_destroy(&pool->work); // (return value ignored)
+    pthread_mutex_destroy(&pool->lock); // (return value ignored)
+#endif //_MSC_VER
+    free(pool->workers);
+    free(pool);
+}
+
+/** Creates a pool with a worker for each of the given parts and starts the
+ *  workers (a part, whose worker cannot be started, gets stepped on the
+ *  calling thread).
+ *
+ * - Returns NULL on error.
+ */
+static struct kenbak_multi_pool * create_pool(
+    struct kenbak_multi_part * const parts, int const count)
+{
+    struct kenbak_multi_pool * const pool = calloc(1, sizeof *pool);
+
+    if(pool == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    pool->workers =
+        calloc((size_t)(0 < count ? count : 1), sizeof *pool->workers);
+    if(pool->workers == NULL)
+    {
+        assert(false); // Must not get here.
+        free(pool);
+        return NULL;
+    }
+
+#ifdef _MSC_VER
+    InitializeCriticalSection(&pool->lock);
+    InitializeConditionVariable(&pool->work);
+    InitializeConditionVariable(&pool->done);
+#else //_MSC_VER
+    if(pthread_mutex_init(&pool->lock, NULL) != 0)
+    {
+        assert(false); // Must not get here.
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if(pthread_cond_init(&pool->work, NULL) != 0)
+    {
+        assert(false); // Must not get here.
+        pthread_mutex_destroy(&pool->lock); // (return value ignored)
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    if(pthread_cond_init(&pool->done, NULL) != 0)
+    {
+        assert(false); // Must not get here.
+        pthread_cond_destroy(&pool->work); // (return value ignored)
+        pthread_mutex_destroy(&pool->lock); // (return value ignored)
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+#endif //_MSC_VER
+
+    pool->worker_count = count;
+    for(int i = 0; i < count; ++i)
+    {
+        struct kenbak_multi_worker * const w = pool->workers + i;
+
+        w->pool = pool;
+        w->p = parts + i;
+#ifdef _MSC_VER
+        w->thread = CreateThread(NULL, 0, work_thread, w, 0, NULL);
+        w->is_started = w->thread != NULL;
+#else //_MSC_VER
+        w->is_started =
+            pthread_create(&w->thread, NULL, work_thread, w) == 0;
+#endif //_MSC_VER
+    }
+    return pool;
+}
+
+/** Lets the started workers of the given pool take the given count of steps
+ *  in their parts and steps the other parts (but the first one) on the
+ *  calling thread.
+ */
+static void start_steps(
+    struct kenbak_multi_pool * const pool, uint64_t const count)
+{
+    int started = 0;
+
+    for(int i = 0; i < pool->worker_count; ++i)
+    {
+        started += pool->workers[i].is_started;
+    }
+
+    lock_pool(pool);
+    pool->count = count;
+    pool->busy = started;
+    ++pool->gen;
+    signal_work(pool);
+    unlock_pool(pool);
+
+    for(int i = 0; i < pool->worker_count; ++i)
+    {
+        if(!pool->workers[i].is_started)
+        {
+            step_part(pool->workers[i].p, count);
+        }
+    }
+}
+
+/** Waits for the workers of the given pool to be done with their steps (see
+ *  start_steps()).
+ */
+static void wait_for_steps(struct kenbak_multi_pool * const pool)
+{
+    lock_pool(pool);
+    while(pool->busy != 0)
+    {
+        wait_pool(pool, &pool->done);
+    }
+    unlock_pool(pool);
+}
+
+/** Returns the count of processors available, at least one.
+ */
+static int get_processor_count(void)
+{
+#ifdef _MSC_VER
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return 0 < (int)info.dwNumberOfProcessors
+        ? (int)info.dwNumberOfProcessors : 1;
+#else //_MSC_VER
+    long const count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return 0 < count && count <= INT32_MAX ? (int)count : 1;
+#endif //_MSC_VER
+}
+
+// *****************************************************************************
+// *** ENTRY POINTS                                                          ***
+// *****************************************************************************
+
+uint8_t * kenbak_multi_get_mem_ptr(
+    struct kenbak_multi * const m, int const slot)
+{
+    assert(0 <= slot && slot < m->capacity);
+
+    return get_mem(m, slot);
+}
+
+bool kenbak_multi_load(
+    struct kenbak_multi * const m,
+    int const slot,
+    struct kenbak_data const * const d)
+{
+    assert(0 <= slot && slot < m->capacity);
+
+    if(d->state == kenbak_state_power_off
+        || d->state == kenbak_state_unknown
+        || (d->input & KENBAK_INPUT_MASK(kenbak_input_bit_power_on)) == 0
+        || (d->input & KENBAK_INPUT_MASK_BUTTONS) != 0
+        || d->input_changed
+        || (d->sigs & (uint8_t)~KENBAK_SIG_MASK(kenbak_sig_ed)) != 0
+        || d->timing != m->timing)
+    {
+        return false;
+    }
+
+    uint8_t * const mem = get_mem(m, slot);
+
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        mem[i] = d->mem[i];
+    }
+    m->state[slot] = (int16_t)d->state;
+    m->reg_i[slot] = d->reg_i;
+    m->reg_k[slot] = d->reg_k;
+    m->reg_w[slot] = d->reg_w;
+    m->sig_r[slot] = d->sig_r;
+    m->sig_inc[slot] = d->sig_inc;
+    m->sigs[slot] = d->sigs;
+    m->sig_x[slot] = d->sig_x;
+    m->byte_times[slot] = d->byte_times;
+    m->output_write_count[slot] = d->output_write_count;
+    return true;
+}
+
+void kenbak_multi_unload(
+    struct kenbak_multi const * const m,
+    int const slot,
+    struct kenbak_data * const d)
+{
+    assert(0 <= slot && slot < m->capacity);
+    assert(m->state[slot] != kenbak_state_power_off);
+
+    // Via the pointer, to keep the code cache, the hash and the memoization
+    // up-to-date:
+    //
+    uint8_t * const mem = kenbak_emu_get_mem_ptr(d, 0);
+    uint8_t const * const src = m->mem + (size_t)slot * KENBAK_DATA_MEM_SIZE;
+
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        mem[i] = src[i];
+    }
+    d->state = (enum kenbak_state)m->state[slot];
+    d->reg_i = m->reg_i[slot];
+    d->reg_k = m->reg_k[slot];
+    d->reg_w = m->reg_w[slot];
+    d->sig_r = m->sig_r[slot];
+    d->sig_inc = m->sig_inc[slot];
+    d->sigs = m->sigs[slot];
+    d->sig_x = m->sig_x[slot];
+    d->byte_times = m->byte_times[slot];
+    d->output_write_count = m->output_write_count[slot];
+}
+
+uint64_t kenbak_multi_steps(
+    struct kenbak_multi * const m, uint64_t const count)
+{
+    uint64_t instrs = 0;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    for(int i = 0; i < m->part_count; ++i)
+    {
+        m->parts[i].instrs = 0;
+    }
+
+    // The first part on the calling thread, the others on the workers:
+    //
+    start_steps(m->pool, count);
+    step_part(m->parts, count);
+    wait_for_steps(m->pool);
+
+    for(int i = 0; i < m->part_count; ++i)
+    {
+        instrs += m->parts[i].instrs;
+    }
+    return instrs;
+}
+
+bool kenbak_multi_set_thread_count(
+    struct kenbak_multi * const m, int const count)
+{
+    assert(0 <= count);
+
+    int part_count = count == 0 ? get_processor_count() : count;
+
+    if(m->capacity < part_count)
+    {
+        part_count = m->capacity; // (at least one slot per part)
+    }
+
+    struct kenbak_multi_part * const parts =
+        calloc((size_t)part_count, sizeof *parts);
+
+    if(parts == NULL)
+    {
+        assert(false); // Must not get here.
+        return false;
+    }
+
+    size_t const n = (size_t)m->capacity;
+
+    for(int i = 0; i < part_count; ++i)
+    {
+        struct kenbak_multi_part * const p = parts + i;
+
+        p->m = m;
+        p->first = (int32_t)((int64_t)m->capacity * i / part_count);
+        p->end = (int32_t)((int64_t)m->capacity * (i + 1) / part_count);
+
+        // Each part uses its slots' range of each group:
+        //
+        for(int j = 0; j < kenbak_state_index_count; ++j)
+        {
+            p->groups[j] = m->group_mem + (size_t)j * n + (size_t)p->first;
+            p->next_groups[j] = m->group_mem
+                + (size_t)(kenbak_state_index_count + j) * n
+                + (size_t)p->first;
+        }
+    }
+
+    // All parts but the first one get their workers:
+    //
+    struct kenbak_multi_pool * const pool =
+        create_pool(parts + 1, part_count - 1);
+
+    if(pool == NULL)
+    {
+        assert(false); // Must not get here.
+        free(parts);
+        return false;
+    }
+
+    delete_pool(m->pool); // Before the parts, the workers are using.
+    free(m->parts);
+    m->pool = pool;
+    m->parts = parts;
+    m->part_count = part_count;
+    return true;
+}
+
+void kenbak_multi_delete(struct kenbak_multi * const m)
+{
+    if(m == NULL)
+    {
+        return; // Just do nothing.
+    }
+
+    free(m->state);
+    free(m->reg_i);
+    free(m->reg_k);
+    free(m->reg_w);
+    free(m->sig_r);
+    free(m->sig_inc);
+    free(m->sigs);
+    free(m->sig_x);
+    free(m->byte_times);
+    free(m->output_write_count);
+    free(m->steps_left);
+    if(m->mem != NULL)
+    {
+#ifdef _MSC_VER
+        _aligned_free(m->mem);
+#else //_MSC_VER
+        free(m->mem);
+#endif //_MSC_VER
+    }
+    free(m->group_mem);
+    delete_pool(m->pool); // Before the parts, the workers are using.
+    free(m->parts);
+    free(m);
+}
+
+struct kenbak_multi * kenbak_multi_create(
+    int const capacity, bool const timing)
+{
+    assert(0 < capacity);
+
+    struct kenbak_multi * const m = calloc(1, sizeof *m);
+
+    if(m == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    size_t const n = (size_t)capacity;
+
+    // The memory's size is a multiple of the cache line size, as
+    // aligned_alloc() wants:
+    //
+    size_t const mem_size = n * KENBAK_DATA_MEM_SIZE;
+
+    m->state = calloc(n, sizeof *m->state);
+    m->reg_i = calloc(n, 1);
+    m->reg_k = calloc(n, 1);
+    m->reg_w = calloc(n, 1);
+    m->sig_r = calloc(n, 1);
+    m->sig_inc = calloc(n, 1);
+    m->sigs = calloc(n, 1);
+    m->sig_x = calloc(n, 1);
+    m->byte_times = calloc(n, sizeof *m->byte_times);
+    m->output_write_count = calloc(n, sizeof *m->output_write_count);
+    m->steps_left = calloc(n, sizeof *m->steps_left);
+#ifdef _MSC_VER
+    m->mem = _aligned_malloc(mem_size, KENBAK_DATA_CACHE_LINE_SIZE);
+#else //_MSC_VER
+    m->mem = aligned_alloc(KENBAK_DATA_CACHE_LINE_SIZE, mem_size);
+#endif //_MSC_VER
+    m->group_mem = calloc(
+        2 * kenbak_state_index_count * n, sizeof *m->group_mem);
+    m->capacity = capacity;
+    m->timing = timing;
+
+    if(m->state == NULL
+        || m->reg_i == NULL
+        || m->reg_k == NULL
+        || m->reg_w == NULL
+        || m->sig_r == NULL
+        || m->sig_inc == NULL
+        || m->sigs == NULL
+        || m->sig_x == NULL
+        || m->byte_times == NULL
+        || m->output_write_count == NULL
+        || m->steps_left == NULL
+        || m->mem == NULL
+        || m->group_mem == NULL
+        || !kenbak_multi_set_thread_count(m, 1))
+    {
+        assert(false); // Must not get here.
+        kenbak_multi_delete(m);
+        return NULL;
+    }
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        m->state[i] = kenbak_state_power_off; // Empty.
+    }
+    for(size_t i = 0; i < mem_size; ++i)
+    {
+        m->mem[i] = 0;
+    }
+    return m;
+}
@@ -0,0 +1,143 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Lockstep engine for many Kenbak-1s in struct-of-arrays form, e.g. for
+// exhaustive sweeps of input bytes or for searching through programs.
+//
+// - Each register, signal and counter of all Kenbak-1s is an array indexed by
+//   the Kenbak-1's slot, their memories are one contiguous array (256 bytes
+//   per slot).
+// - The state machine's core (see kenbak_emu_core.h) is compiled to access
+//   these arrays (see KENBAK_EMU_AT()), so each slot takes the same steps as
+//   kenbak_emu_step() would.
+// - Each tick groups the Kenbak-1s by their states and lets each state's
+//   group take its step in one loop.
+// - A Kenbak-1 in state SA executes its next instructions one after the
+//   other, each in one pass, as long as its step budget allows that, and
+//   fast-forwards countdown loops (see skip_countdown_loop() of the core), as
+//   kenbak_emu_run() does. A halted Kenbak-1 takes its remaining steps in
+//   state QC at once. So each Kenbak-1 has its own step budget, the ticks
+//   continue until all budgets are used up.
+// - The slots may get split into parts, each one stepped on its own thread
+//   (see kenbak_multi_set_thread_count()).
+// - Kenbak-1s get loaded into slots from and unloaded from slots into struct
+//   kenbak_data, with the same conditions as for the bitsliced engines (see
+//   kenbak_slice.h): Powered-on, no push button pressed and the timing model
+//   enabled as the engine's one is.
+
+#ifndef KENBAK_MULTI
+#define KENBAK_MULTI
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kenbak_data.h"
+#include "kenbak_state.h"
+
+struct kenbak_multi;
+struct kenbak_multi_pool; // (see kenbak_multi.c)
+
+// A contiguous range of slots, stepped on its own thread:
+//
+struct kenbak_multi_part
+{
+    struct kenbak_multi * m;
+    int32_t first; // First slot.
+    int32_t end; // Slot following the last one.
+
+    // The part's slots grouped by state: The group of each state index takes
+    // its step of a tick in one loop, putting each slot into the group of its
+    // next state for the next tick (see next_groups), unless its step budget
+    // is used up, then the groups swap:
+    //
+    int32_t * groups[kenbak_state_index_count];
+    int counts[kenbak_state_index_count];
+    int32_t * next_groups[kenbak_state_index_count];
+    int next_counts[kenbak_state_index_count];
+
+    uint64_t instrs; // Count of instructions executed by the part's slots.
+};
+
+struct kenbak_multi
+{
+    int capacity; // Count of slots.
+    bool timing;
+
+    // Per slot (a slot not loaded is in state power-off):
+    //
+    int16_t * state; // enum kenbak_state
+    uint8_t * reg_i;
+    uint8_t * reg_k;
+    uint8_t * reg_w;
+    uint8_t * sig_r;
+    uint8_t * sig_inc;
+    uint8_t * sigs; // See enum kenbak_sig.
+    uint8_t * sig_x;
+    uint32_t * byte_times;
+    uint32_t * output_write_count;
+    uint64_t * steps_left; // Of the current call of kenbak_multi_steps().
+
+    uint8_t * mem; // KENBAK_DATA_MEM_SIZE bytes per slot.
+
+    int32_t * group_mem; // Two groups of up to capacity slots per state.
+
+    struct kenbak_multi_part * parts;
+    int part_count;
+    struct kenbak_multi_pool * pool; // The threads of all parts but the first.
+};
+
+/**
+ * - Returns the memory of the Kenbak-1 in the given slot, e.g. to set the
+ *   input byte of each slot for a sweep.
+ */
+uint8_t * kenbak_multi_get_mem_ptr(
+    struct kenbak_multi * const m, int const slot);
+
+/**
+ * - Loads the given Kenbak-1 into the given slot (replacing what was there).
+ * - Returns false, if the given Kenbak-1 cannot be loaded (see above).
+ */
+bool kenbak_multi_load(
+    struct kenbak_multi * const m,
+    int const slot,
+    struct kenbak_data const * const d);
+
+/**
+ * - Stores the Kenbak-1 in the given slot into the given struct kenbak_data.
+ * - The slot must have been loaded. Keeps the slot loaded.
+ */
+void kenbak_multi_unload(
+    struct kenbak_multi const * const m,
+    int const slot,
+    struct kenbak_data * const d);
+
+/**
+ * - Takes the given count of steps in each loaded slot and returns the count
+ *   of instructions executed by all slots together.
+ */
+uint64_t kenbak_multi_steps(
+    struct kenbak_multi * const m, uint64_t const count);
+
+/**
+ * - Splits the slots into the given count of parts of about the same size,
+ *   each one stepped on its own thread by kenbak_multi_steps() (one part on
+ *   the calling thread), one part per processor for a count of zero.
+ * - Starts the parts' threads, waiting for the calls of kenbak_multi_steps()
+ *   until the next call of this function or kenbak_multi_delete().
+ * - There is one part by default.
+ * - Returns false on error (keeping the parts as they were).
+ */
+bool kenbak_multi_set_thread_count(
+    struct kenbak_multi * const m, int const count);
+
+void kenbak_multi_delete(struct kenbak_multi * const m);
+
+/**
+ * - Creates an engine with the given count of slots, all empty.
+ * - Returns NULL on error.
+ * - Caller takes ownership of returned object.
+ */
+struct kenbak_multi * kenbak_multi_create(
+    int const capacity, bool const timing);
+
+#endif //KENBAK_MULTI
@@ -5,7 +5,31 @@
 #define KENBAK_OUTPUT
 
 #include <stdbool.h>
+#include <stdint.h>
 
+// The bits of the packed output (see kenbak_emu_get_output_bits()), true/1
+// means that the LED is on:
+//
+enum kenbak_output_bit
+{
+    kenbak_output_bit_led_0 = 0, // Data LEDs 0 to 7 are bits 0 to 7.
+    kenbak_output_bit_led_7 = 7,
+
+    kenbak_output_bit_led_input_clear = 8,
+
+    kenbak_output_bit_led_address_set = 9,
+
+    kenbak_output_bit_led_memory_store = 10,
+
+    kenbak_output_bit_led_run_stop = 11
+};
+
+#define KENBAK_OUTPUT_MASK(output_bit) ((uint32_t)1 << (output_bit))
+
+#define KENBAK_OUTPUT_MASK_DATA 0x000000FFu
+
+// This is the original, unpacked output (also see kenbak_emu_get_output()):
+//
 struct kenbak_output
 {
     bool led_bit_7;
@@ -0,0 +1,114 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "kenbak_pool.h"
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+
+struct kenbak_data * kenbak_pool_acquire(struct kenbak_pool * const pool)
+{
+    if(pool->free_count == 0)
+    {
+        return NULL; // All Kenbak-1s are in use.
+    }
+
+    --pool->free_count;
+    return pool->datas + pool->free_indices[pool->free_count];
+}
+
+void kenbak_pool_release(
+    struct kenbak_pool * const pool, struct kenbak_data * const d)
+{
+    int const index = (int)(d - pool->datas);
+
+    assert(0 <= index && index < pool->capacity);
+    assert(pool->free_count < pool->capacity);
+
+    kenbak_emu_reset(d);
+
+    pool->free_indices[pool->free_count] = index;
+    ++pool->free_count;
+}
+
+void kenbak_pool_delete(struct kenbak_pool * const pool)
+{
+    if(pool == NULL)
+    {
+        return; // Just do nothing.
+    }
+
+    if(pool->datas != NULL)
+    {
+        for(int i = 0; i < pool->capacity; ++i)
+        {
+            kenbak_emu_deinit(pool->datas + i);
+        }
+#ifdef _MSC_VER
+        _aligned_free(pool->datas);
+#else //_MSC_VER
+        free(pool->datas);
+#endif //_MSC_VER
+    }
+    free(pool->colds);
+    free(pool->free_indices);
+    free(pool);
+}
+
+struct kenbak_pool * kenbak_pool_create(
+    int const capacity, struct kenbak_emu_options const * const options)
+{
+    assert(0 < capacity);
+
+    struct kenbak_pool * const pool = calloc(1, sizeof *pool);
+
+    if(pool == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    // The size of a Kenbak-1 is a multiple of the cache line size, as
+    // aligned_alloc() wants:
+    //
+#ifdef _MSC_VER
+    pool->datas = _aligned_malloc(
+        (size_t)capacity * sizeof *pool->datas, KENBAK_DATA_CACHE_LINE_SIZE);
+#else //_MSC_VER
+    pool->datas = aligned_alloc(
+        KENBAK_DATA_CACHE_LINE_SIZE, (size_t)capacity * sizeof *pool->datas);
+#endif //_MSC_VER
+    pool->colds = malloc((size_t)capacity * sizeof *pool->colds);
+    pool->free_indices = malloc(
+        (size_t)capacity * sizeof *pool->free_indices);
+
+    if(pool->datas == NULL
+        || pool->colds == NULL
+        || pool->free_indices == NULL)
+    {
+        assert(false); // Must not get here.
+        kenbak_pool_delete(pool); // (capacity is still zero)
+        return NULL;
+    }
+
+    for(int i = 0; i < capacity; ++i)
+    {
+        struct kenbak_emu_options const options_i = {
+            .randomize_memory = options->randomize_memory,
+            .seed = options->seed + (uint64_t)i
+        };
+
+        kenbak_emu_init_in_place(pool->datas + i, pool->colds + i, &options_i);
+
+        // The first Kenbak-1 is to be acquired first:
+        //
+        pool->free_indices[i] = capacity - 1 - i;
+    }
+    pool->capacity = capacity;
+    pool->free_count = capacity;
+    return pool;
+}
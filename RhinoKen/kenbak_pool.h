@@ -0,0 +1,62 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Pool of Kenbak-1s for batch jobs that use many short-lived ones.
+//
+// - All Kenbak-1s of a pool are allocated at once, contiguously (five cache
+//   lines each, see struct kenbak_data) and initialized in place (see
+//   kenbak_emu_init_in_place()), their cold parts are kept separately.
+// - Acquiring and releasing does not allocate anything: A released Kenbak-1
+//   gets reset (see kenbak_emu_reset()) and is handed out again by the next
+//   acquisition, with code cache and memoization still enabled, if they were.
+
+#ifndef KENBAK_POOL
+#define KENBAK_POOL
+
+#include <stdbool.h>
+
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+
+struct kenbak_pool
+{
+    int capacity; // Count of Kenbak-1s.
+
+    struct kenbak_data * datas; // Capacity Kenbak-1s.
+    struct kenbak_data_cold * colds; // Their cold parts.
+
+    // The indices of the Kenbak-1s that are not acquired, the next to be
+    // acquired is at the end:
+    //
+    int * free_indices;
+    int free_count;
+};
+
+/**
+ * - Returns the next free Kenbak-1 of the given pool, which is initialized as
+ *   if just created (see kenbak_emu_create()), or NULL, if all are acquired.
+ */
+struct kenbak_data * kenbak_pool_acquire(struct kenbak_pool * const pool);
+
+/**
+ * - Resets the given Kenbak-1 and gives it back to the given pool, that it
+ *   was acquired from.
+ */
+void kenbak_pool_release(
+    struct kenbak_pool * const pool, struct kenbak_data * const d);
+
+/**
+ * - Deletes the given pool, including its Kenbak-1s (acquired or not) and
+ *   their code caches and memoizations.
+ */
+void kenbak_pool_delete(struct kenbak_pool * const pool);
+
+/**
+ * - Creates a pool of the given count of Kenbak-1s with the given options
+ *   (see kenbak_emu_options), the Kenbak-1 at index i gets the seed plus i.
+ * - Returns NULL on error.
+ */
+struct kenbak_pool * kenbak_pool_create(
+    int const capacity, struct kenbak_emu_options const * const options);
+
+#endif //KENBAK_POOL
@@ -0,0 +1,35 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdint.h>
+#include <string.h>
+
+#include "kenbak_rand.h"
+
+uint64_t kenbak_rand_next(uint64_t * const state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void kenbak_rand_fill(
+    uint64_t * const state, uint8_t * const bytes, int const count)
+{
+    int i = 0;
+
+    for(; i + 8 <= count; i += 8)
+    {
+        uint64_t const val = kenbak_rand_next(state);
+
+        memcpy(bytes + i, &val, sizeof val); // One 64-bit write.
+    }
+    if(i < count) // Remaining bytes (of the next value).
+    {
+        uint64_t const val = kenbak_rand_next(state);
+
+        memcpy(bytes + i, &val, (size_t)(count - i));
+    }
+}
@@ -0,0 +1,30 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Pseudo-random number generator SplitMix64, with its whole state in one
+// 64-bit value (e.g. one per Kenbak-1, see kenbak_emu_options).
+//
+// - The same seed (initial state) leads to the same values on each platform
+//   (the filled bytes are in the platform's byte order, though).
+// - No global state is involved, so generators of different threads do not
+//   interfere.
+
+#ifndef KENBAK_RAND
+#define KENBAK_RAND
+
+#include <stdint.h>
+
+/**
+ * - Returns the next pseudo-random value of the generator with the given
+ *   state and advances the state.
+ */
+uint64_t kenbak_rand_next(uint64_t * const state);
+
+/**
+ * - Fills the given count of bytes with pseudo-random values from the
+ *   generator with the given state, eight bytes (one value) per write.
+ */
+void kenbak_rand_fill(
+    uint64_t * const state, uint8_t * const bytes, int const count);
+
+#endif //KENBAK_RAND
@@ -0,0 +1,924 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kenbak_recomp.h"
+#include "kenbak_instr.h"
+#include "kenbak_data.h"
+#include "kenbak_jmp_cond.h"
+
+// The maximum length of a C expression generated for an address or a value:
+//
+#define KENBAK_RECOMP_EXPR_SIZE 64
+
+struct kenbak_recomp
+{
+    FILE * out;
+    char const * name;
+    uint8_t const * image;
+
+    // Is an instruction at the address (index) reachable from the start?
+    //
+    bool is_instr[KENBAK_DATA_MEM_SIZE];
+
+    // Is the byte at the address (index) part of a reachable instruction?
+    //
+    bool is_code[KENBAK_DATA_MEM_SIZE];
+};
+
+// *****************************************************************************
+// *** REACHABILITY                                                          ***
+// *****************************************************************************
+
+/** Returns the address of the instruction that follows a jump and mark to the
+ *  given address, see step_in_sq() in kenbak_emu.c (after the mark).
+ */
+static uint8_t get_mark_continuation(uint8_t const target)
+{
+    return (uint8_t)(target + 1);
+}
+
+/** Fills the given array with the addresses of the instructions that may follow
+ *  the one at the given address and known at compile time (computed jumps are
+ *  not included), returns the count.
+ */
+static int get_successors(
+    uint8_t const * const image, uint8_t const addr, uint8_t * const succ)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(image[addr]);
+    uint8_t const second_byte = image[(uint8_t)(addr + 1)];
+    int count = 0;
+
+    switch((enum kenbak_instr_type)dec->type)
+    {
+        case kenbak_instr_type_misc:
+        {
+            if(!dec->is_halt)
+            {
+                succ[count++] = (uint8_t)(addr + 1);
+            }
+            break;
+        }
+        case kenbak_instr_type_shift_rot:
+        {
+            succ[count++] = (uint8_t)(addr + 1);
+            break;
+        }
+        case kenbak_instr_type_jump:
+        {
+            if(!dec->jmp_is_unc || dec->jmp_is_mark)
+            {
+                // (after a mark, this is where the subroutine usually returns
+                // to via an indirect jump)
+                //
+                succ[count++] = (uint8_t)(addr + 2);
+            }
+            if(dec->addr_mode == kenbak_addr_mode_constant) // Direct jump.
+            {
+                succ[count++] = dec->jmp_is_mark
+                    ? get_mark_continuation(second_byte) : second_byte;
+            }
+            break;
+        }
+        case kenbak_instr_type_bit:
+        {
+            succ[count++] = (uint8_t)(addr + 2);
+            if(dec->bit_is_skip)
+            {
+                succ[count++] = (uint8_t)(addr + 4);
+            }
+            break;
+        }
+
+        default: // ADD, SUB, LOAD, STORE, AND, OR and LNEG.
+        {
+            succ[count++] = (uint8_t)(addr + 2);
+            break;
+        }
+    }
+    return count;
+}
+
+static void find_reachable(struct kenbak_recomp * const r)
+{
+    uint8_t stack[KENBAK_DATA_MEM_SIZE];
+    int stack_len = 0;
+
+    memset(r->is_instr, 0, sizeof r->is_instr);
+    memset(r->is_code, 0, sizeof r->is_code);
+
+    // The first instruction is at P (see step_in_qc() in kenbak_emu.c):
+    //
+    stack[stack_len++] = r->image[KENBAK_DATA_ADDR_P];
+    r->is_instr[r->image[KENBAK_DATA_ADDR_P]] = true;
+
+    while(0 < stack_len)
+    {
+        uint8_t const addr = stack[--stack_len];
+        uint8_t succ[2];
+        int const count = get_successors(r->image, addr, succ);
+
+        r->is_code[addr] = true;
+        if(KENBAK_INSTR_DECODE(r->image[addr])->len == 2)
+        {
+            r->is_code[(uint8_t)(addr + 1)] = true;
+        }
+
+        for(int i = 0; i < count; ++i)
+        {
+            if(!r->is_instr[succ[i]])
+            {
+                r->is_instr[succ[i]] = true;
+                stack[stack_len++] = succ[i]; // (each address once, only)
+            }
+        }
+    }
+}
+
+// *****************************************************************************
+// *** CODE GENERATION                                                       ***
+// *****************************************************************************
+
+static void write_byte_array(
+    struct kenbak_recomp const * const r,
+    char const * const type,
+    char const * const name,
+    uint8_t const * const bytes)
+{
+    fprintf(r->out, "static %s const %s[%d] = {", type, name,
+        KENBAK_DATA_MEM_SIZE);
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        fprintf(
+            r->out,
+            "%s0%03o%s",
+            i % 8 == 0 ? "\n    " : " ",
+            (unsigned int)bytes[i],
+            i + 1 < KENBAK_DATA_MEM_SIZE ? "," : "");
+    }
+    fprintf(r->out, "\n};\n\n");
+}
+
+/** Writes the statements that end an instruction and continue with the one at
+ *  the given address, known at compile time (after updating P like state SB
+ *  does).
+ */
+static void write_next(
+    struct kenbak_recomp const * const r,
+    char const * const indent,
+    uint8_t const addr)
+{
+    fprintf(r->out,
+        "%s    if(++n == max_instrs)\n"
+        "%s    {\n"
+        "%s        stop = kenbak_recomp_stop_instrs;\n"
+        "%s        goto done;\n"
+        "%s    }\n"
+        "%s    mem[%d] = 0%03o;\n"
+        "%s    goto L_%03o;\n",
+        indent, indent, indent, indent, indent,
+        indent,
+        KENBAK_DATA_ADDR_P,
+        (unsigned int)addr,
+        indent,
+        (unsigned int)addr);
+}
+
+/** Writes the statements that end an instruction and continue with the one at
+ *  P plus the given increment (like state SB does), via dispatch.
+ */
+static void write_next_dyn(
+    struct kenbak_recomp const * const r,
+    char const * const indent,
+    int const inc)
+{
+    fprintf(r->out,
+        "%s    if(++n == max_instrs)\n"
+        "%s    {\n"
+        "%s        stop = kenbak_recomp_stop_instrs;\n"
+        "%s        goto done;\n"
+        "%s    }\n",
+        indent, indent, indent, indent, indent);
+    if(inc != 0)
+    {
+        fprintf(r->out,
+            "%s    mem[%d] = (uint8_t)(mem[%d] + %d);\n",
+            indent,
+            KENBAK_DATA_ADDR_P,
+            KENBAK_DATA_ADDR_P,
+            inc);
+    }
+    fprintf(r->out, "%s    goto dispatch;\n", indent);
+}
+
+/** Writes a statement that writes the given value to the given address (both C
+ *  expressions), the address is known at compile time, if the given static
+ *  address is not -1.
+ *
+ * - Returns true, if the write may change compiled code or P, so the next
+ *   instruction needs to be found via dispatch.
+ */
+static bool write_mem_write(
+    struct kenbak_recomp const * const r,
+    char const * const indent,
+    int const static_addr,
+    char const * const addr_expr,
+    char const * const val_expr)
+{
+    if(static_addr != -1
+        && static_addr != KENBAK_DATA_ADDR_P
+        && !r->is_code[static_addr])
+    {
+        fprintf(r->out,
+            "%s    mem[%s] = (uint8_t)(%s);\n", indent, addr_expr, val_expr);
+        return false;
+    }
+    fprintf(r->out,
+        "%s    %s_write(mem, (uint8_t)(%s), (uint8_t)(%s), &modified);\n",
+        indent,
+        r->name,
+        addr_expr,
+        val_expr);
+    return true;
+}
+
+/** Fills the given buffer with the C expression for the condition of the given
+ *  conditional jump instruction.
+ */
+static void fill_jmp_cond(
+    char * const buf, struct kenbak_instr_decoded const * const dec)
+{
+    switch((enum kenbak_jmp_cond)dec->jmp_cond)
+    {
+        case kenbak_jmp_cond_non_zero:
+        {
+            snprintf(buf, KENBAK_RECOMP_EXPR_SIZE, "mem[%d] != 0", dec->reg);
+            return;
+        }
+        case kenbak_jmp_cond_zero:
+        {
+            snprintf(buf, KENBAK_RECOMP_EXPR_SIZE, "mem[%d] == 0", dec->reg);
+            return;
+        }
+        case kenbak_jmp_cond_neg:
+        {
+            snprintf(
+                buf, KENBAK_RECOMP_EXPR_SIZE, "(mem[%d] & 0x80) != 0", dec->reg);
+            return;
+        }
+        case kenbak_jmp_cond_pos:
+        {
+            snprintf(
+                buf, KENBAK_RECOMP_EXPR_SIZE, "(mem[%d] & 0x80) == 0", dec->reg);
+            return;
+        }
+        case kenbak_jmp_cond_pos_non_zero:
+        {
+            snprintf(
+                buf,
+                KENBAK_RECOMP_EXPR_SIZE,
+                "(mem[%d] & 0x80) == 0 && (mem[%d] & 0x7F) != 0",
+                dec->reg,
+                dec->reg);
+            return;
+        }
+
+        default:
+        {
+            assert(false); // Must not get here.
+            snprintf(buf, KENBAK_RECOMP_EXPR_SIZE, "false");
+            return;
+        }
+    }
+}
+
+/** Fills the given buffer with the C expression for the address the given
+ *  two-byte instruction (no jump) at the given address works on (see states
+ *  SE to SJ), returns the address, if known at compile time, -1 otherwise.
+ */
+static int fill_operand_addr(
+    char * const buf,
+    struct kenbak_instr_decoded const * const dec,
+    uint8_t const addr,
+    uint8_t const second_byte)
+{
+    switch((enum kenbak_addr_mode)dec->addr_mode)
+    {
+        case kenbak_addr_mode_constant: // Store immediate, see step_in_se().
+        {
+            snprintf(
+                buf,
+                KENBAK_RECOMP_EXPR_SIZE,
+                "0%03o",
+                (unsigned int)(uint8_t)(addr + 1));
+            return (uint8_t)(addr + 1);
+        }
+        case kenbak_addr_mode_memory:
+        {
+            snprintf(
+                buf, KENBAK_RECOMP_EXPR_SIZE, "0%03o", (unsigned int)second_byte);
+            return second_byte;
+        }
+        case kenbak_addr_mode_indirect:
+        {
+            snprintf(
+                buf,
+                KENBAK_RECOMP_EXPR_SIZE,
+                "mem[0%03o]",
+                (unsigned int)second_byte);
+            return -1;
+        }
+        case kenbak_addr_mode_indexed:
+        {
+            snprintf(
+                buf,
+                KENBAK_RECOMP_EXPR_SIZE,
+                "(uint8_t)(0%03o + mem[%d])",
+                (unsigned int)second_byte,
+                KENBAK_DATA_ADDR_X);
+            return -1;
+        }
+        case kenbak_addr_mode_indirect_indexed:
+        {
+            snprintf(
+                buf,
+                KENBAK_RECOMP_EXPR_SIZE,
+                "(uint8_t)(mem[0%03o] + mem[%d])",
+                (unsigned int)second_byte,
+                KENBAK_DATA_ADDR_X);
+            return -1;
+        }
+
+        case kenbak_addr_mode_none: // (falls through)
+        default:
+        {
+            assert(false); // Must not get here.
+            snprintf(buf, KENBAK_RECOMP_EXPR_SIZE, "0");
+            return -1;
+        }
+    }
+}
+
+static void write_jump(
+    struct kenbak_recomp const * const r,
+    struct kenbak_instr_decoded const * const dec,
+    uint8_t const addr,
+    uint8_t const second_byte)
+{
+    bool const is_direct = dec->addr_mode == kenbak_addr_mode_constant;
+    char const * const ind = dec->jmp_is_unc ? "" : "    ";
+
+    if(!dec->jmp_is_unc)
+    {
+        char cond[KENBAK_RECOMP_EXPR_SIZE];
+
+        fill_jmp_cond(cond, dec);
+        fprintf(r->out, "    if(%s)\n    {\n", cond);
+    }
+
+    fprintf(r->out,
+        is_direct
+            ? "%s    uint8_t const t = 0%03o;\n"
+            : "%s    uint8_t const t = mem[0%03o];\n",
+        ind,
+        (unsigned int)second_byte);
+    fprintf(r->out, "%s    mem[%d] = t;\n", ind, KENBAK_DATA_ADDR_P);
+
+    if(dec->jmp_is_mark)
+    {
+        char val[KENBAK_RECOMP_EXPR_SIZE];
+
+        // The return address is the one of the instruction following this one,
+        // see state SQ:
+        //
+        snprintf(val, sizeof val, "0%03o", (unsigned int)(uint8_t)(addr + 2));
+        write_mem_write(r, ind, -1, "t", val);
+        write_next_dyn(r, ind, 1); // Continues after the mark.
+    }
+    else if(is_direct)
+    {
+        write_next(r, ind, second_byte);
+    }
+    else
+    {
+        write_next_dyn(r, ind, 0);
+    }
+
+    if(!dec->jmp_is_unc)
+    {
+        fprintf(r->out, "    }\n");
+        write_next(r, "", (uint8_t)(addr + 2)); // Condition is false.
+    }
+}
+
+static void write_instr(struct kenbak_recomp const * const r, uint8_t const addr)
+{
+    uint8_t const first_byte = r->image[addr];
+    uint8_t const second_byte = r->image[(uint8_t)(addr + 1)];
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(first_byte);
+    enum kenbak_instr_type const type = (enum kenbak_instr_type)dec->type;
+    char str[KENBAK_RECOMP_EXPR_SIZE];
+    char reg[KENBAK_RECOMP_EXPR_SIZE];
+    bool dyn = false;
+
+    kenbak_instr_fill_str(str, sizeof str, first_byte, second_byte);
+    for(int i = (int)strlen(str) - 1; 0 <= i && str[i] == ' '; --i)
+    {
+        str[i] = '\0'; // Removes trailing spaces.
+    }
+    if(dec->len == 2)
+    {
+        fprintf(r->out, "L_%03o: // %03o %03o %s\n{\n", (unsigned int)addr,
+            (unsigned int)first_byte, (unsigned int)second_byte, str);
+    }
+    else
+    {
+        fprintf(r->out, "L_%03o: // %03o %s\n{\n", (unsigned int)addr,
+            (unsigned int)first_byte, str);
+    }
+
+    snprintf(reg, sizeof reg, "%d", dec->reg);
+
+    switch(type)
+    {
+        case kenbak_instr_type_misc:
+        {
+            if(!dec->is_halt)
+            {
+                write_next(r, "", (uint8_t)(addr + 1)); // NOOP.
+                break;
+            }
+            fprintf(r->out,
+                "    if(++n == max_instrs)\n"
+                "    {\n"
+                "        stop = kenbak_recomp_stop_instrs;\n"
+                "        goto done;\n"
+                "    }\n"
+                "    mem[%d] = 0%03o;\n"
+                "    stop = kenbak_recomp_stop_halt;\n"
+                "    goto done;\n",
+                KENBAK_DATA_ADDR_P,
+                (unsigned int)(uint8_t)(addr + 1));
+            break;
+        }
+        case kenbak_instr_type_shift_rot:
+        {
+            char val[KENBAK_RECOMP_EXPR_SIZE];
+            int const n = dec->shift_places;
+
+            switch((enum kenbak_instr_shift)dec->shift_kind)
+            {
+                case kenbak_instr_shift_right_shift:
+                {
+                    snprintf(val, sizeof val, "mem[%d] >> %d", dec->reg, n);
+                    break;
+                }
+                case kenbak_instr_shift_left_shift:
+                {
+                    snprintf(val, sizeof val, "mem[%d] << %d", dec->reg, n);
+                    break;
+                }
+                case kenbak_instr_shift_right_rot:
+                {
+                    snprintf(
+                        val,
+                        sizeof val,
+                        "(mem[%d] >> %d) | (mem[%d] << %d)",
+                        dec->reg,
+                        n,
+                        dec->reg,
+                        8 - n);
+                    break;
+                }
+                case kenbak_instr_shift_left_rot: // (falls through)
+                default:
+                {
+                    snprintf(
+                        val,
+                        sizeof val,
+                        "(mem[%d] << %d) | (mem[%d] >> %d)",
+                        dec->reg,
+                        n,
+                        dec->reg,
+                        8 - n);
+                    break;
+                }
+            }
+            dyn = write_mem_write(r, "", dec->reg, reg, val);
+            if(dyn)
+            {
+                write_next_dyn(r, "", 1);
+            }
+            else
+            {
+                write_next(r, "", (uint8_t)(addr + 1));
+            }
+            break;
+        }
+        case kenbak_instr_type_jump:
+        {
+            write_jump(r, dec, addr, second_byte);
+            break;
+        }
+        case kenbak_instr_type_bit:
+        {
+            uint8_t const mask = (uint8_t)(1 << dec->bit_pos);
+            char target[KENBAK_RECOMP_EXPR_SIZE];
+            char val[KENBAK_RECOMP_EXPR_SIZE];
+
+            snprintf(target, sizeof target, "0%03o", (unsigned int)second_byte);
+            if(dec->bit_is_skip)
+            {
+                fprintf(r->out,
+                    "    if(((mem[%s] & 0x%02X) != 0) == %s)\n    {\n",
+                    target,
+                    (unsigned int)mask,
+                    dec->bit_val ? "true" : "false");
+                write_next(r, "    ", (uint8_t)(addr + 4));
+                fprintf(r->out, "    }\n");
+                write_next(r, "", (uint8_t)(addr + 2));
+                break;
+            }
+            if(dec->bit_val)
+            {
+                snprintf(val, sizeof val, "mem[0%03o] | 0x%02X",
+                    (unsigned int)second_byte, (unsigned int)mask);
+            }
+            else
+            {
+                snprintf(val, sizeof val, "mem[0%03o] & 0x%02X",
+                    (unsigned int)second_byte, (unsigned int)(uint8_t)~mask);
+            }
+            dyn = write_mem_write(r, "", second_byte, target, val);
+            if(dyn)
+            {
+                write_next_dyn(r, "", 2);
+            }
+            else
+            {
+                write_next(r, "", (uint8_t)(addr + 2));
+            }
+            break;
+        }
+        case kenbak_instr_type_store:
+        {
+            char target[KENBAK_RECOMP_EXPR_SIZE];
+            char val[KENBAK_RECOMP_EXPR_SIZE];
+            int const static_target =
+                fill_operand_addr(target, dec, addr, second_byte);
+
+            // The address is found before the register is read (SE to SP):
+            //
+            fprintf(r->out, "    uint8_t const t = %s;\n", target);
+            snprintf(val, sizeof val, "mem[%d]", dec->reg);
+            dyn = write_mem_write(r, "", static_target, "t", val);
+            if(dyn)
+            {
+                write_next_dyn(r, "", 2);
+            }
+            else
+            {
+                write_next(r, "", (uint8_t)(addr + 2));
+            }
+            break;
+        }
+
+        default: // ADD, SUB, LOAD, AND, OR and LNEG.
+        {
+            char val[KENBAK_RECOMP_EXPR_SIZE];
+
+            if(dec->addr_mode == kenbak_addr_mode_constant)
+            {
+                fprintf(r->out,
+                    "    uint8_t const w = 0%03o;\n", (unsigned int)second_byte);
+            }
+            else
+            {
+                char operand_addr[KENBAK_RECOMP_EXPR_SIZE];
+
+                fill_operand_addr(operand_addr, dec, addr, second_byte);
+                fprintf(r->out,
+                    "    uint8_t const w = mem[%s];\n", operand_addr);
+            }
+
+            switch(type)
+            {
+                case kenbak_instr_type_add: // (falls through)
+                case kenbak_instr_type_sub:
+                {
+                    char oc[KENBAK_RECOMP_EXPR_SIZE];
+
+                    // Overflow and carry are always written as zero by the
+                    // emulator (see exec_change_reg()):
+                    //
+                    snprintf(
+                        oc, sizeof oc, "0%03o",
+                        (unsigned int)KENBAK_DATA_ADDR_OC_FOR(dec->reg));
+                    fprintf(r->out, "    uint8_t const v = mem[%d];\n",
+                        dec->reg);
+                    dyn = write_mem_write(
+                        r, "", KENBAK_DATA_ADDR_OC_FOR(dec->reg), oc, "0");
+                    snprintf(val, sizeof val, "v %c w",
+                        type == kenbak_instr_type_add ? '+' : '-');
+                    break;
+                }
+                case kenbak_instr_type_and:
+                {
+                    snprintf(val, sizeof val, "mem[%d] & w", dec->reg);
+                    break;
+                }
+                case kenbak_instr_type_or:
+                {
+                    snprintf(val, sizeof val, "mem[%d] | w", dec->reg);
+                    break;
+                }
+                case kenbak_instr_type_lneg:
+                {
+                    snprintf(val, sizeof val, "-w");
+                    break;
+                }
+                case kenbak_instr_type_load: // (falls through)
+                default:
+                {
+                    snprintf(val, sizeof val, "w");
+                    break;
+                }
+            }
+            dyn = write_mem_write(r, "", dec->reg, reg, val) || dyn;
+            if(dyn)
+            {
+                write_next_dyn(r, "", 2);
+            }
+            else
+            {
+                write_next(r, "", (uint8_t)(addr + 2));
+            }
+            break;
+        }
+    }
+
+    fprintf(r->out, "}\n");
+}
+
+bool kenbak_recomp_write_prog(
+    FILE * const out, char const * const name, uint8_t const * const image)
+{
+    struct kenbak_recomp r;
+    char buf[KENBAK_RECOMP_EXPR_SIZE];
+
+    if(out == NULL || name == NULL || image == NULL)
+    {
+        assert(false);
+        return false;
+    }
+
+    r.out = out;
+    r.name = name;
+    r.image = image;
+    find_reachable(&r);
+
+    fprintf(out,
+        "\n// Generated by kenbak_recomp_write_prog(), do not edit.\n\n"
+        "#include <stdint.h>\n"
+        "#include <stdbool.h>\n\n"
+        "#include \"kenbak_recomp.h\"\n\n");
+
+    fprintf(out, "// The compiled memory image:\n//\n");
+    snprintf(buf, sizeof buf, "s_%s_image", name);
+    write_byte_array(&r, "uint8_t", buf, image);
+
+    fprintf(out,
+        "// Is the byte at the address (index) part of the compiled code?\n//\n");
+    {
+        uint8_t is_code[KENBAK_DATA_MEM_SIZE];
+
+        for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+        {
+            is_code[i] = r.is_code[i] ? 1 : 0;
+        }
+        snprintf(buf, sizeof buf, "s_%s_is_code", name);
+        write_byte_array(&r, "uint8_t", buf, is_code);
+    }
+
+    fprintf(out,
+        "static inline void %s_write(\n"
+        "    uint8_t * const mem,\n"
+        "    uint8_t const addr,\n"
+        "    uint8_t const val,\n"
+        "    bool * const modified)\n"
+        "{\n"
+        "    mem[addr] = val;\n"
+        "    if(s_%s_is_code[addr] != 0 && val != s_%s_image[addr])\n"
+        "    {\n"
+        "        *modified = true; // Compiled code is not valid, anymore.\n"
+        "    }\n"
+        "}\n\n",
+        name, name, name);
+
+    fprintf(out,
+        "enum kenbak_recomp_stop %s_run(\n"
+        "    uint8_t * const mem, uint64_t const max_instrs, uint64_t * const instrs)\n"
+        "{\n"
+        "    enum kenbak_recomp_stop stop = kenbak_recomp_stop_fallback;\n"
+        "    uint64_t n = 0;\n"
+        "    bool modified = false;\n\n"
+        "    for(int i = 0; i < %d; ++i)\n"
+        "    {\n"
+        "        if(s_%s_is_code[i] != 0 && mem[i] != s_%s_image[i])\n"
+        "        {\n"
+        "            goto done; // Not the compiled code.\n"
+        "        }\n"
+        "    }\n",
+        name, KENBAK_DATA_MEM_SIZE, name, name);
+
+    if(r.is_code[KENBAK_DATA_ADDR_P])
+    {
+        // Each update of P would modify the code:
+
+        fprintf(out,
+            "    (void)max_instrs;\n"
+            "    (void)modified;\n"
+            "    goto done; // P is part of the code.\n\n");
+    }
+    else
+    {
+        fprintf(out,
+            "    goto dispatch; // P points to the first instruction.\n\n");
+
+        for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+        {
+            if(r.is_instr[i])
+            {
+                write_instr(&r, (uint8_t)i);
+            }
+        }
+
+        fprintf(out,
+            "\ndispatch:\n"
+            "    if(modified)\n"
+            "    {\n"
+            "        goto done;\n"
+            "    }\n"
+            "    switch(mem[%d])\n"
+            "    {\n",
+            KENBAK_DATA_ADDR_P);
+        for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+        {
+            if(r.is_instr[i])
+            {
+                fprintf(out,
+                    "        case 0%03o: goto L_%03o;\n",
+                    (unsigned int)i,
+                    (unsigned int)i);
+            }
+        }
+        fprintf(out,
+            "\n"
+            "        default:\n"
+            "        {\n"
+            "            break; // Not compiled.\n"
+            "        }\n"
+            "    }\n\n");
+    }
+
+    fprintf(out,
+        "done:\n"
+        "    *instrs += n;\n"
+        "    return stop;\n"
+        "}\n");
+
+    return ferror(out) == 0;
+}
+
+bool kenbak_recomp_write_driver(
+    FILE * const out,
+    char const * const name,
+    uint8_t const * const image,
+    uint64_t const max_instrs)
+{
+    struct kenbak_recomp r;
+
+    if(out == NULL || name == NULL || image == NULL)
+    {
+        assert(false);
+        return false;
+    }
+
+    r.out = out;
+    r.name = name;
+    r.image = image;
+
+    fprintf(out,
+        "\n// Generated by kenbak_recomp_write_driver(), do not edit.\n\n"
+        "#include <stdio.h>\n"
+        "#include <stdint.h>\n"
+        "#include <stdbool.h>\n"
+        "#include <string.h>\n\n"
+        "#include \"kenbak_emu.h\"\n"
+        "#include \"kenbak_data.h\"\n"
+        "#include \"kenbak_state.h\"\n"
+        "#include \"kenbak_recomp.h\"\n\n"
+        "#define MAX_INSTRS %lluull\n\n"
+        "enum kenbak_recomp_stop %s_run(\n"
+        "    uint8_t * const mem, uint64_t const max_instrs, uint64_t * const instrs);\n\n",
+        (unsigned long long)max_instrs,
+        name);
+
+    write_byte_array(&r, "uint8_t", "s_image", image);
+
+    fprintf(out,
+        "/** Returns a powered-on Kenbak-1 with the given memory, that is in run\n"
+        " *  mode at P (caller takes ownership).\n"
+        " */\n"
+        "static struct kenbak_data * create_running(uint8_t const * const mem)\n"
+        "{\n"
+        "    struct kenbak_data * const d = kenbak_emu_create(false);\n\n"
+        "    kenbak_emu_press(d, kenbak_input_bit_power_on);\n"
+        "    kenbak_emu_step(d);\n\n"
+        "    for(int i = 0; i < %d; ++i)\n"
+        "    {\n"
+        "        *kenbak_emu_get_mem_ptr(d, (uint8_t)i) = mem[i];\n"
+        "    }\n\n"
+        "    kenbak_emu_press(d, kenbak_input_bit_run_start);\n"
+        "    kenbak_emu_step(d);\n"
+        "    kenbak_emu_step(d);\n"
+        "    kenbak_emu_release(d, kenbak_input_bit_run_start);\n"
+        "    kenbak_emu_step(d);\n"
+        "    return d;\n"
+        "}\n\n"
+        "static void run(struct kenbak_data * const d, uint64_t const max)\n"
+        "{\n"
+        "    struct kenbak_run_limits limits = { 0 };\n"
+        "    struct kenbak_run_result result;\n\n"
+        "    limits.max_instrs = max;\n"
+        "    limits.stop_at_qc = true;\n"
+        "    kenbak_emu_run(d, &limits, &result);\n"
+        "}\n\n"
+        "/** Steps like run() would.\n"
+        " */\n"
+        "static void run_by_steps(struct kenbak_data * const d, uint64_t const max)\n"
+        "{\n"
+        "    uint64_t instrs = 0;\n\n"
+        "    while(true)\n"
+        "    {\n"
+        "        enum kenbak_state const last_state = d->state;\n\n"
+        "        if((last_state == kenbak_state_sa\n"
+        "                || last_state == kenbak_state_qc)\n"
+        "            && max <= instrs)\n"
+        "        {\n"
+        "            return;\n"
+        "        }\n"
+        "        kenbak_emu_step(d);\n"
+        "        if(last_state == kenbak_state_sd)\n"
+        "        {\n"
+        "            ++instrs;\n"
+        "        }\n"
+        "        if(last_state != kenbak_state_qc\n"
+        "            && d->state == kenbak_state_qc)\n"
+        "        {\n"
+        "            return;\n"
+        "        }\n"
+        "    }\n"
+        "}\n\n",
+        KENBAK_DATA_MEM_SIZE);
+
+    fprintf(out,
+        "int main(void)\n"
+        "{\n"
+        "    uint8_t mem[%d];\n"
+        "    uint64_t instrs = 0;\n"
+        "    struct kenbak_data * d = NULL;\n"
+        "    bool equal = false;\n\n"
+        "    // Compiled, falling back to the emulator, if necessary:\n\n"
+        "    memcpy(mem, s_image, sizeof mem);\n"
+        "    if(%s_run(mem, MAX_INSTRS, &instrs)\n"
+        "            == kenbak_recomp_stop_fallback\n"
+        "        && instrs < MAX_INSTRS)\n"
+        "    {\n"
+        "        printf(\"Fallback to emulator after %%llu instr.\\n\",\n"
+        "            (unsigned long long)instrs);\n\n"
+        "        d = create_running(mem);\n"
+        "        run(d, MAX_INSTRS - instrs);\n"
+        "        memcpy(mem, d->mem, sizeof mem);\n"
+        "        kenbak_emu_delete(d);\n"
+        "    }\n\n"
+        "    // Emulated step by step, only:\n\n"
+        "    d = create_running(s_image);\n"
+        "    run_by_steps(d, MAX_INSTRS);\n"
+        "    equal = memcmp(mem, d->mem, sizeof mem) == 0;\n"
+        "    kenbak_emu_delete(d);\n\n"
+        "    printf(\"Final memory is %%s.\\n\", equal ? \"equal\" : \"NOT equal\");\n"
+        "    return equal ? 0 : 1;\n"
+        "}\n",
+        KENBAK_DATA_MEM_SIZE,
+        name);
+
+    return ferror(out) == 0;
+}
@@ -0,0 +1,80 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Static recompiler: Translates a Kenbak-1 memory image into a portable C
+// translation unit that executes the program directly on a 256 byte memory.
+//
+// - Each instruction reachable from the start address (at P) becomes a label,
+//   jumps to addresses known at compile time are gotos and computed jumps
+//   (indirect ones and changes of P by stores) dispatch via a switch on P.
+// - The results equal the ones of the emulator in run mode (see
+//   kenbak_emu_run()), as far as the memory is concerned (no input is
+//   sampled, no timing is modeled).
+// - If an instruction gets modified at run time or P leaves the compiled code,
+//   the generated function returns kenbak_recomp_stop_fallback, so that the
+//   caller can continue with the emulator (the generated driver does so).
+
+#ifndef KENBAK_RECOMP
+#define KENBAK_RECOMP
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Why a generated function returned:
+//
+enum kenbak_recomp_stop
+{
+    // Executed a HALT instruction (P points to the following instruction):
+    //
+    kenbak_recomp_stop_halt = 0,
+
+    // Instruction budget is used up (memory equals the emulator's at the next
+    // instruction boundary):
+    //
+    kenbak_recomp_stop_instrs = 1,
+
+    // Compiled code got modified or P points to code that was not compiled,
+    // continue with the emulator at P (like after pressing the start button):
+    //
+    kenbak_recomp_stop_fallback = 2
+};
+
+/**
+ * - Writes a C translation unit for the program in the given 256 byte memory
+ *   image to the given file, starting at the address at P (see
+ *   KENBAK_DATA_ADDR_P).
+ * - The translation unit defines this function (with <name> being the given
+ *   name, which must be a valid C identifier):
+ *
+ *   enum kenbak_recomp_stop <name>_run(
+ *       uint8_t * const mem, uint64_t const max_instrs, uint64_t * const instrs);
+ *
+ *   It runs the program in the given memory (which should equal the image,
+ *   at least where compiled code is), until a HALT, until the count of
+ *   executed instructions reaches the given maximum (zero for no limit) or
+ *   until it needs to fall back to the emulator. The count of executed
+ *   instructions gets added to instrs.
+ * - Returns false on error.
+ */
+bool kenbak_recomp_write_prog(
+    FILE * const out, char const * const name, uint8_t const * const image);
+
+/**
+ * - Writes a C translation unit with a main() function to the given file,
+ *   that runs the given image via <name>_run() (see
+ *   kenbak_recomp_write_prog()), falling back to the emulator, if necessary,
+ *   and compares the final memory with the one the emulator reaches on its
+ *   own via kenbak_emu_step() (up to the given maximum instruction count,
+ *   stopping at QC, like kenbak_emu_run() would).
+ * - The driver prints the result and returns zero, if the memory is equal
+ *   (see test/kenbak_diff.h for the generated test).
+ * - Returns false on error.
+ */
+bool kenbak_recomp_write_driver(
+    FILE * const out,
+    char const * const name,
+    uint8_t const * const image,
+    uint64_t const max_instrs);
+
+#endif //KENBAK_RECOMP
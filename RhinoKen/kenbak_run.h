@@ -0,0 +1,111 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#ifndef KENBAK_RUN
+#define KENBAK_RUN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Why kenbak_emu_run() returned:
+//
+enum kenbak_run_stop
+{
+    kenbak_run_stop_none = 0, // (never returned)
+
+    kenbak_run_stop_steps = 1, // Step budget is used up.
+    kenbak_run_stop_instrs = 2, // Instruction budget is used up.
+    kenbak_run_stop_byte_times = 3, // Byte time budget is used up.
+
+    kenbak_run_stop_qc = 4, // Entered QC (by HALT or the run stop button).
+    kenbak_run_stop_p = 5, // The next instruction is at the given address.
+    kenbak_run_stop_output = 6, // The output register got written to.
+
+    // Nothing changes until the input changes (see kenbak_emu_is_quiescent()),
+    // the remaining step and byte time budgets got used up by idling:
+    //
+    kenbak_run_stop_quiescent = 7,
+
+    kenbak_run_stop_power_off = 8, // The Kenbak-1 is (or got) powered-off.
+    kenbak_run_stop_error = 9,
+
+    // The Kenbak-1 entered a cycle of states (see detect_cycles and
+    // skip_cycles of struct kenbak_run_limits):
+    //
+    kenbak_run_stop_cycle = 10
+};
+
+// When kenbak_emu_run() shall stop (whatever happens first).
+//
+// - A budget of zero means "no limit".
+//
+struct kenbak_run_limits
+{
+    uint64_t max_steps; // Count of steps, see kenbak_emu_step().
+    uint64_t max_instrs; // Count of instructions fetched in run mode.
+
+    // Sum of byte times returned by the steps. Checked before each step, but
+    // in run mode also before each instruction executed in one pass, so it
+    // may get exceeded by up to one instruction's byte times:
+    //
+    uint64_t max_byte_times;
+
+    // Stop on entry to the idle state QC (not if already in QC on call):
+    //
+    bool stop_at_qc;
+
+    // Stop in state SA, if the next instruction to be executed is at address
+    // p (not checked before the first step, to be able to continue from
+    // there):
+    //
+    bool stop_at_p;
+    uint8_t p;
+
+    // Stop at the next instruction boundary (state SA or QC) after the output
+    // register (address 0200) got written to:
+    //
+    bool stop_at_output;
+
+    // Stop in state SA, if the whole state of the Kenbak-1 (memory, registers,
+    // signals, input and delay line position with the timing model enabled)
+    // equals the one at an earlier instruction boundary of this call, so it
+    // would repeat forever (the result tells about the cycle):
+    //
+    // - Uses Brent's algorithm, so the cycle gets found after at most about
+    //   three times its length after entering it.
+    // - Prefer to enable the incremental hashing via kenbak_emu_set_hashing().
+    // - Instructions are not taken from the code cache while looking for a
+    //   cycle.
+    //
+    bool detect_cycles;
+
+    // Look for a cycle like detect_cycles does, but instead of stopping, let
+    // as many passes of the cycle pass arithmetically as the step,
+    // instruction and byte time budgets allow, then continue normally (e.g.
+    // to find the state after a far-future step count). Stops like
+    // detect_cycles does, if no budget is given:
+    //
+    bool skip_cycles;
+};
+
+// What kenbak_emu_run() did:
+//
+struct kenbak_run_result
+{
+    enum kenbak_run_stop stop;
+
+    uint64_t steps; // Count of steps taken.
+    uint64_t instrs; // Count of instructions fetched in run mode.
+    uint64_t byte_times; // Sum of the byte times of all steps taken.
+
+    // If a cycle got found (see detect_cycles and skip_cycles of struct
+    // kenbak_run_limits), its lengths and the count of steps after which the
+    // state at its start was reached again, otherwise zero:
+    //
+    uint64_t cycle_at_steps;
+    uint64_t cycle_steps;
+    uint64_t cycle_instrs;
+    uint64_t cycle_byte_times;
+};
+
+#endif //KENBAK_RUN
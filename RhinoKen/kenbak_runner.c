@@ -0,0 +1,361 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#ifndef _MSC_VER
+    #define _POSIX_C_SOURCE 200809L // For clock_gettime() and nanosleep().
+#endif //_MSC_VER
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _MSC_VER
+    #include <windows.h>
+#else //_MSC_VER
+    #include <stdatomic.h>
+    #include <pthread.h>
+    #include <time.h>
+#endif //_MSC_VER
+
+#include "kenbak_runner.h"
+#include "kenbak_emu.h"
+#include "kenbak_data.h"
+#include "kenbak_run.h"
+
+// The index of the snapshot buffer between both threads (see middle of struct
+// kenbak_runner) and whether the emulation thread published it since the
+// drawing thread took the last one:
+//
+#define KENBAK_RUNNER_INDEX_MASK 3
+#define KENBAK_RUNNER_FRESH 4
+
+// *****************************************************************************
+// *** PLATFORM-SPECIFIC                                                     ***
+// *****************************************************************************
+
+// The values shared by both threads, all accesses are sequentially
+// consistent:
+//
+#ifdef _MSC_VER
+    typedef LONG volatile kenbak_runner_shared;
+#else //_MSC_VER
+    typedef atomic_long kenbak_runner_shared;
+#endif //_MSC_VER
+
+/** Initializes the given shared value, before the other thread exists.
+ */
+static void init_shared(kenbak_runner_shared * const p, long const val)
+{
+#ifdef _MSC_VER
+    *p = val;
+#else //_MSC_VER
+    atomic_init(p, val);
+#endif //_MSC_VER
+}
+
+static long load_shared(kenbak_runner_shared * const p)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange(p, 0, 0);
+#else //_MSC_VER
+    return atomic_load(p);
+#endif //_MSC_VER
+}
+
+/** Stores the given value and returns the value stored before.
+ */
+static long exchange_shared(kenbak_runner_shared * const p, long const val)
+{
+#ifdef _MSC_VER
+    return InterlockedExchange(p, val);
+#else //_MSC_VER
+    return atomic_exchange(p, val);
+#endif //_MSC_VER
+}
+
+static void increment_shared(kenbak_runner_shared * const p)
+{
+#ifdef _MSC_VER
+    InterlockedIncrement(p);
+#else //_MSC_VER
+    atomic_fetch_add(p, 1);
+#endif //_MSC_VER
+}
+
+/** Returns milliseconds passed since an arbitrary point in time (that does
+ *  not change while the process runs).
+ */
+static uint64_t get_ms(void)
+{
+#ifdef _MSC_VER
+    return (uint64_t)GetTickCount64();
+#else //_MSC_VER
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t); // (return value ignored)
+    return (uint64_t)t.tv_sec * 1000 + (uint64_t)t.tv_nsec / 1000000;
+#endif //_MSC_VER
+}
+
+static void sleep_ms(uint64_t const ms)
+{
+#ifdef _MSC_VER
+    Sleep((DWORD)ms);
+#else //_MSC_VER
+    struct timespec const t = {
+        .tv_sec = (time_t)(ms / 1000),
+        .tv_nsec = (long)(ms % 1000) * 1000000
+    };
+
+    nanosleep(&t, NULL); // (return value ignored, may wake up early)
+#endif //_MSC_VER
+}
+
+// *****************************************************************************
+
+struct kenbak_runner
+{
+    struct kenbak_data * d; // Belongs to the emulation thread.
+    int interval_ms;
+
+    // The triple buffer: The emulation thread writes to the snapshot at index
+    // back, the drawing thread reads from the one at index front and the one
+    // at index middle is the latest one published (exchanged with back by
+    // the emulation thread, with front by the drawing thread):
+    //
+    struct kenbak_snapshot snapshots[3];
+    int back; // Of the emulation thread.
+    int front; // Of the drawing thread.
+    kenbak_runner_shared middle; // Index plus KENBAK_RUNNER_FRESH, if new.
+
+    // Set by the drawing thread, taken over by the emulation thread:
+    //
+    kenbak_runner_shared input_bits;
+    kenbak_runner_shared step_mode;
+    kenbak_runner_shared step_requests; // Counts up (wrapping around).
+    kenbak_runner_shared stop;
+
+    // Of the emulation thread:
+    //
+    uint64_t seq;
+    uint64_t byte_times;
+
+#ifdef _MSC_VER
+    HANDLE thread;
+#else //_MSC_VER
+    pthread_t thread;
+#endif //_MSC_VER
+    bool is_thread_started;
+};
+
+/** Fills the snapshot buffer of the emulation thread from the Kenbak-1 and
+ *  publishes it as the latest one.
+ */
+static void publish(struct kenbak_runner * const r)
+{
+    struct kenbak_data * const d = r->d;
+    struct kenbak_snapshot * const s = r->snapshots + r->back;
+
+    s->seq = r->seq++;
+    s->byte_times = r->byte_times;
+    kenbak_emu_get_output(d, &s->output);
+    s->state = d->state;
+    s->reg_i = d->reg_i;
+    s->reg_w = d->reg_w;
+    s->reg_k = kenbak_emu_get_reg_k(d);
+    memcpy(s->mem, d->mem, sizeof s->mem);
+
+    r->back = (int)(exchange_shared(&r->middle, r->back | KENBAK_RUNNER_FRESH)
+        & KENBAK_RUNNER_INDEX_MASK);
+}
+
+/** Takes over the input set by the drawing thread, if it changed.
+ */
+static void take_input(struct kenbak_runner * const r)
+{
+    uint32_t const bits = (uint32_t)load_shared(&r->input_bits);
+
+    if(bits != kenbak_emu_get_input_bits(r->d))
+    {
+        kenbak_emu_set_input_bits(r->d, bits);
+    }
+}
+
+/** The emulation thread's loop, until the runner gets deleted.
+ */
+static void run(struct kenbak_runner * const r)
+{
+    struct kenbak_data * const d = r->d;
+    uint64_t const byte_times_per_interval =
+        (uint64_t)KENBAK_RUNNER_BYTE_TIMES_PER_SECOND
+            * (uint64_t)r->interval_ms / 1000;
+    long steps_done = load_shared(&r->step_requests);
+    uint64_t last = get_ms();
+
+    while(load_shared(&r->stop) == 0)
+    {
+        if(load_shared(&r->step_mode) != 0)
+        {
+            long const step_requests = load_shared(&r->step_requests);
+
+            if(step_requests == steps_done)
+            {
+                sleep_ms(1); // (waiting for a step request)
+                continue;
+            }
+
+            // (the input set before the request is visible, now)
+            //
+            take_input(r);
+            while(steps_done != step_requests)
+            {
+                r->byte_times += (uint64_t)kenbak_emu_step(d);
+                ++steps_done;
+            }
+            publish(r);
+            last = get_ms(); // (real time continues from here)
+            continue;
+        }
+        steps_done = load_shared(&r->step_requests); // (ignored, if late)
+        take_input(r);
+
+        uint64_t const cur = get_ms();
+        uint64_t intervals = (cur - last) / (uint64_t)r->interval_ms;
+
+        if(intervals == 0)
+        {
+            sleep_ms((uint64_t)r->interval_ms - (cur - last));
+            continue;
+        }
+        last += intervals * (uint64_t)r->interval_ms;
+        if(KENBAK_RUNNER_MAX_INTERVALS_PER_UPDATE < intervals)
+        {
+            intervals = KENBAK_RUNNER_MAX_INTERVALS_PER_UPDATE;
+        }
+
+        // Let the emulator do the work that a real Kenbak-1 computer can do
+        // in the intervals passed:
+        //
+        struct kenbak_run_limits const limits = {
+            .max_byte_times = intervals * byte_times_per_interval
+        };
+        struct kenbak_run_result result;
+
+        kenbak_emu_run(d, &limits, &result);
+        r->byte_times += result.byte_times;
+        publish(r);
+    }
+}
+
+#ifdef _MSC_VER
+static DWORD WINAPI run_thread(LPVOID param)
+{
+    run(param);
+    return 0;
+}
+#else //_MSC_VER
+static void * run_thread(void * param)
+{
+    run(param);
+    return NULL;
+}
+#endif //_MSC_VER
+
+struct kenbak_snapshot const * kenbak_runner_get_snapshot(
+    struct kenbak_runner * const r)
+{
+    assert(r != NULL);
+
+    if((load_shared(&r->middle) & KENBAK_RUNNER_FRESH) != 0)
+    {
+        r->front = (int)(exchange_shared(&r->middle, r->front)
+            & KENBAK_RUNNER_INDEX_MASK);
+    }
+    return r->snapshots + r->front;
+}
+
+void kenbak_runner_set_input_bits(
+    struct kenbak_runner * const r, uint32_t const bits)
+{
+    assert(r != NULL);
+
+    exchange_shared(&r->input_bits, (long)bits);
+}
+
+void kenbak_runner_set_step_mode(
+    struct kenbak_runner * const r, bool const enable)
+{
+    assert(r != NULL);
+
+    exchange_shared(&r->step_mode, enable ? 1 : 0);
+}
+
+void kenbak_runner_step(struct kenbak_runner * const r)
+{
+    assert(r != NULL);
+
+    increment_shared(&r->step_requests);
+}
+
+void kenbak_runner_delete(struct kenbak_runner * const r)
+{
+    if(r == NULL)
+    {
+        return;
+    }
+    if(r->is_thread_started)
+    {
+        exchange_shared(&r->stop, 1);
+#ifdef _MSC_VER
+        WaitForSingleObject(r->thread, INFINITE); // (return value ignored)
+        CloseHandle(r->thread); // (return value ignored)
+#else //_MSC_VER
+        pthread_join(r->thread, NULL); // (return value ignored)
+#endif //_MSC_VER
+    }
+    free(r);
+}
+
+struct kenbak_runner * kenbak_runner_create(
+    struct kenbak_data * const d, int const interval_ms)
+{
+    assert(d != NULL);
+    assert(0 < interval_ms);
+
+    struct kenbak_runner * const r = calloc(1, sizeof *r);
+
+    if(r == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    r->d = d;
+    r->interval_ms = interval_ms;
+    r->back = 0;
+    init_shared(&r->middle, 1);
+    r->front = 2;
+    init_shared(&r->input_bits, (long)kenbak_emu_get_input_bits(d));
+    init_shared(&r->step_mode, 0);
+    init_shared(&r->step_requests, 0);
+    init_shared(&r->stop, 0);
+
+    publish(r); // (so there is a snapshot from the start)
+
+#ifdef _MSC_VER
+    r->thread = CreateThread(NULL, 0, run_thread, r, 0, NULL);
+    r->is_thread_started = r->thread != NULL;
+#else //_MSC_VER
+    r->is_thread_started =
+        pthread_create(&r->thread, NULL, run_thread, r) == 0;
+#endif //_MSC_VER
+    if(!r->is_thread_started)
+    {
+        assert(false); // Must not get here.
+        kenbak_runner_delete(r);
+        return NULL;
+    }
+    return r;
+}
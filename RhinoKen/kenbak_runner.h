@@ -0,0 +1,101 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Runs a Kenbak-1 in real time on its own thread, e.g. for a front panel that
+// gets drawn on another thread.
+//
+// - The emulation thread takes the byte times of each update interval passed
+//   at once (see kenbak_emu_run()) and publishes a snapshot of what a front
+//   panel shows afterwards, the drawing thread gets the latest snapshot
+//   published. Neither of both ever waits for the other: The snapshots are
+//   triple-buffered, the emulation thread writes to one buffer, the drawing
+//   thread reads from another one and the third one holds the latest
+//   snapshot not read, yet. They get exchanged atomically.
+// - The drawing thread sets the input and the step mode atomically, too, the
+//   emulation thread takes them over at its next update.
+// - The Kenbak-1 belongs to the emulation thread from creation to deletion
+//   of the runner.
+
+#ifndef KENBAK_RUNNER
+#define KENBAK_RUNNER
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kenbak_data.h"
+#include "kenbak_output.h"
+#include "kenbak_state.h"
+
+// A real Kenbak-1 passes 62500 byte times per second (16 microseconds each):
+//
+#define KENBAK_RUNNER_BYTE_TIMES_PER_SECOND 62500
+
+// The emulation thread skips the byte times of more update intervals than
+// these passed at once (e.g. after the process got suspended), instead of
+// catching up:
+//
+#define KENBAK_RUNNER_MAX_INTERVALS_PER_UPDATE 10
+
+struct kenbak_snapshot
+{
+    uint64_t seq; // Count of snapshots published before this one.
+    uint64_t byte_times; // Passed since the runner got created.
+
+    struct kenbak_output output;
+    enum kenbak_state state;
+    uint8_t reg_i;
+    uint8_t reg_w;
+    uint8_t reg_k;
+
+    uint8_t mem[KENBAK_DATA_MEM_SIZE]; // Including registers A, B, X and P.
+};
+
+struct kenbak_runner; // (see kenbak_runner.c)
+
+/**
+ * - Returns the latest snapshot published by the emulation thread, which
+ *   stays valid and unchanged until the next call (never waits).
+ * - Must always be called from the same thread.
+ */
+struct kenbak_snapshot const * kenbak_runner_get_snapshot(
+    struct kenbak_runner * const r);
+
+/**
+ * - Sets the whole packed input (see enum kenbak_input_bit and
+ *   kenbak_emu_set_input_bits()), taken over at the next update.
+ */
+void kenbak_runner_set_input_bits(
+    struct kenbak_runner * const r, uint32_t const bits);
+
+/**
+ * - Enables or disables the step mode, in which the Kenbak-1 takes steps
+ *   only on request (see kenbak_runner_step()) instead of running in real
+ *   time.
+ */
+void kenbak_runner_set_step_mode(
+    struct kenbak_runner * const r, bool const enable);
+
+/**
+ * - Requests one step (see kenbak_emu_step()) in step mode, followed by a
+ *   snapshot.
+ */
+void kenbak_runner_step(struct kenbak_runner * const r);
+
+/**
+ * - Stops the emulation thread (waiting for it to end) and deletes the given
+ *   runner, but not its Kenbak-1, which belongs to the caller again.
+ */
+void kenbak_runner_delete(struct kenbak_runner * const r);
+
+/**
+ * - Creates a runner with the given update interval and starts its
+ *   emulation thread for the given Kenbak-1, with the Kenbak-1's current
+ *   input.
+ * - The Kenbak-1 must not be accessed until the runner gets deleted.
+ * - Returns NULL on error.
+ * - Caller takes ownership of returned object.
+ */
+struct kenbak_runner * kenbak_runner_create(
+    struct kenbak_data * const d, int const interval_ms);
+
+#endif //KENBAK_RUNNER
@@ -0,0 +1,853 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "kenbak_serial.h"
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+#include "kenbak_instr.h"
+#include "kenbak_input.h"
+#include "kenbak_jmp_cond.h"
+#include "kenbak_state.h"
+#include "kenbak_x.h"
+
+// *****************************************************************************
+// *** THE SERIAL DATAPATH                                                   ***
+// *****************************************************************************
+
+/** Returns the bit at the memory's output at the given bit time (0 to 7) of
+ *  the byte time, during which the byte at the given address is there.
+ *
+ * - Bit 8 * p + t of a delay line is bit t of the byte at its position p.
+ */
+static int get_mem_bit(
+    struct kenbak_data const * const d, uint8_t const addr, int const t)
+{
+    uint8_t const * const line =
+        KENBAK_DATA_DELAY_LINE(d, addr / KENBAK_DATA_DELAY_LINE_SIZE);
+    int const bit = KENBAK_SERIAL_BITS_PER_BYTE
+        * (addr % KENBAK_DATA_DELAY_LINE_SIZE) + t;
+
+    return (line[bit / 8] >> (bit % 8)) & 1;
+}
+
+/** Returns the given serial register with the given bit shifted in at its
+ *  most significant end (registers get loaded least significant bit first,
+ *  so the bit of T0 is the least significant one after T7).
+ */
+static uint8_t shift_in(uint8_t const reg, int const bit)
+{
+    return (uint8_t)((reg >> 1) | (bit << 7));
+}
+
+/** Loads the byte at the given address bit by bit (T0 to T7) from the
+ *  memory's output into a serial register and returns it.
+ */
+static uint8_t load_serial(struct kenbak_data const * const d, uint8_t addr)
+{
+    uint8_t reg = 0;
+
+    for(int t = 0; t < KENBAK_SERIAL_BITS_PER_BYTE; ++t)
+    {
+        reg = shift_in(reg, get_mem_bit(d, addr, t));
+    }
+    return reg;
+}
+
+/** Adds the given bytes (and carry) bit by bit (T0 to T7) via the serial adder
+ *  and its carry flip-flop and returns the sum.
+ *
+ * - The carry flip-flop gets reset at the end of the byte time, so a carry out
+ *   of T7 is lost.
+ */
+static uint8_t add_serial(uint8_t const a, uint8_t const b, int carry)
+{
+    uint8_t sum = 0;
+
+    for(int t = 0; t < KENBAK_SERIAL_BITS_PER_BYTE; ++t)
+    {
+        int const bit_a = (a >> t) & 1;
+        int const bit_b = (b >> t) & 1;
+
+        sum = shift_in(sum, bit_a ^ bit_b ^ carry);
+        carry = (bit_a & bit_b) | (carry & (bit_a ^ bit_b));
+    }
+    return sum;
+}
+
+/** Shifts or rotates the given byte bit by bit (T0 to T7) by the shift or
+ *  rotate instruction in the given decoded instruction and returns the result.
+ *
+ * - At each bit time the multiplexer selects the bit of W that is the given
+ *   count of places away (or zero, when shifting in from outside).
+ */
+static uint8_t shift_serial(
+    uint8_t const w, struct kenbak_instr_decoded const * const dec)
+{
+    int const places = dec->shift_places;
+    uint8_t reg = 0;
+
+    for(int t = 0; t < KENBAK_SERIAL_BITS_PER_BYTE; ++t)
+    {
+        int src = 0; // Bit time of the selected bit of W.
+
+        switch((enum kenbak_instr_shift)dec->shift_kind)
+        {
+            case kenbak_instr_shift_right_shift:
+            {
+                src = t + places;
+                break;
+            }
+            case kenbak_instr_shift_right_rot:
+            {
+                src = (t + places) % KENBAK_SERIAL_BITS_PER_BYTE;
+                break;
+            }
+            case kenbak_instr_shift_left_shift:
+            {
+                src = t - places;
+                break;
+            }
+            case kenbak_instr_shift_left_rot:
+            {
+                src = (t - places + KENBAK_SERIAL_BITS_PER_BYTE)
+                    % KENBAK_SERIAL_BITS_PER_BYTE;
+                break;
+            }
+
+            default: // Must not get here.
+            {
+                assert(false);
+                break;
+            }
+        }
+
+        reg = shift_in(
+            reg,
+            0 <= src && src < KENBAK_SERIAL_BITS_PER_BYTE
+                ? (w >> src) & 1 : 0);
+    }
+    return reg;
+}
+
+/** Returns true, if the byte at the given address meets the given (not
+ *  unconditional) jump condition.
+ *
+ * - The bits of T0 to T6 are ORed together while they pass and the sign is
+ *   the bit at T7.
+ */
+static bool is_jmp_cond_met_serial(
+    struct kenbak_data const * const d,
+    uint8_t const addr,
+    uint8_t const jmp_cond)
+{
+    int non_zero = 0; // Any bit of T0 to T6 set?
+
+    for(int t = 0; t < KENBAK_SERIAL_BITS_PER_BYTE - 1; ++t)
+    {
+        non_zero |= get_mem_bit(d, addr, t);
+    }
+
+    int const sign = get_mem_bit(d, addr, KENBAK_SERIAL_BITS_PER_BYTE - 1);
+
+    switch((enum kenbak_jmp_cond)jmp_cond)
+    {
+        case kenbak_jmp_cond_non_zero:
+        {
+            return (non_zero | sign) != 0;
+        }
+        case kenbak_jmp_cond_zero:
+        {
+            return (non_zero | sign) == 0;
+        }
+        case kenbak_jmp_cond_neg:
+        {
+            return sign != 0;
+        }
+        case kenbak_jmp_cond_pos:
+        {
+            return sign == 0;
+        }
+        case kenbak_jmp_cond_pos_non_zero:
+        {
+            return sign == 0 && non_zero != 0;
+        }
+
+        default:
+        {
+            assert(false); // Must not get here.
+            return false;
+        }
+    }
+}
+
+// *****************************************************************************
+// *** TIMING OF THE DELAY LINES                                             ***
+// *****************************************************************************
+
+/** Returns the count of byte times until CM (R0 to R6 equal L0 to L6) is true
+ *  at T7, beginning with the current byte time.
+ *
+ * - L is one byte ahead of the delay lines' output.
+ */
+static int wait_for_cm(struct kenbak_data const * const d)
+{
+    uint8_t reg_l = (uint8_t)d->byte_times;
+    int c = 0;
+
+    do
+    {
+        ++reg_l; // (T0 to T6 of the byte time)
+        ++c;
+    }while(((reg_l ^ d->sig_r) & 0x7F) != 0); // (T7)
+
+    return c;
+}
+
+// *****************************************************************************
+// *** THE STATES OF RUN MODE                                                ***
+// *****************************************************************************
+//
+// Each function returns the count of byte times the state lasts (or zero on
+// error), the writes to memory are committed at the end of the byte time.
+
+static int step_in_sa(struct kenbak_data * const d)
+{
+    d->sig_r = KENBAK_DATA_ADDR_P;
+    d->state = kenbak_state_sb;
+    return wait_for_cm(d);
+}
+
+static int step_in_sb(struct kenbak_data * const d)
+{
+    uint8_t const val = add_serial(load_serial(d, d->sig_r), d->sig_inc, 0);
+
+    d->sig_inc = 255; // Invalid, see kenbak_emu_step().
+
+    kenbak_emu_write_mem(d, d->sig_r, val);
+
+    d->reg_w = val;
+
+    if(KENBAK_DATA_IS_SIG(d, kenbak_sig_ed))
+    {
+        KENBAK_DATA_CLEAR_SIG(d, kenbak_sig_ed);
+        d->state = kenbak_state_qc;
+        return 1;
+    }
+    d->state = kenbak_state_sc;
+    return 1;
+}
+
+static int step_in_sc(struct kenbak_data * const d)
+{
+    d->sig_r = d->reg_w;
+    d->state = kenbak_state_sd;
+    return wait_for_cm(d);
+}
+
+static int step_in_sd(struct kenbak_data * const d)
+{
+    d->reg_i = load_serial(d, d->sig_r);
+
+    if(KENBAK_INSTR_DECODE(d->reg_i)->len == 2)
+    {
+        d->state = kenbak_state_se;
+        return 1;
+    }
+    d->sig_inc = 1;
+    d->state = kenbak_state_su;
+    return 1;
+}
+
+static int step_in_se(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+    enum kenbak_addr_mode const addr_mode =
+        (enum kenbak_addr_mode)dec->addr_mode;
+    enum kenbak_instr_type const instr_type =
+        (enum kenbak_instr_type)dec->type;
+
+    if(addr_mode == kenbak_addr_mode_constant
+        && instr_type == kenbak_instr_type_store)
+    {
+        d->reg_w = add_serial(d->sig_r, 0, 1); // Address of the second byte.
+    }
+    else
+    {
+        d->reg_w = load_serial(d, (uint8_t)(d->sig_r + 1));
+    }
+
+    if(addr_mode == kenbak_addr_mode_indirect
+        || addr_mode == kenbak_addr_mode_indirect_indexed
+        || (addr_mode == kenbak_addr_mode_memory
+                && instr_type == kenbak_instr_type_jump))
+    {
+        d->state = kenbak_state_sf;
+        return 1;
+    }
+    if(addr_mode == kenbak_addr_mode_indexed)
+    {
+        d->state = kenbak_state_sh;
+        return 1;
+    }
+    if(addr_mode == kenbak_addr_mode_constant
+        || instr_type == kenbak_instr_type_jump
+        || (instr_type == kenbak_instr_type_store
+                && addr_mode == kenbak_addr_mode_memory))
+    {
+        d->state = kenbak_state_sm;
+        return 1;
+    }
+    d->state = kenbak_state_sk;
+    return 1;
+}
+
+static int step_in_sf(struct kenbak_data * const d)
+{
+    d->sig_r = d->reg_w;
+    d->state = kenbak_state_sg;
+    return wait_for_cm(d);
+}
+
+static int step_in_sg(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+
+    d->reg_w = load_serial(d, d->sig_r);
+
+    switch((enum kenbak_addr_mode)dec->addr_mode)
+    {
+        case kenbak_addr_mode_indirect_indexed:
+        {
+            d->state = kenbak_state_sh;
+            return 1;
+        }
+        case kenbak_addr_mode_indirect:
+        {
+            d->state = dec->type == kenbak_instr_type_store
+                ? kenbak_state_sm : kenbak_state_sk;
+            return 1;
+        }
+        case kenbak_addr_mode_memory: // Indirect jump.
+        {
+            d->state = kenbak_state_sm;
+            return 1;
+        }
+
+        default:
+        {
+            assert(false); // Must not get here.
+            return 0;
+        }
+    }
+}
+
+static int step_in_sh(struct kenbak_data * const d)
+{
+    d->sig_r = KENBAK_DATA_ADDR_X;
+    d->state = kenbak_state_sj;
+    return wait_for_cm(d);
+}
+
+static int step_in_sj(struct kenbak_data * const d)
+{
+    d->reg_w = add_serial(d->reg_w, load_serial(d, d->sig_r), 0);
+
+    d->state = KENBAK_INSTR_DECODE(d->reg_i)->type == kenbak_instr_type_store
+        ? kenbak_state_sm : kenbak_state_sk;
+    return 1;
+}
+
+static int step_in_sk(struct kenbak_data * const d)
+{
+    d->sig_r = d->reg_w;
+    d->state = kenbak_state_sl;
+    return wait_for_cm(d);
+}
+
+static int step_in_sl(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+
+    if(dec->type != kenbak_instr_type_bit)
+    {
+        d->reg_w = load_serial(d, d->sig_r);
+        d->state = kenbak_state_sm;
+        return 1;
+    }
+
+    // The designated bit passes at T = bit position, where it gets tested (for
+    // SKP) or replaced (for SET):
+
+    uint8_t reg = 0;
+    bool bit_is_set = false;
+
+    d->sig_inc = 2;
+    for(int t = 0; t < KENBAK_SERIAL_BITS_PER_BYTE; ++t)
+    {
+        int bit = get_mem_bit(d, d->sig_r, t);
+
+        if(t == dec->bit_pos)
+        {
+            bit_is_set = bit != 0;
+            if(!dec->bit_is_skip)
+            {
+                bit = dec->bit_val ? 1 : 0;
+            }
+        }
+        reg = shift_in(reg, bit);
+    }
+    d->reg_w = reg;
+    d->state = kenbak_state_sa;
+
+    if(dec->bit_is_skip)
+    {
+        if(bit_is_set == dec->bit_val)
+        {
+            d->sig_inc += 2;
+        }
+        return 1;
+    }
+
+    // The modified byte can be written back at the next revolution, only:
+    //
+    kenbak_emu_write_mem(d, d->sig_r, d->reg_w);
+    return KENBAK_DATA_DELAY_LINE_SIZE;
+}
+
+static int step_in_sm(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+
+    d->sig_r = dec->reg;
+
+    switch((enum kenbak_instr_type)dec->type)
+    {
+        case kenbak_instr_type_jump:
+        {
+            d->state = kenbak_state_sz;
+            break;
+        }
+        case kenbak_instr_type_store:
+        {
+            d->state = kenbak_state_sp;
+            break;
+        }
+
+        default: // ADD, SUB, LOAD, AND, OR and LNEG.
+        {
+            d->state = kenbak_state_sn;
+            break;
+        }
+    }
+    return wait_for_cm(d);
+}
+
+static int step_in_sn(struct kenbak_data * const d)
+{
+    uint8_t const reg_content = load_serial(d, d->sig_r);
+    uint8_t result = 0;
+
+    switch((enum kenbak_instr_type)KENBAK_INSTR_DECODE(d->reg_i)->type)
+    {
+        case kenbak_instr_type_add: // (falls through)
+        case kenbak_instr_type_sub:
+        {
+            bool const do_sub =
+                KENBAK_INSTR_DECODE(d->reg_i)->type == kenbak_instr_type_sub;
+
+            // Subtracts by adding the complement of W with a carry in:
+            //
+            result = do_sub
+                ? add_serial(reg_content, (uint8_t)~d->reg_w, 1)
+                : add_serial(reg_content, d->reg_w, 0);
+
+            // Zero, as exec_change_reg() of the state machine writes it (see
+            // its TODO), to keep both engines in agreement:
+            //
+            kenbak_emu_write_mem(d, KENBAK_DATA_ADDR_OC_FOR(d->sig_r), 0);
+
+            d->sig_inc = 2;
+            break;
+        }
+        case kenbak_instr_type_load:
+        {
+            result = d->reg_w;
+            d->sig_inc = 2;
+            break;
+        }
+        case kenbak_instr_type_and:
+        {
+            result = d->reg_w & reg_content;
+            d->sig_inc = 2;
+            break;
+        }
+        case kenbak_instr_type_or:
+        {
+            result = d->reg_w | reg_content;
+            d->sig_inc = 2;
+            break;
+        }
+        case kenbak_instr_type_lneg:
+        {
+            result = add_serial(0, (uint8_t)~d->reg_w, 1);
+            d->sig_inc = 2;
+            break;
+        }
+        case kenbak_instr_type_jump:
+        {
+            result = d->reg_w; // W holds the jump destination address.
+            break;
+        }
+
+        default:
+        {
+            assert(false);
+            return 0; // Error!
+        }
+    }
+
+    kenbak_emu_write_mem(d, d->sig_r, result);
+
+    d->state = kenbak_state_sa;
+    return 1;
+}
+
+static int step_in_sp(struct kenbak_data * const d)
+{
+    d->reg_i = load_serial(d, d->sig_r);
+    d->sig_inc = 2;
+    d->state = kenbak_state_sr;
+    return 1;
+}
+
+static int step_in_sq(struct kenbak_data * const d)
+{
+    d->reg_i = add_serial(load_serial(d, KENBAK_DATA_ADDR_P), 2, 0);
+
+    kenbak_emu_write_mem(d, KENBAK_DATA_ADDR_P, d->reg_w);
+
+    d->sig_inc = 1;
+    d->state = kenbak_state_sr;
+    return 1;
+}
+
+static int step_in_sr(struct kenbak_data * const d)
+{
+    d->sig_r = d->reg_w;
+    d->state = kenbak_state_ss;
+    return wait_for_cm(d);
+}
+
+static int step_in_ss(struct kenbak_data * const d)
+{
+    kenbak_emu_write_mem(d, d->sig_r, d->reg_i);
+
+    d->state = kenbak_state_sa;
+    return 1;
+}
+
+static int step_in_st(struct kenbak_data * const d)
+{
+    d->sig_r = KENBAK_DATA_ADDR_P;
+    d->state = KENBAK_INSTR_DECODE(d->reg_i)->jmp_is_mark
+        ? kenbak_state_sq : kenbak_state_sn;
+    return wait_for_cm(d);
+}
+
+static int step_in_su(struct kenbak_data * const d)
+{
+    d->sig_r = KENBAK_INSTR_DECODE(d->reg_i)->reg;
+    d->state = kenbak_state_sv;
+    return wait_for_cm(d);
+}
+
+static int step_in_sv(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+
+    d->reg_w = load_serial(d, d->sig_r);
+
+    if(dec->type == kenbak_instr_type_misc)
+    {
+        if(dec->is_halt)
+        {
+            KENBAK_DATA_SET_SIG(d, kenbak_sig_ed);
+        }
+        d->state = kenbak_state_sa;
+        return 1;
+    }
+    d->state = kenbak_state_sw;
+    return 1;
+}
+
+static int step_in_sw(struct kenbak_data * const d)
+{
+    d->reg_w = shift_serial(d->reg_w, KENBAK_INSTR_DECODE(d->reg_i));
+    d->state = kenbak_state_sx;
+    return 1;
+}
+
+static int step_in_sx(struct kenbak_data * const d)
+{
+    d->sig_r = KENBAK_INSTR_DECODE(d->reg_i)->reg;
+    d->state = kenbak_state_sy;
+    return wait_for_cm(d);
+}
+
+static int step_in_sy(struct kenbak_data * const d)
+{
+    kenbak_emu_write_mem(d, d->sig_r, d->reg_w);
+
+    d->state = kenbak_state_sa;
+    return 1;
+}
+
+static int step_in_sz(struct kenbak_data * const d)
+{
+    struct kenbak_instr_decoded const * const dec =
+        KENBAK_INSTR_DECODE(d->reg_i);
+
+    if(dec->jmp_is_unc
+        || is_jmp_cond_met_serial(d, d->sig_r, dec->jmp_cond))
+    {
+        d->state = kenbak_state_st; // Jump!
+        d->sig_inc = 0;
+        return 1;
+    }
+    d->state = kenbak_state_sa; // NO jump.
+    d->sig_inc = 2;
+    return 1;
+}
+
+/** Takes the step of the current state of run mode and returns the count of
+ *  byte times it lasts (zero on error).
+ */
+static int step_in_run_mode(struct kenbak_data * const d)
+{
+    switch(d->state)
+    {
+        case kenbak_state_sa: return step_in_sa(d);
+        case kenbak_state_sb: return step_in_sb(d);
+        case kenbak_state_sc: return step_in_sc(d);
+        case kenbak_state_sd: return step_in_sd(d);
+        case kenbak_state_se: return step_in_se(d);
+        case kenbak_state_sf: return step_in_sf(d);
+        case kenbak_state_sg: return step_in_sg(d);
+        case kenbak_state_sh: return step_in_sh(d);
+        case kenbak_state_sj: return step_in_sj(d);
+        case kenbak_state_sk: return step_in_sk(d);
+        case kenbak_state_sl: return step_in_sl(d);
+        case kenbak_state_sm: return step_in_sm(d);
+        case kenbak_state_sn: return step_in_sn(d);
+        case kenbak_state_sp: return step_in_sp(d);
+        case kenbak_state_sq: return step_in_sq(d);
+        case kenbak_state_sr: return step_in_sr(d);
+        case kenbak_state_ss: return step_in_ss(d);
+        case kenbak_state_st: return step_in_st(d);
+        case kenbak_state_su: return step_in_su(d);
+        case kenbak_state_sv: return step_in_sv(d);
+        case kenbak_state_sw: return step_in_sw(d);
+        case kenbak_state_sx: return step_in_sx(d);
+        case kenbak_state_sy: return step_in_sy(d);
+        case kenbak_state_sz: return step_in_sz(d);
+
+        default:
+        {
+            assert(false); // Must not get here.
+            return 0;
+        }
+    }
+}
+
+// *****************************************************************************
+// *** DATA LAMPS                                                            ***
+// *****************************************************************************
+
+/** Updates X as the lamps see it during the byte times of the given state.
+ *
+ * - Unlike the state machine's X (which is updated when the input gets
+ *   sampled, only), this follows the state: X3 is active during SA only and
+ *   X4 takes over while BU or CL is active.
+ * - See page 06 of the logic schematics.
+ */
+static void update_lamp_x(
+    struct kenbak_serial * const s,
+    struct kenbak_data const * const d,
+    enum kenbak_state const state)
+{
+    if(KENBAK_DATA_IS_SIG(d, kenbak_sig_da))
+    {
+        s->lamp_x = kenbak_x_1;
+        return;
+    }
+    if(KENBAK_DATA_IS_SIG(d, kenbak_sig_dd))
+    {
+        s->lamp_x = kenbak_x_2;
+        return;
+    }
+    if(state == kenbak_state_sa)
+    {
+        s->lamp_x = kenbak_x_3;
+        return;
+    }
+    if(KENBAK_DATA_IS_SIG(d, kenbak_sig_bu)
+        || KENBAK_DATA_IS_SIG(d, kenbak_sig_cl))
+    {
+        s->lamp_x = kenbak_x_4;
+        return;
+    }
+
+    // Keep current X state, when getting here.
+}
+
+/** Returns the content of register K as the lamps see it (see lamp_x).
+ *
+ * - See page 07 of the logic schematics.
+ */
+static uint8_t get_lamp_k(
+    struct kenbak_serial const * const s, struct kenbak_data const * const d)
+{
+    switch(s->lamp_x)
+    {
+        case kenbak_x_3:
+        {
+            return d->mem[KENBAK_DATA_ADDR_OUTPUT];
+        }
+        case kenbak_x_4:
+        {
+            return d->mem[KENBAK_DATA_ADDR_INPUT];
+        }
+
+        default:
+        {
+            return d->reg_k;
+        }
+    }
+}
+
+/** Lets the given count of byte times pass with the data lamps showing the
+ *  given content of register K.
+ */
+static void pass_byte_times(
+    struct kenbak_serial * const s, uint8_t const reg_k, int const byte_times)
+{
+    uint64_t const bit_times =
+        (uint64_t)byte_times * KENBAK_SERIAL_BITS_PER_BYTE;
+
+    for(int i = 0; i < KENBAK_SERIAL_LAMP_COUNT; ++i)
+    {
+        // All or none of the bit times, without branching:
+        //
+        uint64_t const mask = 0 - (uint64_t)((reg_k >> i) & 1);
+
+        s->lamp_on_bit_times[i] += bit_times & mask;
+    }
+    s->lamp_bit_times += bit_times;
+    s->bit_times += bit_times;
+}
+
+// *****************************************************************************
+// *** ENTRY POINTS                                                          ***
+// *****************************************************************************
+
+void kenbak_serial_init(
+    struct kenbak_serial * const s, struct kenbak_data * const d)
+{
+    s->bit_times = 0;
+    for(int i = 0; i < KENBAK_SERIAL_LAMP_COUNT; ++i)
+    {
+        s->lamp_on_bit_times[i] = 0;
+    }
+    s->lamp_bit_times = 0;
+    s->lamp_x = d->sig_x;
+
+    kenbak_emu_set_timing(d, true);
+}
+
+int kenbak_serial_step(
+    struct kenbak_serial * const s, struct kenbak_data * const d)
+{
+    assert(d->timing);
+
+    enum kenbak_state const state = d->state;
+
+    if((state >> KENBAK_STATE_TYPE_SHIFT) != KENBAK_STATE_TYPE_S
+        || (d->input & KENBAK_INPUT_MASK(kenbak_input_bit_power_on)) == 0)
+    {
+        // Not in run mode or power switch got turned off.
+
+        update_lamp_x(s, d, state);
+
+        uint8_t const reg_k = get_lamp_k(s, d);
+        int const c = kenbak_emu_step(d);
+
+        if(c <= 0)
+        {
+            return 0; // Powered-off or error.
+        }
+        pass_byte_times(s, reg_k, c);
+        return c * KENBAK_SERIAL_BITS_PER_BYTE;
+    }
+
+    if(state == kenbak_state_sa)
+    {
+        kenbak_emu_sample_input(d); // As the state machine does before SA.
+    }
+    update_lamp_x(s, d, state);
+
+    // (the writes get committed at the end of the state's last byte time)
+    //
+    uint8_t const reg_k = get_lamp_k(s, d);
+    int const c = step_in_run_mode(d);
+
+    if(c <= 0)
+    {
+        return 0; // Error!
+    }
+    d->byte_times += (uint32_t)c;
+    pass_byte_times(s, reg_k, c);
+    return c * KENBAK_SERIAL_BITS_PER_BYTE;
+}
+
+uint64_t kenbak_serial_run(
+    struct kenbak_serial * const s,
+    struct kenbak_data * const d,
+    uint64_t const bit_times)
+{
+    uint64_t passed = 0;
+
+    while(passed < bit_times)
+    {
+        int const c = kenbak_serial_step(s, d);
+
+        if(c <= 0)
+        {
+            break; // Powered-off or error.
+        }
+        passed += (uint64_t)c;
+    }
+    return passed;
+}
+
+void kenbak_serial_get_lamps(
+    struct kenbak_serial * const s, int * const brightness)
+{
+    for(int i = 0; i < KENBAK_SERIAL_LAMP_COUNT; ++i)
+    {
+        brightness[i] = s->lamp_bit_times == 0
+            ? 0
+            : (int)(s->lamp_on_bit_times[i] * KENBAK_SERIAL_LAMP_MAX
+                / s->lamp_bit_times);
+        s->lamp_on_bit_times[i] = 0;
+    }
+    s->lamp_bit_times = 0;
+}
@@ -0,0 +1,98 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Bit-serial engine: Executes the states of run mode (SA to SZ) at bit time
+// resolution (T0 to T7 of each byte time, two microseconds each), the way the
+// Kenbak-1's serial datapath does.
+//
+// - The memory is the two delay lines of 1024 bits each. The bits of the byte
+//   at delay line position p are the bits 8 * p to 8 * p + 7 of its line
+//   (T0 to T7, least significant bit first), which is exactly how the bytes
+//   of struct kenbak_data's memory are laid out. So the delay lines do not
+//   get shifted, the position of their output moves instead.
+// - Registers are loaded serially from the memory's output, bit by bit, and
+//   the additions and subtractions (also of P and X) go through a serial
+//   adder with a carry flip-flop, shifts and rotates through a serial
+//   multiplexer.
+// - The comparator CM (R0 to R6 equal L0 to L6) is evaluated at T7 of each
+//   byte time while waiting for it, T0 to T6 of these byte times pass at once
+//   (nothing but the position of the delay lines changes during them).
+// - The data lamps are lit as register K's bits during each bit time, with X
+//   as the lamps see it (X3 during SA, X4 while BU or CL is active, see
+//   page 06 of the logic schematics). So data buttons pressed in run mode
+//   show the input byte with the output byte (location 0200) as a faint glow
+//   (see kenbak_serial_get_lamps()).
+// - The manual states (QB to QF) and the power switch are left to
+//   kenbak_emu_step().
+// - Memory, registers, signals and byte times equal the ones of
+//   kenbak_emu_step() with the timing model enabled after each step (the
+//   validation of the invariants and the traces are not supported in run
+//   mode, though).
+
+#ifndef KENBAK_SERIAL
+#define KENBAK_SERIAL
+
+#include <stdint.h>
+
+#include "kenbak_data.h"
+
+#define KENBAK_SERIAL_BITS_PER_BYTE 8
+
+// A real Kenbak-1 passes 500000 bit times per second (two microseconds each):
+//
+#define KENBAK_SERIAL_BIT_TIMES_PER_SECOND 500000
+
+#define KENBAK_SERIAL_LAMP_COUNT 8 // Data lamps.
+
+#define KENBAK_SERIAL_LAMP_MAX 1000 // Brightness of an always lit lamp.
+
+struct kenbak_serial
+{
+    // Count of bit times passed since kenbak_serial_init():
+    //
+    uint64_t bit_times;
+
+    // Count of bit times each data lamp was lit (indexed by bit) and count of
+    // bit times passed since the last call of kenbak_serial_get_lamps():
+    //
+    uint64_t lamp_on_bit_times[KENBAK_SERIAL_LAMP_COUNT];
+    uint64_t lamp_bit_times;
+
+    // X as the lamps see it, an enum kenbak_x (see update_lamp_x()):
+    //
+    uint8_t lamp_x;
+};
+
+/**
+ * - Initializes the given bit-serial engine for the given Kenbak-1 and
+ *   enables the Kenbak-1's timing model (see kenbak_emu_set_timing()), which
+ *   the bit-serial engine always follows.
+ */
+void kenbak_serial_init(
+    struct kenbak_serial * const s, struct kenbak_data * const d);
+
+/**
+ * - Takes one step (like kenbak_emu_step()) and returns the count of bit
+ *   times passed (eight per byte time) or zero, if powered-off (or on error).
+ */
+int kenbak_serial_step(
+    struct kenbak_serial * const s, struct kenbak_data * const d);
+
+/**
+ * - Takes steps until at least the given count of bit times passed (or until
+ *   powered-off or on error) and returns the count of bit times passed.
+ */
+uint64_t kenbak_serial_run(
+    struct kenbak_serial * const s,
+    struct kenbak_data * const d,
+    uint64_t const bit_times);
+
+/**
+ * - Fills the given array of KENBAK_SERIAL_LAMP_COUNT values (indexed by
+ *   bit) with the brightness of each data lamp since the last call, from
+ *   zero (always off) to KENBAK_SERIAL_LAMP_MAX (always lit).
+ */
+void kenbak_serial_get_lamps(
+    struct kenbak_serial * const s, int * const brightness);
+
+#endif //KENBAK_SERIAL
@@ -0,0 +1,59 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#ifndef KENBAK_SIG
+#define KENBAK_SIG
+
+#include <stdint.h>
+
+// The bits of the packed boolean signals (see sigs in struct kenbak_data).
+//
+// The boolean signals are all to-be-interpreted as true/1 meaning that the
+// signal is active, even if the hardware puts the "signal" to ground (0V) to
+// signalize that it is active.
+//
+enum kenbak_sig
+{
+    // BU = The eight data input switches are scanned by T0 through T7 and ORed
+    //      together to produce the serial signal BU.
+    kenbak_sig_bu = 0,
+
+    // CL = True when the clear push button is depressed. (04)
+    kenbak_sig_cl = 1,
+
+    // ^DA = Display address (from push button of that name). Goes to ground
+    //       when button is pushed. (04)
+    kenbak_sig_da = 2,
+
+    // ^DD = Display data (from read memory push button) after being cleaned up.
+    //       Goes to ground when button is pushed. (04)
+    kenbak_sig_dd = 3,
+
+    // ^EA = Enter Address (from set address push button) after being cleaned
+    //       up. Goes to ground when button is pushed. (04)
+    kenbak_sig_ea = 4,
+
+    // ED = Automatic processing should end after the current instruction is
+    //      finished. (22)
+    kenbak_sig_ed = 5,
+
+    // ^EN = Enter data (from store memory push button) after being cleaned up.
+    //       Goes to ground when button is pushed. (04)
+    kenbak_sig_en = 6,
+
+    // ^GO = Signal from start push button after being cleaned up. Goes to
+    //       ground when button is pushed. (04)
+    kenbak_sig_go = 7
+};
+
+#define KENBAK_SIG_MASK(sig) ((uint8_t)(1u << (sig)))
+
+// The signals of the push buttons that select a manual operation (see state
+// QC):
+//
+#define KENBAK_SIG_MASK_MANUAL \
+    (KENBAK_SIG_MASK(kenbak_sig_da) \
+        | KENBAK_SIG_MASK(kenbak_sig_dd) \
+        | KENBAK_SIG_MASK(kenbak_sig_en))
+
+#endif //KENBAK_SIG
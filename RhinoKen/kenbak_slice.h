@@ -0,0 +1,99 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Bitsliced engines: Run 64 Kenbak-1s (or 256 with AVX2) in lockstep, for
+// fuzzing and searching through many small programs.
+//
+// - Each Kenbak-1 is a lane: Bit k of each byte of memory, of each register
+//   and the state of all lanes are held by one lane word (an uint64_t or an
+//   AVX2 vector), so each boolean operation advances all lanes at once.
+// - The steps are the ones of the state machine (states SA to SZ and QB to
+//   QF, see kenbak_emu_core.h), each lane takes the same steps as
+//   kenbak_emu_step() would take for it, with the timing model enabled or
+//   disabled for all lanes.
+// - Kenbak-1s get loaded into lanes from and unloaded from lanes into struct
+//   kenbak_data. To be loaded, a Kenbak-1 must be powered-on, no push button
+//   may be pressed (the input does not change while in a lane) and its timing
+//   model must be enabled as the engine's one is.
+// - Functions of <prefix> kenbak_slice64 and (if KENBAK_SLICE_HAS_AVX2 is
+//   defined) kenbak_slice256:
+//
+//   <prefix>_create() creates an engine with all lanes empty.
+//   <prefix>_delete() deletes it.
+//   <prefix>_load() loads a Kenbak-1 into a lane (replacing what was there).
+//   <prefix>_unload() stores the lane's Kenbak-1 into a struct kenbak_data.
+//   <prefix>_steps() takes steps in all loaded lanes.
+
+#ifndef KENBAK_SLICE
+#define KENBAK_SLICE
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kenbak_data.h"
+
+#if defined(__AVX2__) && (defined(_M_X64) || defined(__x86_64__))
+    #define KENBAK_SLICE_HAS_AVX2
+#endif //defined(__AVX2__) && (defined(_M_X64) || defined(__x86_64__))
+
+#define KENBAK_SLICE64_LANES 64
+
+struct kenbak_slice64;
+
+/**
+ * - Returns NULL on error.
+ * - Caller takes ownership of returned object.
+ */
+struct kenbak_slice64 * kenbak_slice64_create(bool const timing);
+
+void kenbak_slice64_delete(struct kenbak_slice64 * const s);
+
+/**
+ * - Returns false, if the given Kenbak-1 cannot be loaded (see above).
+ */
+bool kenbak_slice64_load(
+    struct kenbak_slice64 * const s,
+    int const lane,
+    struct kenbak_data const * const d);
+
+/**
+ * - The lane must have been loaded. Keeps the lane loaded.
+ */
+void kenbak_slice64_unload(
+    struct kenbak_slice64 const * const s,
+    int const lane,
+    struct kenbak_data * const d);
+
+/**
+ * - Takes the given count of steps in each loaded lane and returns the count
+ *   of instructions executed by all lanes together.
+ */
+uint64_t kenbak_slice64_steps(
+    struct kenbak_slice64 * const s, uint64_t const count);
+
+#ifdef KENBAK_SLICE_HAS_AVX2
+
+#define KENBAK_SLICE256_LANES 256
+
+struct kenbak_slice256;
+
+struct kenbak_slice256 * kenbak_slice256_create(bool const timing);
+
+void kenbak_slice256_delete(struct kenbak_slice256 * const s);
+
+bool kenbak_slice256_load(
+    struct kenbak_slice256 * const s,
+    int const lane,
+    struct kenbak_data const * const d);
+
+void kenbak_slice256_unload(
+    struct kenbak_slice256 const * const s,
+    int const lane,
+    struct kenbak_data * const d);
+
+uint64_t kenbak_slice256_steps(
+    struct kenbak_slice256 * const s, uint64_t const count);
+
+#endif //KENBAK_SLICE_HAS_AVX2
+
+#endif //KENBAK_SLICE
@@ -0,0 +1,93 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// 256-lane bitsliced engine (see kenbak_slice.h), a lane word is an AVX2
+// vector. Compiled only, if the compiler targets AVX2 (e.g. via /arch:AVX2).
+
+#include "kenbak_slice.h"
+
+#ifdef KENBAK_SLICE_HAS_AVX2
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <immintrin.h>
+
+#define KENBAK_SLICE_CORE_PREFIX kenbak_slice256
+#define KENBAK_SLICE_CORE_LANES 256
+
+typedef __m256i kenbak_slice_word;
+
+static kenbak_slice_word word_zero(void)
+{
+    return _mm256_setzero_si256();
+}
+
+static kenbak_slice_word word_ones(void)
+{
+    return _mm256_set1_epi64x(-1);
+}
+
+static kenbak_slice_word word_and(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return _mm256_and_si256(a, b);
+}
+
+static kenbak_slice_word word_or(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return _mm256_or_si256(a, b);
+}
+
+static kenbak_slice_word word_xor(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return _mm256_xor_si256(a, b);
+}
+
+/** Returns a AND NOT b.
+ */
+static kenbak_slice_word word_andnot(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return _mm256_andnot_si256(b, a); // (complements its first argument)
+}
+
+static bool word_any(kenbak_slice_word const a)
+{
+    return _mm256_testz_si256(a, a) == 0;
+}
+
+static bool word_get(kenbak_slice_word const a, int const lane)
+{
+    uint64_t parts[4];
+
+    _mm256_storeu_si256((__m256i *)parts, a);
+    return ((parts[lane / 64] >> (lane % 64)) & 1) != 0;
+}
+
+static void word_set(
+    kenbak_slice_word * const a, int const lane, bool const bit)
+{
+    uint64_t parts[4];
+    uint64_t const mask = (uint64_t)1 << (lane % 64);
+
+    _mm256_storeu_si256((__m256i *)parts, *a);
+    parts[lane / 64] = (parts[lane / 64] & ~mask) | (bit ? mask : 0);
+    *a = _mm256_loadu_si256((__m256i const *)parts);
+}
+
+/** Returns the count of lanes set (population count).
+ */
+static int word_count(kenbak_slice_word const a)
+{
+    uint64_t parts[4];
+
+    _mm256_storeu_si256((__m256i *)parts, a);
+    return (int)(_mm_popcnt_u64(parts[0]) + _mm_popcnt_u64(parts[1])
+        + _mm_popcnt_u64(parts[2]) + _mm_popcnt_u64(parts[3]));
+}
+
+#include "kenbak_slice_core.h"
+
+#endif //KENBAK_SLICE_HAS_AVX2
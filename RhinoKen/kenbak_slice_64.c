@@ -0,0 +1,76 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// 64-lane bitsliced engine (see kenbak_slice.h), a lane word is an uint64_t.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KENBAK_SLICE_CORE_PREFIX kenbak_slice64
+#define KENBAK_SLICE_CORE_LANES 64
+
+typedef uint64_t kenbak_slice_word;
+
+static kenbak_slice_word word_zero(void)
+{
+    return 0;
+}
+
+static kenbak_slice_word word_ones(void)
+{
+    return ~(uint64_t)0;
+}
+
+static kenbak_slice_word word_and(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return a & b;
+}
+
+static kenbak_slice_word word_or(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return a | b;
+}
+
+static kenbak_slice_word word_xor(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return a ^ b;
+}
+
+/** Returns a AND NOT b.
+ */
+static kenbak_slice_word word_andnot(
+    kenbak_slice_word const a, kenbak_slice_word const b)
+{
+    return a & ~b;
+}
+
+static bool word_any(kenbak_slice_word const a)
+{
+    return a != 0;
+}
+
+static bool word_get(kenbak_slice_word const a, int const lane)
+{
+    return ((a >> lane) & 1) != 0;
+}
+
+static void word_set(
+    kenbak_slice_word * const a, int const lane, bool const bit)
+{
+    *a = (*a & ~((uint64_t)1 << lane)) | ((uint64_t)bit << lane);
+}
+
+/** Returns the count of lanes set (population count).
+ */
+static int word_count(kenbak_slice_word a)
+{
+    a = a - ((a >> 1) & 0x5555555555555555u);
+    a = (a & 0x3333333333333333u) + ((a >> 2) & 0x3333333333333333u);
+    a = (a + (a >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (int)((a * 0x0101010101010101u) >> 56);
+}
+
+#include "kenbak_slice_core.h"
@@ -0,0 +1,1441 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// The core of the bitsliced engines (see kenbak_slice.h): The Kenbak-1's state
+// machine, with each lane word holding one bit of all lanes.
+//
+// - To be included by a translation unit once, after defining
+//   KENBAK_SLICE_CORE_PREFIX, KENBAK_SLICE_CORE_LANES, the type
+//   kenbak_slice_word and its operations word_zero(), word_ones(), word_and(),
+//   word_or(), word_xor(), word_andnot(), word_any(), word_get(), word_set()
+//   and word_count(). All other functions are static, so the engines can be
+//   linked side by side.
+// - The lanes do not branch: Each state's transition is applied to the lanes
+//   in that state (the lanes' masks, one per state) and skipped, if there are
+//   none.
+// - A byte that each lane reads from or writes to an address of its own (in
+//   R) is selected by splitting the lanes by that address (see
+//   split_by_byte()), which leads to one group per address used.
+
+#ifndef KENBAK_SLICE_CORE
+#define KENBAK_SLICE_CORE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "kenbak_slice.h"
+#include "kenbak_data.h"
+#include "kenbak_emu.h"
+#include "kenbak_input.h"
+#include "kenbak_instr.h"
+#include "kenbak_jmp_cond.h"
+#include "kenbak_sig.h"
+#include "kenbak_state.h"
+#include "kenbak_x.h"
+
+#define KENBAK_SLICE_CORE_BYTE_BITS 8
+#define KENBAK_SLICE_CORE_COUNTER_BITS 32 // Byte times and output writes.
+
+#define KENBAK_SLICE_CORE_CONCAT(prefix, name) prefix ## name
+#define KENBAK_SLICE_CORE_NAME(prefix, name) \
+    KENBAK_SLICE_CORE_CONCAT(prefix, name)
+
+// The given name with the engine's prefix:
+//
+#define KENBAK_SLICE_CORE_FN(name) \
+    KENBAK_SLICE_CORE_NAME(KENBAK_SLICE_CORE_PREFIX, name)
+
+// What the states need to know about the instruction in register I, decoded
+// at state SD (see decode()), one lane word each:
+//
+enum kenbak_slice_pred
+{
+    kenbak_slice_pred_len_2 = 0,
+
+    kenbak_slice_pred_add,
+    kenbak_slice_pred_sub,
+    kenbak_slice_pred_load,
+    kenbak_slice_pred_store,
+    kenbak_slice_pred_or,
+    kenbak_slice_pred_and,
+    kenbak_slice_pred_lneg,
+    kenbak_slice_pred_jump,
+    kenbak_slice_pred_bit,
+    kenbak_slice_pred_misc,
+
+    kenbak_slice_pred_constant,
+    kenbak_slice_pred_memory,
+    kenbak_slice_pred_indirect,
+    kenbak_slice_pred_indexed,
+    kenbak_slice_pred_indirect_indexed,
+
+    kenbak_slice_pred_reg_bit_0, // Bits of the register's address.
+    kenbak_slice_pred_reg_bit_1,
+
+    kenbak_slice_pred_non_zero, // Jump conditions.
+    kenbak_slice_pred_zero,
+    kenbak_slice_pred_neg,
+    kenbak_slice_pred_pos,
+    kenbak_slice_pred_pos_non_zero,
+    kenbak_slice_pred_unc,
+    kenbak_slice_pred_mark,
+
+    kenbak_slice_pred_right_shift, // Shifts and rotates.
+    kenbak_slice_pred_right_rot,
+    kenbak_slice_pred_left_shift,
+    kenbak_slice_pred_left_rot,
+    kenbak_slice_pred_places_1, // (to 4)
+
+    kenbak_slice_pred_bit_pos_0 = kenbak_slice_pred_places_1 + 4, // (to 7)
+    kenbak_slice_pred_bit_val = kenbak_slice_pred_bit_pos_0 + 8,
+    kenbak_slice_pred_bit_is_skip,
+
+    kenbak_slice_pred_halt,
+
+    kenbak_slice_pred_count
+};
+
+#define KENBAK_SLICE_CORE_PRED_MASK(pred) ((uint64_t)1 << (pred))
+
+struct KENBAK_SLICE_CORE_PREFIX
+{
+    // Bit b of the byte at address a (of all lanes) is mem[a][b]:
+    //
+    kenbak_slice_word mem[KENBAK_DATA_MEM_SIZE][KENBAK_SLICE_CORE_BYTE_BITS];
+
+    // The lanes in each state, indexed by enum kenbak_state_index (a lane that
+    // is not loaded is in none):
+    //
+    kenbak_slice_word state[kenbak_state_index_count];
+
+    kenbak_slice_word reg_i[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word reg_k[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word reg_w[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word sig_r[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word sig_inc[KENBAK_SLICE_CORE_BYTE_BITS];
+
+    kenbak_slice_word pred[kenbak_slice_pred_count];
+
+    // ED is the only signal that may be on without a push button being
+    // pressed, the lanes with X3 or X4 active:
+    //
+    kenbak_slice_word sig_ed;
+    kenbak_slice_word x_3;
+    kenbak_slice_word x_4;
+
+    kenbak_slice_word byte_times[KENBAK_SLICE_CORE_COUNTER_BITS];
+    kenbak_slice_word output_write_count[KENBAK_SLICE_CORE_COUNTER_BITS];
+
+    kenbak_slice_word lanes; // The loaded lanes.
+
+    uint8_t sig_x[KENBAK_SLICE_CORE_LANES]; // X of each lane, as loaded.
+
+    bool timing;
+
+    uint64_t instrs; // Count of instructions executed by all lanes.
+};
+
+// A group of lanes that use the same address (see split_by_byte()):
+//
+struct kenbak_slice_group
+{
+    kenbak_slice_word lanes;
+    uint8_t addr;
+};
+
+// *****************************************************************************
+// *** OPERATIONS ON BYTES OF ALL LANES                                      ***
+// *****************************************************************************
+
+/** Sets the given byte of the given lanes to the given byte.
+ */
+static void assign(
+    kenbak_slice_word * const dest,
+    kenbak_slice_word const * const src,
+    kenbak_slice_word const lanes)
+{
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+    {
+        dest[b] = word_or(word_andnot(dest[b], lanes), word_and(src[b], lanes));
+    }
+}
+
+/** Sets the given byte of the given lanes to the given constant value.
+ */
+static void assign_const(
+    kenbak_slice_word * const dest,
+    uint8_t const val,
+    kenbak_slice_word const lanes)
+{
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+    {
+        dest[b] = ((val >> b) & 1) != 0
+            ? word_or(dest[b], lanes) : word_andnot(dest[b], lanes);
+    }
+}
+
+/** Sets the given byte of all lanes to the given constant value.
+ */
+static void set_const(kenbak_slice_word * const dest, uint8_t const val)
+{
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+    {
+        dest[b] = ((val >> b) & 1) != 0 ? word_ones() : word_zero();
+    }
+}
+
+/** Adds the given bytes of all lanes, with a carry in for the lanes given, and
+ *  stores the sums (may be one of the bytes added).
+ */
+static void add(
+    kenbak_slice_word const * const a,
+    kenbak_slice_word const * const b,
+    kenbak_slice_word carry,
+    kenbak_slice_word * const sum)
+{
+    for(int i = 0; i < KENBAK_SLICE_CORE_BYTE_BITS; ++i)
+    {
+        kenbak_slice_word const x = word_xor(a[i], b[i]);
+        kenbak_slice_word const next_carry =
+            word_or(word_and(a[i], b[i]), word_and(x, carry));
+
+        sum[i] = word_xor(x, carry);
+        carry = next_carry;
+    }
+}
+
+/** Stores the complement of the given byte of all lanes.
+ */
+static void complement(
+    kenbak_slice_word const * const a, kenbak_slice_word * const result)
+{
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+    {
+        result[b] = word_andnot(word_ones(), a[b]);
+    }
+}
+
+/** Adds one to the given counter bits of the given lanes.
+ */
+static void count_up(
+    kenbak_slice_word * const counter,
+    int const bit_count,
+    kenbak_slice_word carry)
+{
+    for(int b = 0; b < bit_count && word_any(carry); ++b)
+    {
+        kenbak_slice_word const next_carry = word_and(counter[b], carry);
+
+        counter[b] = word_xor(counter[b], carry);
+        carry = next_carry;
+    }
+}
+
+/** Adds the given byte of all lanes to the given counter.
+ */
+static void count_up_by(
+    kenbak_slice_word * const counter, kenbak_slice_word const * const val)
+{
+    kenbak_slice_word carry = word_zero();
+
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+    {
+        kenbak_slice_word const x = word_xor(counter[b], val[b]);
+        kenbak_slice_word const next_carry =
+            word_or(word_and(counter[b], val[b]), word_and(x, carry));
+
+        counter[b] = word_xor(x, carry);
+        carry = next_carry;
+    }
+    count_up(
+        counter + KENBAK_SLICE_CORE_BYTE_BITS,
+        KENBAK_SLICE_CORE_COUNTER_BITS - KENBAK_SLICE_CORE_BYTE_BITS,
+        carry);
+}
+
+/** Splits the given lanes into groups with the same byte value in the given
+ *  byte (e.g. register R) and returns the count of groups.
+ */
+static int split_by_byte(
+    kenbak_slice_word const * const sel,
+    kenbak_slice_word const lanes,
+    int const bit,
+    uint8_t const val,
+    struct kenbak_slice_group * const groups,
+    int count)
+{
+    if(!word_any(lanes))
+    {
+        return count;
+    }
+    if(bit < 0)
+    {
+        groups[count].lanes = lanes;
+        groups[count].addr = val;
+        return count + 1;
+    }
+    count = split_by_byte(
+        sel, word_andnot(lanes, sel[bit]), bit - 1, val, groups, count);
+    return split_by_byte(
+        sel,
+        word_and(lanes, sel[bit]),
+        bit - 1,
+        (uint8_t)(val | (1 << bit)),
+        groups,
+        count);
+}
+
+/** Reads the bytes at the given addresses (one per lane) of the given lanes,
+ *  the other lanes read zero.
+ */
+static void read_mem(
+    struct KENBAK_SLICE_CORE_PREFIX const * const s,
+    kenbak_slice_word const * const addr,
+    kenbak_slice_word const lanes,
+    kenbak_slice_word * const val)
+{
+    struct kenbak_slice_group groups[KENBAK_SLICE_CORE_LANES];
+    int const count = split_by_byte(
+        addr, lanes, KENBAK_SLICE_CORE_BYTE_BITS - 1, 0, groups, 0);
+
+    set_const(val, 0);
+    for(int i = 0; i < count; ++i)
+    {
+        kenbak_slice_word const * const src = s->mem[groups[i].addr];
+
+        for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+        {
+            val[b] = word_or(val[b], word_and(src[b], groups[i].lanes));
+        }
+    }
+}
+
+/** Writes the given bytes to the given addresses (one per lane) of the given
+ *  lanes, counting the writes to the output register.
+ */
+static void write_mem(
+    struct KENBAK_SLICE_CORE_PREFIX * const s,
+    kenbak_slice_word const * const addr,
+    kenbak_slice_word const lanes,
+    kenbak_slice_word const * const val)
+{
+    struct kenbak_slice_group groups[KENBAK_SLICE_CORE_LANES];
+    int const count = split_by_byte(
+        addr, lanes, KENBAK_SLICE_CORE_BYTE_BITS - 1, 0, groups, 0);
+
+    for(int i = 0; i < count; ++i)
+    {
+        assign(s->mem[groups[i].addr], val, groups[i].lanes);
+        if(groups[i].addr == KENBAK_DATA_ADDR_OUTPUT)
+        {
+            count_up(
+                s->output_write_count,
+                KENBAK_SLICE_CORE_COUNTER_BITS,
+                groups[i].lanes);
+        }
+    }
+}
+
+/** Writes the given bytes to the given (same) address of the given lanes,
+ *  counting the writes to the output register.
+ */
+static void write_mem_at(
+    struct KENBAK_SLICE_CORE_PREFIX * const s,
+    uint8_t const addr,
+    kenbak_slice_word const lanes,
+    kenbak_slice_word const * const val)
+{
+    assign(s->mem[addr], val, lanes);
+    if(addr == KENBAK_DATA_ADDR_OUTPUT)
+    {
+        count_up(
+            s->output_write_count, KENBAK_SLICE_CORE_COUNTER_BITS, lanes);
+    }
+}
+
+// *****************************************************************************
+// *** DECODING OF THE INSTRUCTIONS                                          ***
+// *****************************************************************************
+
+/** Returns the mask of the predicates (see KENBAK_SLICE_CORE_PRED_MASK())
+ *  that are true for the given decoded instruction.
+ */
+static uint64_t get_pred_mask(struct kenbak_instr_decoded const * const dec)
+{
+    static int const type_preds[][2] = {
+        { kenbak_instr_type_add, kenbak_slice_pred_add },
+        { kenbak_instr_type_sub, kenbak_slice_pred_sub },
+        { kenbak_instr_type_load, kenbak_slice_pred_load },
+        { kenbak_instr_type_store, kenbak_slice_pred_store },
+        { kenbak_instr_type_or, kenbak_slice_pred_or },
+        { kenbak_instr_type_and, kenbak_slice_pred_and },
+        { kenbak_instr_type_lneg, kenbak_slice_pred_lneg },
+        { kenbak_instr_type_jump, kenbak_slice_pred_jump },
+        { kenbak_instr_type_bit, kenbak_slice_pred_bit },
+        { kenbak_instr_type_misc, kenbak_slice_pred_misc }
+    };
+    static int const mode_preds[][2] = {
+        { kenbak_addr_mode_constant, kenbak_slice_pred_constant },
+        { kenbak_addr_mode_memory, kenbak_slice_pred_memory },
+        { kenbak_addr_mode_indirect, kenbak_slice_pred_indirect },
+        { kenbak_addr_mode_indexed, kenbak_slice_pred_indexed },
+        { kenbak_addr_mode_indirect_indexed,
+            kenbak_slice_pred_indirect_indexed }
+    };
+
+    uint64_t mask = 0;
+
+    assert(dec->reg <= 3);
+
+    if(dec->len == 2)
+    {
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_len_2);
+    }
+    for(int i = 0; i < (int)(sizeof type_preds / sizeof *type_preds); ++i)
+    {
+        if(dec->type == (uint8_t)type_preds[i][0])
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(type_preds[i][1]);
+        }
+    }
+    for(int i = 0; i < (int)(sizeof mode_preds / sizeof *mode_preds); ++i)
+    {
+        if(dec->addr_mode == (uint8_t)mode_preds[i][0])
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(mode_preds[i][1]);
+        }
+    }
+    if((dec->reg & 1) != 0)
+    {
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_reg_bit_0);
+    }
+    if((dec->reg & 2) != 0)
+    {
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_reg_bit_1);
+    }
+
+    if(dec->type == kenbak_instr_type_jump)
+    {
+        if(dec->jmp_is_unc)
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_unc);
+        }
+        else
+        {
+            // The jump conditions' values are 3 to 7 (see
+            // enum kenbak_jmp_cond), in the same order as the predicates:
+            //
+            assert(kenbak_jmp_cond_non_zero <= dec->jmp_cond
+                && dec->jmp_cond <= kenbak_jmp_cond_pos_non_zero);
+
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(
+                kenbak_slice_pred_non_zero
+                    + dec->jmp_cond - kenbak_jmp_cond_non_zero);
+        }
+        if(dec->jmp_is_mark)
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_mark);
+        }
+    }
+    if(dec->type == kenbak_instr_type_shift_rot)
+    {
+        assert(1 <= dec->shift_places && dec->shift_places <= 4);
+
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(
+            kenbak_slice_pred_right_shift + dec->shift_kind);
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(
+            kenbak_slice_pred_places_1 + dec->shift_places - 1);
+    }
+    if(dec->type == kenbak_instr_type_bit)
+    {
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(
+            kenbak_slice_pred_bit_pos_0 + dec->bit_pos);
+        if(dec->bit_val)
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_bit_val);
+        }
+        if(dec->bit_is_skip)
+        {
+            mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_bit_is_skip);
+        }
+    }
+    if(dec->is_halt)
+    {
+        mask |= KENBAK_SLICE_CORE_PRED_MASK(kenbak_slice_pred_halt);
+    }
+    return mask;
+}
+
+/** Decodes the instruction in register I of the given lanes into the
+ *  predicates (via the decode table, once per instruction value in use).
+ */
+static void decode(
+    struct KENBAK_SLICE_CORE_PREFIX * const s, kenbak_slice_word const lanes)
+{
+    struct kenbak_slice_group groups[KENBAK_SLICE_CORE_LANES];
+    int const count = split_by_byte(
+        s->reg_i, lanes, KENBAK_SLICE_CORE_BYTE_BITS - 1, 0, groups, 0);
+
+    for(int p = 0; p < kenbak_slice_pred_count; ++p)
+    {
+        s->pred[p] = word_andnot(s->pred[p], lanes);
+    }
+    for(int i = 0; i < count; ++i)
+    {
+        uint64_t const mask =
+            get_pred_mask(KENBAK_INSTR_DECODE(groups[i].addr));
+
+        for(int p = 0; p < kenbak_slice_pred_count; ++p)
+        {
+            if((mask & KENBAK_SLICE_CORE_PRED_MASK(p)) != 0)
+            {
+                s->pred[p] = word_or(s->pred[p], groups[i].lanes);
+            }
+        }
+    }
+}
+
+/** Sets R of the given lanes to the address of the register of the
+ *  instruction in register I (see reg in struct kenbak_instr_decoded).
+ */
+static void assign_reg_addr(
+    struct KENBAK_SLICE_CORE_PREFIX * const s, kenbak_slice_word const lanes)
+{
+    kenbak_slice_word reg[KENBAK_SLICE_CORE_BYTE_BITS];
+
+    set_const(reg, 0);
+    reg[0] = s->pred[kenbak_slice_pred_reg_bit_0];
+    reg[1] = s->pred[kenbak_slice_pred_reg_bit_1];
+    assign(s->sig_r, reg, lanes);
+}
+
+// *****************************************************************************
+// *** INSTRUCTION EXECUTION                                                 ***
+// *****************************************************************************
+
+/** Stores the given byte W of all lanes shifted or rotated by the shift or
+ *  rotate instruction of each lane (see exec_shift_rot() of the state
+ *  machine).
+ */
+static void shift_rot(
+    struct KENBAK_SLICE_CORE_PREFIX const * const s,
+    kenbak_slice_word const * const w,
+    kenbak_slice_word * const result)
+{
+    set_const(result, 0);
+    for(int places = 1; places <= 4; ++places)
+    {
+        kenbak_slice_word const p =
+            s->pred[kenbak_slice_pred_places_1 + places - 1];
+
+        if(!word_any(p))
+        {
+            continue;
+        }
+        for(int kind = 0; kind < 4; ++kind)
+        {
+            kenbak_slice_word const m =
+                word_and(p, s->pred[kenbak_slice_pred_right_shift + kind]);
+
+            if(!word_any(m))
+            {
+                continue;
+            }
+            for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+            {
+                int src = 0; // Bit of W that ends up in bit b.
+
+                switch((enum kenbak_instr_shift)kind)
+                {
+                    case kenbak_instr_shift_right_shift:
+                    {
+                        src = b + places;
+                        break;
+                    }
+                    case kenbak_instr_shift_right_rot:
+                    {
+                        src = (b + places) % KENBAK_SLICE_CORE_BYTE_BITS;
+                        break;
+                    }
+                    case kenbak_instr_shift_left_shift:
+                    {
+                        src = b - places;
+                        break;
+                    }
+                    case kenbak_instr_shift_left_rot: // (falls through)
+                    default:
+                    {
+                        src = (b - places + KENBAK_SLICE_CORE_BYTE_BITS)
+                            % KENBAK_SLICE_CORE_BYTE_BITS;
+                        break;
+                    }
+                }
+                if(0 <= src && src < KENBAK_SLICE_CORE_BYTE_BITS)
+                {
+                    result[b] = word_or(result[b], word_and(w[src], m));
+                }
+            }
+        }
+    }
+}
+
+/** Returns the lanes whose jump condition is true for the given register
+ *  content (see is_jmp_cond_true() of the state machine).
+ */
+static kenbak_slice_word get_jmp_cond_true(
+    struct KENBAK_SLICE_CORE_PREFIX const * const s,
+    kenbak_slice_word const * const val)
+{
+    kenbak_slice_word const sign = val[KENBAK_SLICE_CORE_BYTE_BITS - 1];
+    kenbak_slice_word const pos = word_andnot(word_ones(), sign);
+    kenbak_slice_word low = word_zero(); // Any bit but the sign set?
+
+    for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS - 1; ++b)
+    {
+        low = word_or(low, val[b]);
+    }
+
+    kenbak_slice_word const non_zero = word_or(low, sign);
+
+    return word_or(
+        word_or(
+            word_or(
+                s->pred[kenbak_slice_pred_unc],
+                word_and(s->pred[kenbak_slice_pred_non_zero], non_zero)),
+            word_or(
+                word_andnot(s->pred[kenbak_slice_pred_zero], non_zero),
+                word_and(s->pred[kenbak_slice_pred_neg], sign))),
+        word_or(
+            word_and(s->pred[kenbak_slice_pred_pos], pos),
+            word_and(
+                s->pred[kenbak_slice_pred_pos_non_zero], word_and(pos, low))));
+}
+
+// *****************************************************************************
+// *** A STEP OF ALL LANES                                                   ***
+// *****************************************************************************
+
+#define KENBAK_SLICE_CORE_IN(name) (s->state[kenbak_state_index_ ## name])
+#define KENBAK_SLICE_CORE_PRED(name) (s->pred[kenbak_slice_pred_ ## name])
+
+/** Adds the given lanes to the given state's ones.
+ */
+static void go_to(
+    kenbak_slice_word * const next,
+    enum kenbak_state_index const i,
+    kenbak_slice_word const lanes)
+{
+    next[i] = word_or(next[i], lanes);
+}
+
+/** Lets the byte times of the given lanes waiting for CM (see wait_for_cm()
+ *  of the state machine) or for a full revolution of the delay lines pass,
+ *  one byte time for each other loaded lane.
+ */
+static void pass_byte_times(
+    struct KENBAK_SLICE_CORE_PREFIX * const s,
+    kenbak_slice_word const wait_cm,
+    kenbak_slice_word const wait_rev)
+{
+    if(!s->timing)
+    {
+        count_up(s->byte_times, KENBAK_SLICE_CORE_COUNTER_BITS, s->lanes);
+        return;
+    }
+
+    kenbak_slice_word c[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word wait[KENBAK_SLICE_CORE_BYTE_BITS];
+
+    set_const(c, 0);
+    c[0] = s->lanes;
+
+    // ((R - byte times - 1) % 128) + 1, as R + NOT byte times equals
+    // R - byte times - 1:
+    //
+    complement(s->byte_times, wait);
+    add(s->sig_r, wait, word_zero(), wait);
+    wait[KENBAK_SLICE_CORE_BYTE_BITS - 1] = word_zero();
+    add(wait, c, word_zero(), wait); // (c is one for all lanes, here)
+
+    assign(c, wait, wait_cm);
+    assign_const(c, KENBAK_DATA_DELAY_LINE_SIZE, wait_rev);
+
+    count_up_by(s->byte_times, c);
+}
+
+/** Takes one step in each loaded lane.
+ */
+static void step(struct KENBAK_SLICE_CORE_PREFIX * const s)
+{
+    kenbak_slice_word next[kenbak_state_index_count];
+    kenbak_slice_word wait_cm = word_zero(); // Lanes waiting for CM.
+    kenbak_slice_word wait_rev = word_zero(); // (for a full revolution)
+    kenbak_slice_word val[KENBAK_SLICE_CORE_BYTE_BITS]; // Read at R.
+    kenbak_slice_word tmp[KENBAK_SLICE_CORE_BYTE_BITS];
+    kenbak_slice_word to_write[KENBAK_SLICE_CORE_BYTE_BITS]; // At R.
+    kenbak_slice_word write_lanes = word_zero();
+    kenbak_slice_word one[KENBAK_SLICE_CORE_BYTE_BITS];
+
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        next[i] = word_zero();
+    }
+    set_const(one, 1);
+    set_const(to_write, 0);
+
+    // Samples the input before QB, QC, QF and SA (see
+    // update_input_signals_byte_and_x() of the state machine, no push button
+    // is pressed): Latches K and activates X3 in SA.
+    {
+        kenbak_slice_word const sampling = word_or(
+            word_or(KENBAK_SLICE_CORE_IN(qb), KENBAK_SLICE_CORE_IN(qc)),
+            word_or(KENBAK_SLICE_CORE_IN(qf), KENBAK_SLICE_CORE_IN(sa)));
+
+        assign(
+            s->reg_k,
+            s->mem[KENBAK_DATA_ADDR_OUTPUT],
+            word_and(sampling, s->x_3));
+        assign(
+            s->reg_k,
+            s->mem[KENBAK_DATA_ADDR_INPUT],
+            word_and(sampling, s->x_4));
+
+        s->x_3 = word_or(s->x_3, KENBAK_SLICE_CORE_IN(sa));
+        s->x_4 = word_andnot(s->x_4, KENBAK_SLICE_CORE_IN(sa));
+    }
+
+    // All reads at R happen before anything gets changed:
+    {
+        kenbak_slice_word const reading = word_or(
+            word_or(
+                word_or(KENBAK_SLICE_CORE_IN(qe), KENBAK_SLICE_CORE_IN(sb)),
+                word_or(KENBAK_SLICE_CORE_IN(sd), KENBAK_SLICE_CORE_IN(sg))),
+            word_or(
+                word_or(
+                    word_or(
+                        KENBAK_SLICE_CORE_IN(sj), KENBAK_SLICE_CORE_IN(sl)),
+                    word_or(
+                        KENBAK_SLICE_CORE_IN(sn), KENBAK_SLICE_CORE_IN(sp))),
+                word_or(KENBAK_SLICE_CORE_IN(sv), KENBAK_SLICE_CORE_IN(sz))));
+
+        read_mem(s, s->sig_r, reading, val);
+    }
+
+    // QB: Start button is released (see step_in_qb()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(qb);
+
+        s->sig_ed = word_andnot(s->sig_ed, m);
+        go_to(next, kenbak_state_index_sa, m);
+    }
+
+    // QC: Idle (see step_in_qc()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(qc);
+
+        assign_const(s->sig_inc, 0, m);
+        assign(s->reg_i, s->mem[KENBAK_DATA_ADDR_INPUT], m);
+        go_to(next, kenbak_state_index_qc, m);
+    }
+
+    // QD (see step_in_qd()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(qd);
+
+        assign(s->sig_r, s->reg_w, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_qe, m);
+    }
+
+    // QE: Display data (see step_in_qe()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(qe);
+
+        if(word_any(m))
+        {
+            assign(s->reg_k, val, m);
+            add(s->reg_w, one, word_zero(), tmp);
+            assign(s->reg_w, tmp, m);
+        }
+        go_to(next, kenbak_state_index_qf, m);
+    }
+
+    // QF: Buttons are released (see step_in_qf()).
+    //
+    go_to(next, kenbak_state_index_qc, KENBAK_SLICE_CORE_IN(qf));
+
+    // SA (see step_in_sa()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sa);
+
+        assign_const(s->sig_r, KENBAK_DATA_ADDR_P, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sb, m);
+    }
+
+    // SB: Increments P (see step_in_sb()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sb);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word const ended = word_and(m, s->sig_ed);
+
+            add(val, s->sig_inc, word_zero(), tmp);
+            assign_const(s->sig_inc, 255, m);
+            assign(to_write, tmp, m);
+            write_lanes = word_or(write_lanes, m);
+            assign(s->reg_w, tmp, m);
+
+            s->sig_ed = word_andnot(s->sig_ed, m);
+            go_to(next, kenbak_state_index_qc, ended);
+            go_to(next, kenbak_state_index_sc, word_andnot(m, ended));
+        }
+    }
+
+    // SC (see step_in_sc()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sc);
+
+        assign(s->sig_r, s->reg_w, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sd, m);
+    }
+
+    // SD: Loads I and decodes it (see step_in_sd()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sd);
+
+        if(word_any(m))
+        {
+            assign(s->reg_i, val, m);
+            decode(s, m);
+
+            kenbak_slice_word const two =
+                word_and(m, KENBAK_SLICE_CORE_PRED(len_2));
+
+            assign_const(s->sig_inc, 1, word_andnot(m, two));
+            go_to(next, kenbak_state_index_se, two);
+            go_to(next, kenbak_state_index_su, word_andnot(m, two));
+
+            s->instrs += (uint64_t)word_count(m);
+        }
+    }
+
+    // SE: Loads the second byte (see step_in_se()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(se);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word second[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word const store_const = word_and(
+                m,
+                word_and(
+                    KENBAK_SLICE_CORE_PRED(constant),
+                    KENBAK_SLICE_CORE_PRED(store)));
+
+            add(s->sig_r, one, word_zero(), tmp); // R + 1
+            read_mem(s, tmp, word_andnot(m, store_const), second);
+            assign(s->reg_w, tmp, store_const);
+            assign(s->reg_w, second, word_andnot(m, store_const));
+
+            kenbak_slice_word const to_sf = word_and(
+                m,
+                word_or(
+                    word_or(
+                        KENBAK_SLICE_CORE_PRED(indirect),
+                        KENBAK_SLICE_CORE_PRED(indirect_indexed)),
+                    word_and(
+                        KENBAK_SLICE_CORE_PRED(memory),
+                        KENBAK_SLICE_CORE_PRED(jump))));
+            kenbak_slice_word const to_sh = word_and(
+                word_andnot(m, to_sf), KENBAK_SLICE_CORE_PRED(indexed));
+            kenbak_slice_word const rest =
+                word_andnot(word_andnot(m, to_sf), to_sh);
+            kenbak_slice_word const to_sm = word_and(
+                rest,
+                word_or(
+                    word_or(
+                        KENBAK_SLICE_CORE_PRED(constant),
+                        KENBAK_SLICE_CORE_PRED(jump)),
+                    word_and(
+                        KENBAK_SLICE_CORE_PRED(store),
+                        KENBAK_SLICE_CORE_PRED(memory))));
+
+            go_to(next, kenbak_state_index_sf, to_sf);
+            go_to(next, kenbak_state_index_sh, to_sh);
+            go_to(next, kenbak_state_index_sm, to_sm);
+            go_to(next, kenbak_state_index_sk, word_andnot(rest, to_sm));
+        }
+    }
+
+    // SF (see step_in_sf()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sf);
+
+        assign(s->sig_r, s->reg_w, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sg, m);
+    }
+
+    // SG: Loads the indirect address (see step_in_sg()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sg);
+        kenbak_slice_word const to_sh =
+            word_and(m, KENBAK_SLICE_CORE_PRED(indirect_indexed));
+        kenbak_slice_word const to_sm = word_and(
+            m,
+            word_or(
+                word_and(
+                    KENBAK_SLICE_CORE_PRED(indirect),
+                    KENBAK_SLICE_CORE_PRED(store)),
+                KENBAK_SLICE_CORE_PRED(memory)));
+
+        assign(s->reg_w, val, m);
+        go_to(next, kenbak_state_index_sh, to_sh);
+        go_to(next, kenbak_state_index_sm, to_sm);
+        go_to(
+            next,
+            kenbak_state_index_sk,
+            word_andnot(word_andnot(m, to_sh), to_sm));
+    }
+
+    // SH (see step_in_sh()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sh);
+
+        assign_const(s->sig_r, KENBAK_DATA_ADDR_X, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sj, m);
+    }
+
+    // SJ: Adds X (see step_in_sj()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sj);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word const store =
+                word_and(m, KENBAK_SLICE_CORE_PRED(store));
+
+            add(s->reg_w, val, word_zero(), tmp);
+            assign(s->reg_w, tmp, m);
+            go_to(next, kenbak_state_index_sm, store);
+            go_to(next, kenbak_state_index_sk, word_andnot(m, store));
+        }
+    }
+
+    // SK (see step_in_sk()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sk);
+
+        assign(s->sig_r, s->reg_w, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sl, m);
+    }
+
+    // SL: Loads the operand, executes bit instructions (see step_in_sl() and
+    // exec_bit()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sl);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word const bit =
+                word_and(m, KENBAK_SLICE_CORE_PRED(bit));
+            kenbak_slice_word const skip =
+                word_and(bit, KENBAK_SLICE_CORE_PRED(bit_is_skip));
+            kenbak_slice_word const set = word_andnot(bit, skip);
+            kenbak_slice_word bit_is_set = word_zero();
+
+            assign(s->reg_w, val, m);
+            go_to(next, kenbak_state_index_sm, word_andnot(m, bit));
+            go_to(next, kenbak_state_index_sa, bit);
+
+            assign_const(s->sig_inc, 2, bit);
+            for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+            {
+                kenbak_slice_word const pos =
+                    s->pred[kenbak_slice_pred_bit_pos_0 + b];
+
+                bit_is_set = word_or(bit_is_set, word_and(pos, val[b]));
+
+                // Sets the designated bit of the lanes that SET:
+                //
+                tmp[b] = word_or(
+                    word_andnot(val[b], pos),
+                    word_and(pos, KENBAK_SLICE_CORE_PRED(bit_val)));
+            }
+
+            // Skips, if the bit equals the value to skip on:
+            //
+            assign_const(
+                s->sig_inc,
+                4,
+                word_andnot(
+                    skip,
+                    word_xor(bit_is_set, KENBAK_SLICE_CORE_PRED(bit_val))));
+
+            assign(s->reg_w, tmp, set);
+            assign(to_write, tmp, set);
+            write_lanes = word_or(write_lanes, set);
+            wait_rev = word_or(wait_rev, set);
+        }
+    }
+
+    // SM: Seeks the register (see step_in_sm()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sm);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word const jump =
+                word_and(m, KENBAK_SLICE_CORE_PRED(jump));
+            kenbak_slice_word const store =
+                word_and(m, KENBAK_SLICE_CORE_PRED(store));
+
+            assign_reg_addr(s, m);
+            wait_cm = word_or(wait_cm, m);
+            go_to(next, kenbak_state_index_sz, jump);
+            go_to(next, kenbak_state_index_sp, store);
+            go_to(
+                next,
+                kenbak_state_index_sn,
+                word_andnot(word_andnot(m, jump), store));
+        }
+    }
+
+    // SN: Changes A, B, X or P (see step_in_sn() and exec_change_reg()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sn);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word not_w[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word sum[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word diff[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word neg[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word zero[KENBAK_SLICE_CORE_BYTE_BITS];
+            kenbak_slice_word const add_sub = word_and(
+                m,
+                word_or(
+                    KENBAK_SLICE_CORE_PRED(add), KENBAK_SLICE_CORE_PRED(sub)));
+            kenbak_slice_word const take_w = word_or(
+                KENBAK_SLICE_CORE_PRED(load), KENBAK_SLICE_CORE_PRED(jump));
+
+            set_const(zero, 0);
+            complement(s->reg_w, not_w);
+            add(val, s->reg_w, word_zero(), sum);
+            add(val, not_w, word_ones(), diff); // Two's complement.
+            add(zero, not_w, word_ones(), neg);
+
+            for(int b = 0; b < KENBAK_SLICE_CORE_BYTE_BITS; ++b)
+            {
+                kenbak_slice_word const w = s->reg_w[b];
+
+                tmp[b] = word_or(
+                    word_or(
+                        word_and(KENBAK_SLICE_CORE_PRED(add), sum[b]),
+                        word_and(KENBAK_SLICE_CORE_PRED(sub), diff[b])),
+                    word_or(
+                        word_or(
+                            word_and(take_w, w),
+                            word_and(
+                                KENBAK_SLICE_CORE_PRED(lneg), neg[b])),
+                        word_or(
+                            word_and(
+                                KENBAK_SLICE_CORE_PRED(and),
+                                word_and(w, val[b])),
+                            word_and(
+                                KENBAK_SLICE_CORE_PRED(or),
+                                word_or(w, val[b])))));
+            }
+            assign(to_write, tmp, m);
+            write_lanes = word_or(write_lanes, m);
+
+            // The overflow and carry byte gets zero, as exec_change_reg()
+            // writes it (see there):
+            {
+                kenbak_slice_word oc_addr[KENBAK_SLICE_CORE_BYTE_BITS];
+
+                set_const(tmp, KENBAK_DATA_ADDR_OC_FOR(0));
+                add(s->sig_r, tmp, word_zero(), oc_addr);
+                write_mem(s, oc_addr, add_sub, zero);
+            }
+
+            assign_const(
+                s->sig_inc, 2, word_andnot(m, KENBAK_SLICE_CORE_PRED(jump)));
+            go_to(next, kenbak_state_index_sa, m);
+        }
+    }
+
+    // SP: Loads the byte to store (see step_in_sp()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sp);
+
+        assign(s->reg_i, val, m);
+        assign_const(s->sig_inc, 2, m);
+        go_to(next, kenbak_state_index_sr, m);
+    }
+
+    // SQ: Jump and mark (see step_in_sq()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sq);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word two[KENBAK_SLICE_CORE_BYTE_BITS];
+
+            set_const(two, 2);
+            add(s->mem[KENBAK_DATA_ADDR_P], two, word_zero(), tmp);
+            assign(s->reg_i, tmp, m);
+            write_mem_at(s, KENBAK_DATA_ADDR_P, m, s->reg_w);
+            assign_const(s->sig_inc, 1, m);
+            go_to(next, kenbak_state_index_sr, m);
+        }
+    }
+
+    // SR (see step_in_sr()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sr);
+
+        assign(s->sig_r, s->reg_w, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_ss, m);
+    }
+
+    // SS: Stores I (see step_in_ss()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(ss);
+
+        assign(to_write, s->reg_i, m);
+        write_lanes = word_or(write_lanes, m);
+        go_to(next, kenbak_state_index_sa, m);
+    }
+
+    // ST: Seeks P (see step_in_st()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(st);
+        kenbak_slice_word const mark =
+            word_and(m, KENBAK_SLICE_CORE_PRED(mark));
+
+        assign_const(s->sig_r, KENBAK_DATA_ADDR_P, m);
+        wait_cm = word_or(wait_cm, m);
+        go_to(next, kenbak_state_index_sq, mark);
+        go_to(next, kenbak_state_index_sn, word_andnot(m, mark));
+    }
+
+    // SU (see step_in_su()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(su);
+
+        if(word_any(m))
+        {
+            assign_reg_addr(s, m);
+            wait_cm = word_or(wait_cm, m);
+            go_to(next, kenbak_state_index_sv, m);
+        }
+    }
+
+    // SV: Loads A or B, halts (see step_in_sv()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sv);
+        kenbak_slice_word const misc =
+            word_and(m, KENBAK_SLICE_CORE_PRED(misc));
+
+        assign(s->reg_w, val, m);
+        s->sig_ed = word_or(
+            s->sig_ed, word_and(misc, KENBAK_SLICE_CORE_PRED(halt)));
+        go_to(next, kenbak_state_index_sa, misc);
+        go_to(next, kenbak_state_index_sw, word_andnot(m, misc));
+    }
+
+    // SW: Shifts or rotates (see step_in_sw()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sw);
+
+        if(word_any(m))
+        {
+            shift_rot(s, s->reg_w, tmp);
+            assign(s->reg_w, tmp, m);
+            go_to(next, kenbak_state_index_sx, m);
+        }
+    }
+
+    // SX (see step_in_sx()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sx);
+
+        if(word_any(m))
+        {
+            assign_reg_addr(s, m);
+            wait_cm = word_or(wait_cm, m);
+            go_to(next, kenbak_state_index_sy, m);
+        }
+    }
+
+    // SY: Stores the shifted or rotated value (see step_in_sy()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sy);
+
+        assign(to_write, s->reg_w, m);
+        write_lanes = word_or(write_lanes, m);
+        go_to(next, kenbak_state_index_sa, m);
+    }
+
+    // SZ: Evaluates the jump condition (see step_in_sz()).
+    {
+        kenbak_slice_word const m = KENBAK_SLICE_CORE_IN(sz);
+
+        if(word_any(m))
+        {
+            kenbak_slice_word const jump =
+                word_and(m, get_jmp_cond_true(s, val));
+
+            assign_const(s->sig_inc, 0, jump);
+            assign_const(s->sig_inc, 2, word_andnot(m, jump));
+            go_to(next, kenbak_state_index_st, jump);
+            go_to(next, kenbak_state_index_sa, word_andnot(m, jump));
+        }
+    }
+
+    // All writes at R (none of the writing lanes changed R):
+    //
+    write_mem(s, s->sig_r, write_lanes, to_write);
+
+    pass_byte_times(s, wait_cm, wait_rev);
+
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        s->state[i] = next[i];
+    }
+}
+
+#undef KENBAK_SLICE_CORE_IN
+#undef KENBAK_SLICE_CORE_PRED
+
+// *****************************************************************************
+// *** LOADING AND UNLOADING OF LANES                                        ***
+// *****************************************************************************
+
+/** Sets the given lane of the given byte to the given value.
+ */
+static void set_lane_bits(
+    kenbak_slice_word * const bits,
+    int const bit_count,
+    int const lane,
+    uint32_t const val)
+{
+    for(int b = 0; b < bit_count; ++b)
+    {
+        word_set(bits + b, lane, ((val >> b) & 1) != 0);
+    }
+}
+
+/** Returns the value of the given lane of the given byte (or counter).
+ */
+static uint32_t get_lane_bits(
+    kenbak_slice_word const * const bits, int const bit_count, int const lane)
+{
+    uint32_t val = 0;
+
+    for(int b = 0; b < bit_count; ++b)
+    {
+        val |= (uint32_t)word_get(bits[b], lane) << b;
+    }
+    return val;
+}
+
+// *****************************************************************************
+// *** ENTRY POINTS OF AN ENGINE                                             ***
+// *****************************************************************************
+
+struct KENBAK_SLICE_CORE_PREFIX * KENBAK_SLICE_CORE_FN(_create)(
+    bool const timing)
+{
+    // Rounded up to a multiple of the alignment, as aligned_alloc() wants:
+    //
+    size_t const size = (sizeof (struct KENBAK_SLICE_CORE_PREFIX)
+            + KENBAK_DATA_CACHE_LINE_SIZE - 1)
+        / KENBAK_DATA_CACHE_LINE_SIZE * KENBAK_DATA_CACHE_LINE_SIZE;
+
+#ifdef _MSC_VER
+    struct KENBAK_SLICE_CORE_PREFIX * const s = _aligned_malloc(
+        size, KENBAK_DATA_CACHE_LINE_SIZE);
+#else //_MSC_VER
+    struct KENBAK_SLICE_CORE_PREFIX * const s = aligned_alloc(
+        KENBAK_DATA_CACHE_LINE_SIZE, size);
+#endif //_MSC_VER
+
+    if(s == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+
+    for(int a = 0; a < KENBAK_DATA_MEM_SIZE; ++a)
+    {
+        set_const(s->mem[a], 0);
+    }
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        s->state[i] = word_zero();
+    }
+    set_const(s->reg_i, 0);
+    set_const(s->reg_k, 0);
+    set_const(s->reg_w, 0);
+    set_const(s->sig_r, 0);
+    set_const(s->sig_inc, 0);
+    for(int p = 0; p < kenbak_slice_pred_count; ++p)
+    {
+        s->pred[p] = word_zero();
+    }
+    s->sig_ed = word_zero();
+    s->x_3 = word_zero();
+    s->x_4 = word_zero();
+    for(int b = 0; b < KENBAK_SLICE_CORE_COUNTER_BITS; ++b)
+    {
+        s->byte_times[b] = word_zero();
+        s->output_write_count[b] = word_zero();
+    }
+    s->lanes = word_zero();
+    for(int lane = 0; lane < KENBAK_SLICE_CORE_LANES; ++lane)
+    {
+        s->sig_x[lane] = kenbak_x_none;
+    }
+    s->timing = timing;
+    s->instrs = 0;
+    return s;
+}
+
+void KENBAK_SLICE_CORE_FN(_delete)(struct KENBAK_SLICE_CORE_PREFIX * const s)
+{
+#ifdef _MSC_VER
+    _aligned_free(s);
+#else //_MSC_VER
+    free(s);
+#endif //_MSC_VER
+}
+
+bool KENBAK_SLICE_CORE_FN(_load)(
+    struct KENBAK_SLICE_CORE_PREFIX * const s,
+    int const lane,
+    struct kenbak_data const * const d)
+{
+    assert(0 <= lane && lane < KENBAK_SLICE_CORE_LANES);
+
+    if(d->state == kenbak_state_power_off
+        || d->state == kenbak_state_unknown
+        || (d->input & KENBAK_INPUT_MASK(kenbak_input_bit_power_on)) == 0
+        || (d->input & KENBAK_INPUT_MASK_BUTTONS) != 0
+        || d->input_changed
+        || (d->sigs & (uint8_t)~KENBAK_SIG_MASK(kenbak_sig_ed)) != 0
+        || d->timing != s->timing)
+    {
+        return false;
+    }
+
+    for(int a = 0; a < KENBAK_DATA_MEM_SIZE; ++a)
+    {
+        set_lane_bits(s->mem[a], KENBAK_SLICE_CORE_BYTE_BITS, lane, d->mem[a]);
+    }
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        word_set(
+            s->state + i,
+            lane,
+            i == (int)KENBAK_STATE_GET_INDEX(d->state));
+    }
+    set_lane_bits(s->reg_i, KENBAK_SLICE_CORE_BYTE_BITS, lane, d->reg_i);
+    set_lane_bits(s->reg_k, KENBAK_SLICE_CORE_BYTE_BITS, lane, d->reg_k);
+    set_lane_bits(s->reg_w, KENBAK_SLICE_CORE_BYTE_BITS, lane, d->reg_w);
+    set_lane_bits(s->sig_r, KENBAK_SLICE_CORE_BYTE_BITS, lane, d->sig_r);
+    set_lane_bits(s->sig_inc, KENBAK_SLICE_CORE_BYTE_BITS, lane, d->sig_inc);
+    {
+        uint64_t const mask = get_pred_mask(KENBAK_INSTR_DECODE(d->reg_i));
+
+        for(int p = 0; p < kenbak_slice_pred_count; ++p)
+        {
+            word_set(
+                s->pred + p,
+                lane,
+                (mask & KENBAK_SLICE_CORE_PRED_MASK(p)) != 0);
+        }
+    }
+    word_set(&s->sig_ed, lane, KENBAK_DATA_IS_SIG(d, kenbak_sig_ed));
+    word_set(&s->x_3, lane, d->sig_x == kenbak_x_3);
+    word_set(&s->x_4, lane, d->sig_x == kenbak_x_4);
+    set_lane_bits(
+        s->byte_times, KENBAK_SLICE_CORE_COUNTER_BITS, lane, d->byte_times);
+    set_lane_bits(
+        s->output_write_count,
+        KENBAK_SLICE_CORE_COUNTER_BITS,
+        lane,
+        d->output_write_count);
+    word_set(&s->lanes, lane, true);
+    s->sig_x[lane] = d->sig_x;
+    return true;
+}
+
+void KENBAK_SLICE_CORE_FN(_unload)(
+    struct KENBAK_SLICE_CORE_PREFIX const * const s,
+    int const lane,
+    struct kenbak_data * const d)
+{
+    assert(0 <= lane && lane < KENBAK_SLICE_CORE_LANES);
+    assert(word_get(s->lanes, lane));
+
+    // Via the pointer, to keep the code cache, the hash and the memoization
+    // up-to-date:
+    //
+    uint8_t * const mem = kenbak_emu_get_mem_ptr(d, 0);
+
+    for(int a = 0; a < KENBAK_DATA_MEM_SIZE; ++a)
+    {
+        mem[a] = (uint8_t)get_lane_bits(
+            s->mem[a], KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    }
+    for(int i = 0; i < kenbak_state_index_count; ++i)
+    {
+        if(word_get(s->state[i], lane))
+        {
+            d->state = kenbak_state_from_index[i];
+            break;
+        }
+    }
+    d->reg_i = (uint8_t)get_lane_bits(
+        s->reg_i, KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    d->reg_k = (uint8_t)get_lane_bits(
+        s->reg_k, KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    d->reg_w = (uint8_t)get_lane_bits(
+        s->reg_w, KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    d->sig_r = (uint8_t)get_lane_bits(
+        s->sig_r, KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    d->sig_inc = (uint8_t)get_lane_bits(
+        s->sig_inc, KENBAK_SLICE_CORE_BYTE_BITS, lane);
+    d->sigs = word_get(s->sig_ed, lane) ? KENBAK_SIG_MASK(kenbak_sig_ed) : 0;
+    d->sig_x = word_get(s->x_3, lane)
+        ? kenbak_x_3
+        : word_get(s->x_4, lane) ? kenbak_x_4 : s->sig_x[lane];
+    d->byte_times = get_lane_bits(
+        s->byte_times, KENBAK_SLICE_CORE_COUNTER_BITS, lane);
+    d->output_write_count = get_lane_bits(
+        s->output_write_count, KENBAK_SLICE_CORE_COUNTER_BITS, lane);
+}
+
+uint64_t KENBAK_SLICE_CORE_FN(_steps)(
+    struct KENBAK_SLICE_CORE_PREFIX * const s, uint64_t const count)
+{
+    uint64_t const instrs = s->instrs;
+
+    for(uint64_t i = 0; i < count; ++i)
+    {
+        step(s);
+    }
+    return s->instrs - instrs;
+}
+
+#endif //KENBAK_SLICE_CORE
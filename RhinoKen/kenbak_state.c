@@ -3,51 +3,74 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "kenbak_state.h"
 
+#define X kenbak_state_index_count // Invalid.
+
+// Indexed by KENBAK_STATE_INDEX_KEY():
+//
+unsigned char const kenbak_state_index_table[64] = {
+
+	// Q (and 0 for unknown):
+
+	kenbak_state_index_unknown, X, kenbak_state_index_qb,
+	kenbak_state_index_qc, kenbak_state_index_qd, kenbak_state_index_qe,
+	kenbak_state_index_qf, X,
+	X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X,
+
+	// S (and 63 for power-off):
+
+	X, kenbak_state_index_sa, kenbak_state_index_sb, kenbak_state_index_sc,
+	kenbak_state_index_sd, kenbak_state_index_se, kenbak_state_index_sf,
+	kenbak_state_index_sg,
+	kenbak_state_index_sh, X, kenbak_state_index_sj, kenbak_state_index_sk,
+	kenbak_state_index_sl, kenbak_state_index_sm, kenbak_state_index_sn, X,
+	kenbak_state_index_sp, kenbak_state_index_sq, kenbak_state_index_sr,
+	kenbak_state_index_ss, kenbak_state_index_st, kenbak_state_index_su,
+	kenbak_state_index_sv, kenbak_state_index_sw,
+	kenbak_state_index_sx, kenbak_state_index_sy, kenbak_state_index_sz, X,
+	X, X, X, kenbak_state_index_power_off
+};
+
+#undef X
+
+enum kenbak_state const kenbak_state_from_index[kenbak_state_index_count] = {
+	kenbak_state_power_off, kenbak_state_unknown,
+
+	kenbak_state_qb, kenbak_state_qc, kenbak_state_qd, kenbak_state_qe,
+	kenbak_state_qf,
+
+	kenbak_state_sa, kenbak_state_sb, kenbak_state_sc, kenbak_state_sd,
+	kenbak_state_se, kenbak_state_sf, kenbak_state_sg, kenbak_state_sh,
+	kenbak_state_sj, kenbak_state_sk, kenbak_state_sl, kenbak_state_sm,
+	kenbak_state_sn, kenbak_state_sp, kenbak_state_sq, kenbak_state_sr,
+	kenbak_state_ss, kenbak_state_st, kenbak_state_su, kenbak_state_sv,
+	kenbak_state_sw, kenbak_state_sx, kenbak_state_sy, kenbak_state_sz
+};
+
 char const * kenbak_state_get_str(enum kenbak_state const state)
 {
-	switch(state)
+	static char const * const strs[kenbak_state_index_count] = {
+		"po", "un",
+
+		"QB", "QC", "QD", "QE", "QF",
+
+		"SA", "SB", "SC", "SD", "SE", "SF", "SG", "SH", "SJ", "SK", "SL",
+		"SM", "SN", "SP", "SQ", "SR", "SS", "ST", "SU", "SV", "SW", "SX",
+		"SY", "SZ"
+	};
+
+	enum kenbak_state_index const i = KENBAK_STATE_GET_INDEX(state);
+
+	if(i == kenbak_state_index_count
+		|| kenbak_state_from_index[i] != state)
 	{
-		case kenbak_state_power_off:	{ return "po"; }
-		case kenbak_state_unknown:		{ return "un"; }
-
-		case kenbak_state_qb:			{ return "QB"; }
-		case kenbak_state_qc:			{ return "QC"; }
-		case kenbak_state_qd:			{ return "QD"; }
-		case kenbak_state_qe:			{ return "QE"; }
-		case kenbak_state_qf:			{ return "QF"; }
-
-		case kenbak_state_sa:			{ return "SA"; }
-		case kenbak_state_sb:			{ return "SB"; }
-		case kenbak_state_sc:			{ return "SC"; }
-		case kenbak_state_sd:			{ return "SD"; }
-		case kenbak_state_se:			{ return "SE"; }
-		case kenbak_state_sf:		    { return "SF"; }
-		case kenbak_state_sg:		    { return "SG"; }
-		case kenbak_state_sh:		    { return "SH"; }
-		case kenbak_state_sj:		    { return "SJ"; }
-		case kenbak_state_sk:		    { return "SK"; }
-		case kenbak_state_sl:		    { return "SL"; }
-		case kenbak_state_sm:		    { return "SM"; }
-		case kenbak_state_sn:		    { return "SN"; }
-		case kenbak_state_sp:		    { return "SP"; }
-		case kenbak_state_sq:		    { return "SQ"; }
-		case kenbak_state_sr:		    { return "SR"; }
-		case kenbak_state_ss:		    { return "SS"; }
-		case kenbak_state_st:		    { return "ST"; }
-		case kenbak_state_su:		    { return "SU"; }
-		case kenbak_state_sv:		    { return "SV"; }
-		case kenbak_state_sw:		    { return "SW"; }
-		case kenbak_state_sx:		    { return "SX"; }
-		case kenbak_state_sy:		    { return "SY"; }
-		case kenbak_state_sz:		    { return "SZ"; }
-
-		default:
-		{
-			assert(false); // Must not get here.
-			return NULL;
-		}
+		assert(false); // Must not get here.
+		return NULL;
 	}
+	return strs[i];
 }
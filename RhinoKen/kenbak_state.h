@@ -204,6 +204,63 @@ enum kenbak_state
     kenbak_state_sz = KENBAK_STATE_TYPE_SHIFTED_S | 26
 };
 
+// Dense numbering of the states above (e.g. to be used as array index):
+//
+enum kenbak_state_index
+{
+    kenbak_state_index_power_off = 0,
+    kenbak_state_index_unknown,
+
+    kenbak_state_index_qb,
+    kenbak_state_index_qc,
+    kenbak_state_index_qd,
+    kenbak_state_index_qe,
+    kenbak_state_index_qf,
+
+    kenbak_state_index_sa,
+    kenbak_state_index_sb,
+    kenbak_state_index_sc,
+    kenbak_state_index_sd,
+    kenbak_state_index_se,
+    kenbak_state_index_sf,
+    kenbak_state_index_sg,
+    kenbak_state_index_sh,
+    kenbak_state_index_sj,
+    kenbak_state_index_sk,
+    kenbak_state_index_sl,
+    kenbak_state_index_sm,
+    kenbak_state_index_sn,
+    kenbak_state_index_sp,
+    kenbak_state_index_sq,
+    kenbak_state_index_sr,
+    kenbak_state_index_ss,
+    kenbak_state_index_st,
+    kenbak_state_index_su,
+    kenbak_state_index_sv,
+    kenbak_state_index_sw,
+    kenbak_state_index_sx,
+    kenbak_state_index_sy,
+    kenbak_state_index_sz,
+
+    kenbak_state_index_count // Also used as invalid-value.
+};
+
+// The states' letter numbers fit into five bits and Q and S differ in the
+// second bit of their type, so six bits are enough as key to map any state to
+// its dense index (power-off maps to key 63, which is unused otherwise):
+//
+#define KENBAK_STATE_INDEX_KEY(state) \
+    (((unsigned int)(state) >> 1 & 0x20) | ((unsigned int)(state) & 0x1F))
+
+extern unsigned char const kenbak_state_index_table[64];
+
+#define KENBAK_STATE_GET_INDEX(state) \
+    ((enum kenbak_state_index)kenbak_state_index_table[ \
+        KENBAK_STATE_INDEX_KEY(state)])
+
+extern enum kenbak_state const kenbak_state_from_index[
+    kenbak_state_index_count];
+
 char const * kenbak_state_get_str(enum kenbak_state const state);
 
 #endif //KENBAK_STATE
@@ -0,0 +1,55 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Engine variants: The state machine's core (see kenbak_emu_core.h) compiled
+// with fixed features, each into its own translation unit and with its own
+// prefix, so that the variants can be linked side by side.
+//
+// - Each variant works on the same struct kenbak_data as kenbak_emu.h's
+//   functions do, the Kenbak-1 must be powered-on via kenbak_emu_step(), first
+//   (the variants do not handle the power switch).
+// - <prefix>_step() takes a single step like kenbak_emu_step() and returns
+//   its byte time count (zero, if powered-off, negative on error).
+// - <prefix>_steps() takes the given count of steps (stopping on error) and
+//   returns the summed-up byte time count.
+// - Features that a variant does not have are compiled out of it. None of the
+//   variants supports the code cache, the memory hash or the memoization of
+//   calls (see kenbak_emu.h), stepping fails while one of them is enabled.
+
+#ifndef KENBAK_VARIANT
+#define KENBAK_VARIANT
+
+#include <stdint.h>
+
+#include "kenbak_data.h"
+
+// Fast: No timing model (each step lasts one byte time), no tracing, no
+// counting and no validation of the invariants.
+//
+int kenbak_variant_fast_step(struct kenbak_data * const d);
+uint64_t kenbak_variant_fast_steps(
+    struct kenbak_data * const d, uint64_t const count);
+
+// Timing-accurate: Like fast, but with the timing model of the delay line
+// memory always enabled (whatever kenbak_emu_set_timing() set).
+//
+int kenbak_variant_timing_step(struct kenbak_data * const d);
+uint64_t kenbak_variant_timing_steps(
+    struct kenbak_data * const d, uint64_t const count);
+
+// Traced: Like fast, but calls the trace function before each step (see
+// kenbak_emu_set_trace()).
+//
+int kenbak_variant_trace_step(struct kenbak_data * const d);
+uint64_t kenbak_variant_trace_steps(
+    struct kenbak_data * const d, uint64_t const count);
+
+// Instrumented: Like fast, but counts the steps taken in each state (see
+// state_steps in struct kenbak_data_cold) and validates the invariants as set
+// via kenbak_emu_set_check_interval().
+//
+int kenbak_variant_count_step(struct kenbak_data * const d);
+uint64_t kenbak_variant_count_steps(
+    struct kenbak_data * const d, uint64_t const count);
+
+#endif //KENBAK_VARIANT
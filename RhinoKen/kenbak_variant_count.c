@@ -0,0 +1,10 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Instrumented engine variant (see kenbak_variant.h):
+//
+#define KENBAK_EMU_CORE_PREFIX kenbak_variant_count
+#define KENBAK_EMU_FEATURE_COUNT KENBAK_EMU_FEATURE_ON
+#define KENBAK_EMU_FEATURE_CHECK KENBAK_EMU_FEATURE_RUNTIME
+
+#include "kenbak_emu_core.h"
@@ -0,0 +1,8 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Engine variant without features (see kenbak_variant.h):
+//
+#define KENBAK_EMU_CORE_PREFIX kenbak_variant_fast
+
+#include "kenbak_emu_core.h"
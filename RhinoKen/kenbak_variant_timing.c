@@ -0,0 +1,9 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Timing-accurate engine variant (see kenbak_variant.h):
+//
+#define KENBAK_EMU_CORE_PREFIX kenbak_variant_timing
+#define KENBAK_EMU_FEATURE_TIMING KENBAK_EMU_FEATURE_ON
+
+#include "kenbak_emu_core.h"
@@ -0,0 +1,9 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Traced engine variant (see kenbak_variant.h):
+//
+#define KENBAK_EMU_CORE_PREFIX kenbak_variant_trace
+#define KENBAK_EMU_FEATURE_TRACE KENBAK_EMU_FEATURE_ON
+
+#include "kenbak_emu_core.h"
@@ -10,17 +10,14 @@
 #include "kenbak_instr.h"
 #include "kenbak_emu.h"
 #include "kenbak_data.h"
+#include "kenbak_runner.h"
 
 //#include "kenbak_asm.h"
 
-// See kenbak_emu.h:
+// See kenbak_runner.h:
 //
 #define MT_FPS 25
 #define MT_UPDATE_INTERVAL_MS (1000 / MT_FPS)
-#define MT_INSTRUCTIONS_PER_SEC 480
-#define MT_STEPS_PER_INSTRUCTION 10 // A guessed average value.
-#define MT_STEPS_PER_SEC (MT_INSTRUCTIONS_PER_SEC * MT_STEPS_PER_INSTRUCTION)
-#define MT_STEPS_PER_FRAME (MT_STEPS_PER_SEC / MT_FPS)
 
 // *****************************************************************************
 // *** WINDOWS-SPECIFIC                                                      ***
@@ -29,28 +26,6 @@
 #include <windows.h>
 #include <conio.h>
 
-static uint32_t get_ms(void)
-{
-	static LARGE_INTEGER freq;
-	static LARGE_INTEGER start;
-	static bool is_init = false;
-
-	LARGE_INTEGER now;
-
-	if(!is_init)
-	{
-		QueryPerformanceFrequency(&freq); // Ignoring return value..
-		QueryPerformanceCounter(&start); // Ignoring return value..
-		is_init = true;
-	}
-
-	QueryPerformanceCounter(&now); // Ignoring return value..
-
-	LONGLONG const offset_pc = now.QuadPart - start.QuadPart;
-
-	return (uint32_t)(1000 * offset_pc / freq.QuadPart);
-}
-
 static bool is_key_down(char const key)
 {
 	return (GetAsyncKeyState((int)key) & 0x8000) != 0;
@@ -162,12 +137,15 @@ static int print_byte_at(
 }
 
 static int print_memory_at(
-	int const x, int const y, struct kenbak_data * const d)
+	int const x, int const y, struct kenbak_snapshot const * const s)
 {
 	assert(KENBAK_DATA_DELAY_LINE_SIZE == 8 * 16);
 
 	int ret_val = 0;
-	int const p = (int)(*kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_P));
+	int const p = (int)s->mem[KENBAK_DATA_ADDR_P];
+	uint8_t const * const delay_line_0 = s->mem;
+	uint8_t const * const delay_line_1 =
+		s->mem + KENBAK_DATA_DELAY_LINE_SIZE;
 
 	for(int row = 0; row < 8; ++row)
 	{
@@ -178,7 +156,7 @@ static int print_memory_at(
 			ret_val += print_raw_hex_byte_at(
 				x + 2 * col,
 				y + row,
-				d->delay_line_0[row_offset + col],
+				delay_line_0[row_offset + col],
 				row_offset + col == p);
 		}
 	}
@@ -192,7 +170,7 @@ static int print_memory_at(
 			ret_val += print_raw_hex_byte_at(
 				x + 2 * col,
 				y + 1 + 8 + row,
-				d->delay_line_1[row_offset + col],
+				delay_line_1[row_offset + col],
 				false);
 		}
 	}
@@ -453,15 +431,18 @@ int main(void)
 #endif //0
 
 	struct kenbak_data * const d = kenbak_emu_create(true);
-	uint32_t last = 0;
+	struct kenbak_runner * r = NULL;
 	bool stepMode = false;
+	struct kenbak_input input;
 
 	set_cursor_visibility(false);
 
 	print_kenbak();
 	print_keys();
 
-	d->input.switch_power_on = true;
+	kenbak_emu_set_timing(d, true); // Paces by real byte times, see below.
+	kenbak_emu_set_code_cache(d, true);
+	kenbak_emu_press(d, kenbak_input_bit_power_on);
 
 // TODO: Debugging:
 //
@@ -540,33 +521,34 @@ int main(void)
 
 	kenbak_emu_step(d);
 
+	// The emulation runs on its own thread (see kenbak_runner.h), this thread
+	// gets the user input and prints the latest snapshot, only:
+	//
+	r = kenbak_runner_create(d, MT_UPDATE_INTERVAL_MS);
+	if(r == NULL)
+	{
+		kenbak_emu_delete(d);
+		return 1;
+	}
+
 	// The "game" loop:
 	//
-	last = get_ms();
 	do
 	{
-		uint32_t const cur = get_ms(), cur_interval = cur - last;
-
-		if(!stepMode && cur_interval < MT_UPDATE_INTERVAL_MS)
-		{
-			continue; // Wait a little longer.
-		}
-
-		last = cur;
-
 		// Get user input:
 		//
 		if(is_key_down('Q'))
 		{
 			break; // => Exit emulation (1/2).
 		}
-		kenbak_emu_init_input(d, true);
-		update_input(&d->input);
-		print_input(&d->input);
+		input = (struct kenbak_input){ .switch_power_on = true };
+		update_input(&input);
+		kenbak_runner_set_input_bits(r, kenbak_emu_pack_input(&input));
+		print_input(&input);
 
 		if(stepMode)
 		{
-			kenbak_emu_step(d); // (returned byte time is unused..)
+			kenbak_runner_step(r);
 			
 			char const pressed_key = wait_for_key_presses(
 				'y', // Exit step mode.
@@ -576,6 +558,7 @@ int main(void)
 			if(pressed_key == 'y') // Hard-coded
 			{
 				stepMode = false;
+				kenbak_runner_set_step_mode(r, false);
 			}
 			else
 			{
@@ -592,52 +575,42 @@ int main(void)
 			if(is_key_down('A'))
 			{
 				stepMode = true;
-			}
-
-			// Let the emulator do the work that a real Kenbak-1 computer can do
-			// in the current update interval timespan:
-			//
-			uint32_t const frames_per_cur_interval =
-				cur_interval / MT_UPDATE_INTERVAL_MS;
-			//
-			for(uint32_t f = 0; f < frames_per_cur_interval; ++f)
-			{
-				for(int s = 0; s < MT_STEPS_PER_FRAME; ++s)
-				{
-					kenbak_emu_step(d); // (returned byte time is unused..)
-				}
+				kenbak_runner_set_step_mode(r, true);
 			}
 		}
 
-		// Update output:
+		// Update output (the emulation thread does not wait for this):
 		//
-		print_leds(&d->output);
+		struct kenbak_snapshot const * const s =
+			kenbak_runner_get_snapshot(r);
+
+		print_leds(&s->output);
 
-		print_str_at(0, 16, kenbak_state_get_str(d->state), false);
+		print_str_at(0, 16, kenbak_state_get_str(s->state), false);
 
 		// Overdone (printing everything each time):
 		//
 		print_str_at(
 			3, 16, stepMode ? "[x] Step mode" : "[ ] Step mode", false);
 
-		print_byte_at(0, 18, 'A', d->delay_line_0[KENBAK_DATA_ADDR_A]);
-		print_byte_at(0, 19, 'B', d->delay_line_0[KENBAK_DATA_ADDR_B]);
-		print_byte_at(0, 20, 'X', d->delay_line_0[KENBAK_DATA_ADDR_X]);
-		print_byte_at(0, 21, 'P', d->delay_line_0[KENBAK_DATA_ADDR_P]);
+		print_byte_at(0, 18, 'A', s->mem[KENBAK_DATA_ADDR_A]);
+		print_byte_at(0, 19, 'B', s->mem[KENBAK_DATA_ADDR_B]);
+		print_byte_at(0, 20, 'X', s->mem[KENBAK_DATA_ADDR_X]);
+		print_byte_at(0, 21, 'P', s->mem[KENBAK_DATA_ADDR_P]);
 
 		// TODO: Implement correctly:
 		//
 		{
 			char buf[81];
 			int const buf_len = sizeof buf / sizeof *buf;
-			uint8_t const first_byte_addr = d->delay_line_0[KENBAK_DATA_ADDR_P],
+			uint8_t const first_byte_addr = s->mem[KENBAK_DATA_ADDR_P],
 				second_byte_addr = first_byte_addr + 1;
 
 			kenbak_instr_fill_str(
 				buf,
 				buf_len,
-				*kenbak_emu_get_mem_ptr(d, first_byte_addr),
-				*kenbak_emu_get_mem_ptr(d, second_byte_addr));
+				s->mem[first_byte_addr],
+				s->mem[second_byte_addr]);
 
 			print_str_at(
 				16, // Hard-coded
@@ -646,13 +619,19 @@ int main(void)
 				false);
 		}
 
-		print_byte_at(0, 23, 'W', d->reg_w);
-		print_byte_at(0, 24, 'I', d->reg_i);
-		print_byte_at(0, 25, 'K', d->reg_k);
+		print_byte_at(0, 23, 'W', s->reg_w);
+		print_byte_at(0, 24, 'I', s->reg_i);
+		print_byte_at(0, 25, 'K', s->reg_k);
 
-		print_memory_at(41, 13, d);
+		print_memory_at(41, 13, s);
+
+		if(!stepMode)
+		{
+			Sleep(MT_UPDATE_INTERVAL_MS); // (printing is not paced otherwise)
+		}
 	} while(true);
 
+	kenbak_runner_delete(r);
 	set_cursor_visibility(true);
 	set_cursor_pos(0, 11);
 	kenbak_emu_delete(d);
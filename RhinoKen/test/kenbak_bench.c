@@ -0,0 +1,901 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <time.h>
+
+#include "kenbak_bench.h"
+#include "kenbak_emu.h"
+#include "kenbak_data.h"
+#include "kenbak_state.h"
+#include "kenbak_dispatch.h"
+#include "kenbak_variant.h"
+#include "kenbak_pool.h"
+#include "kenbak_serial.h"
+#include "kenbak_slice.h"
+#include "kenbak_multi.h"
+#include "kenbak_gate.h"
+#include "kenbak_gate_net.h"
+
+#define KENBAK_BENCH_STEPS 50000000
+
+#define KENBAK_BENCH_JOBS 200000 // Short-lived Kenbak-1s.
+#define KENBAK_BENCH_JOB_INSTRS 100 // Per short-lived Kenbak-1.
+#define KENBAK_BENCH_POOL_CAPACITY 16
+
+#define KENBAK_BENCH_BIT_TIMES 1000000000 // Per program, 2000 s of real time.
+
+#define KENBAK_BENCH_SLICE_STEPS 1000000 // Per lane.
+
+#define KENBAK_BENCH_MULTI_SLOTS 1024
+#define KENBAK_BENCH_MULTI_STEPS 100000 // Per slot.
+
+#define KENBAK_BENCH_GATE_BIT_TIMES 5000000 // Per program, 10 s of real time.
+
+struct kenbak_bench_prog
+{
+    char const * name;
+    uint8_t const * bytes; // To be loaded at KENBAK_DATA_ADDR_P.
+    int len;
+};
+
+// Own: Count up (with delay loop), see main.c:
+//
+static uint8_t const s_prog_count_up[] = {
+    0004, //  3 004 P = 4
+    0023, //  4 023 LOAD-A constant
+    0000, //  5 - constant -
+    0034, //  6 034 STORE-A memory
+    0200, //  7 - address -
+    0003, //  8 003 ADD-A constant
+    0001, //  9 - constant -
+    0223, // 10 223 LOAD-X constant
+    0100, // 11 - constant -
+    0213, // 12 213 SUB-X constant
+    0001, // 13 - constant -
+    0243, // 14 243 JPD-X != 0
+    0014, // 15 - address -
+    0343, // 16 343 JPD-Unc. "!= 0"
+    0006, // 17 - address -
+};
+
+// Own: Rotate a bit, with inner delay loop (countdown), see main.c:
+//
+static uint8_t const s_prog_rotate[] = {
+    0004, //  3 004 P = 4
+    0023, //  4 023 LOAD-A constant
+    0200, //  5 - constant -
+    0311, //  6 311 ROTATE_LEFT_1-A
+    0034, //  7 034 STORE-A memory
+    0200, //  8 - address -
+    0223, //  9 223 LOAD-X constant
+    0040, // 10 - constant -
+    0213, // 11 213 SUB-X constant
+    0001, // 12 - constant -
+    0243, // 13 243 JPD-X != 0
+    0013, // 14 - address -
+    0343, // 15 343 JPD-Unc. "!= 0"
+    0006  // 16 - address -
+};
+
+// PRM, EX 3-1, but with a NOOP instead of the HALT (to keep on running):
+//
+static uint8_t const s_prog_ex_3_1[] = {
+    0004, // 3 004 P = 4
+    0023, // 4 023 A LOAD constant
+    0000, // 5 000
+    0034, // 6 034 A STORE memory
+    0200, // 7 200
+    0200, // 8 200 NOOP (instead of HALT)
+    0003, // 9 003 A ADD constant
+    0001, // A 001
+    0344, // B 344 Unconditional JPD
+    0006  // C 006
+};
+
+// Own: Multiply the values of two tables via a subroutine (repeated
+// addition), showing the results at the output (see kenbak_bench_memo()):
+//
+static uint8_t const s_prog_mul[] = {
+    0004, //  3 004 P = 4
+    0223, //  4 223 LOAD-X constant
+    0000, //  5 - constant -
+    0026, //  6 026 LOAD-A indexed
+    0100, //  7 - address -
+    0126, //  8 126 LOAD-B indexed
+    0110, //  9 - address -
+    0364, // 10 364 JMD-Unc.
+    0040, // 11 - address -
+    0034, // 12 034 STORE-A memory
+    0200, // 13 - address -
+    0203, // 14 203 ADD-X constant
+    0001, // 15 - constant -
+    0234, // 16 234 STORE-X memory
+    0121, // 17 - address -
+    0024, // 18 024 LOAD-A memory
+    0121, // 19 - address -
+    0013, // 20 013 SUB-A constant
+    0004, // 21 - constant -
+    0043, // 22 043 JPD-A != 0
+    0006, // 23 - address -
+    0344, // 24 344 JPD-Unc.
+    0004, // 25 - address -
+    0, 0, 0, 0, 0, 0, // 26 - 31
+    0000, // 32 (040) - mark -
+    0034, // 33 034 STORE-A memory
+    0120, // 34 - address -
+    0023, // 35 023 LOAD-A constant
+    0000, // 36 - constant -
+    0144, // 37 144 JPD-B == 0
+    0055, // 38 - address -
+    0004, // 39 004 ADD-A memory
+    0120, // 40 - address -
+    0113, // 41 113 SUB-B constant
+    0001, // 42 - constant -
+    0344, // 43 344 JPD-Unc.
+    0045, // 44 - address -
+    0354, // 45 354 JPI-Unc.
+    0040, // 46 - address -
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 47 - 63
+    0003, 0005, 0007, 0011, // 64 (0100) - 67 - table A -
+    0, 0, 0, 0, // 68 - 71
+    0020, 0015, 0022, 0017  // 72 (0110) - 75 - table B -
+};
+
+static struct kenbak_bench_prog const s_progs[] = {
+    { "count up", s_prog_count_up, (int)(sizeof s_prog_count_up) },
+    { "rotate", s_prog_rotate, (int)(sizeof s_prog_rotate) },
+    { "EX 3-1", s_prog_ex_3_1, (int)(sizeof s_prog_ex_3_1) }
+};
+
+static char const * get_dispatch_str(enum kenbak_dispatch const dispatch)
+{
+    switch(dispatch)
+    {
+        case kenbak_dispatch_switch:
+        {
+            return "switch";
+        }
+        case kenbak_dispatch_table:
+        {
+            return "table";
+        }
+        case kenbak_dispatch_goto:
+        {
+            return "goto";
+        }
+
+        default:
+        {
+            assert(false);
+            return "?";
+        }
+    }
+}
+
+/**
+ * - Powers-on the given Kenbak-1, loads the given program and switches to run
+ *   mode.
+ */
+static void start_running(
+    struct kenbak_data * const d, struct kenbak_bench_prog const * const prog)
+{
+    kenbak_emu_press(d, kenbak_input_bit_power_on);
+    kenbak_emu_step(d);
+
+    for(int i = 0; i < prog->len; ++i)
+    {
+        *kenbak_emu_get_mem_ptr(d, (uint8_t)(KENBAK_DATA_ADDR_P + i)) =
+            prog->bytes[i];
+    }
+
+    kenbak_emu_press(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d);
+    kenbak_emu_step(d);
+    kenbak_emu_release(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d);
+
+    assert(d->state != kenbak_state_qc);
+}
+
+/**
+ * - Returns a powered-on Kenbak-1 that has the given program loaded and is in
+ *   run mode.
+ * - Caller takes ownership of returned object.
+ */
+static struct kenbak_data * create_running(
+    struct kenbak_bench_prog const * const prog)
+{
+    struct kenbak_data * const d = kenbak_emu_create(false);
+
+    start_running(d, prog);
+    return d;
+}
+
+void kenbak_bench_dispatch(void)
+{
+    static enum kenbak_dispatch const dispatches[] = {
+        kenbak_dispatch_switch, kenbak_dispatch_table, kenbak_dispatch_goto
+    };
+
+    for(int i = 0; i < (int)(sizeof dispatches / sizeof *dispatches); ++i)
+    {
+        // Timed runs, one step per call and all steps in one call:
+
+        for(int in_one_call = 0; in_one_call < 2; ++in_one_call)
+        {
+            struct kenbak_data * const d = create_running(s_progs);
+            clock_t start = 0;
+            double secs = 0.0;
+
+            start = clock();
+            if(in_one_call == 1)
+            {
+                kenbak_emu_steps_via(d, KENBAK_BENCH_STEPS, dispatches[i]);
+            }
+            else
+            {
+                for(long n = 0; n < KENBAK_BENCH_STEPS; ++n)
+                {
+                    kenbak_emu_step_via(d, dispatches[i]);
+                }
+            }
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            printf(
+                "Dispatch %-6s (%s): %ld steps in %.3f s => %.1f M"
+                    " steps/s.\n",
+                get_dispatch_str(dispatches[i]),
+                in_one_call == 1 ? "one call " : "each step",
+                (long)KENBAK_BENCH_STEPS,
+                secs,
+                0.0 < secs ? KENBAK_BENCH_STEPS / secs / 1000000.0 : 0.0);
+
+            kenbak_emu_delete(d);
+        }
+    }
+
+    // Count of steps per state (the same for each kind of dispatch), counted
+    // by the instrumented engine variant in an extra run to keep the timed runs
+    // free of the counting:
+    {
+        struct kenbak_data * const d = create_running(s_progs);
+
+        kenbak_variant_count_steps(d, KENBAK_BENCH_STEPS);
+
+        for(int i = 0; i < (int)kenbak_state_index_count; ++i)
+        {
+            if(d->cold->state_steps[i] == 0)
+            {
+                continue;
+            }
+            printf(
+                "%s: %llu\n",
+                kenbak_state_get_str(kenbak_state_from_index[i]),
+                (unsigned long long)d->cold->state_steps[i]);
+        }
+
+        kenbak_emu_delete(d);
+    }
+}
+
+static void trace_nothing(void * const ctx, struct kenbak_data const * const d)
+{
+    ++*(uint64_t *)ctx;
+    (void)d;
+}
+
+void kenbak_bench_variants(void)
+{
+    static char const * const names[] = {
+        "kenbak_emu_step", "fast", "timing", "trace", "count"
+    };
+
+    for(int i = 0; i < (int)(sizeof names / sizeof *names); ++i)
+    {
+        struct kenbak_data * const d = create_running(s_progs);
+        uint64_t traced = 0;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        kenbak_emu_set_trace(d, trace_nothing, &traced);
+
+        // Timed run:
+
+        start = clock();
+        switch(i)
+        {
+            case 0:
+            {
+                for(long n = 0; n < KENBAK_BENCH_STEPS; ++n)
+                {
+                    kenbak_emu_step(d);
+                }
+                break;
+            }
+            case 1:
+            {
+                kenbak_variant_fast_steps(d, KENBAK_BENCH_STEPS);
+                break;
+            }
+            case 2:
+            {
+                kenbak_variant_timing_steps(d, KENBAK_BENCH_STEPS);
+                break;
+            }
+            case 3:
+            {
+                kenbak_variant_trace_steps(d, KENBAK_BENCH_STEPS);
+                break;
+            }
+            case 4:
+            {
+                kenbak_variant_count_steps(d, KENBAK_BENCH_STEPS);
+                break;
+            }
+
+            default:
+            {
+                assert(false); // Must not get here.
+                break;
+            }
+        }
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf(
+            "Variant %-15s: %ld steps in %.3f s => %.1f M steps/s.\n",
+            names[i],
+            (long)KENBAK_BENCH_STEPS,
+            secs,
+            0.0 < secs ? KENBAK_BENCH_STEPS / secs / 1000000.0 : 0.0);
+
+        kenbak_emu_delete(d);
+    }
+}
+
+void kenbak_bench_code_cache(void)
+{
+    static char const * const modes[] = {
+        "plain", "code cache", "threaded", "jit"
+    };
+
+    for(int i = 0; i < (int)(sizeof s_progs / sizeof *s_progs); ++i)
+    {
+        double code_cache_per_sec = 0.0; // (for the JIT's speedup)
+
+        for(int mode = 0; mode < (int)(sizeof modes / sizeof *modes); ++mode)
+        {
+            struct kenbak_data * const d = create_running(s_progs + i);
+            struct kenbak_run_limits limits = { 0 };
+            struct kenbak_run_result result;
+            clock_t start = 0;
+            double secs = 0.0;
+            double per_sec = 0.0;
+            bool enabled = true;
+
+            if(mode == 1)
+            {
+                enabled = kenbak_emu_set_code_cache(d, true);
+            }
+            else if(mode == 2)
+            {
+                enabled = kenbak_emu_set_threaded_code(d, true);
+            }
+            else if(mode == 3 && !kenbak_emu_set_jit(d, true))
+            {
+                printf("%-8s %-10s: Not available.\n", s_progs[i].name, "jit");
+                kenbak_emu_delete(d);
+                continue;
+            }
+            if(!enabled)
+            {
+                assert(false); // Must not get here.
+                kenbak_emu_delete(d);
+                return;
+            }
+            limits.max_steps = KENBAK_BENCH_STEPS;
+
+            // Timed run:
+
+            start = clock();
+            kenbak_emu_run(d, &limits, &result);
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+            per_sec = 0.0 < secs ? result.instrs / secs / 1000000.0 : 0.0;
+
+            printf(
+                "%-8s %-10s: %llu instr. in %.3f s => %.1f M instr./s",
+                s_progs[i].name,
+                modes[mode],
+                (unsigned long long)result.instrs,
+                secs,
+                per_sec);
+            if(mode == 1)
+            {
+                code_cache_per_sec = per_sec;
+            }
+            else if(mode == 3 && 0.0 < code_cache_per_sec)
+            {
+                printf(
+                    " (%.2f times the code cache)",
+                    per_sec / code_cache_per_sec);
+            }
+            printf(".\n");
+
+            kenbak_emu_delete(d);
+        }
+    }
+}
+
+void kenbak_bench_memo(void)
+{
+    static struct kenbak_bench_prog const prog = {
+        "multiply", s_prog_mul, (int)(sizeof s_prog_mul)
+    };
+
+    for(int mode = 0; mode < 2; ++mode)
+    {
+        struct kenbak_data * const d = create_running(&prog);
+        struct kenbak_run_limits limits = { 0 };
+        struct kenbak_run_result result;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        if(!kenbak_emu_set_threaded_code(d, true)
+            || !kenbak_emu_set_memo(d, mode == 1))
+        {
+            assert(false); // Must not get here.
+            kenbak_emu_delete(d);
+            return;
+        }
+        limits.max_steps = KENBAK_BENCH_STEPS;
+
+        // Timed run:
+
+        start = clock();
+        kenbak_emu_run(d, &limits, &result);
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf(
+            "%-8s %-10s: %llu instr. in %.3f s => %.1f M instr./s.\n",
+            prog.name,
+            mode == 1 ? "memo" : "threaded",
+            (unsigned long long)result.instrs,
+            secs,
+            0.0 < secs ? result.instrs / secs / 1000000.0 : 0.0);
+
+        kenbak_emu_delete(d);
+    }
+}
+
+/**
+ * - Lets the given short-lived Kenbak-1 run the given program with the
+ *   threaded code for a few instructions and returns the count of
+ *   instructions executed (or zero on error).
+ */
+static uint64_t run_job(
+    struct kenbak_data * const d, struct kenbak_bench_prog const * const prog)
+{
+    struct kenbak_run_limits limits = { 0 };
+    struct kenbak_run_result result;
+
+    if(!kenbak_emu_set_threaded_code(d, true))
+    {
+        assert(false); // Must not get here.
+        return 0;
+    }
+    start_running(d, prog);
+
+    limits.max_instrs = KENBAK_BENCH_JOB_INSTRS;
+    kenbak_emu_run(d, &limits, &result);
+    return result.instrs;
+}
+
+void kenbak_bench_pool(void)
+{
+    static struct kenbak_emu_options const options = { 0 };
+    struct kenbak_pool * const pool = kenbak_pool_create(
+        KENBAK_BENCH_POOL_CAPACITY, &options);
+
+    if(pool == NULL)
+    {
+        assert(false); // Must not get here.
+        return;
+    }
+
+    for(int mode = 0; mode < 2; ++mode)
+    {
+        uint64_t instrs = 0;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        // Timed run:
+
+        start = clock();
+        for(long n = 0; n < KENBAK_BENCH_JOBS; ++n)
+        {
+            if(mode == 1)
+            {
+                struct kenbak_data * const d = kenbak_pool_acquire(pool);
+
+                instrs += run_job(d, s_progs);
+                kenbak_pool_release(pool, d);
+            }
+            else
+            {
+                struct kenbak_data * const d = kenbak_emu_create(false);
+
+                instrs += run_job(d, s_progs);
+                kenbak_emu_delete(d);
+            }
+        }
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf(
+            "%-6s: %ld Kenbak-1s (%llu instr.) in %.3f s => %.1f k/s.\n",
+            mode == 1 ? "pool" : "create",
+            (long)KENBAK_BENCH_JOBS,
+            (unsigned long long)instrs,
+            secs,
+            0.0 < secs ? KENBAK_BENCH_JOBS / secs / 1000.0 : 0.0);
+    }
+
+    kenbak_pool_delete(pool);
+}
+
+void kenbak_bench_serial(void)
+{
+    for(int i = 0; i < (int)(sizeof s_progs / sizeof *s_progs); ++i)
+    {
+        struct kenbak_data * const d = create_running(s_progs + i);
+        struct kenbak_serial s;
+        int lamps[KENBAK_SERIAL_LAMP_COUNT];
+        uint64_t bit_times = 0;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        kenbak_serial_init(&s, d);
+
+        // Timed run:
+
+        start = clock();
+        bit_times = kenbak_serial_run(&s, d, KENBAK_BENCH_BIT_TIMES);
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf(
+            "%-8s: %llu bit times in %.3f s => %.1f M bit times/s"
+                " (%.0f x real time).\n",
+            s_progs[i].name,
+            (unsigned long long)bit_times,
+            secs,
+            0.0 < secs ? bit_times / secs / 1000000.0 : 0.0,
+            0.0 < secs
+                ? bit_times / secs / KENBAK_SERIAL_BIT_TIMES_PER_SECOND
+                : 0.0);
+
+        // The data lamps during one (real) second with data button 0 pressed,
+        // where the output byte glows faintly besides the input byte:
+
+        kenbak_serial_get_lamps(&s, lamps);
+        kenbak_emu_press(d, kenbak_input_bit_data_0);
+        kenbak_serial_run(&s, d, KENBAK_SERIAL_BIT_TIMES_PER_SECOND);
+        kenbak_emu_release(d, kenbak_input_bit_data_0);
+        kenbak_serial_get_lamps(&s, lamps);
+
+        printf("%-8s: Lamps 7 to 0 (per mille):", s_progs[i].name);
+        for(int bit = KENBAK_SERIAL_LAMP_COUNT - 1; 0 <= bit; --bit)
+        {
+            printf(" %4d", lamps[bit]);
+        }
+        printf("\n");
+
+        kenbak_emu_delete(d);
+    }
+}
+
+/** Returns the seconds passed since some point in time, by the wall clock.
+ */
+static double get_wall_secs(void)
+{
+    struct timespec t;
+
+    timespec_get(&t, TIME_UTC); // (return value ignored)
+    return (double)t.tv_sec + (double)t.tv_nsec / 1000000000.0;
+}
+
+/** Returns a Kenbak-1 like create_running() does, that may be loaded into a
+ *  lane of a bitsliced engine (see kenbak_slice.h) or into a slot of the
+ *  lockstep engine (see kenbak_multi.h), with the given timing.
+ */
+static struct kenbak_data * create_running_for_slice(
+    struct kenbak_bench_prog const * const prog, bool const timing)
+{
+    struct kenbak_data * const d = kenbak_emu_create(false);
+
+    kenbak_emu_set_timing(d, timing);
+    start_running(d, prog);
+    while(d->input_changed) // Until the released start button got sampled.
+    {
+        kenbak_emu_step(d);
+    }
+    return d;
+}
+
+/** Prints the instructions per second reached.
+ */
+static void print_instrs_per_sec(
+    char const * const prog_name,
+    char const * const engine_name,
+    int const count,
+    uint64_t const instrs,
+    double const secs)
+{
+    printf(
+        "%-8s: %-9s %3d x %d steps (%llu instr.) in %.3f s"
+            " => %.1f M instr./s.\n",
+        prog_name,
+        engine_name,
+        count,
+        KENBAK_BENCH_SLICE_STEPS,
+        (unsigned long long)instrs,
+        secs,
+        0.0 < secs ? instrs / secs / 1000000.0 : 0.0);
+}
+
+void kenbak_bench_slice(void)
+{
+    for(int i = 0; i < (int)(sizeof s_progs / sizeof *s_progs); ++i)
+    {
+        uint64_t instrs = 0;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        // The same count of Kenbak-1s, one after the other, via
+        // kenbak_emu_run():
+        {
+            struct kenbak_data * d[KENBAK_SLICE64_LANES];
+            struct kenbak_run_limits limits = { 0 };
+
+            for(int lane = 0; lane < KENBAK_SLICE64_LANES; ++lane)
+            {
+                d[lane] = create_running_for_slice(s_progs + i, false);
+            }
+            limits.max_steps = KENBAK_BENCH_SLICE_STEPS;
+
+            start = clock();
+            for(int lane = 0; lane < KENBAK_SLICE64_LANES; ++lane)
+            {
+                struct kenbak_run_result result;
+
+                kenbak_emu_run(d[lane], &limits, &result);
+                instrs += result.instrs;
+            }
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            print_instrs_per_sec(
+                s_progs[i].name, "run", KENBAK_SLICE64_LANES, instrs, secs);
+
+            for(int lane = 0; lane < KENBAK_SLICE64_LANES; ++lane)
+            {
+                kenbak_emu_delete(d[lane]);
+            }
+        }
+
+        // 64 lanes:
+        {
+            struct kenbak_slice64 * const s = kenbak_slice64_create(false);
+
+            if(s == NULL)
+            {
+                assert(false); // Must not get here.
+                return;
+            }
+            for(int lane = 0; lane < KENBAK_SLICE64_LANES; ++lane)
+            {
+                struct kenbak_data * const d =
+                    create_running_for_slice(s_progs + i, false);
+
+                kenbak_slice64_load(s, lane, d);
+                kenbak_emu_delete(d);
+            }
+
+            start = clock();
+            instrs = kenbak_slice64_steps(s, KENBAK_BENCH_SLICE_STEPS);
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            print_instrs_per_sec(
+                s_progs[i].name, "slice64", KENBAK_SLICE64_LANES, instrs, secs);
+
+            kenbak_slice64_delete(s);
+        }
+
+#ifdef KENBAK_SLICE_HAS_AVX2
+        // 256 lanes:
+        {
+            struct kenbak_slice256 * const s = kenbak_slice256_create(false);
+
+            if(s == NULL)
+            {
+                assert(false); // Must not get here.
+                return;
+            }
+            for(int lane = 0; lane < KENBAK_SLICE256_LANES; ++lane)
+            {
+                struct kenbak_data * const d =
+                    create_running_for_slice(s_progs + i, false);
+
+                kenbak_slice256_load(s, lane, d);
+                kenbak_emu_delete(d);
+            }
+
+            start = clock();
+            instrs = kenbak_slice256_steps(s, KENBAK_BENCH_SLICE_STEPS);
+            secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            print_instrs_per_sec(
+                s_progs[i].name,
+                "slice256",
+                KENBAK_SLICE256_LANES,
+                instrs,
+                secs);
+
+            kenbak_slice256_delete(s);
+        }
+#endif //KENBAK_SLICE_HAS_AVX2
+    }
+}
+
+void kenbak_bench_multi(void)
+{
+    for(int i = 0; i < (int)(sizeof s_progs / sizeof *s_progs); ++i)
+    {
+        struct kenbak_multi * const m =
+            kenbak_multi_create(KENBAK_BENCH_MULTI_SLOTS, false);
+        struct kenbak_run_limits limits = { 0 };
+        uint64_t instrs = 0;
+        clock_t start = 0;
+        double wall_start = 0.0;
+        double secs = 0.0;
+
+        if(m == NULL)
+        {
+            assert(false); // Must not get here.
+            return;
+        }
+
+        // Each slot gets another input byte, as for a sweep:
+        //
+        for(int slot = 0; slot < KENBAK_BENCH_MULTI_SLOTS; ++slot)
+        {
+            struct kenbak_data * const d =
+                create_running_for_slice(s_progs + i, false);
+
+            kenbak_multi_load(m, slot, d);
+            kenbak_multi_get_mem_ptr(m, slot)[KENBAK_DATA_ADDR_INPUT] =
+                (uint8_t)slot;
+            kenbak_emu_delete(d);
+        }
+
+        // One thread per processor, measured by the wall clock (clock() may
+        // sum up the processor time of all threads):
+        //
+        kenbak_multi_set_thread_count(m, 0); // (keeps one thread on error)
+        wall_start = get_wall_secs();
+        instrs = kenbak_multi_steps(m, KENBAK_BENCH_MULTI_STEPS);
+        secs = get_wall_secs() - wall_start;
+
+        printf(
+            "%-8s: multi %d x %d steps (%llu instr.) on %d thread(s) in %.3f"
+                " s => %.1f M instr./s.\n",
+            s_progs[i].name,
+            KENBAK_BENCH_MULTI_SLOTS,
+            KENBAK_BENCH_MULTI_STEPS,
+            (unsigned long long)instrs,
+            m->part_count,
+            secs,
+            0.0 < secs ? instrs / secs / 1000000.0 : 0.0);
+
+        kenbak_multi_delete(m);
+
+        // The same Kenbak-1s, one after the other, via kenbak_emu_run():
+
+        limits.max_steps = KENBAK_BENCH_MULTI_STEPS;
+        instrs = 0;
+        secs = 0.0;
+        for(int slot = 0; slot < KENBAK_BENCH_MULTI_SLOTS; ++slot)
+        {
+            struct kenbak_data * const d =
+                create_running_for_slice(s_progs + i, false);
+            struct kenbak_run_result result;
+
+            *kenbak_emu_get_mem_ptr(d, KENBAK_DATA_ADDR_INPUT) = (uint8_t)slot;
+
+            start = clock();
+            kenbak_emu_run(d, &limits, &result);
+            secs += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            instrs += result.instrs;
+            kenbak_emu_delete(d);
+        }
+
+        printf(
+            "%-8s: run   %d x %d steps (%llu instr.) in %.3f s"
+                " => %.1f M instr./s.\n",
+            s_progs[i].name,
+            KENBAK_BENCH_MULTI_SLOTS,
+            KENBAK_BENCH_MULTI_STEPS,
+            (unsigned long long)instrs,
+            secs,
+            0.0 < secs ? instrs / secs / 1000000.0 : 0.0);
+    }
+}
+
+void kenbak_bench_gate(void)
+{
+    static char const * const r_names[] = {
+        "r0", "r1", "r2", "r3", "r4", "r5", "r6" };
+
+    for(int i = 0; i < (int)(sizeof s_progs / sizeof *s_progs); ++i)
+    {
+        char * msg = NULL;
+        struct kenbak_gate * const g =
+            kenbak_gate_create(kenbak_gate_net_timing, &msg);
+        struct kenbak_data * const d = create_running(s_progs + i);
+        int r[7];
+        uint64_t bit_times = 0;
+        clock_t start = 0;
+        double secs = 0.0;
+
+        if(g == NULL)
+        {
+            printf("%s\n", msg == NULL ? "Netlist error." : msg);
+            free(msg);
+            kenbak_emu_delete(d);
+            return;
+        }
+        for(int bit = 0; bit < 7; ++bit)
+        {
+            r[bit] = kenbak_gate_get_net(g, r_names[bit]);
+        }
+        kenbak_emu_set_timing(d, true);
+
+        // The Kenbak-1 drives R of all lanes, clocking the netlist for each
+        // bit time of each of its steps:
+        //
+        start = clock();
+        while(bit_times < KENBAK_BENCH_GATE_BIT_TIMES)
+        {
+            int const byte_times = kenbak_emu_step(d);
+
+            for(int bit = 0; bit < 7; ++bit)
+            {
+                kenbak_gate_set(
+                    g, r[bit], ((d->sig_r >> bit) & 1) == 0 ? 0 : ~(uint64_t)0);
+            }
+            for(int t = 0; t < byte_times * 8; ++t)
+            {
+                kenbak_gate_clock(g);
+            }
+            bit_times += (uint64_t)byte_times * 8;
+        }
+        secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf(
+            "%-8s: gate %llu bit times x %d lanes in %.3f s"
+                " => %.2f M bit times/s,"
+                " %.1f of %d gates evaluated per bit time.\n",
+            s_progs[i].name,
+            (unsigned long long)bit_times,
+            KENBAK_GATE_LANES,
+            secs,
+            0.0 < secs ? bit_times / secs / 1000000.0 : 0.0,
+            (double)kenbak_gate_get_evals(g) / (double)bit_times,
+            kenbak_gate_get_gate_count(g));
+
+        kenbak_emu_delete(d);
+        kenbak_gate_delete(g);
+    }
+}
@@ -0,0 +1,86 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Benchmarks of the emulator (printed to stdout).
+
+#ifndef KENBAK_BENCH
+#define KENBAK_BENCH
+
+/**
+ * - Runs the same program with each kind of state dispatch (see enum
+ *   kenbak_dispatch), one step per call (see kenbak_emu_step_via()) and all
+ *   steps in one call (see kenbak_emu_steps_via()), and prints the steps per
+ *   second reached, followed by the count of steps taken in each state.
+ */
+void kenbak_bench_dispatch(void);
+
+/**
+ * - Runs the same program via kenbak_emu_step() and via each engine variant
+ *   (see kenbak_variant.h) and prints the steps per second reached.
+ */
+void kenbak_bench_variants(void);
+
+/**
+ * - Runs each of some example loops (see PRM) via kenbak_emu_run(), without
+ *   and with the code cache (see kenbak_emu_set_code_cache()), with the
+ *   threaded code (see kenbak_emu_set_threaded_code()) and with the JIT (see
+ *   kenbak_emu_set_jit(), where available), and prints the instructions per
+ *   second reached (and the JIT's speedup over the code cache).
+ */
+void kenbak_bench_code_cache(void);
+
+/**
+ * - Runs a program that calls a multiplication subroutine with repeating
+ *   arguments via kenbak_emu_run() with the threaded code, without and with
+ *   the memoization of calls (see kenbak_emu_set_memo()), and prints the
+ *   instructions per second reached.
+ */
+void kenbak_bench_memo(void);
+
+/**
+ * - Lets many short-lived Kenbak-1s each run a program for a few instructions
+ *   with the threaded code, creating and deleting each of them vs. acquiring
+ *   and releasing them from a pool (see kenbak_pool.h), and prints the
+ *   Kenbak-1s per second reached.
+ */
+void kenbak_bench_pool(void);
+
+/**
+ * - Runs each of some example programs via the bit-serial engine (see
+ *   kenbak_serial.h) and prints the bit times per second reached (and how
+ *   much faster than a real Kenbak-1 that is), followed by the brightness of
+ *   the data lamps while a data button is pressed.
+ */
+void kenbak_bench_serial(void);
+
+/**
+ * - Lets Kenbak-1s each run an example program for the same count of steps,
+ *   64 one after the other via kenbak_emu_run() and 64 (and 256, if
+ *   available) at once via the bitsliced engines (see kenbak_slice.h), and
+ *   prints the instructions per second reached by each.
+ * - All lanes run the same program, so the lanes never need to be split by
+ *   address (the best case for the bitsliced engines).
+ */
+void kenbak_bench_slice(void);
+
+/**
+ * - Lets 1024 Kenbak-1s, each with another input byte, run an example
+ *   program for the same count of steps, all at once via the lockstep engine
+ *   (see kenbak_multi.h, on one thread per processor) and one after the other
+ *   via kenbak_emu_run(), and prints the instructions per second reached by
+ *   each.
+ */
+void kenbak_bench_multi(void);
+
+/**
+ * - Runs each of some example programs via kenbak_emu_step() with the timing
+ *   model enabled, driving R of all lanes of the gate-level simulator with the
+ *   bundled timing netlist (see kenbak_gate_net.h) and clocking it for each
+ *   bit time, and prints the bit times per second reached, as well as the
+ *   count of gates evaluated per bit time.
+ * - As the bundled netlist covers a small part of the logic, only, the speed
+ *   reached says nothing about the one of a whole board.
+ */
+void kenbak_bench_gate(void);
+
+#endif //KENBAK_BENCH
@@ -0,0 +1,1299 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "kenbak_diff.h"
+#include "kenbak_emu.h"
+#include "kenbak_data.h"
+#include "kenbak_state.h"
+#include "kenbak_serial.h"
+#include "kenbak_slice.h"
+#include "kenbak_multi.h"
+#include "kenbak_gate.h"
+#include "kenbak_gate_net.h"
+#include "kenbak_recomp.h"
+
+#define KENBAK_DIFF_RUNS_PER_PROG 200
+#define KENBAK_DIFF_MAX_INSTRS_PER_RUN 500
+#define KENBAK_DIFF_MAX_STEPS_PER_INSTR 13 // (see kenbak_emu_run())
+#define KENBAK_DIFF_MAX_STEPS_PER_CYCLE_RUN 3000000
+#define KENBAK_DIFF_STEPS_PER_SERIAL_PROG 20000
+#define KENBAK_DIFF_STEPS_PER_SLICE_PROG 20000
+#define KENBAK_DIFF_MAX_SLICE_LANES 256
+#define KENBAK_DIFF_STEPS_PER_MULTI_PROG 20000
+#define KENBAK_DIFF_STEPS_PER_GATE_PROG 20000
+#define KENBAK_DIFF_STEPS_PER_SLICE_CHECK 997 // (prime, to vary the states)
+#define KENBAK_DIFF_RECOMP_PATH_SIZE 1024
+
+static uint32_t s_rand = 1;
+
+/** Returns a pseudo-random value from 0 to 32767 (same sequence on each
+ *  platform, unlike rand()).
+ */
+static int get_rand(void)
+{
+    s_rand = s_rand * 1103515245u + 12345u;
+    return (int)((s_rand >> 16) & 0x7FFF);
+}
+
+/** Fills the memory with random bytes, maybe including a countdown loop (see
+ *  kenbak_code_get_countdown_reg()) and lets P point near to it.
+ */
+static void fill_mem(uint8_t * const mem)
+{
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        mem[i] = (uint8_t)get_rand();
+    }
+
+    if(get_rand() % 2 == 0)
+    {
+        static uint8_t const regs[] = { 0000, 0100, 0200 }; // A, B and X.
+
+        uint8_t const reg = regs[get_rand() % 3];
+        uint8_t const addr = (uint8_t)(4 + get_rand() % 240);
+
+        mem[KENBAK_DATA_ADDR_P] = (uint8_t)(addr - 2);
+        mem[(uint8_t)(addr - 2)] = 0023 | reg; // LOAD constant
+        mem[(uint8_t)(addr - 1)] = (uint8_t)get_rand();
+        mem[addr] = 0013 | reg; // SUB constant
+        mem[(uint8_t)(addr + 1)] = 1;
+        mem[(uint8_t)(addr + 2)] = 0043 | reg; // JPD != 0
+        mem[(uint8_t)(addr + 3)] = addr;
+    }
+}
+
+/** Plants a counter loop that writes to the output register (a cycle of 256
+ *  passes) and lets P point to it.
+ */
+static void plant_counter_loop(uint8_t * const mem)
+{
+    uint8_t const addr = (uint8_t)(4 + get_rand() % 100);
+
+    mem[KENBAK_DATA_ADDR_P] = addr;
+    mem[addr] = 0003; // ADD-A constant
+    mem[(uint8_t)(addr + 1)] = 1;
+    mem[(uint8_t)(addr + 2)] = 0034; // STORE-A memory
+    mem[(uint8_t)(addr + 3)] = KENBAK_DATA_ADDR_OUTPUT;
+    mem[(uint8_t)(addr + 4)] = 0344; // JPD-Unc.
+    mem[(uint8_t)(addr + 5)] = addr;
+}
+
+/** Plants a main loop that calls a subroutine multiplying A by B (via
+ *  repeated addition) with arguments from two tables of four random values
+ *  each, so calls get repeated, and lets P point to it.
+ */
+static void plant_mul_calls(uint8_t * const mem)
+{
+    static uint8_t const prog[] = {
+        0223, 0000, //  4 LOAD-X constant 0
+        0026, 0100, //  6 LOAD-A indexed 0100
+        0126, 0110, //  8 LOAD-B indexed 0110
+        0364, 0040, // 10 JMD-Unc. 0040 (multiply)
+        0034, 0200, // 12 STORE-A memory 0200
+        0203, 0001, // 14 ADD-X constant 1
+        0234, 0121, // 16 STORE-X memory 0121
+        0024, 0121, // 18 LOAD-A memory 0121
+        0013, 0004, // 20 SUB-A constant 4
+        0043, 0006, // 22 JPD-A != 0 0006
+        0344, 0004  // 24 JPD-Unc. 0004
+    };
+    static uint8_t const mul[] = {
+        0000, //       40 (mark)
+        0034, 0120, // 41 STORE-A memory 0120
+        0023, 0000, // 43 LOAD-A constant 0
+        0144, 0055, // 45 JPD-B == 0 0055
+        0004, 0120, // 47 ADD-A memory 0120
+        0113, 0001, // 51 SUB-B constant 1
+        0344, 0045, // 53 JPD-Unc. 0045
+        0354, 0040  // 55 JPI-Unc. 0040
+    };
+
+    mem[KENBAK_DATA_ADDR_P] = 4;
+    for(int i = 0; i < (int)sizeof prog; ++i)
+    {
+        mem[4 + i] = prog[i];
+    }
+    for(int i = 0; i < (int)sizeof mul; ++i)
+    {
+        mem[0040 + i] = mul[i];
+    }
+    for(int i = 0; i < 4; ++i)
+    {
+        mem[0100 + i] = (uint8_t)get_rand();
+        mem[0110 + i] = (uint8_t)(get_rand() % 16);
+    }
+}
+
+/** Powers-on the Kenbak-1, loads the given memory and starts it.
+ */
+static void start(struct kenbak_data * const d, uint8_t const * const mem)
+{
+    kenbak_emu_press(d, kenbak_input_bit_power_on);
+    kenbak_emu_step(d);
+
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        *kenbak_emu_get_mem_ptr(d, (uint8_t)i) = mem[i];
+    }
+
+    kenbak_emu_press(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d);
+    kenbak_emu_step(d);
+    kenbak_emu_release(d, kenbak_input_bit_run_start);
+    kenbak_emu_step(d);
+}
+
+/** Returns a Kenbak-1 with the given timing, started with a random program
+ *  (see fill_mem() and start()).
+ */
+static struct kenbak_data * create_random(bool const timing)
+{
+    struct kenbak_data * const d = kenbak_emu_create(false);
+    uint8_t mem[KENBAK_DATA_MEM_SIZE];
+
+    if(d == NULL)
+    {
+        assert(false); // Must not get here.
+        return NULL;
+    }
+    kenbak_emu_set_timing(d, timing);
+    fill_mem(mem);
+    start(d, mem);
+    return d;
+}
+
+/** Returns true, if the given budget is used up (zero means no limit, see
+ *  struct kenbak_run_limits).
+ */
+static bool is_used_up(uint64_t const budget, uint64_t const used)
+{
+    return budget != 0 && budget <= used;
+}
+
+/** Returns the reason for kenbak_emu_run() to stop before the next step with
+ *  the given limits (see struct kenbak_run_limits, cycles are not supported).
+ */
+static enum kenbak_run_stop get_stop_by_steps(
+    struct kenbak_data const * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result const * const result,
+    uint32_t const output_write_count)
+{
+    if(is_used_up(limits->max_steps, result->steps))
+    {
+        return kenbak_run_stop_steps;
+    }
+    if(is_used_up(limits->max_byte_times, result->byte_times))
+    {
+        return kenbak_run_stop_byte_times;
+    }
+    if(d->state != kenbak_state_sa && d->state != kenbak_state_qc)
+    {
+        return kenbak_run_stop_none;
+    }
+    if(limits->stop_at_output && d->output_write_count != output_write_count)
+    {
+        return kenbak_run_stop_output;
+    }
+    if(is_used_up(limits->max_instrs, result->instrs))
+    {
+        return kenbak_run_stop_instrs;
+    }
+    if(limits->stop_at_p
+        && d->state == kenbak_state_sa
+        && 0 < result->steps
+        && (uint8_t)(d->mem[KENBAK_DATA_ADDR_P] + d->sig_inc) == limits->p)
+    {
+        return kenbak_run_stop_p;
+    }
+    return kenbak_run_stop_none;
+}
+
+/** Takes one step, adding it to the given result.
+ */
+static void step(
+    struct kenbak_data * const d, struct kenbak_run_result * const result)
+{
+    enum kenbak_state const last_state = d->state;
+
+    result->byte_times += (uint64_t)kenbak_emu_step(d);
+    ++result->steps;
+    if(last_state == kenbak_state_sd)
+    {
+        ++result->instrs;
+    }
+}
+
+/** Takes steps like kenbak_emu_run() with the given limits would (cycles are
+ *  not supported), adding them to the given result.
+ *
+ * - As kenbak_emu_run() executes an instruction in one pass, if the step
+ *   budget allows it, the byte time budget is not checked within such an
+ *   instruction (see max_byte_times of struct kenbak_run_limits).
+ */
+static void run_by_steps(
+    struct kenbak_data * const d,
+    struct kenbak_run_limits const * const limits,
+    struct kenbak_run_result * const result)
+{
+    assert(!limits->detect_cycles && !limits->skip_cycles);
+
+    uint32_t const output_write_count = d->output_write_count;
+
+    while(true)
+    {
+        enum kenbak_state const last_state = d->state;
+
+        result->stop = get_stop_by_steps(
+            d, limits, result, output_write_count);
+        if(result->stop != kenbak_run_stop_none)
+        {
+            return;
+        }
+
+        if(kenbak_emu_is_quiescent(d))
+        {
+            // Each step would last one byte time, the rest of the budgets
+            // passes (zero without one):
+
+            uint64_t count = 0;
+
+            if(limits->max_steps != 0)
+            {
+                count = limits->max_steps - result->steps;
+            }
+            if(limits->max_byte_times != 0
+                && (count == 0
+                    || limits->max_byte_times - result->byte_times < count))
+            {
+                count = limits->max_byte_times - result->byte_times;
+            }
+            for(uint64_t i = 0; i < count; ++i)
+            {
+                step(d, result);
+            }
+            result->stop = kenbak_run_stop_quiescent;
+            return;
+        }
+
+        bool const whole = last_state == kenbak_state_sa
+            && !is_used_up(
+                limits->max_steps,
+                result->steps + KENBAK_DIFF_MAX_STEPS_PER_INSTR - 1);
+
+        step(d, result);
+        if(whole)
+        {
+            // The rest of the instruction:
+
+            while(d->state != kenbak_state_sa && d->state != kenbak_state_qc)
+            {
+                step(d, result);
+            }
+        }
+
+        if(limits->stop_at_qc
+            && last_state != kenbak_state_qc
+            && d->state == kenbak_state_qc)
+        {
+            result->stop = kenbak_run_stop_qc;
+            return;
+        }
+    }
+}
+
+/** Fills the given limits with a random budget and random reasons to stop.
+ */
+static void fill_limits(struct kenbak_run_limits * const limits)
+{
+    int const instrs = 1 + get_rand() % KENBAK_DIFF_MAX_INSTRS_PER_RUN;
+
+    int const budgets = 1 + get_rand() % 7; // Bits for steps, byte times
+                                            // and instructions.
+
+    if((budgets & 1) != 0)
+    {
+        limits->max_steps = (uint64_t)(
+            1 + get_rand() % (instrs * KENBAK_DIFF_MAX_STEPS_PER_INSTR));
+    }
+    if((budgets & 2) != 0)
+    {
+        limits->max_byte_times = (uint64_t)(
+            1 + get_rand() % (instrs * KENBAK_DIFF_MAX_STEPS_PER_INSTR));
+    }
+    if((budgets & 4) != 0)
+    {
+        limits->max_instrs = (uint64_t)instrs;
+    }
+    limits->stop_at_qc = get_rand() % 4 != 0;
+    limits->stop_at_output = get_rand() % 4 == 0;
+    limits->stop_at_p = get_rand() % 4 == 0;
+    limits->p = (uint8_t)get_rand();
+}
+
+/** Returns the name of the first difference between the given Kenbak-1
+ *  states, or NULL, if they are equal.
+ */
+static char const * get_diff(
+    struct kenbak_data * const a, struct kenbak_data * const b)
+{
+    for(int i = 0; i < KENBAK_DATA_MEM_SIZE; ++i)
+    {
+        if(a->mem[i] != b->mem[i])
+        {
+            return "memory";
+        }
+    }
+    if(a->state != b->state)
+    {
+        return "state";
+    }
+    if(a->reg_i != b->reg_i
+        || a->reg_w != b->reg_w
+        || kenbak_emu_get_reg_k(a) != kenbak_emu_get_reg_k(b))
+    {
+        return "registers";
+    }
+    if(a->sigs != b->sigs
+        || a->sig_x != b->sig_x
+        || a->sig_r != b->sig_r
+        || a->sig_inc != b->sig_inc)
+    {
+        return "signals";
+    }
+    if(a->byte_times != b->byte_times)
+    {
+        return "byte times";
+    }
+    if(a->output_write_count != b->output_write_count)
+    {
+        return "output writes";
+    }
+    return NULL;
+}
+
+/** Returns the name of the first difference between the given results of
+ *  runs or between the Kenbak-1 states after them (see get_diff()), or NULL,
+ *  if they are equal.
+ */
+static char const * get_run_diff(
+    struct kenbak_run_result const * const result_a,
+    struct kenbak_run_result const * const result_b,
+    struct kenbak_data * const a,
+    struct kenbak_data * const b)
+{
+    if(result_a->stop != result_b->stop
+        || result_a->steps != result_b->steps
+        || result_a->instrs != result_b->instrs
+        || result_a->byte_times != result_b->byte_times)
+    {
+        return "run result";
+    }
+    return get_diff(a, b);
+}
+
+/** Runs the given count of random programs via kenbak_emu_run() with the
+ *  threaded code (or without the code cache) and, optionally, the memoization
+ *  of calls enabled, comparing them with kenbak_emu_step() (see
+ *  kenbak_diff_threaded_code()).
+ */
+static bool diff_against_steps(int const prog_count, bool const memo)
+{
+    long run_count = 0;
+    uint64_t hit_count = 0;
+    int jit_count = 0;
+    int plain_count = 0;
+
+    for(int prog = 0; prog < prog_count; ++prog)
+    {
+        struct kenbak_data * const a = kenbak_emu_create(false);
+        struct kenbak_data * const b = kenbak_emu_create(false);
+        uint8_t mem[KENBAK_DATA_MEM_SIZE];
+        bool ok = true;
+
+        if(!kenbak_emu_set_threaded_code(a, prog % 8 < 6)
+            || !kenbak_emu_set_memo(a, memo))
+        {
+            assert(false); // Must not get here.
+            kenbak_emu_delete(a);
+            kenbak_emu_delete(b);
+            return false;
+        }
+        kenbak_emu_set_timing(a, prog % 2 == 1);
+        kenbak_emu_set_timing(b, prog % 2 == 1);
+
+        // Half of the programs with the JIT, where available (with the timing
+        // model, it must leave everything to the threaded code):
+        //
+        if(!memo && prog % 4 < 2 && kenbak_emu_set_jit(a, true))
+        {
+            ++jit_count;
+        }
+        if(prog % 8 >= 6)
+        {
+            ++plain_count; // (without the code cache)
+        }
+
+        fill_mem(mem);
+        if(memo && get_rand() % 2 == 0)
+        {
+            plant_mul_calls(mem);
+        }
+        start(a, mem);
+        start(b, mem);
+
+        for(int run = 0; ok && run < KENBAK_DIFF_RUNS_PER_PROG; ++run)
+        {
+            struct kenbak_run_limits limits = { 0 };
+            struct kenbak_run_result result_a;
+            struct kenbak_run_result result_b = { kenbak_run_stop_none };
+            char const * diff = NULL;
+
+            if(a->state == kenbak_state_qc)
+            {
+                break; // Halted.
+            }
+
+            fill_limits(&limits);
+
+            kenbak_emu_run(a, &limits, &result_a);
+            run_by_steps(b, &limits, &result_b);
+            ++run_count;
+
+            diff = get_run_diff(&result_a, &result_b, a, b);
+            if(diff != NULL)
+            {
+                printf(
+                    "Difference in %s: Program %d, run %d, state %s.\n",
+                    diff,
+                    prog,
+                    run,
+                    kenbak_state_get_str(b->state));
+                ok = false;
+            }
+        }
+
+        if(a->memo != NULL)
+        {
+            hit_count += a->memo->hit_count;
+        }
+        kenbak_emu_delete(a);
+        kenbak_emu_delete(b);
+        if(!ok)
+        {
+            return false;
+        }
+    }
+
+    if(memo)
+    {
+        printf(
+            "No difference found in %ld runs (%llu calls replayed).\n",
+            run_count,
+            (unsigned long long)hit_count);
+        return true;
+    }
+    printf(
+        "No difference found in %ld runs (%d programs with the JIT, %d"
+            " without the code cache).\n",
+        run_count,
+        jit_count,
+        plain_count);
+    return true;
+}
+
+bool kenbak_diff_threaded_code(int const prog_count)
+{
+    return diff_against_steps(prog_count, false);
+}
+
+bool kenbak_diff_memo(int const prog_count)
+{
+    return diff_against_steps(prog_count, true);
+}
+
+
+
+bool kenbak_diff_cycle_skip(int const prog_count)
+{
+    int skip_count = 0;
+
+    for(int prog = 0; prog < prog_count; ++prog)
+    {
+        struct kenbak_data * const a = kenbak_emu_create(false);
+        struct kenbak_data * const b = kenbak_emu_create(false);
+        uint8_t mem[KENBAK_DATA_MEM_SIZE];
+        struct kenbak_run_limits limits = { 0 };
+        struct kenbak_run_result result_a;
+        struct kenbak_run_result result_b;
+        char const * diff = NULL;
+
+        kenbak_emu_set_hashing(a, true);
+        kenbak_emu_set_timing(a, prog % 2 == 1);
+        kenbak_emu_set_timing(b, prog % 2 == 1);
+
+        fill_mem(mem);
+        if(get_rand() % 2 == 0)
+        {
+            plant_counter_loop(mem);
+        }
+        start(a, mem);
+        start(b, mem);
+
+        limits.max_steps =
+            1 + (uint64_t)get_rand() * get_rand()
+                % KENBAK_DIFF_MAX_STEPS_PER_CYCLE_RUN;
+        limits.stop_at_qc = true;
+        kenbak_emu_run(b, &limits, &result_b);
+
+        limits.skip_cycles = true;
+        kenbak_emu_run(a, &limits, &result_a);
+
+        if(result_a.cycle_steps != 0)
+        {
+            ++skip_count;
+        }
+
+        diff = get_run_diff(&result_a, &result_b, a, b);
+
+        kenbak_emu_delete(a);
+        kenbak_emu_delete(b);
+        if(diff != NULL)
+        {
+            printf("Difference in %s: Program %d.\n", diff, prog);
+            return false;
+        }
+    }
+
+    printf(
+        "No difference found in %d programs (%d with cycles skipped).\n",
+        prog_count,
+        skip_count);
+    return true;
+}
+
+bool kenbak_diff_serial(int const prog_count)
+{
+    long boundary_count = 0;
+
+    for(int prog = 0; prog < prog_count; ++prog)
+    {
+        struct kenbak_data * const a = kenbak_emu_create(false);
+        struct kenbak_data * const b = kenbak_emu_create(false);
+        struct kenbak_serial s;
+        uint8_t mem[KENBAK_DATA_MEM_SIZE];
+        enum kenbak_input_bit const data_bit =
+            (enum kenbak_input_bit)(get_rand() % 8);
+        char const * diff = NULL;
+        int step = 0;
+
+        kenbak_serial_init(&s, a);
+        kenbak_emu_set_timing(b, true);
+
+        fill_mem(mem);
+        start(a, mem);
+        start(b, mem);
+
+        for(; diff == NULL && step < KENBAK_DIFF_STEPS_PER_SERIAL_PROG; ++step)
+        {
+            if(step == KENBAK_DIFF_STEPS_PER_SERIAL_PROG / 4)
+            {
+                kenbak_emu_press(a, data_bit);
+                kenbak_emu_press(b, data_bit);
+            }
+            else if(step == KENBAK_DIFF_STEPS_PER_SERIAL_PROG / 2)
+            {
+                kenbak_emu_release(a, data_bit);
+                kenbak_emu_release(b, data_bit);
+            }
+
+            int const bit_times = kenbak_serial_step(&s, a);
+            int const byte_times = kenbak_emu_step(b);
+
+            if(bit_times != byte_times * KENBAK_SERIAL_BITS_PER_BYTE)
+            {
+                diff = "bit times";
+            }
+            else if(b->state == kenbak_state_sa || b->state == kenbak_state_qc)
+            {
+                diff = get_diff(a, b); // At an instruction boundary.
+                ++boundary_count;
+            }
+        }
+
+        kenbak_emu_delete(a);
+        kenbak_emu_delete(b);
+        if(diff != NULL)
+        {
+            printf(
+                "Difference in %s: Program %d, step %d.\n",
+                diff,
+                prog,
+                step - 1);
+            return false;
+        }
+    }
+
+    printf(
+        "No difference found at %ld instruction boundaries.\n",
+        boundary_count);
+    return true;
+}
+
+/** Lets the given Kenbak-1 started by start() take steps, until the release of
+ *  the start button got sampled, so it may be loaded into a lane (see
+ *  kenbak_slice.h).
+ */
+static void settle(struct kenbak_data * const d)
+{
+    while(d->input_changed)
+    {
+        kenbak_emu_step(d);
+    }
+}
+
+// An engine taking the steps of many Kenbak-1s at once, one per lane (see
+// diff_lanes()):
+//
+struct lane_engine
+{
+    void * e;
+    bool (* load)(
+        void * const e, int const lane, struct kenbak_data const * const d);
+    void (* unload)(
+        void * const e, int const lane, struct kenbak_data * const d);
+    void (* steps)(void * const e, uint64_t const count);
+};
+
+static bool slice64_load(
+    void * const e, int const lane, struct kenbak_data const * const d)
+{
+    return kenbak_slice64_load(e, lane, d);
+}
+
+static void slice64_unload(
+    void * const e, int const lane, struct kenbak_data * const d)
+{
+    kenbak_slice64_unload(e, lane, d);
+}
+
+static void slice64_steps(void * const e, uint64_t const count)
+{
+    kenbak_slice64_steps(e, count); // (return value ignored)
+}
+
+#ifdef KENBAK_SLICE_HAS_AVX2
+static bool slice256_load(
+    void * const e, int const lane, struct kenbak_data const * const d)
+{
+    return kenbak_slice256_load(e, lane, d);
+}
+
+static void slice256_unload(
+    void * const e, int const lane, struct kenbak_data * const d)
+{
+    kenbak_slice256_unload(e, lane, d);
+}
+
+static void slice256_steps(void * const e, uint64_t const count)
+{
+    kenbak_slice256_steps(e, count); // (return value ignored)
+}
+#endif //KENBAK_SLICE_HAS_AVX2
+
+static bool multi_load(
+    void * const e, int const lane, struct kenbak_data const * const d)
+{
+    return kenbak_multi_load(e, lane, d);
+}
+
+static void multi_unload(
+    void * const e, int const lane, struct kenbak_data * const d)
+{
+    kenbak_multi_unload(e, lane, d);
+}
+
+static void multi_steps(void * const e, uint64_t const count)
+{
+    kenbak_multi_steps(e, count); // (return value ignored)
+}
+
+/** Runs the given count of random programs (one per lane) in the given
+ *  engine, with the given timing, and via kenbak_emu_step(), comparing the
+ *  whole states every KENBAK_DIFF_STEPS_PER_SLICE_CHECK steps, until the
+ *  given count of steps got taken.
+ *
+ *  - Returns the name of the first difference found or NULL.
+ */
+static char const * diff_lanes(
+    struct lane_engine const * const engine,
+    int const lanes,
+    bool const timing,
+    int const steps,
+    long * const check_count)
+{
+    struct kenbak_data * const a = kenbak_emu_create(false);
+    struct kenbak_data * * const b = calloc((size_t)lanes, sizeof *b);
+    char const * diff = NULL;
+
+    if(a == NULL || b == NULL)
+    {
+        diff = "creation";
+    }
+    else
+    {
+        kenbak_emu_set_timing(a, timing);
+    }
+    for(int lane = 0; lane < lanes && diff == NULL; ++lane)
+    {
+        b[lane] = create_random(timing);
+        if(b[lane] == NULL)
+        {
+            diff = "creation";
+            break;
+        }
+        settle(b[lane]);
+        if(!engine->load(engine->e, lane, b[lane]))
+        {
+            diff = "loading";
+        }
+    }
+
+    for(int step = 0;
+        diff == NULL && step < steps;
+        step += KENBAK_DIFF_STEPS_PER_SLICE_CHECK)
+    {
+        engine->steps(engine->e, KENBAK_DIFF_STEPS_PER_SLICE_CHECK);
+
+        for(int lane = 0; lane < lanes && diff == NULL; ++lane)
+        {
+            for(int i = 0; i < KENBAK_DIFF_STEPS_PER_SLICE_CHECK; ++i)
+            {
+                kenbak_emu_step(b[lane]);
+            }
+            engine->unload(engine->e, lane, a);
+            diff = get_diff(a, b[lane]);
+            ++*check_count;
+        }
+    }
+
+    if(b != NULL)
+    {
+        for(int lane = 0; lane < lanes; ++lane)
+        {
+            if(b[lane] != NULL)
+            {
+                kenbak_emu_delete(b[lane]);
+            }
+        }
+        free(b);
+    }
+    if(a != NULL)
+    {
+        kenbak_emu_delete(a);
+    }
+    return diff;
+}
+
+/** Runs one batch of random programs (one per lane) in a bitsliced engine
+ *  (the 256-lane one, if wide is true) and via kenbak_emu_step() (see
+ *  diff_lanes()).
+ *
+ *  - Returns the name of the first difference found or NULL.
+ */
+static char const * diff_slice_batch(
+    int const lanes,
+    bool const wide,
+    bool const timing,
+    long * const check_count)
+{
+    char const * diff = NULL;
+
+#ifdef KENBAK_SLICE_HAS_AVX2
+    if(wide)
+    {
+        struct kenbak_slice256 * const s = kenbak_slice256_create(timing);
+        struct lane_engine const engine = {
+            s, slice256_load, slice256_unload, slice256_steps };
+
+        if(s == NULL)
+        {
+            return "creation";
+        }
+        diff = diff_lanes(
+            &engine,
+            lanes,
+            timing,
+            KENBAK_DIFF_STEPS_PER_SLICE_PROG,
+            check_count);
+        kenbak_slice256_delete(s);
+        return diff;
+    }
+#else //KENBAK_SLICE_HAS_AVX2
+    assert(!wide);
+    (void)wide; // (for NDEBUG)
+#endif //KENBAK_SLICE_HAS_AVX2
+
+    struct kenbak_slice64 * const s = kenbak_slice64_create(timing);
+    struct lane_engine const engine = {
+        s, slice64_load, slice64_unload, slice64_steps };
+
+    if(s == NULL)
+    {
+        return "creation";
+    }
+    diff = diff_lanes(
+        &engine, lanes, timing, KENBAK_DIFF_STEPS_PER_SLICE_PROG, check_count);
+    kenbak_slice64_delete(s);
+    return diff;
+}
+
+bool kenbak_diff_slice(int const prog_count)
+{
+    long check_count = 0;
+    int prog = 0;
+
+    for(int batch = 0; prog < prog_count; ++batch)
+    {
+#ifdef KENBAK_SLICE_HAS_AVX2
+        bool const wide = batch % 4 >= 2;
+        int const lanes = wide ? KENBAK_SLICE256_LANES : KENBAK_SLICE64_LANES;
+#else //KENBAK_SLICE_HAS_AVX2
+        bool const wide = false;
+        int const lanes = KENBAK_SLICE64_LANES;
+#endif //KENBAK_SLICE_HAS_AVX2
+        bool const timing = batch % 2 == 1;
+        char const * const diff =
+            diff_slice_batch(lanes, wide, timing, &check_count);
+
+        if(diff != NULL)
+        {
+            printf(
+                "Difference in %s: Batch %d (%d lanes, timing %s).\n",
+                diff,
+                batch,
+                lanes,
+                timing ? "on" : "off");
+            return false;
+        }
+        prog += lanes;
+    }
+
+    printf(
+        "No difference found in %d programs (%ld checks).\n",
+        prog,
+        check_count);
+    return true;
+}
+
+/** Runs the given count of random programs in the lockstep engine (see
+ *  kenbak_multi.h) and via kenbak_emu_step() (see diff_lanes()).
+ *
+ *  - Returns the name of the first difference found or NULL.
+ */
+static char const * diff_multi_batch(
+    int const prog_count, bool const timing, long * const check_count)
+{
+    struct kenbak_multi * const m = kenbak_multi_create(prog_count, timing);
+    struct lane_engine const engine = {
+        m, multi_load, multi_unload, multi_steps };
+    char const * diff = NULL;
+
+    // The engine with the timing model steps its slots on three threads:
+    //
+    if(m == NULL || (timing && !kenbak_multi_set_thread_count(m, 3)))
+    {
+        kenbak_multi_delete(m);
+        return "creation";
+    }
+    diff = diff_lanes(
+        &engine,
+        prog_count,
+        timing,
+        KENBAK_DIFF_STEPS_PER_MULTI_PROG,
+        check_count);
+    kenbak_multi_delete(m);
+    return diff;
+}
+
+bool kenbak_diff_multi(int const prog_count)
+{
+    long check_count = 0;
+
+    for(int timing = 0; timing < 2; ++timing)
+    {
+        char const * const diff =
+            diff_multi_batch(prog_count / 2, timing == 1, &check_count);
+
+        if(diff != NULL)
+        {
+            printf(
+                "Difference in %s: Timing %s.\n",
+                diff,
+                timing == 1 ? "on" : "off");
+            return false;
+        }
+    }
+
+    printf(
+        "No difference found in %d programs (%ld checks).\n",
+        prog_count / 2 * 2,
+        check_count);
+    return true;
+}
+
+// A Kenbak-1 driving the inputs of one lane of the gate-level simulator (see
+// diff_gate_batch()):
+//
+struct gate_lane
+{
+    struct kenbak_data * d;
+    int steps;
+    int left; // Byte times left of the current step.
+    bool is_cm_checked; // CM must be set at T7 of the last byte time, only.
+    bool is_add; // The step adds a and b (states SB and SJ).
+    uint8_t a;
+    uint8_t b;
+    uint8_t sum;
+};
+
+/** Lets the given lane's Kenbak-1 take its next step and prepares the
+ *  checks of the gate-level simulator's lane during that step.
+ *
+ *  - Returns the name of the difference found (no byte times) or NULL.
+ */
+static char const * begin_gate_step(
+    struct gate_lane * const lane, long * const instr_count)
+{
+    struct kenbak_data * const d = lane->d;
+    uint32_t const byte_times = d->byte_times;
+
+    lane->is_add = false;
+    if(d->state == kenbak_state_sb) // W = P + increment.
+    {
+        lane->is_add = true;
+        lane->a = d->mem[d->sig_r];
+        lane->b = d->sig_inc;
+    }
+    else if(d->state == kenbak_state_sj) // W = W + X.
+    {
+        lane->is_add = true;
+        lane->a = d->reg_w;
+        lane->b = d->mem[d->sig_r];
+    }
+    else if(d->state == kenbak_state_sa)
+    {
+        ++*instr_count;
+    }
+    lane->sum = 0;
+
+    lane->left = kenbak_emu_step(d);
+    ++lane->steps;
+    if(lane->left <= 0)
+    {
+        return "byte times";
+    }
+
+    // If the step lasted as long as waiting for CM would (see wait_for_cm()
+    // of kenbak_emu_core.h), CM must get set at the end of it, only:
+    //
+    lane->is_cm_checked = lane->left == (int)(
+        ((uint32_t)d->sig_r - byte_times - 1) % KENBAK_DATA_DELAY_LINE_SIZE)
+            + 1;
+    return NULL;
+}
+
+/** Runs one batch of random programs (one per lane) via kenbak_emu_step()
+ *  with the timing model enabled, step by step, driving the inputs of the
+ *  bundled timing netlist (see kenbak_gate_net_timing) with R and the
+ *  operands of the additions of each step and clocking it for each bit time.
+ *
+ *  - Checks the sums of the serial adder, CM while waiting for it and L at
+ *    each step's end.
+ *  - Returns the name of the first difference found or NULL.
+ */
+static char const * diff_gate_batch(
+    long * const check_count, long * const instr_count)
+{
+    static char const * const r_names[] = {
+        "r0", "r1", "r2", "r3", "r4", "r5", "r6" };
+    static char const * const l_names[] = {
+        "l0", "l1", "l2", "l3", "l4", "l5", "l6" };
+
+    struct gate_lane lanes[KENBAK_GATE_LANES] = { 0 };
+    char * msg = NULL;
+    struct kenbak_gate * const g =
+        kenbak_gate_create(kenbak_gate_net_timing, &msg);
+    char const * diff = NULL;
+    int r[7];
+    int l[7];
+
+    if(g == NULL)
+    {
+        printf("%s\n", msg == NULL ? "Netlist error." : msg);
+        free(msg);
+        return "netlist";
+    }
+    for(int i = 0; i < 7; ++i)
+    {
+        r[i] = kenbak_gate_get_net(g, r_names[i]);
+        l[i] = kenbak_gate_get_net(g, l_names[i]);
+    }
+
+    int const a = kenbak_gate_get_net(g, "a");
+    int const b = kenbak_gate_get_net(g, "b");
+    int const sum = kenbak_gate_get_net(g, "sum");
+    int const cm = kenbak_gate_get_net(g, "cm");
+
+    // L is one byte ahead of the memory (see wait_for_cm() of
+    // kenbak_emu_core.h):
+    //
+    uint64_t l_words[7] = { 0 };
+
+    for(int i = 0; i < KENBAK_GATE_LANES && diff == NULL; ++i)
+    {
+        lanes[i].d = create_random(true);
+        if(lanes[i].d == NULL)
+        {
+            diff = "creation";
+            break;
+        }
+
+        uint32_t const addr =
+            (lanes[i].d->byte_times + 1) % KENBAK_DATA_DELAY_LINE_SIZE;
+
+        for(int bit = 0; bit < 7; ++bit)
+        {
+            l_words[bit] |= (uint64_t)((addr >> bit) & 1) << i;
+        }
+        diff = begin_gate_step(lanes + i, instr_count);
+    }
+    for(int bit = 0; bit < 7; ++bit)
+    {
+        kenbak_gate_set(g, l[bit], l_words[bit]);
+    }
+
+    bool done = false;
+
+    while(diff == NULL && !done)
+    {
+        uint64_t r_words[7] = { 0 };
+
+        for(int i = 0; i < KENBAK_GATE_LANES; ++i)
+        {
+            for(int bit = 0; bit < 7; ++bit)
+            {
+                r_words[bit] |=
+                    (uint64_t)((lanes[i].d->sig_r >> bit) & 1) << i;
+            }
+        }
+        for(int bit = 0; bit < 7; ++bit)
+        {
+            kenbak_gate_set(g, r[bit], r_words[bit]);
+        }
+
+        // The lanes not adding get random operands, so a carry left over
+        // from one byte time would show in the next addition:
+        //
+        for(int i = 0; i < KENBAK_GATE_LANES; ++i)
+        {
+            if(!lanes[i].is_add)
+            {
+                lanes[i].a = (uint8_t)get_rand();
+                lanes[i].b = (uint8_t)get_rand();
+            }
+        }
+
+        // One byte time (T0 to T7):
+
+        for(int t = 0; t < 8; ++t)
+        {
+            uint64_t a_word = 0;
+            uint64_t b_word = 0;
+
+            for(int i = 0; i < KENBAK_GATE_LANES; ++i)
+            {
+                a_word |= (uint64_t)((lanes[i].a >> t) & 1) << i;
+                b_word |= (uint64_t)((lanes[i].b >> t) & 1) << i;
+            }
+            kenbak_gate_set(g, a, a_word);
+            kenbak_gate_set(g, b, b_word);
+
+            uint64_t const sum_word = kenbak_gate_get(g, sum);
+            uint64_t const cm_word = t == 7 ? kenbak_gate_get(g, cm) : 0;
+
+            for(int i = 0; i < KENBAK_GATE_LANES; ++i)
+            {
+                lanes[i].sum |= (uint8_t)(((sum_word >> i) & 1) << t);
+                if(t == 7 && lanes[i].is_cm_checked
+                    && ((cm_word >> i) & 1) != (lanes[i].left == 1))
+                {
+                    diff = "CM";
+                }
+            }
+            kenbak_gate_clock(g);
+        }
+
+        // Checks and next steps of the lanes whose steps ended:
+
+        for(int bit = 0; bit < 7; ++bit)
+        {
+            l_words[bit] = kenbak_gate_get(g, l[bit]);
+        }
+        done = true;
+        for(int i = 0; i < KENBAK_GATE_LANES && diff == NULL; ++i)
+        {
+            struct gate_lane * const lane = lanes + i;
+
+            if(lane->left == 0) // (done with its steps)
+            {
+                continue;
+            }
+            if(--lane->left != 0)
+            {
+                done = false;
+                continue;
+            }
+
+            uint32_t addr = 0;
+
+            for(int bit = 0; bit < 7; ++bit)
+            {
+                addr |= (uint32_t)((l_words[bit] >> i) & 1) << bit;
+            }
+            if(addr
+                != (lane->d->byte_times + 1) % KENBAK_DATA_DELAY_LINE_SIZE)
+            {
+                diff = "L";
+            }
+            else if(lane->is_add && lane->sum != lane->d->reg_w)
+            {
+                diff = "sum";
+            }
+            ++*check_count;
+            lane->is_cm_checked = false;
+            lane->is_add = false;
+            if(diff == NULL && lane->steps < KENBAK_DIFF_STEPS_PER_GATE_PROG)
+            {
+                diff = begin_gate_step(lane, instr_count);
+                done = false;
+            }
+        }
+    }
+
+    for(int i = 0; i < KENBAK_GATE_LANES; ++i)
+    {
+        if(lanes[i].d != NULL)
+        {
+            kenbak_emu_delete(lanes[i].d);
+        }
+    }
+    kenbak_gate_delete(g);
+    return diff;
+}
+
+bool kenbak_diff_gate(int const prog_count)
+{
+    long check_count = 0;
+    long instr_count = 0;
+    int batch = 0;
+
+    for(; batch * KENBAK_GATE_LANES < prog_count; ++batch)
+    {
+        char const * const diff =
+            diff_gate_batch(&check_count, &instr_count);
+
+        if(diff != NULL)
+        {
+            printf("Difference in %s: Batch %d.\n", diff, batch);
+            return false;
+        }
+    }
+
+    printf(
+        "No difference found in %d programs (%ld step ends checked,"
+            " %ld instructions).\n",
+        batch * KENBAK_GATE_LANES,
+        check_count,
+        instr_count);
+    return true;
+}
+
+// *****************************************************************************
+// *** STATIC RECOMPILER                                                     ***
+// *****************************************************************************
+
+/** Writes one translation unit for the given program via
+ *  kenbak_recomp_write_driver() (with the given maximum instruction count) or
+ *  kenbak_recomp_write_prog() to the file with the given index in the given
+ *  directory (see kenbak_diff_write_recomp()).
+ */
+static bool write_recomp_file(
+    char const * const dir,
+    bool const driver,
+    int const index,
+    uint8_t const * const mem,
+    uint64_t const max_instrs)
+{
+    char path[KENBAK_DIFF_RECOMP_PATH_SIZE];
+    char name[32];
+    FILE * out = NULL;
+    bool ret_val = false;
+
+    snprintf(name, sizeof name, "kenbak_recomp_prog%d", index);
+    snprintf(
+        path,
+        sizeof path,
+        "%s/kenbak_recomp_%s%d.c",
+        dir,
+        driver ? "driver" : "prog",
+        index);
+
+    out = fopen(path, "w");
+    if(out == NULL)
+    {
+        printf("Failed to open \"%s\"!\n", path);
+        return false;
+    }
+    if(driver)
+    {
+        ret_val = kenbak_recomp_write_driver(out, name, mem, max_instrs);
+    }
+    else
+    {
+        ret_val = kenbak_recomp_write_prog(out, name, mem);
+    }
+    return fclose(out) == 0 && ret_val;
+}
+
+bool kenbak_diff_write_recomp(char const * const dir, int const prog_count)
+{
+    for(int prog = 0; prog < prog_count; ++prog)
+    {
+        uint8_t mem[KENBAK_DATA_MEM_SIZE];
+        uint64_t const max_instrs = (uint64_t)(1 + get_rand()); // Up to 32768.
+
+        fill_mem(mem);
+        if(prog % 4 == 1)
+        {
+            plant_counter_loop(mem);
+        }
+        else if(prog % 4 == 2)
+        {
+            plant_mul_calls(mem);
+        }
+
+        if(!write_recomp_file(dir, false, prog, mem, max_instrs)
+            || !write_recomp_file(dir, true, prog, mem, max_instrs))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Differential tests of the emulator's faster ways of execution against
+// kenbak_emu_step() (printed to stdout).
+
+#ifndef KENBAK_DIFF
+#define KENBAK_DIFF
+
+#include <stdbool.h>
+
+/**
+ * - Runs the given count of random programs (some containing countdown loops,
+ *   many modifying themselves) via kenbak_emu_run() with the threaded code
+ *   enabled (see kenbak_emu_set_threaded_code()) and compares the results and
+ *   the whole state after each run with the ones reached by calling
+ *   kenbak_emu_step() for each state.
+ * - Each run gets random limits (see struct kenbak_run_limits): Budgets of
+ *   steps, byte times and/or instructions and, optionally, stops at QC, at an
+ *   output or at a random address.
+ * - Every second program runs with the timing model enabled, every second
+ *   pair of programs with the JIT enabled, too, where available (see
+ *   kenbak_emu_set_jit()), and every fourth pair without the code cache.
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_threaded_code(int const prog_count);
+
+/**
+ * - Like kenbak_diff_threaded_code(), but with the memoization of calls
+ *   enabled, too (see kenbak_emu_set_memo()) and half of the programs calling
+ *   a multiplication subroutine with repeating arguments.
+ */
+bool kenbak_diff_memo(int const prog_count);
+
+/**
+ * - Runs the given count of random programs (half of them with a counter loop
+ *   that cycles) with a random step budget via kenbak_emu_run(), once with
+ *   cycles being skipped (see skip_cycles of struct kenbak_run_limits) and
+ *   once without, and compares the results and the whole states.
+ * - Every second program runs with the timing model enabled.
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_cycle_skip(int const prog_count);
+
+/**
+ * - Runs the given count of random programs (with the timing model and a data
+ *   button pressed for a while) via the bit-serial engine (see
+ *   kenbak_serial.h) and via kenbak_emu_step(), step by step, and compares the
+ *   bit times passed with the byte times after each step and the whole states
+ *   at each instruction boundary (states SA and QC).
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_serial(int const prog_count);
+
+/**
+ * - Runs at least the given count of random programs in batches, one program
+ *   per lane of a bitsliced engine (see kenbak_slice.h, every second batch of
+ *   two in the 256-lane engine, if available), and via kenbak_emu_step(), step
+ *   by step, and compares the whole states every few hundred steps.
+ * - Every second batch runs with the timing model enabled.
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_slice(int const prog_count);
+
+/**
+ * - Runs the given count of random programs together in the lockstep engine
+ *   (see kenbak_multi.h, half of them with the timing model enabled, in a
+ *   second engine, stepped on three threads) and via kenbak_emu_step(), step
+ *   by step, and compares the whole states every few hundred steps.
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_multi(int const prog_count);
+
+/**
+ * - Runs at least the given count of random programs in batches via
+ *   kenbak_emu_step() with the timing model enabled, step by step, each one
+ *   driving one lane of the gate-level simulator with the bundled timing
+ *   netlist (see kenbak_gate_net.h), bit time by bit time, and compares the
+ *   address counter L at the end of each step, CM while waiting for it and
+ *   the serial adder's sums of P and W (states SB and SJ) with the emulator's
+ *   ones.
+ * - Prints the first difference found.
+ * - Returns true, if no difference was found.
+ */
+bool kenbak_diff_gate(int const prog_count);
+
+/**
+ * - Writes the given count of random programs (some with a counter loop or
+ *   calls of a subroutine) as pairs of C translation units to the given
+ *   directory (which must exist): "kenbak_recomp_prog<i>.c" via
+ *   kenbak_recomp_write_prog() and "kenbak_recomp_driver<i>.c" via
+ *   kenbak_recomp_write_driver(), i being the index from 0.
+ * - Each driver, compiled and linked with its program and the library,
+ *   compares the recompiled program with kenbak_emu_step() (see
+ *   CMakeLists.txt, one test each).
+ * - Returns false on error.
+ */
+bool kenbak_diff_write_recomp(char const * const dir, int const prog_count);
+
+#endif //KENBAK_DIFF
@@ -0,0 +1,88 @@
+
+// Marcel Timm, RhinoDevel, 2026oct16
+
+// Runs the exhaustive check of the state machine's invariants (see
+// kenbak_check.h) or one of the differential tests (see kenbak_diff.h), with
+// the given count of random programs, e.g. "kenbak_test slice 500" (see
+// CMakeLists.txt, one test each), or the benchmarks (see kenbak_bench.h) via
+// "kenbak_test bench", or writes the recompiled random programs to a directory
+// via "kenbak_test recomp <dir> <programs>" (see kenbak_diff_write_recomp()).
+//
+// - Exits with EXIT_SUCCESS, if no invariant got violated or no difference
+//   was found.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "kenbak_check.h"
+#include "kenbak_diff.h"
+#include "kenbak_bench.h"
+
+struct kenbak_test
+{
+    char const * name;
+    bool (* diff)(int const prog_count);
+};
+
+static struct kenbak_test const s_tests[] = {
+    { "threaded_code", kenbak_diff_threaded_code },
+    { "memo", kenbak_diff_memo },
+    { "cycle_skip", kenbak_diff_cycle_skip },
+    { "serial", kenbak_diff_serial },
+    { "slice", kenbak_diff_slice },
+    { "multi", kenbak_diff_multi },
+    { "gate", kenbak_diff_gate }
+};
+
+int main(int argc, char * argv[])
+{
+    if(argc == 2 && strcmp(argv[1], "check") == 0)
+    {
+        return kenbak_check_exhaustive() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if(argc == 2 && strcmp(argv[1], "bench") == 0)
+    {
+        kenbak_bench_dispatch();
+        kenbak_bench_variants();
+        kenbak_bench_code_cache();
+        kenbak_bench_memo();
+        kenbak_bench_pool();
+        kenbak_bench_serial();
+        kenbak_bench_slice();
+        kenbak_bench_multi();
+        kenbak_bench_gate();
+        return EXIT_SUCCESS;
+    }
+    if(argc == 4 && strcmp(argv[1], "recomp") == 0 && 0 < atoi(argv[3]))
+    {
+        return kenbak_diff_write_recomp(argv[2], atoi(argv[3]))
+            ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    for(int i = 0;
+        argc == 3 && i < (int)(sizeof s_tests / sizeof *s_tests);
+        ++i)
+    {
+        int const prog_count = atoi(argv[2]);
+
+        if(strcmp(argv[1], s_tests[i].name) != 0 || prog_count <= 0)
+        {
+            continue;
+        }
+        return s_tests[i].diff(prog_count) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    printf(
+        "Usage: kenbak_test check | kenbak_test bench"
+            " | kenbak_test recomp <dir> <programs>"
+            " | kenbak_test <test> <programs>\n");
+    printf("Tests:");
+    for(int i = 0; i < (int)(sizeof s_tests / sizeof *s_tests); ++i)
+    {
+        printf(" %s", s_tests[i].name);
+    }
+    printf("\n");
+    return EXIT_FAILURE;
+}